@@ -20,14 +20,9 @@ Dynamic_prop_handle
 Dynamic_prop_manager::create(Dynamic_prop_create_info const &create_info) {
   auto &value = _entities[_next_entity_handle_value];
   value.manager = this;
-  auto const prop_transform =
-      math::Mat4x4f::rigid(create_info.position, create_info.orientation);
-  auto const surface_pretransform_4x4 =
-      math::Mat4x4f{_surface_pretransform_3x4, {0.0f, 0.0f, 0.0f, 1.0}};
-  auto const surface_transform_4x4 = prop_transform * surface_pretransform_4x4;
-  auto const surface_transform_3x4 = math::Mat3x4f{surface_transform_4x4[0],
-                                                   surface_transform_4x4[1],
-                                                   surface_transform_4x4[2]};
+  auto const prop_transform = math::Rigid_transform{
+      .position = create_info.position, .orientation = create_info.orientation};
+  auto const surface_transform_3x4 = prop_transform * _surface_pretransform_3x4;
   value.surface = {
       .mesh = _surface_mesh,
       .material = _surface_material,
@@ -68,17 +63,8 @@ Dynamic_prop_manager::get_rigid_body(Dynamic_prop_handle prop) const noexcept {
 
 void Dynamic_prop_manager::Entity::on_rigid_body_motion(
     physics::World const &world, physics::Rigid_body rigid_body) {
-  auto const position = world.data(rigid_body)->position();
-  auto const orientation = world.data(rigid_body)->orientation();
-  auto const prop_transform = math::Mat4x4f::rigid(position, orientation);
-  auto const &surface_pretransform_3x4 = manager->_surface_pretransform_3x4;
-  auto const surface_pretransform_4x4 =
-      math::Mat4x4f{surface_pretransform_3x4, {0.0f, 0.0f, 0.0f, 1.0}};
-  auto const surface_transform_4x4 = prop_transform * surface_pretransform_4x4;
-  auto const surface_transform_3x4 = math::Mat3x4f{surface_transform_4x4[0],
-                                                   surface_transform_4x4[1],
-                                                   surface_transform_4x4[2]};
-  surface.transform = surface_transform_3x4;
+  auto const prop_transform = world.data(rigid_body)->transform();
+  surface.transform = prop_transform * manager->_surface_pretransform_3x4;
 }
 } // namespace client
 } // namespace marlon
\ No newline at end of file
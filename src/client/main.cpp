@@ -1,4 +1,3 @@
-#include <fstream>
 #include <iostream>
 #include <stdexcept>
 
@@ -7,6 +6,8 @@
 
 #include "../engine/app.h"
 #include "../graphics/graphics.h"
+#include "../util/mapped_file.h"
+#include "../util/tracking_allocator.h"
 
 using namespace marlon;
 using enum engine::Key;
@@ -56,21 +57,12 @@ Resources create_resources(graphics::Graphics *graphics) {
 }
 
 graphics::Unique_texture create_texture(graphics::Graphics *graphics, const char *path) {
-  std::ifstream in{path, std::ios_base::binary};
-  if (in) {
-    in.seekg(0, std::ios_base::end);
-    auto const file_size = static_cast<std::size_t>(in.tellg());
-    auto data = std::vector<char>();
-    data.resize(file_size);
-    in.seekg(0, std::ios_base::beg);
-    in.read(data.data(), file_size);
-    return graphics->create_texture_unique({
-        .data = data.data(),
-        .size = data.size(),
-    });
-  } else {
-    throw std::runtime_error{"Failed to open texture file."};
-  }
+  // ktx reads the levels straight out of the page cache while uploading
+  auto const file = util::Mapped_file{{
+      .path = path,
+      .access_pattern = util::File_access_pattern::sequential,
+  }};
+  return graphics->create_texture_unique({.data = file.data()});
 }
 
 graphics::Unique_surface_mesh create_cube_mesh(graphics::Graphics *graphics) {
@@ -581,4 +573,10 @@ private:
   double _total_narrowphase_wall_time{0.0};
 };
 
-int main() { return Client{}.run(); }
\ No newline at end of file
+int main() {
+  auto const result = Client{}.run();
+  if constexpr (util::allocation_tracking_enabled) {
+    util::write_allocation_report(std::cout);
+  }
+  return result;
+}
\ No newline at end of file
@@ -16,14 +16,9 @@ Static_prop_handle
 Static_prop_manager::create(Static_prop_create_info const &create_info) {
   auto &value = _entities[_next_entity_handle_value];
   // TODO: consider exceptions in scene node creation
-  auto const prop_transform =
-      math::Mat4x4f::rigid(create_info.position, create_info.orientation);
-  auto const surface_pretransform_4x4 =
-      math::Mat4x4f{_surface_pretransform_3x4, {0.0f, 0.0f, 0.0f, 1.0f}};
-  auto const surface_transform_4x4 = prop_transform * surface_pretransform_4x4;
-  auto const surface_transform_3x4 = math::Mat3x4f{surface_transform_4x4[0],
-                                                   surface_transform_4x4[1],
-                                                   surface_transform_4x4[2]};
+  auto const prop_transform = math::Rigid_transform{
+      .position = create_info.position, .orientation = create_info.orientation};
+  auto const surface_transform_3x4 = prop_transform * _surface_pretransform_3x4;
   value.surface = {
       .mesh = _surface_mesh,
       .material = _surface_material,
@@ -56,6 +56,8 @@ public:
 
   graphics::Camera *get_camera() noexcept { return &_camera; }
 
+  util::Io_service *get_io_service() noexcept { return &_io_service; }
+
   void render() {
     _render_stream->render();
     glfwSwapBuffers(_window.get_glfw_window());
@@ -70,6 +72,8 @@ private:
   graphics::Scene _scene;
   graphics::Camera _camera;
   graphics::Unique_render_stream _render_stream;
+  // destroyed first, reads in flight finish before the members above go away
+  util::Io_service _io_service;
 };
 
 App::App(App_create_info const &create_info)
@@ -127,6 +131,8 @@ graphics::Camera const *App::get_camera() const noexcept { return _runtime->get_
 
 graphics::Camera *App::get_camera() noexcept { return _runtime->get_camera(); }
 
+util::Io_service *App::get_io_service() noexcept { return _runtime->get_io_service(); }
+
 bool App::is_looping() const noexcept { return _looping; }
 
 void App::stop_looping() noexcept { _looping = false; }
@@ -145,6 +151,7 @@ void App::loop() {
     _loop_iteration_wall_time = std::chrono::duration_cast<duration>(current_time - previous_time).count();
     previous_time = current_time;
     accumulated_time += _loop_iteration_wall_time;
+    _runtime->get_io_service()->poll();
     _runtime->get_window()->pre_input();
     pre_input();
     glfwPollEvents();
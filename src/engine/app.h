@@ -6,6 +6,7 @@
 
 #include "../graphics/graphics.h"
 #include "../physics/physics.h"
+#include "../util/io_service.h"
 #include "../util/thread_pool.h"
 #include "window.h"
 
@@ -51,6 +52,10 @@ protected:
 
   graphics::Camera *get_camera() noexcept;
 
+  // Completions are reported once per loop iteration, before input, on the
+  // thread owning the graphics context
+  util::Io_service *get_io_service() noexcept;
+
   bool is_looping() const noexcept;
 
   void stop_looping() noexcept;
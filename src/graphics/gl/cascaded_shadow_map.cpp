@@ -1,6 +1,8 @@
 #include "cascaded_shadow_map.h"
 
+#include <array>
 #include <iostream>
+#include <span>
 #include <stdexcept>
 
 #include <glad/gl.h>
@@ -37,6 +39,43 @@ auto constexpr fragment_shader_source = R"(
 void main() {
 }
 )";
+
+// Calls f(surface, light_space_bounds) for every shadow casting surface of
+// the scene, transforming their bounds in batches
+template <typename F>
+void for_each_shadow_caster(Scene const &scene,
+                            Mat3x4f const &world_to_light_matrix,
+                            F &&f) {
+  auto constexpr batch_size = std::size_t{64};
+  auto surfaces = std::array<Surface const *, batch_size>{};
+  auto model_to_light_matrices = std::array<Mat3x4f, batch_size>{};
+  auto bounds = std::array<Aabb3f, batch_size>{};
+  auto count = std::size_t{};
+  auto const flush = [&] {
+    auto const light_space_bounds = std::span{bounds}.first(count);
+    transform_aabbs(std::span{model_to_light_matrices}.first(count),
+                    light_space_bounds,
+                    light_space_bounds);
+    for (auto i = std::size_t{}; i != count; ++i) {
+      f(surfaces[i], light_space_bounds[i]);
+    }
+    count = 0;
+  };
+  for (auto const surface : scene.surfaces()) {
+    if (surface->shadow_casting) {
+      surfaces[count] = surface;
+      model_to_light_matrices[count] =
+          world_to_light_matrix *
+          Mat4x4f{surface->transform, {0.0f, 0.0f, 0.0f, 1.0f}};
+      bounds[count] = static_cast<Surface_mesh const *>(surface->mesh)
+                          ->model_space_bounds();
+      if (++count == batch_size) {
+        flush();
+      }
+    }
+  }
+  flush();
+}
 } // namespace
 
 Cascaded_shadow_map::Intrinsic_state::Intrinsic_state(
@@ -164,16 +203,10 @@ void Cascaded_shadow_map::draw(
               tan_half_fov.y * cascade_far,
               -cascade_far},
     };
-    auto const light_space_frustum_vertices = std::array<Vec3f, 8>{
-        camera_to_light_matrix * Vec4f{camera_space_frustum_vertices[0], 1.0f},
-        camera_to_light_matrix * Vec4f{camera_space_frustum_vertices[1], 1.0f},
-        camera_to_light_matrix * Vec4f{camera_space_frustum_vertices[2], 1.0f},
-        camera_to_light_matrix * Vec4f{camera_space_frustum_vertices[3], 1.0f},
-        camera_to_light_matrix * Vec4f{camera_space_frustum_vertices[4], 1.0f},
-        camera_to_light_matrix * Vec4f{camera_space_frustum_vertices[5], 1.0f},
-        camera_to_light_matrix * Vec4f{camera_space_frustum_vertices[6], 1.0f},
-        camera_to_light_matrix * Vec4f{camera_space_frustum_vertices[7], 1.0f},
-    };
+    auto light_space_frustum_vertices = std::array<Vec3f, 8>{};
+    transform_points(camera_to_light_matrix,
+                     camera_space_frustum_vertices,
+                     light_space_frustum_vertices);
     auto light_space_cascade_bounds_xy =
         Aabb2f{light_space_frustum_vertices[0].xy()};
     auto light_space_cascade_min_z = light_space_frustum_vertices[0].z;
@@ -202,32 +235,16 @@ void Cascaded_shadow_map::draw(
     // auto const view_space_cascade_min_z =
     //     sphere_center_light_space.z - sphere_radius;
     // auto view_space_cascade_max_z = view_space_cascade_min_z;
-    for (auto const surface : scene.surfaces()) {
-      if (surface->shadow_casting) {
-        auto const model_to_light_matrix =
-            world_to_light_matrix *
-            Mat4x4f{surface->transform, {0.0f, 0.0f, 0.0f, 1.0f}};
-        auto const &model_space_surface_bounds =
-            static_cast<Surface_mesh const *>(surface->mesh)
-                ->model_space_bounds();
-        auto const light_space_surface_bounds_center =
-            model_to_light_matrix *
-            Vec4f{center(model_space_surface_bounds), 1.0f};
-        auto const light_space_surface_bounds_half_extents =
-            abs(model_to_light_matrix) *
-            Vec4f{0.5f * extents(model_space_surface_bounds), 0.0f};
-        auto const light_space_surface_bounds =
-            Aabb3f{light_space_surface_bounds_center -
-                       light_space_surface_bounds_half_extents,
-                   light_space_surface_bounds_center +
-                       light_space_surface_bounds_half_extents};
-        if (overlaps(light_space_surface_bounds.xy(),
-                     light_space_cascade_bounds_xy)) {
-          light_space_cascade_max_z =
-              max(light_space_cascade_max_z, light_space_surface_bounds.max.z);
-        }
-      }
-    }
+    for_each_shadow_caster(
+        scene,
+        world_to_light_matrix,
+        [&](Surface const *, Aabb3f const &light_space_surface_bounds) {
+          if (overlaps(light_space_surface_bounds.xy(),
+                       light_space_cascade_bounds_xy)) {
+            light_space_cascade_max_z = max(light_space_cascade_max_z,
+                                            light_space_surface_bounds.max.z);
+          }
+        });
     auto const light_space_cascade_bounds = Aabb3f{
         Vec3f{light_space_cascade_bounds_xy.min, light_space_cascade_min_z},
         Vec3f{light_space_cascade_bounds_xy.max, light_space_cascade_max_z}};
@@ -252,36 +269,23 @@ void Cascaded_shadow_map::draw(
     glClear(GL_DEPTH_BUFFER_BIT);
     glUseProgram(_intrinsic_state->shader_program());
     glBindBufferBase(GL_UNIFORM_BUFFER, 0, cascade.uniform_buffer().get());
-    for (auto const surface : scene.surfaces()) {
-      if (surface->shadow_casting) {
-        auto const mesh = static_cast<Surface_mesh const *>(surface->mesh);
-        auto const &model_space_surface_bounds = mesh->model_space_bounds();
-        auto const model_to_light_matrix =
-            world_to_light_matrix *
-            Mat4x4f{surface->transform, {0.0f, 0.0f, 0.0f, 1.0f}};
-        auto const light_space_surface_bounds_center =
-            model_to_light_matrix *
-            Vec4f{center(model_space_surface_bounds), 1.0f};
-        auto const light_space_surface_bounds_half_extents =
-            abs(world_to_light_matrix) *
-            Vec4f{0.5f * extents(model_space_surface_bounds), 0.0f};
-        auto const light_space_surface_bounds =
-            Aabb3f{light_space_surface_bounds_center -
-                       light_space_surface_bounds_half_extents,
-                   light_space_surface_bounds_center +
-                       light_space_surface_bounds_half_extents};
-        if (overlaps(light_space_surface_bounds, light_space_cascade_bounds)) {
-          glBindBufferRange(
-              GL_UNIFORM_BUFFER,
-              1,
-              acquired_surface_resource.uniform_buffer(),
-              acquired_surface_resource.uniform_buffer_offset(surface),
-              48);
-          mesh->bind_vertex_array();
-          mesh->draw();
-        }
-      }
-    }
+    for_each_shadow_caster(
+        scene,
+        world_to_light_matrix,
+        [&](Surface const *surface, Aabb3f const &light_space_surface_bounds) {
+          if (overlaps(light_space_surface_bounds,
+                       light_space_cascade_bounds)) {
+            auto const mesh = static_cast<Surface_mesh const *>(surface->mesh);
+            glBindBufferRange(
+                GL_UNIFORM_BUFFER,
+                1,
+                acquired_surface_resource.uniform_buffer(),
+                acquired_surface_resource.uniform_buffer_offset(surface),
+                48);
+            mesh->bind_vertex_array();
+            mesh->draw();
+          }
+        });
     auto const light_space_cascade_extents =
         extents(light_space_cascade_bounds.xy());
     auto const pixel_length =
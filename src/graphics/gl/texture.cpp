@@ -12,12 +12,12 @@ namespace graphics {
 namespace gl {
 namespace {
 ktxTexture2 *create_ktx_texture(Texture_create_info const &create_info) {
-  assert(create_info.data != nullptr);
-  assert(create_info.size != 0);
+  assert(create_info.data.begin != nullptr);
+  assert(create_info.data.size() != 0);
   ktxTexture2 *retval{};
   auto const result = ktxTexture2_CreateFromMemory(
-      static_cast<ktx_uint8_t const *>(create_info.data),
-      static_cast<ktx_size_t>(create_info.size),
+      reinterpret_cast<ktx_uint8_t const *>(create_info.data.begin),
+      static_cast<ktx_size_t>(create_info.data.size()),
       KTX_TEXTURE_CREATE_NO_FLAGS,
       &retval);
   if (result != KTX_SUCCESS) {
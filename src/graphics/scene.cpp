@@ -1,22 +1,31 @@
 #include "scene.h"
 
+#include <util/tracking_allocator.h>
+
 namespace marlon {
 namespace graphics {
 using namespace math;
 using namespace util;
 
 namespace {
+constinit auto scene_allocation_tag = Allocation_tag{"graphics::Scene"};
+
+Tracking_allocator<System_allocator> scene_allocator() noexcept {
+  return Tracking_allocator<System_allocator>{System_allocator{},
+                                              scene_allocation_tag};
+}
+
 constexpr std::size_t memory_requirement(std::size_t max_surfaces,
                                          std::size_t max_wireframes) noexcept {
   return Stack_allocator<>::memory_requirement({
-      Set<Surface *>::memory_requirement(max_surfaces),
-      Set<Wireframe *>::memory_requirement(max_wireframes),
+      Flat_set<Surface const *>::memory_requirement(max_surfaces),
+      Flat_set<Wireframe const *>::memory_requirement(max_wireframes),
   });
 }
 } // namespace
 
 Scene::Scene(Scene_create_info const &create_info) noexcept
-    : _memory{System_allocator{}.alloc(memory_requirement(
+    : _memory{scene_allocator().alloc(memory_requirement(
           create_info.max_surfaces, create_info.max_wireframes))} {
   auto allocator = Stack_allocator<>{_memory};
   _surfaces =
@@ -28,7 +37,7 @@ Scene::Scene(Scene_create_info const &create_info) noexcept
 Scene::~Scene() {
   _wireframes = {};
   _surfaces = {};
-  System_allocator{}.free(_memory);
+  scene_allocator().free(_memory);
 }
 } // namespace graphics
 } // namespace marlon
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include <memory>
 #include <optional>
 
-#include <util/set.h>
+#include <util/flat_set.h>
 
 #include "directional_light.h"
 #include "surface.h"
@@ -37,9 +37,9 @@ public:
     _directional_light = directional_light;
   }
 
-  util::Set<Surface const *> const &surfaces() const noexcept { return _surfaces; }
+  util::Flat_set<Surface const *> const &surfaces() const noexcept { return _surfaces; }
 
-  util::Set<Wireframe const *> const &wireframes() const noexcept { return _wireframes; }
+  util::Flat_set<Wireframe const *> const &wireframes() const noexcept { return _wireframes; }
 
   void clear() {
     _sky_irradiance = Rgb_spectrum::black();
@@ -62,8 +62,8 @@ public:
 
 private:
   util::Block _memory;
-  util::Set<Surface const *> _surfaces;
-  util::Set<Wireframe const *> _wireframes;
+  util::Flat_set<Surface const *> _surfaces;
+  util::Flat_set<Wireframe const *> _wireframes;
   Rgb_spectrum _sky_irradiance{Rgb_spectrum::black()};
   Rgb_spectrum _ground_albedo{Rgb_spectrum{0.25f}};
   std::optional<Directional_light> _directional_light;
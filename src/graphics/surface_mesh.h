@@ -13,6 +13,8 @@ struct Surface_vertex {
   math::Vec2f texcoord;
 };
 
+// The spans are uploaded directly, they may view a util::Mapped_file through
+// util::Mapped_file::as_span
 struct Surface_mesh_create_info {
   std::span<std::uint16_t const> indices;
   std::span<Surface_vertex const> vertices;
@@ -7,11 +7,14 @@
 
 #include <variant>
 
+#include "../util/memory.h"
+
 namespace marlon {
 namespace graphics {
 struct Texture_create_info {
-  void const *data;
-  std::size_t size;
+  // Contents of a ktx2 file, e.g. util::Mapped_file::data(). Only needs to
+  // stay valid until the texture is created.
+  util::Const_block data;
 };
 
 class Texture {};
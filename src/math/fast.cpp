@@ -0,0 +1,137 @@
+#include "fast.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace math {
+namespace {
+constexpr auto random_float(std::uint32_t &state) noexcept {
+  state = state * 1664525u + 1013904223u;
+  return static_cast<float>(static_cast<std::int32_t>(state >> 8) - (1 << 23)) /
+         static_cast<float>(1 << 21);
+}
+
+// |actual - expected| in units of the last place of expected rounded to float
+double ulp_error(float actual, double expected) noexcept {
+  auto const rounded = std::abs(static_cast<float>(expected));
+  auto const ulp =
+      static_cast<double>(std::nextafter(
+          rounded, std::numeric_limits<float>::infinity())) -
+      static_cast<double>(rounded);
+  return std::abs(static_cast<double>(actual) - expected) / ulp;
+}
+
+// largest ulp_error(f(x), g(x)) over every stride-th float x with a bit
+// pattern in [first, last)
+template <typename F, typename G>
+double max_ulp_error(std::uint32_t first,
+                     std::uint32_t last,
+                     std::uint32_t stride,
+                     F &&f,
+                     G &&g) {
+  auto retval = 0.0;
+  for (auto bits = first; bits < last; bits += stride) {
+    auto const x = std::bit_cast<float>(bits);
+    retval = std::max(retval, ulp_error(f(x), g(double{x})));
+  }
+  return retval;
+}
+
+auto constexpr min_normal_bits = std::uint32_t{0x00800000};
+auto constexpr infinity_bits = std::uint32_t{0x7f800000};
+} // namespace
+
+TEST_CASE("fast::rsqrt is within 4 ulp") {
+  REQUIRE(max_ulp_error(
+              min_normal_bits,
+              infinity_bits,
+              4099,
+              [](float x) { return fast::rsqrt(x); },
+              [](double x) { return 1.0 / std::sqrt(x); }) <= 4.0);
+}
+
+TEST_CASE("fast::length and fast::normalize are within 5 ulp") {
+  auto state = std::uint32_t{11};
+  auto length_error = 0.0;
+  auto normalize_error = 0.0;
+  for (auto i = 0; i != 100000; ++i) {
+    auto const x = random_float(state);
+    auto const y = random_float(state);
+    auto const z = random_float(state);
+    auto const v = Vec3f{x, y, z};
+    auto const exact = std::sqrt(double{x} * x + double{y} * y + double{z} * z);
+    if (exact == 0.0) {
+      continue;
+    }
+    length_error = std::max(length_error, ulp_error(fast::length(v), exact));
+    auto const n = fast::normalize(v);
+    for (auto j = 0; j != 3; ++j) {
+      normalize_error =
+          std::max(normalize_error, ulp_error(n[j], v[j] / exact));
+    }
+  }
+  REQUIRE(length_error <= 5.0);
+  REQUIRE(normalize_error <= 5.0);
+}
+
+TEST_CASE("fast::renormalize converges to unit length") {
+  auto state = std::uint32_t{13};
+  for (auto i = 0; i != 1000; ++i) {
+    auto const w = random_float(state);
+    auto const x = random_float(state);
+    auto const y = random_float(state);
+    auto const z = random_float(state);
+    auto q = normalize(Quatf{w, Vec3f{x, y, z}});
+    // an integration step's worth of drift
+    q *= 1.0f + 0.01f * random_float(state) / 4.0f;
+    auto const drift = std::abs(length_squared(q) - 1.0f);
+    q = fast::renormalize(q);
+    REQUIRE(std::abs(length_squared(q) - 1.0f) <= drift * drift + 1e-6f);
+    q = fast::renormalize(q);
+    REQUIRE(std::abs(length_squared(q) - 1.0f) <= 1e-6f);
+  }
+}
+
+TEST_CASE("fast::exp is within 2 ulp") {
+  auto const f = [](float x) { return fast::exp(x); };
+  auto const g = [](double x) { return std::exp(x); };
+  REQUIRE(max_ulp_error(0, std::bit_cast<std::uint32_t>(88.0f), 4099, f, g) <=
+          2.0);
+  REQUIRE(max_ulp_error(
+              0x80000000, std::bit_cast<std::uint32_t>(-87.0f), 4099, f, g) <=
+          2.0);
+}
+
+TEST_CASE("fast::log is within 2 ulp") {
+  REQUIRE(max_ulp_error(
+              min_normal_bits,
+              infinity_bits,
+              4099,
+              [](float x) { return fast::log(x); },
+              [](double x) { return std::log(x); }) <= 2.0);
+}
+
+TEST_CASE("fast::pow is within 4 ulp for small y * ln x") {
+  auto error = 0.0;
+  for (auto i = 1; i <= 1000; ++i) {
+    auto const x = static_cast<float>(i) / 1000.0f;
+    for (auto j = 0; j <= 100; ++j) {
+      auto const y = static_cast<float>(j) / 100.0f;
+      if (std::abs(y * std::log(x)) < 1.0f) {
+        error = std::max(
+            error,
+            ulp_error(fast::pow(x, y), std::pow(double{x}, double{y})));
+      }
+    }
+  }
+  REQUIRE(error <= 4.0);
+}
+} // namespace math
+} // namespace marlon
@@ -0,0 +1,112 @@
+#ifndef MARLON_MATH_FAST_H
+#define MARLON_MATH_FAST_H
+
+#include <bit>
+#include <cstdint>
+
+#include "quat.h"
+#include "scalar.h"
+#include "simd.h"
+#include "vec.h"
+
+namespace marlon {
+namespace math {
+// Approximations of the exact functions for code that can give up a few ulp
+// for speed. The bounds are relative to the correctly rounded result and
+// hold over the stated domain, fast.cpp checks them.
+namespace fast {
+// 1 / sqrt(x) for positive normal x, within 4 ulp. rsqrtss refined by one
+// Newton step, or without SSE the bit trick estimate refined by three.
+inline float rsqrt(float x) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  auto const y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#else
+  auto y = std::bit_cast<float>(std::uint32_t{0x5f375a86} -
+                                (std::bit_cast<std::uint32_t>(x) >> 1));
+  y *= 1.5f - 0.5f * x * y * y;
+  y *= 1.5f - 0.5f * x * y * y;
+#endif
+  // y * (1.5 - 0.5 * x * y * y), written as a correction to y so the
+  // correction's rounding error stays small relative to y
+  return y + y * (0.5f - 0.5f * (x * y) * y);
+}
+
+// length(v) for nonzero v, within 5 ulp
+template <int N> float length(Vec<float, N> const &v) noexcept {
+  auto const length2 = length_squared(v);
+  return length2 * rsqrt(length2);
+}
+
+// normalize(v) for nonzero v, each component within 5 ulp
+template <int N> Vec<float, N> normalize(Vec<float, N> const &v) noexcept {
+  return v * rsqrt(length_squared(v));
+}
+
+inline Quatf normalize(Quatf const &q) noexcept {
+  return q * rsqrt(length_squared(q));
+}
+
+// normalize(q) to first order in length_squared(q) - 1, for quaternions that
+// drifted slightly off unit length, e.g. by an integration step. If
+// length_squared(q) is 1 + e, the result has length 1 - 3 / 8 * e^2 + O(e^3),
+// so repeated renormalization converges to unit length.
+inline Quatf renormalize(Quatf const &q) noexcept {
+  return q * (1.5f - 0.5f * length_squared(q));
+}
+
+namespace detail {
+// round(x) for |x| < 2^22, by the rounding of the addition
+inline float round_to_integer(float x) noexcept {
+  return (x + 12582912.0f) - 12582912.0f;
+}
+} // namespace detail
+
+// e^x within 2 ulp for x in [-87, 88], where the result is a normal float.
+// Other x are clamped into the interval.
+inline float exp(float x) noexcept {
+  x = clamp(x, -87.0f, 88.0f);
+  auto const n = detail::round_to_integer(x * 1.44269504f);
+  // x - n * ln 2, with ln 2 split so the first product is exact
+  auto const r = (x - n * 0.693359375f) + n * 2.12194440e-4f;
+  // e^r - 1 - r for |r| <= ln 2 / 2
+  auto p = 1.9875691500e-4f;
+  p = p * r + 1.3981999507e-3f;
+  p = p * r + 8.3334519073e-3f;
+  p = p * r + 4.1665795894e-2f;
+  p = p * r + 1.6666665459e-1f;
+  p = p * r + 5.0000001201e-1f;
+  auto const e_r = p * (r * r) + r + 1.0f;
+  auto const two_n = std::bit_cast<float>(
+      static_cast<std::uint32_t>(static_cast<std::int32_t>(n) + 127) << 23);
+  return e_r * two_n;
+}
+
+// ln x for positive normal x, within 2 ulp
+inline float log(float x) noexcept {
+  auto const bits = std::bit_cast<std::uint32_t>(x);
+  auto e = static_cast<float>(static_cast<std::int32_t>(bits >> 23) - 127);
+  auto m = std::bit_cast<float>((bits & 0x007fffffu) | 0x3f800000u);
+  if (m > 1.41421356f) {
+    m *= 0.5f;
+    e += 1.0f;
+  }
+  // ln m = 2 atanh(s) for |s| <= 3 - 2 sqrt 2
+  auto const s = (m - 1.0f) / (m + 1.0f);
+  auto const s2 = s * s;
+  auto p = 1.0f / 9.0f;
+  p = p * s2 + 1.0f / 7.0f;
+  p = p * s2 + 1.0f / 5.0f;
+  p = p * s2 + 1.0f / 3.0f;
+  auto const ln_m = 2.0f * s + 2.0f * s * s2 * p;
+  return e * 0.693359375f + (ln_m - e * 2.12194440e-4f);
+}
+
+// x^y for positive normal x, as exp(y * log(x)). The error grows with the
+// magnitude of y * ln x, it is within 4 ulp while that stays below 1, e.g.
+// for the per step damping factors of a simulation.
+inline float pow(float x, float y) noexcept { return exp(y * log(x)); }
+} // namespace fast
+} // namespace math
+} // namespace marlon
+
+#endif
@@ -1,9 +1,37 @@
 #include "mat.h"
 
+#include <array>
+#include <bit>
+#include <cstdint>
+
 #include <catch2/catch_test_macros.hpp>
 
 namespace marlon {
 namespace math {
+namespace {
+constexpr auto random_float(std::uint32_t &state) noexcept {
+  state = state * 1664525u + 1013904223u;
+  return static_cast<float>(static_cast<std::int32_t>(state >> 8) - (1 << 23)) /
+         static_cast<float>(1 << 21);
+}
+
+template <int N>
+constexpr auto random_mat(std::uint32_t &state) noexcept {
+  auto retval = Mat<float, N, 4>::zero();
+  for (auto i = 0; i < N; ++i) {
+    for (auto j = 0; j < 4; ++j) {
+      retval[i][j] = random_float(state);
+    }
+  }
+  return retval;
+}
+
+template <typename T> bool bitwise_equal(T const &a, T const &b) noexcept {
+  using Bits = std::array<std::uint32_t, sizeof(T) / 4>;
+  return std::bit_cast<Bits>(a) == std::bit_cast<Bits>(b);
+}
+} // namespace
+
 static_assert(sizeof(Mat2x2i) == 16);
 static_assert(sizeof(Mat2x2f) == 16);
 static_assert(sizeof(Mat2x2d) == 32);
@@ -39,5 +67,70 @@ TEST_CASE("Matrices can be multiplied") {
                    {3 * 5 + 4 * 7, 3 * 6 + 4 * 8}};
   REQUIRE(a * b == ab);
 }
+
+TEST_CASE("Vectorized matrix operations match the scalar ones bit for bit") {
+  struct Inputs {
+    Mat3x4f a;
+    Mat4x4f b;
+    Vec4f v;
+    Rvec<float, 4> r;
+    Vec3f t;
+    Quatf q;
+  };
+  struct Outputs {
+    Mat3x4f ab;
+    Mat4x4f bb;
+    Vec3f av;
+    Vec4f bv;
+    Rvec<float, 4> rb;
+    Mat3x4f rotation;
+    Mat3x4f rigid;
+  };
+  static constexpr auto inputs = [] {
+    auto retval = std::array<Inputs, 32>{};
+    auto state = std::uint32_t{1};
+    for (auto &input : retval) {
+      input.a = random_mat<3>(state);
+      input.b = random_mat<4>(state);
+      auto const c = random_mat<4>(state);
+      input.v = {c[0][0], c[0][1], c[0][2], c[0][3]};
+      input.r = c[1];
+      input.t = {c[2][0], c[2][1], c[2][2]};
+      input.q = {c[3][0], {c[3][1], c[3][2], c[3][3]}};
+    }
+    // signed zeros
+    retval[0].q = {1.0f, {0.0f, 0.0f, 0.0f}};
+    retval[1].q = {-0.0f, {0.0f, -1.0f, -0.0f}};
+    retval[1].v = {0.0f, -0.0f, 0.0f, -0.0f};
+    return retval;
+  }();
+  constexpr auto expected = [] {
+    auto retval = std::array<Outputs, inputs.size()>{};
+    for (auto i = std::size_t{}; i != inputs.size(); ++i) {
+      auto const &input = inputs[i];
+      retval[i] = {
+          .ab = input.a * input.b,
+          .bb = input.b * input.b,
+          .av = input.a * input.v,
+          .bv = input.b * input.v,
+          .rb = input.r * input.b,
+          .rotation = Mat3x4f::rotation(input.q),
+          .rigid = Mat3x4f::rigid(input.t, input.q),
+      };
+    }
+    return retval;
+  }();
+  for (auto i = std::size_t{}; i != inputs.size(); ++i) {
+    auto const &input = inputs[i];
+    REQUIRE(bitwise_equal(input.a * input.b, expected[i].ab));
+    REQUIRE(bitwise_equal(input.b * input.b, expected[i].bb));
+    REQUIRE(bitwise_equal(input.a * input.v, expected[i].av));
+    REQUIRE(bitwise_equal(input.b * input.v, expected[i].bv));
+    REQUIRE(bitwise_equal(input.r * input.b, expected[i].rb));
+    REQUIRE(bitwise_equal(Mat3x4f::rotation(input.q), expected[i].rotation));
+    REQUIRE(
+        bitwise_equal(Mat3x4f::rigid(input.t, input.q), expected[i].rigid));
+  }
+}
 } // namespace math
 } // namespace marlon
\ No newline at end of file
@@ -115,6 +115,57 @@ private:
   T _components[4];
 };
 
+#ifdef MARLON_MATH_SSE4_1
+namespace detail {
+inline __m128 load(Rvec<float, 4> const &v) noexcept {
+  return _mm_loadu_ps(&v[0]);
+}
+
+inline void store(Rvec<float, 4> &destination, __m128 v) noexcept {
+  _mm_storeu_ps(&destination[0], v);
+}
+
+inline Rvec<float, 4> to_rvec4f(__m128 v) noexcept {
+  Rvec<float, 4> retval;
+  store(retval, v);
+  return retval;
+}
+
+// Writes the rows of Mat3x4f::rotation(r) with t in the last column. Each
+// entry is (diagonal ? 1 - p : p) + q, where p and q are the products the
+// scalar code adds or subtracts and the sign of q is folded into a factor.
+inline void
+rigid_rows(__m128 r, __m128 t, Rvec<float, 4> *destination) noexcept {
+  auto const one = _mm_set1_ps(1.0f);
+  auto const two_r = _mm_add_ps(r, r);
+  auto const p0 =
+      _mm_mul_ps(shuffle<2, 1, 1, 0>(two_r), shuffle<2, 2, 3, 0>(r));
+  auto const q0 =
+      _mm_mul_ps(negate<true, true, false, false>(shuffle<3, 0, 0, 0>(two_r)),
+                 shuffle<3, 3, 2, 0>(r));
+  auto const p1 =
+      _mm_mul_ps(shuffle<1, 1, 2, 0>(two_r), shuffle<2, 1, 3, 0>(r));
+  auto const q1 =
+      _mm_mul_ps(negate<false, true, true, false>(shuffle<0, 3, 0, 0>(two_r)),
+                 shuffle<3, 3, 1, 0>(r));
+  auto const p2 =
+      _mm_mul_ps(shuffle<1, 2, 1, 0>(two_r), shuffle<3, 3, 1, 0>(r));
+  auto const q2 =
+      _mm_mul_ps(negate<true, false, true, false>(shuffle<0, 0, 2, 0>(two_r)),
+                 shuffle<2, 1, 2, 0>(r));
+  auto const row0 =
+      _mm_add_ps(_mm_blend_ps(p0, _mm_sub_ps(one, p0), 0b0001), q0);
+  auto const row1 =
+      _mm_add_ps(_mm_blend_ps(p1, _mm_sub_ps(one, p1), 0b0010), q1);
+  auto const row2 =
+      _mm_add_ps(_mm_blend_ps(p2, _mm_sub_ps(one, p2), 0b0100), q2);
+  store(destination[0], _mm_blend_ps(row0, broadcast<0>(t), 0b1000));
+  store(destination[1], _mm_blend_ps(row1, broadcast<1>(t), 0b1000));
+  store(destination[2], _mm_blend_ps(row2, broadcast<2>(t), 0b1000));
+}
+} // namespace detail
+#endif
+
 template <typename T, int N, int M> class Mat;
 
 template <typename T, int M> class Mat<T, 2, M> {
@@ -177,6 +228,15 @@ public:
 
   static constexpr auto rotation(Quat<T> const &r) noexcept {
     static_assert(M == 3 || M == 4);
+#ifdef MARLON_MATH_SSE4_1
+    if constexpr (std::is_same_v<T, float> && M == 4) {
+      if !consteval {
+        Mat<T, 3, 4> retval;
+        detail::rigid_rows(detail::load(r), _mm_setzero_ps(), &retval[0]);
+        return retval;
+      }
+    }
+#endif
     auto const m00 = T(1) - T(2) * r.v.y * r.v.y - T(2) * r.v.z * r.v.z;
     auto const m01 = T(2) * r.v.x * r.v.y - T(2) * r.w * r.v.z;
     auto const m02 = T(2) * r.v.x * r.v.z + T(2) * r.w * r.v.y;
@@ -206,6 +266,16 @@ public:
 
   static constexpr auto rigid(Vec3<T> const &t, Quat<T> const &r) noexcept {
     static_assert(M == 4);
+#ifdef MARLON_MATH_SSE4_1
+    if constexpr (std::is_same_v<T, float>) {
+      if !consteval {
+        Mat<T, 3, 4> retval;
+        detail::rigid_rows(
+            detail::load(r), _mm_setr_ps(t.x, t.y, t.z, 0.0f), &retval[0]);
+        return retval;
+      }
+    }
+#endif
     auto result = rotation(r);
     result[0][3] = t.x;
     result[1][3] = t.y;
@@ -411,6 +481,55 @@ using Mat4x2d = Mat<double, 4, 2>;
 using Mat4x3d = Mat<double, 4, 3>;
 using Mat4x4d = Mat<double, 4, 4>;
 
+#ifdef MARLON_MATH_SSE4_1
+namespace detail {
+// The columns of m dotted with v, summed in the order of the scalar loop
+template <int N>
+inline __m128 multiply(Mat<float, N, 4> const &m, __m128 v) noexcept {
+  static_assert(N == 3 || N == 4);
+  auto c0 = load(m[0]);
+  auto c1 = load(m[1]);
+  auto c2 = load(m[2]);
+  auto c3 = _mm_setzero_ps();
+  if constexpr (N == 4) {
+    c3 = load(m[3]);
+  }
+  _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+  return linear_combination(v, c0, c1, c2, c3);
+}
+
+// Each row of the product is a linear combination of the rows of b
+template <int N>
+inline Mat<float, N, 4> multiply(Mat<float, N, 4> const &a,
+                                 Mat<float, 4, 4> const &b) noexcept {
+  Mat<float, N, 4> retval;
+  auto i = 0;
+#ifdef MARLON_MATH_AVX2
+  auto const duplicate = [](__m128 v) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(v), v, 1);
+  };
+  auto const b0 = duplicate(load(b[0]));
+  auto const b1 = duplicate(load(b[1]));
+  auto const b2 = duplicate(load(b[2]));
+  auto const b3 = duplicate(load(b[3]));
+  for (; i + 1 < N; i += 2) {
+    auto const rows = _mm256_insertf128_ps(
+        _mm256_castps128_ps256(load(a[i])), load(a[i + 1]), 1);
+    auto const product = linear_combination(rows, b0, b1, b2, b3);
+    store(retval[i], _mm256_castps256_ps128(product));
+    store(retval[i + 1], _mm256_extractf128_ps(product, 1));
+  }
+#endif
+  for (; i < N; ++i) {
+    store(retval[i],
+          linear_combination(
+              load(a[i]), load(b[0]), load(b[1]), load(b[2]), load(b[3])));
+  }
+  return retval;
+}
+} // namespace detail
+#endif
+
 template <typename T, int N>
 constexpr bool operator==(Rvec<T, N> const &a, Rvec<T, N> const &b) noexcept {
   for (auto i = 0; i < N; ++i) {
@@ -423,6 +542,13 @@ constexpr bool operator==(Rvec<T, N> const &a, Rvec<T, N> const &b) noexcept {
 
 template <typename T, int N>
 constexpr Rvec<T, N> operator*(T s, Rvec<T, N> const &v) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float> && N == 4) {
+    if !consteval {
+      return detail::to_rvec4f(_mm_mul_ps(_mm_set1_ps(s), detail::load(v)));
+    }
+  }
+#endif
   return Rvec<T, N>{[&](int i) { return s * v[i]; }};
 }
 
@@ -509,6 +635,17 @@ constexpr Mat<T, N, M> &operator*=(Mat<T, N, M> &a, T s) noexcept {
 template <typename T, int N, int M>
 constexpr Rvec<T, M> operator*(Rvec<T, N> const &v,
                                Mat<T, N, M> const &m) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float> && N == 4 && M == 4) {
+    if !consteval {
+      return detail::to_rvec4f(detail::linear_combination(detail::load(v),
+                                                          detail::load(m[0]),
+                                                          detail::load(m[1]),
+                                                          detail::load(m[2]),
+                                                          detail::load(m[3])));
+    }
+  }
+#endif
   return Rvec<T, M>{[&](int j) {
     auto retval = T(0);
     for (int i = 0; i < N; ++i) {
@@ -527,6 +664,18 @@ constexpr Rvec<T, N> &operator*=(Rvec<T, N> &v,
 template <typename T, int N, int M>
 constexpr Vec<T, N> operator*(Mat<T, N, M> const &m,
                               Vec<T, M> const &v) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float> && (N == 3 || N == 4) && M == 4) {
+    if !consteval {
+      auto const product = detail::multiply(m, detail::load(v));
+      if constexpr (N == 4) {
+        return detail::to_vec4f(product);
+      } else {
+        return detail::to_vec4f(product).xyz();
+      }
+    }
+  }
+#endif
   return Vec<T, N>{[&](int i) {
     auto retval = T(0);
     for (int j = 0; j < M; ++j) {
@@ -553,6 +702,13 @@ constexpr Mat<T, N, M> &operator/=(Mat<T, N, M> &m, T s) noexcept {
 template <typename T, int N1, int N2, int N3>
 constexpr Mat<T, N1, N3> operator*(Mat<T, N1, N2> const &a,
                                    Mat<T, N2, N3> const &b) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float> && N2 == 4 && N3 == 4) {
+    if !consteval {
+      return detail::multiply(a, b);
+    }
+  }
+#endif
   auto retval = Mat<T, N1, N3>::zero();
   for (auto i = 0; i < N1; ++i) {
     for (auto j = 0; j < N3; ++j) {
@@ -2,9 +2,13 @@
 #define MARLON_MATH_MATH_H
 
 #include "aabb.h"
+#include "fast.h"
 #include "mat.h"
+#include "quantize.h"
 #include "quat.h"
+#include "rigid_transform.h"
 #include "scalar.h"
+#include "transform.h"
 #include "vec.h"
 
 #endif
\ No newline at end of file
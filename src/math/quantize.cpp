@@ -0,0 +1,276 @@
+#include "quantize.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace math {
+namespace {
+constexpr auto random_float(std::uint32_t &state) noexcept {
+  state = state * 1664525u + 1013904223u;
+  return static_cast<float>(static_cast<std::int32_t>(state >> 8) - (1 << 23)) /
+         static_cast<float>(1 << 21);
+}
+
+constexpr auto random_vec3(std::uint32_t &state) noexcept {
+  auto const x = random_float(state);
+  auto const y = random_float(state);
+  auto const z = random_float(state);
+  return Vec3f{x, y, z};
+}
+
+Vec3f random_unit_vec3(std::uint32_t &state) noexcept {
+  for (;;) {
+    auto const v = random_vec3(state);
+    if (length_squared(v) > 1e-6f) {
+      return normalize(v);
+    }
+  }
+}
+
+Quatf random_unit_quat(std::uint32_t &state) noexcept {
+  for (;;) {
+    auto const w = random_float(state);
+    auto const q = Quatf{w, random_vec3(state)};
+    if (length_squared(q) > 1e-6f) {
+      return normalize(q);
+    }
+  }
+}
+
+template <typename T> bool bitwise_equal(T const &a, T const &b) noexcept {
+  using Bytes = std::array<unsigned char, sizeof(T)>;
+  return std::bit_cast<Bytes>(a) == std::bit_cast<Bytes>(b);
+}
+
+// Covers every tail length of the four and eight wide batches
+constexpr auto batch_size = std::size_t{27};
+
+// Both halves of a quaternion with a largest component at every index, and
+// ties between the largest ones
+auto quat_inputs() {
+  auto state = std::uint32_t{5};
+  auto retval = std::vector<Quatf>{
+      Quatf::identity(),
+      Quatf{-1.0f, Vec3f::zero()},
+      Quatf{0.5f, Vec3f{-0.5f, 0.5f, -0.5f}},
+      Quatf{0.0f, Vec3f{0.0f, -1.0f, 0.0f}},
+  };
+  while (retval.size() != batch_size) {
+    retval.push_back(random_unit_quat(state));
+  }
+  return retval;
+}
+
+auto max_component_error(Quatf const &q, Quatf const &p) noexcept {
+  auto const error = [](Quatf const &a, Quatf const &b) {
+    return std::max({abs(a.w - b.w),
+                     abs(a.v.x - b.v.x),
+                     abs(a.v.y - b.v.y),
+                     abs(a.v.z - b.v.z)});
+  };
+  return std::min(error(q, p), error(q, -1.0f * p));
+}
+} // namespace
+
+TEST_CASE("Halves round trip through floats") {
+  for (auto bits = 0u; bits != 0x10000u; ++bits) {
+    auto const h = Half{static_cast<std::uint16_t>(bits)};
+    auto const x = from_half(h);
+    if (std::isnan(x)) {
+      REQUIRE(std::isnan(from_half(to_half(x))));
+    } else {
+      REQUIRE(to_half(x) == h);
+    }
+  }
+}
+
+TEST_CASE("Floats round to the nearest half") {
+  REQUIRE(from_half(to_half(65504.0f)) == 65504.0f);
+  REQUIRE(from_half(to_half(65519.0f)) == 65504.0f);
+  REQUIRE(std::isinf(from_half(to_half(65520.0f))));
+  REQUIRE(std::isinf(from_half(to_half(-1e10f))));
+  REQUIRE(std::isnan(from_half(to_half(std::nanf("")))));
+  // ties go to the even mantissa
+  REQUIRE(from_half(to_half(1.0f + 0x1p-11f)) == 1.0f);
+  REQUIRE(from_half(to_half(1.0f + 0x3p-11f)) == 1.0f + 0x1p-9f);
+  REQUIRE(from_half(to_half(0x1p-25f)) == 0.0f);
+  REQUIRE(from_half(to_half(0x3p-25f)) == 0x1p-23f);
+  auto max_relative_error = 0.0f;
+  auto max_subnormal_error = 0.0f;
+  for (auto bits = std::bit_cast<std::uint32_t>(0x1p-30f);
+       bits < std::bit_cast<std::uint32_t>(65504.0f);
+       bits += 997) {
+    auto const x = std::bit_cast<float>(bits);
+    auto const error = abs(from_half(to_half(x)) - x);
+    if (x >= 0x1p-14f) {
+      max_relative_error = std::max(max_relative_error, error / x);
+    } else {
+      max_subnormal_error = std::max(max_subnormal_error, error);
+    }
+  }
+  REQUIRE(max_relative_error <= 0x1p-11f);
+  REQUIRE(max_subnormal_error <= 0x1p-25f);
+}
+
+TEST_CASE("Batched half conversions match the scalar ones") {
+  auto state = std::uint32_t{3};
+  auto input = std::vector<float>{0.0f,
+                                  -0.0f,
+                                  0x1p-20f,
+                                  -0x1p-24f,
+                                  65520.0f,
+                                  std::numeric_limits<float>::infinity(),
+                                  std::nanf("")};
+  while (input.size() != batch_size) {
+    input.push_back(1000.0f * random_float(state));
+  }
+  for (auto n = std::size_t{}; n <= batch_size; ++n) {
+    auto halves = std::vector<Half>(n);
+    auto floats = std::vector<float>(n);
+    to_half(std::span{input}.first(n), std::span{halves});
+    from_half(std::span<Half const>{halves}, std::span{floats});
+    for (auto i = std::size_t{}; i != n; ++i) {
+      REQUIRE(halves[i] == to_half(input[i]));
+      REQUIRE(bitwise_equal(floats[i], from_half(halves[i])));
+    }
+  }
+  auto vectors = std::vector<Vec3f>{};
+  for (auto i = std::size_t{}; i != batch_size; ++i) {
+    vectors.push_back(random_vec3(state));
+  }
+  auto vector_halves = std::vector<Vec3h>(batch_size);
+  to_half(std::span<Vec3f const>{vectors}, std::span{vector_halves});
+  for (auto i = std::size_t{}; i != batch_size; ++i) {
+    REQUIRE(vector_halves[i] == to_half(vectors[i]));
+  }
+}
+
+TEST_CASE("16-bit normalized values are within half a step") {
+  REQUIRE(to_snorm16(1.0f) == 32767);
+  REQUIRE(to_snorm16(-2.0f) == -32767);
+  REQUIRE(from_snorm16(std::int16_t{-32768}) == -1.0f);
+  REQUIRE(to_unorm16(1.5f) == 65535);
+  REQUIRE(to_unorm16(-1.0f) == 0);
+  REQUIRE(from_unorm16(std::uint16_t{65535}) == 1.0f);
+  auto state = std::uint32_t{17};
+  auto snorm_error = 0.0f;
+  auto unorm_error = 0.0f;
+  for (auto i = 0; i != 100000; ++i) {
+    auto const x = random_float(state) / 4.0f;
+    snorm_error = std::max(
+        snorm_error, abs(from_snorm16(to_snorm16(x)) - clamp(x, -1.0f, 1.0f)));
+    unorm_error = std::max(
+        unorm_error, abs(from_unorm16(to_unorm16(x)) - clamp(x, 0.0f, 1.0f)));
+  }
+  REQUIRE(snorm_error <= 1.0f / 65534.0f + 0x1p-24f);
+  REQUIRE(unorm_error <= 1.0f / 131070.0f + 0x1p-25f);
+}
+
+TEST_CASE("Batched 16-bit normalized conversions match the scalar ones") {
+  auto state = std::uint32_t{19};
+  auto input = std::vector<float>{std::nanf(""), 2.0f, -2.0f, -0.0f};
+  while (input.size() != batch_size) {
+    input.push_back(random_float(state) / 2.0f);
+  }
+  for (auto n = std::size_t{}; n <= batch_size; ++n) {
+    auto snorms = std::vector<std::int16_t>(n);
+    auto unorms = std::vector<std::uint16_t>(n);
+    auto snorm_floats = std::vector<float>(n);
+    auto unorm_floats = std::vector<float>(n);
+    to_snorm16(std::span{input}.first(n), std::span{snorms});
+    to_unorm16(std::span{input}.first(n), std::span{unorms});
+    from_snorm16(std::span<std::int16_t const>{snorms},
+                 std::span{snorm_floats});
+    from_unorm16(std::span<std::uint16_t const>{unorms},
+                 std::span{unorm_floats});
+    for (auto i = std::size_t{}; i != n; ++i) {
+      REQUIRE(snorms[i] == to_snorm16(input[i]));
+      REQUIRE(unorms[i] == to_unorm16(input[i]));
+      REQUIRE(bitwise_equal(snorm_floats[i], from_snorm16(snorms[i])));
+      REQUIRE(bitwise_equal(unorm_floats[i], from_unorm16(unorms[i])));
+    }
+  }
+}
+
+TEST_CASE("Octahedral unit vectors are within 7e-5 radians") {
+  REQUIRE(from_oct(to_oct(Vec3f::z_axis())) == Vec3f::z_axis());
+  REQUIRE(from_oct(to_oct(-Vec3f::z_axis())) == -Vec3f::z_axis());
+  REQUIRE(from_oct(to_oct(-Vec3f::x_axis())) == -Vec3f::x_axis());
+  auto state = std::uint32_t{23};
+  auto max_angle = 0.0f;
+  for (auto i = 0; i != 100000; ++i) {
+    auto const v = random_unit_vec3(state);
+    REQUIRE(length(from_oct(to_oct(v)) - v) <= 1e-6f);
+    auto const decoded = from_oct16(to_oct16(v));
+    max_angle = std::max(max_angle, length(cross(decoded, v)));
+  }
+  REQUIRE(max_angle <= 7e-5f);
+}
+
+TEST_CASE("Batched octahedral conversions match the scalar ones") {
+  auto state = std::uint32_t{29};
+  auto input = std::vector<Vec3f>{Vec3f::z_axis(),
+                                  -Vec3f::z_axis(),
+                                  Vec3f{-0.0f, 0.0f, -1.0f},
+                                  Vec3f{0.6f, 0.0f, -0.8f}};
+  while (input.size() != batch_size) {
+    input.push_back(random_unit_vec3(state));
+  }
+  for (auto n = std::size_t{}; n <= batch_size; ++n) {
+    auto encoded = std::vector<Vec2<std::int16_t>>(n);
+    auto decoded = std::vector<Vec3f>(n);
+    to_oct16(std::span<Vec3f const>{input}.first(n), std::span{encoded});
+    from_oct16(std::span<Vec2<std::int16_t> const>{encoded},
+               std::span{decoded});
+    for (auto i = std::size_t{}; i != n; ++i) {
+      REQUIRE(encoded[i] == to_oct16(input[i]));
+      REQUIRE(bitwise_equal(decoded[i], from_oct16(encoded[i])));
+    }
+  }
+}
+
+TEST_CASE("Packed quaternions are within their bounds") {
+  auto state = std::uint32_t{31};
+  auto error32 = 0.0f;
+  auto error48 = 0.0f;
+  for (auto i = 0; i != 100000; ++i) {
+    auto const q = random_unit_quat(state);
+    error32 = std::max(error32, max_component_error(q, unpack(pack32(q))));
+    error48 = std::max(error48, max_component_error(q, unpack(pack48(q))));
+    REQUIRE(pack32(q) == pack32(-1.0f * q));
+    REQUIRE(pack48(q) == pack48(-1.0f * q));
+  }
+  REQUIRE(error32 <= 2e-3f);
+  REQUIRE(error48 <= 6e-5f);
+}
+
+TEST_CASE("Batched quaternion packing matches the scalar packing") {
+  auto const input = quat_inputs();
+  for (auto n = std::size_t{}; n <= batch_size; ++n) {
+    auto packed32 = std::vector<Packed_quat32>(n);
+    auto packed48 = std::vector<Packed_quat48>(n);
+    auto unpacked32 = std::vector<Quatf>(n);
+    auto unpacked48 = std::vector<Quatf>(n);
+    pack32(std::span{input}.first(n), std::span{packed32});
+    pack48(std::span{input}.first(n), std::span{packed48});
+    unpack(std::span<Packed_quat32 const>{packed32}, std::span{unpacked32});
+    unpack(std::span<Packed_quat48 const>{packed48}, std::span{unpacked48});
+    for (auto i = std::size_t{}; i != n; ++i) {
+      REQUIRE(packed32[i] == pack32(input[i]));
+      REQUIRE(packed48[i] == pack48(input[i]));
+      REQUIRE(bitwise_equal(unpacked32[i], unpack(packed32[i])));
+      REQUIRE(bitwise_equal(unpacked48[i], unpack(packed48[i])));
+    }
+  }
+}
+} // namespace math
+} // namespace marlon
@@ -0,0 +1,876 @@
+#ifndef MARLON_MATH_QUANTIZE_H
+#define MARLON_MATH_QUANTIZE_H
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <bit>
+#include <span>
+
+#include "quat.h"
+#include "scalar.h"
+#include "simd.h"
+#include "transform.h"
+#include "vec.h"
+
+// Compact encodings of floats, vectors and rotations for large arrays,
+// snapshots and network streams. Every encoding has a scalar form and a batch
+// form over spans. The batch forms run four elements per iteration with
+// SSE4.1 and produce the same bits as the scalar forms.
+namespace marlon {
+namespace math {
+// An IEEE 754 binary16, for storage only
+struct Half {
+  std::uint16_t bits;
+
+  friend constexpr bool operator==(Half, Half) noexcept = default;
+};
+
+using Vec2h = Vec2<Half>;
+using Vec3h = Vec3<Half>;
+using Vec4h = Vec4<Half>;
+
+static_assert(sizeof(Vec3h) == 6);
+static_assert(sizeof(Vec4h) == 8);
+
+// Smallest three encoding of a unit quaternion: the index of its largest
+// magnitude component in the top two bits, then the other three components
+// in 10 bits each. Those lie in [-1 / sqrt 2, 1 / sqrt 2], and the largest is
+// recovered from unit length. The quaternion is negated first if its largest
+// component is negative, q and -q being the same rotation.
+struct Packed_quat32 {
+  std::uint32_t bits;
+
+  friend constexpr bool operator==(Packed_quat32,
+                                   Packed_quat32) noexcept = default;
+};
+
+// The same with 15 bits per component, least significant word first. The
+// words keep the alignment at 2 so arrays of it need no padding.
+struct Packed_quat48 {
+  std::uint16_t bits[3];
+
+  friend constexpr bool operator==(Packed_quat48 const &,
+                                   Packed_quat48 const &) noexcept = default;
+};
+
+static_assert(sizeof(Packed_quat48) == 6);
+
+namespace detail {
+// Floats from this magnitude up overflow to an infinite half
+auto constexpr half_overflow_bits = std::uint32_t{(127 + 16) << 23};
+auto constexpr half_min_normal_bits = std::uint32_t{(127 - 14) << 23};
+// Adding 0.5 to a float below the smallest normal half shifts its mantissa so
+// the last kept bit is that of the subnormal half, rounding as it goes
+auto constexpr half_subnormal_magic = 0.5f;
+auto constexpr half_subnormal_magic_bits = std::uint32_t{126 << 23};
+// Adds 15 - 127 to the exponent, modulo 2^32
+auto constexpr half_rebias = std::uint32_t{0xc8000000};
+auto constexpr half_min_normal = 6.103515625e-05f;
+
+// Components of a packed quaternion scaled by sqrt 2 to [-1, 1], then mapped
+// to [0, 2^Bits - 1]
+template <int Bits>
+inline auto constexpr quat_component_scale =
+    static_cast<float>((1 << Bits) - 1) * 0.5f;
+
+auto constexpr sqrt2 = 1.41421356f;
+auto constexpr inverse_sqrt2 = 0.707106781f;
+
+inline float oct_sign(float x) noexcept {
+  return x >= 0.0f ? 1.0f : -1.0f;
+}
+
+// The index of the first largest magnitude component of q, 0 for w
+inline int largest_component(Quatf const &q) noexcept {
+  auto retval = 0;
+  auto largest = abs(q.w);
+  for (auto i = 0; i != 3; ++i) {
+    if (abs(q.v[i]) > largest) {
+      retval = i + 1;
+      largest = abs(q.v[i]);
+    }
+  }
+  return retval;
+}
+
+template <int Bits>
+inline std::uint32_t encode_quat_component(float x) noexcept {
+  auto const scale = quat_component_scale<Bits>;
+  return static_cast<std::uint32_t>(
+      std::nearbyint(clamp(x * sqrt2, -1.0f, 1.0f) * scale + scale));
+}
+
+template <int Bits>
+inline float decode_quat_component(std::uint32_t code) noexcept {
+  auto const scale = quat_component_scale<Bits>;
+  return (static_cast<float>(static_cast<std::int32_t>(code)) - scale) /
+         scale * inverse_sqrt2;
+}
+
+// The index of the largest component and the codes of the other three, in
+// order
+template <int Bits> struct Quat_codes {
+  std::uint32_t index;
+  std::uint32_t codes[3];
+};
+
+template <int Bits>
+inline Quat_codes<Bits> encode_quat(Quatf const &q) noexcept {
+  auto const index = largest_component(q);
+  auto const components = Vec4f{q.w, q.v.x, q.v.y, q.v.z};
+  auto const sign = components[index] < 0.0f ? -1.0f : 1.0f;
+  auto retval = Quat_codes<Bits>{.index = static_cast<std::uint32_t>(index),
+                                 .codes = {}};
+  for (auto i = 0, j = 0; i != 4; ++i) {
+    if (i != index) {
+      retval.codes[j++] = encode_quat_component<Bits>(sign * components[i]);
+    }
+  }
+  return retval;
+}
+
+template <int Bits>
+inline Quatf decode_quat(Quat_codes<Bits> const &codes) noexcept {
+  auto const a = decode_quat_component<Bits>(codes.codes[0]);
+  auto const b = decode_quat_component<Bits>(codes.codes[1]);
+  auto const c = decode_quat_component<Bits>(codes.codes[2]);
+  auto const largest = std::sqrt(max(1.0f - (a * a + b * b + c * c), 0.0f));
+  switch (codes.index) {
+  case 0:
+    return {largest, {a, b, c}};
+  case 1:
+    return {a, {largest, b, c}};
+  case 2:
+    return {a, {b, largest, c}};
+  default:
+    return {a, {b, c, largest}};
+  }
+}
+
+inline Quat_codes<10> unpack(Packed_quat32 q) noexcept {
+  return {.index = q.bits >> 30,
+          .codes = {q.bits >> 20 & 0x3ffu,
+                    q.bits >> 10 & 0x3ffu,
+                    q.bits & 0x3ffu}};
+}
+
+inline Quat_codes<15> unpack(Packed_quat48 const &q) noexcept {
+  auto const bits = std::uint64_t{q.bits[0]} | std::uint64_t{q.bits[1]} << 16 |
+                    std::uint64_t{q.bits[2]} << 32;
+  return {.index = static_cast<std::uint32_t>(bits >> 45),
+          .codes = {static_cast<std::uint32_t>(bits >> 30 & 0x7fff),
+                    static_cast<std::uint32_t>(bits >> 15 & 0x7fff),
+                    static_cast<std::uint32_t>(bits & 0x7fff)}};
+}
+
+inline Packed_quat32 pack(Quat_codes<10> const &codes) noexcept {
+  return {codes.index << 30 | codes.codes[0] << 20 | codes.codes[1] << 10 |
+          codes.codes[2]};
+}
+
+inline Packed_quat48 pack(Quat_codes<15> const &codes) noexcept {
+  auto const bits = std::uint64_t{codes.index} << 45 |
+                    std::uint64_t{codes.codes[0]} << 30 |
+                    std::uint64_t{codes.codes[1]} << 15 | codes.codes[2];
+  return {{static_cast<std::uint16_t>(bits),
+           static_cast<std::uint16_t>(bits >> 16),
+           static_cast<std::uint16_t>(bits >> 32)}};
+}
+} // namespace detail
+
+// x rounded to the nearest half, ties to even. Magnitudes from 65520 on
+// become infinite and NaNs stay NaN. Results of magnitude 2^-14 to 65504 are
+// within a relative 2^-11 of x, smaller ones within 2^-25.
+constexpr Half to_half(float x) noexcept {
+  auto bits = std::bit_cast<std::uint32_t>(x);
+  auto const sign = bits & 0x80000000u;
+  bits ^= sign;
+  auto retval = std::uint32_t{};
+  if (bits >= detail::half_overflow_bits) {
+    retval = bits > 0x7f800000u ? 0x7e00u : 0x7c00u;
+  } else if (bits < detail::half_min_normal_bits) {
+    retval = std::bit_cast<std::uint32_t>(std::bit_cast<float>(bits) +
+                                          detail::half_subnormal_magic) -
+             detail::half_subnormal_magic_bits;
+  } else {
+    auto const mantissa_odd = bits >> 13 & 1u;
+    retval = (bits + detail::half_rebias + 0xfffu + mantissa_odd) >> 13;
+  }
+  return Half{static_cast<std::uint16_t>(retval | sign >> 16)};
+}
+
+// The float equal to x
+constexpr float from_half(Half x) noexcept {
+  auto bits = static_cast<std::uint32_t>(x.bits & 0x7fffu) << 13;
+  auto const exponent = bits & 0x0f800000u;
+  bits += std::uint32_t{127 - 15} << 23;
+  if (exponent == 0x0f800000u) {
+    // infinity or NaN
+    bits += std::uint32_t{128 - 16} << 23;
+  } else if (exponent == 0) {
+    // zero or subnormal, scaled by the float arithmetic
+    bits += std::uint32_t{1} << 23;
+    bits = std::bit_cast<std::uint32_t>(std::bit_cast<float>(bits) -
+                                        detail::half_min_normal);
+  }
+  return std::bit_cast<float>(bits |
+                              static_cast<std::uint32_t>(x.bits & 0x8000u)
+                                  << 16);
+}
+
+template <int N>
+constexpr Vec<Half, N> to_half(Vec<float, N> const &v) noexcept {
+  return Vec<Half, N>{[&](int i) { return to_half(v[i]); }};
+}
+
+template <int N>
+constexpr Vec<float, N> from_half(Vec<Half, N> const &v) noexcept {
+  return Vec<float, N>{[&](int i) { return from_half(v[i]); }};
+}
+
+// round(clamp(x, -1, 1) * 32767), ties to even. NaN becomes 32767.
+// from_snorm16(to_snorm16(x)) is within 1 / 65534 + 2^-24 of clamp(x, -1, 1).
+inline std::int16_t to_snorm16(float x) noexcept {
+  return static_cast<std::int16_t>(
+      std::nearbyint(clamp(x, -1.0f, 1.0f) * 32767.0f));
+}
+
+// x / 32767, with -32768 decoded as -1
+inline float from_snorm16(std::int16_t x) noexcept {
+  return max(static_cast<float>(x) / 32767.0f, -1.0f);
+}
+
+// round(clamp(x, 0, 1) * 65535), ties to even. NaN becomes 65535.
+// from_unorm16(to_unorm16(x)) is within 1 / 131070 + 2^-25 of clamp(x, 0, 1).
+inline std::uint16_t to_unorm16(float x) noexcept {
+  return static_cast<std::uint16_t>(
+      std::nearbyint(clamp(x, 0.0f, 1.0f) * 65535.0f));
+}
+
+inline float from_unorm16(std::uint16_t x) noexcept {
+  return static_cast<float>(x) / 65535.0f;
+}
+
+template <int N>
+inline Vec<std::int16_t, N> to_snorm16(Vec<float, N> const &v) noexcept {
+  return Vec<std::int16_t, N>{[&](int i) { return to_snorm16(v[i]); }};
+}
+
+template <int N>
+inline Vec<float, N> from_snorm16(Vec<std::int16_t, N> const &v) noexcept {
+  return Vec<float, N>{[&](int i) { return from_snorm16(v[i]); }};
+}
+
+template <int N>
+inline Vec<std::uint16_t, N> to_unorm16(Vec<float, N> const &v) noexcept {
+  return Vec<std::uint16_t, N>{[&](int i) { return to_unorm16(v[i]); }};
+}
+
+template <int N>
+inline Vec<float, N> from_unorm16(Vec<std::uint16_t, N> const &v) noexcept {
+  return Vec<float, N>{[&](int i) { return from_unorm16(v[i]); }};
+}
+
+// The octahedral map of a unit vector into [-1, 1]^2, as oct_encode in the
+// surface shaders computes it: the vector is projected onto the octahedron
+// |x| + |y| + |z| = 1 and the lower half is folded over the diagonals.
+inline Vec2f to_oct(Vec3f const &v) noexcept {
+  auto const inverse_norm = 1.0f / (abs(v.x) + abs(v.y) + abs(v.z));
+  auto const p = Vec2f{v.x * inverse_norm, v.y * inverse_norm};
+  if (v.z <= 0.0f) {
+    return {(1.0f - abs(p.y)) * detail::oct_sign(p.x),
+            (1.0f - abs(p.x)) * detail::oct_sign(p.y)};
+  }
+  return p;
+}
+
+// The unit vector mapped to e, as decode_world_space_normal in the lighting
+// shader computes it
+inline Vec3f from_oct(Vec2f const &e) noexcept {
+  auto v = Vec3f{e.x, e.y, 1.0f - abs(e.x) - abs(e.y)};
+  if (v.z < 0.0f) {
+    v.x = (1.0f - abs(e.y)) * detail::oct_sign(e.x);
+    v.y = (1.0f - abs(e.x)) * detail::oct_sign(e.y);
+  }
+  return normalize(v);
+}
+
+// to_oct with 16-bit snorm components. from_oct16(to_oct16(v)) is within
+// 7e-5 radians of a unit v.
+inline Vec2<std::int16_t> to_oct16(Vec3f const &v) noexcept {
+  return to_snorm16(to_oct(v));
+}
+
+inline Vec3f from_oct16(Vec2<std::int16_t> const &e) noexcept {
+  return from_oct(from_snorm16(e));
+}
+
+// Smallest three encodings of a unit quaternion q. unpack(pack32(q)) is
+// within 2e-3 of q or -q in each component, unpack(pack48(q)) within 6e-5.
+// The stored components are within half a step, 7e-4 and 2.2e-5, the
+// recovered largest one collects their errors.
+inline Packed_quat32 pack32(Quatf const &q) noexcept {
+  return detail::pack(detail::encode_quat<10>(q));
+}
+
+inline Packed_quat48 pack48(Quatf const &q) noexcept {
+  return detail::pack(detail::encode_quat<15>(q));
+}
+
+inline Quatf unpack(Packed_quat32 q) noexcept {
+  return detail::decode_quat(detail::unpack(q));
+}
+
+inline Quatf unpack(Packed_quat48 const &q) noexcept {
+  return detail::decode_quat(detail::unpack(q));
+}
+
+namespace detail {
+#ifdef MARLON_MATH_SSE4_1
+inline __m128 abs(__m128 v) noexcept {
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+// clamp(v, lo, hi) as the scalar clamp computes it, NaN included
+inline __m128 clamp(__m128 v, __m128 lo, __m128 hi) noexcept {
+  return _mm_min_ps(_mm_max_ps(lo, v), hi);
+}
+
+// Four float bit patterns to the bit patterns of the nearest halves, in the
+// low 16 bits of each lane
+inline __m128i to_half(__m128 v) noexcept {
+  auto bits = _mm_castps_si128(v);
+  auto const sign = _mm_and_si128(bits, _mm_set1_epi32(0x80000000));
+  bits = _mm_xor_si128(bits, sign);
+  auto const overflow = _mm_cmpgt_epi32(
+      bits, _mm_set1_epi32(static_cast<int>(half_overflow_bits - 1)));
+  auto const special =
+      _mm_blendv_epi8(_mm_set1_epi32(0x7c00),
+                      _mm_set1_epi32(0x7e00),
+                      _mm_cmpgt_epi32(bits, _mm_set1_epi32(0x7f800000)));
+  auto const subnormal = _mm_cmplt_epi32(
+      bits, _mm_set1_epi32(static_cast<int>(half_min_normal_bits)));
+  auto const subnormal_bits = _mm_sub_epi32(
+      _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits),
+                                  _mm_set1_ps(half_subnormal_magic))),
+      _mm_set1_epi32(static_cast<int>(half_subnormal_magic_bits)));
+  auto const mantissa_odd =
+      _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+  auto const normal_bits = _mm_srli_epi32(
+      _mm_add_epi32(
+          _mm_add_epi32(
+              bits, _mm_set1_epi32(static_cast<int>(half_rebias + 0xfffu))),
+          mantissa_odd),
+      13);
+  auto const retval = _mm_blendv_epi8(
+      _mm_blendv_epi8(normal_bits, subnormal_bits, subnormal),
+      special,
+      overflow);
+  return _mm_or_si128(retval, _mm_srli_epi32(sign, 16));
+}
+
+// Four half bit patterns, one per 32-bit lane, to floats
+inline __m128 from_half(__m128i h) noexcept {
+  auto bits =
+      _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+  auto const exponent_mask = _mm_set1_epi32(0x0f800000);
+  auto const exponent = _mm_and_si128(bits, exponent_mask);
+  bits = _mm_add_epi32(bits, _mm_set1_epi32((127 - 15) << 23));
+  auto const special = _mm_cmpeq_epi32(exponent, exponent_mask);
+  bits = _mm_add_epi32(
+      bits, _mm_and_si128(special, _mm_set1_epi32((128 - 16) << 23)));
+  auto const subnormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+  auto const subnormal_bits = _mm_castps_si128(
+      _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(1 << 23))),
+                 _mm_set1_ps(half_min_normal)));
+  bits = _mm_blendv_epi8(bits, subnormal_bits, subnormal);
+  auto const sign =
+      _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+  return _mm_castsi128_ps(_mm_or_si128(bits, sign));
+}
+
+inline __m128i to_snorm16(__m128 v) noexcept {
+  return _mm_cvtps_epi32(
+      _mm_mul_ps(clamp(v, _mm_set1_ps(-1.0f), _mm_set1_ps(1.0f)),
+                 _mm_set1_ps(32767.0f)));
+}
+
+inline __m128 from_snorm16(__m128i v) noexcept {
+  return _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(32767.0f)),
+                    _mm_set1_ps(-1.0f));
+}
+
+inline __m128i to_unorm16(__m128 v) noexcept {
+  return _mm_cvtps_epi32(
+      _mm_mul_ps(clamp(v, _mm_setzero_ps(), _mm_set1_ps(1.0f)),
+                 _mm_set1_ps(65535.0f)));
+}
+
+inline __m128 from_unorm16(__m128i v) noexcept {
+  return _mm_div_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(65535.0f));
+}
+
+// x >= 0 ? 1 : -1
+inline __m128 oct_sign(__m128 x) noexcept {
+  return _mm_blendv_ps(_mm_set1_ps(-1.0f),
+                       _mm_set1_ps(1.0f),
+                       _mm_cmpge_ps(x, _mm_setzero_ps()));
+}
+
+inline void to_oct(__m128 x, __m128 y, __m128 z, __m128 &u, __m128 &v) {
+  auto const one = _mm_set1_ps(1.0f);
+  auto const inverse_norm =
+      _mm_div_ps(one, _mm_add_ps(_mm_add_ps(abs(x), abs(y)), abs(z)));
+  auto const px = _mm_mul_ps(x, inverse_norm);
+  auto const py = _mm_mul_ps(y, inverse_norm);
+  auto const fold = _mm_cmple_ps(z, _mm_setzero_ps());
+  u = _mm_blendv_ps(
+      px, _mm_mul_ps(_mm_sub_ps(one, abs(py)), oct_sign(px)), fold);
+  v = _mm_blendv_ps(
+      py, _mm_mul_ps(_mm_sub_ps(one, abs(px)), oct_sign(py)), fold);
+}
+
+inline void
+from_oct(__m128 ex, __m128 ey, __m128 &x, __m128 &y, __m128 &z) noexcept {
+  auto const one = _mm_set1_ps(1.0f);
+  z = _mm_sub_ps(_mm_sub_ps(one, abs(ex)), abs(ey));
+  auto const fold = _mm_cmplt_ps(z, _mm_setzero_ps());
+  x = _mm_blendv_ps(
+      ex, _mm_mul_ps(_mm_sub_ps(one, abs(ey)), oct_sign(ex)), fold);
+  y = _mm_blendv_ps(
+      ey, _mm_mul_ps(_mm_sub_ps(one, abs(ex)), oct_sign(ey)), fold);
+  // v * (1 / length(v)) like normalize, the squares summed from zero like
+  // length_squared
+  auto length2 = _mm_add_ps(_mm_setzero_ps(), _mm_mul_ps(x, x));
+  length2 = _mm_add_ps(length2, _mm_mul_ps(y, y));
+  length2 = _mm_add_ps(length2, _mm_mul_ps(z, z));
+  auto const inverse_length = _mm_div_ps(one, _mm_sqrt_ps(length2));
+  x = _mm_mul_ps(x, inverse_length);
+  y = _mm_mul_ps(y, inverse_length);
+  z = _mm_mul_ps(z, inverse_length);
+}
+
+// encode_quat on four quaternions given per component
+template <int Bits>
+inline void encode_quats(__m128 w,
+                         __m128 x,
+                         __m128 y,
+                         __m128 z,
+                         __m128i &index,
+                         __m128i (&codes)[3]) noexcept {
+  // the first largest magnitude wins, like largest_component
+  auto largest = abs(w);
+  auto largest_signed = w;
+  index = _mm_setzero_si128();
+  __m128 const candidates[3] = {x, y, z};
+  for (auto i = 0; i != 3; ++i) {
+    auto const greater = _mm_cmpgt_ps(abs(candidates[i]), largest);
+    largest = _mm_blendv_ps(largest, abs(candidates[i]), greater);
+    largest_signed = _mm_blendv_ps(largest_signed, candidates[i], greater);
+    index = _mm_blendv_epi8(
+        index, _mm_set1_epi32(i + 1), _mm_castps_si128(greater));
+  }
+  auto const flip = _mm_and_ps(_mm_cmplt_ps(largest_signed, _mm_setzero_ps()),
+                               _mm_set1_ps(-0.0f));
+  w = _mm_xor_ps(w, flip);
+  x = _mm_xor_ps(x, flip);
+  y = _mm_xor_ps(y, flip);
+  z = _mm_xor_ps(z, flip);
+  auto const at_least_1 =
+      _mm_castsi128_ps(_mm_cmpgt_epi32(index, _mm_setzero_si128()));
+  auto const at_least_2 =
+      _mm_castsi128_ps(_mm_cmpgt_epi32(index, _mm_set1_epi32(1)));
+  auto const at_least_3 =
+      _mm_castsi128_ps(_mm_cmpgt_epi32(index, _mm_set1_epi32(2)));
+  __m128 const smallest[3] = {
+      _mm_blendv_ps(x, w, at_least_1),
+      _mm_blendv_ps(y, x, at_least_2),
+      _mm_blendv_ps(z, y, at_least_3),
+  };
+  auto const scale = _mm_set1_ps(quat_component_scale<Bits>);
+  for (auto i = 0; i != 3; ++i) {
+    codes[i] = _mm_cvtps_epi32(_mm_add_ps(
+        _mm_mul_ps(clamp(_mm_mul_ps(smallest[i], _mm_set1_ps(sqrt2)),
+                         _mm_set1_ps(-1.0f),
+                         _mm_set1_ps(1.0f)),
+                   scale),
+        scale));
+  }
+}
+
+// decode_quat on four quaternions, returned per component
+template <int Bits>
+inline void decode_quats(__m128i index,
+                         __m128i const (&codes)[3],
+                         __m128 &w,
+                         __m128 &x,
+                         __m128 &y,
+                         __m128 &z) noexcept {
+  auto const scale = _mm_set1_ps(quat_component_scale<Bits>);
+  __m128 smallest[3];
+  for (auto i = 0; i != 3; ++i) {
+    smallest[i] = _mm_mul_ps(
+        _mm_div_ps(_mm_sub_ps(_mm_cvtepi32_ps(codes[i]), scale), scale),
+        _mm_set1_ps(inverse_sqrt2));
+  }
+  auto sum = _mm_mul_ps(smallest[0], smallest[0]);
+  sum = _mm_add_ps(sum, _mm_mul_ps(smallest[1], smallest[1]));
+  sum = _mm_add_ps(sum, _mm_mul_ps(smallest[2], smallest[2]));
+  auto const largest = _mm_sqrt_ps(
+      _mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), sum), _mm_setzero_ps()));
+  auto const at_least_1 =
+      _mm_castsi128_ps(_mm_cmpgt_epi32(index, _mm_setzero_si128()));
+  auto const at_least_2 =
+      _mm_castsi128_ps(_mm_cmpgt_epi32(index, _mm_set1_epi32(1)));
+  auto const at_least_3 =
+      _mm_castsi128_ps(_mm_cmpgt_epi32(index, _mm_set1_epi32(2)));
+  auto const is_0 =
+      _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_setzero_si128()));
+  w = _mm_blendv_ps(smallest[0], largest, is_0);
+  x = _mm_blendv_ps(
+      smallest[0],
+      _mm_blendv_ps(largest, smallest[1], at_least_2),
+      at_least_1);
+  y = _mm_blendv_ps(
+      smallest[1],
+      _mm_blendv_ps(largest, smallest[2], at_least_3),
+      at_least_2);
+  z = _mm_blendv_ps(smallest[2], largest, at_least_3);
+}
+
+// Lanes w, x, y, z of four quaternions
+inline void
+load_quats(Quatf const *q, __m128 &w, __m128 &x, __m128 &y, __m128 &z) {
+  w = load(q[0]);
+  x = load(q[1]);
+  y = load(q[2]);
+  z = load(q[3]);
+  _MM_TRANSPOSE4_PS(w, x, y, z);
+}
+
+inline void store_quats(Quatf *q, __m128 w, __m128 x, __m128 y, __m128 z) {
+  _MM_TRANSPOSE4_PS(w, x, y, z);
+  _mm_storeu_ps(&q[0].w, w);
+  _mm_storeu_ps(&q[1].w, x);
+  _mm_storeu_ps(&q[2].w, y);
+  _mm_storeu_ps(&q[3].w, z);
+}
+#endif
+} // namespace detail
+
+// output[i] = to_half(input[i])
+inline void to_half(std::span<float const> input,
+                    std::span<Half> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 8 <= input.size(); i += 8) {
+    auto const lo = detail::to_half(_mm_loadu_ps(&input[i]));
+    auto const hi = detail::to_half(_mm_loadu_ps(&input[i + 4]));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&output[i]),
+                     _mm_packus_epi32(lo, hi));
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = to_half(input[i]);
+  }
+}
+
+// output[i] = from_half(input[i])
+inline void from_half(std::span<Half const> input,
+                      std::span<float> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 8 <= input.size(); i += 8) {
+    auto const halves =
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(&input[i]));
+    _mm_storeu_ps(&output[i], detail::from_half(_mm_cvtepu16_epi32(halves)));
+    _mm_storeu_ps(&output[i + 4],
+                  detail::from_half(
+                      _mm_cvtepu16_epi32(_mm_srli_si128(halves, 8))));
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = from_half(input[i]);
+  }
+}
+
+inline void to_half(std::span<Vec3f const> input,
+                    std::span<Vec3h> output) noexcept {
+  assert(output.size() == input.size());
+  to_half(std::span{reinterpret_cast<float const *>(input.data()),
+                    3 * input.size()},
+          std::span{reinterpret_cast<Half *>(output.data()),
+                    3 * output.size()});
+}
+
+inline void from_half(std::span<Vec3h const> input,
+                      std::span<Vec3f> output) noexcept {
+  assert(output.size() == input.size());
+  from_half(std::span{reinterpret_cast<Half const *>(input.data()),
+                      3 * input.size()},
+            std::span{reinterpret_cast<float *>(output.data()),
+                      3 * output.size()});
+}
+
+inline void to_half(std::span<Vec4f const> input,
+                    std::span<Vec4h> output) noexcept {
+  assert(output.size() == input.size());
+  to_half(std::span{reinterpret_cast<float const *>(input.data()),
+                    4 * input.size()},
+          std::span{reinterpret_cast<Half *>(output.data()),
+                    4 * output.size()});
+}
+
+inline void from_half(std::span<Vec4h const> input,
+                      std::span<Vec4f> output) noexcept {
+  assert(output.size() == input.size());
+  from_half(std::span{reinterpret_cast<Half const *>(input.data()),
+                      4 * input.size()},
+            std::span{reinterpret_cast<float *>(output.data()),
+                      4 * output.size()});
+}
+
+// output[i] = to_snorm16(input[i])
+inline void to_snorm16(std::span<float const> input,
+                       std::span<std::int16_t> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 8 <= input.size(); i += 8) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(&output[i]),
+        _mm_packs_epi32(detail::to_snorm16(_mm_loadu_ps(&input[i])),
+                        detail::to_snorm16(_mm_loadu_ps(&input[i + 4]))));
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = to_snorm16(input[i]);
+  }
+}
+
+// output[i] = from_snorm16(input[i])
+inline void from_snorm16(std::span<std::int16_t const> input,
+                         std::span<float> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 8 <= input.size(); i += 8) {
+    auto const v =
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(&input[i]));
+    _mm_storeu_ps(&output[i], detail::from_snorm16(_mm_cvtepi16_epi32(v)));
+    _mm_storeu_ps(
+        &output[i + 4],
+        detail::from_snorm16(_mm_cvtepi16_epi32(_mm_srli_si128(v, 8))));
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = from_snorm16(input[i]);
+  }
+}
+
+// output[i] = to_unorm16(input[i])
+inline void to_unorm16(std::span<float const> input,
+                       std::span<std::uint16_t> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 8 <= input.size(); i += 8) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(&output[i]),
+        _mm_packus_epi32(detail::to_unorm16(_mm_loadu_ps(&input[i])),
+                         detail::to_unorm16(_mm_loadu_ps(&input[i + 4]))));
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = to_unorm16(input[i]);
+  }
+}
+
+// output[i] = from_unorm16(input[i])
+inline void from_unorm16(std::span<std::uint16_t const> input,
+                         std::span<float> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 8 <= input.size(); i += 8) {
+    auto const v =
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(&input[i]));
+    _mm_storeu_ps(&output[i], detail::from_unorm16(_mm_cvtepu16_epi32(v)));
+    _mm_storeu_ps(
+        &output[i + 4],
+        detail::from_unorm16(_mm_cvtepu16_epi32(_mm_srli_si128(v, 8))));
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = from_unorm16(input[i]);
+  }
+}
+
+// output[i] = to_oct16(input[i])
+inline void to_oct16(std::span<Vec3f const> input,
+                     std::span<Vec2<std::int16_t>> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 4 <= input.size(); i += 4) {
+    __m128 x, y, z, u, v;
+    detail::load_soa(&input[i].x, x, y, z);
+    detail::to_oct(x, y, z, u, v);
+    auto const us = detail::to_snorm16(u);
+    auto const vs = detail::to_snorm16(v);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&output[i]),
+                     _mm_packs_epi32(_mm_unpacklo_epi32(us, vs),
+                                     _mm_unpackhi_epi32(us, vs)));
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = to_oct16(input[i]);
+  }
+}
+
+// output[i] = from_oct16(input[i])
+inline void from_oct16(std::span<Vec2<std::int16_t> const> input,
+                       std::span<Vec3f> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 4 <= input.size(); i += 4) {
+    auto const e =
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(&input[i]));
+    auto const e01 = detail::from_snorm16(_mm_cvtepi16_epi32(e));
+    auto const e23 =
+        detail::from_snorm16(_mm_cvtepi16_epi32(_mm_srli_si128(e, 8)));
+    auto const ex = _mm_shuffle_ps(e01, e23, _MM_SHUFFLE(2, 0, 2, 0));
+    auto const ey = _mm_shuffle_ps(e01, e23, _MM_SHUFFLE(3, 1, 3, 1));
+    __m128 x, y, z;
+    detail::from_oct(ex, ey, x, y, z);
+    detail::store_aos(&output[i].x, x, y, z);
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = from_oct16(input[i]);
+  }
+}
+
+// output[i] = pack32(input[i])
+inline void pack32(std::span<Quatf const> input,
+                   std::span<Packed_quat32> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 4 <= input.size(); i += 4) {
+    __m128 w, x, y, z;
+    detail::load_quats(&input[i], w, x, y, z);
+    __m128i index, codes[3];
+    detail::encode_quats<10>(w, x, y, z, index, codes);
+    auto bits = _mm_slli_epi32(index, 30);
+    bits = _mm_or_si128(bits, _mm_slli_epi32(codes[0], 20));
+    bits = _mm_or_si128(bits, _mm_slli_epi32(codes[1], 10));
+    bits = _mm_or_si128(bits, codes[2]);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&output[i]), bits);
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = pack32(input[i]);
+  }
+}
+
+// output[i] = unpack(input[i])
+inline void unpack(std::span<Packed_quat32 const> input,
+                   std::span<Quatf> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 4 <= input.size(); i += 4) {
+    auto const bits =
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(&input[i]));
+    auto const mask = _mm_set1_epi32(0x3ff);
+    __m128i const codes[3] = {
+        _mm_and_si128(_mm_srli_epi32(bits, 20), mask),
+        _mm_and_si128(_mm_srli_epi32(bits, 10), mask),
+        _mm_and_si128(bits, mask),
+    };
+    __m128 w, x, y, z;
+    detail::decode_quats<10>(_mm_srli_epi32(bits, 30), codes, w, x, y, z);
+    detail::store_quats(&output[i], w, x, y, z);
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = unpack(input[i]);
+  }
+}
+
+// output[i] = pack48(input[i])
+inline void pack48(std::span<Quatf const> input,
+                   std::span<Packed_quat48> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 4 <= input.size(); i += 4) {
+    __m128 w, x, y, z;
+    detail::load_quats(&input[i], w, x, y, z);
+    __m128i index, codes[3];
+    detail::encode_quats<15>(w, x, y, z, index, codes);
+    alignas(16) std::uint32_t indices[4];
+    alignas(16) std::uint32_t lane_codes[3][4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(indices), index);
+    for (auto j = 0; j != 3; ++j) {
+      _mm_store_si128(reinterpret_cast<__m128i *>(lane_codes[j]), codes[j]);
+    }
+    for (auto j = 0; j != 4; ++j) {
+      output[i + j] = detail::pack(detail::Quat_codes<15>{
+          .index = indices[j],
+          .codes = {lane_codes[0][j], lane_codes[1][j], lane_codes[2][j]}});
+    }
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = pack48(input[i]);
+  }
+}
+
+// output[i] = unpack(input[i])
+inline void unpack(std::span<Packed_quat48 const> input,
+                   std::span<Quatf> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  for (; i + 4 <= input.size(); i += 4) {
+    alignas(16) std::uint32_t indices[4];
+    alignas(16) std::uint32_t lane_codes[3][4];
+    for (auto j = 0; j != 4; ++j) {
+      auto const codes = detail::unpack(input[i + j]);
+      indices[j] = codes.index;
+      for (auto k = 0; k != 3; ++k) {
+        lane_codes[k][j] = codes.codes[k];
+      }
+    }
+    __m128i const codes[3] = {
+        _mm_load_si128(reinterpret_cast<__m128i const *>(lane_codes[0])),
+        _mm_load_si128(reinterpret_cast<__m128i const *>(lane_codes[1])),
+        _mm_load_si128(reinterpret_cast<__m128i const *>(lane_codes[2])),
+    };
+    __m128 w, x, y, z;
+    detail::decode_quats<15>(
+        _mm_load_si128(reinterpret_cast<__m128i const *>(indices)),
+        codes,
+        w,
+        x,
+        y,
+        z);
+    detail::store_quats(&output[i], w, x, y, z);
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = unpack(input[i]);
+  }
+}
+} // namespace math
+} // namespace marlon
+
+#endif
@@ -2,6 +2,10 @@
 
 #include "quat.h"
 
+#include <array>
+#include <bit>
+#include <cstdint>
+
 #include <catch2/catch_test_macros.hpp>
 
 namespace marlon {
@@ -42,6 +46,37 @@ TEST_CASE("Quaternions can be multiplied by quaternions.") {
   REQUIRE(p * q == Quatf::identity());
 }
 
+TEST_CASE("Vectorized quaternion products match the scalar ones bit for bit") {
+  static constexpr auto quats = [] {
+    auto retval = std::array<Quatf, 33>{};
+    auto state = std::uint32_t{1};
+    auto const random_float = [&] {
+      state = state * 1664525u + 1013904223u;
+      return static_cast<float>(static_cast<std::int32_t>(state >> 8) -
+                                (1 << 23)) /
+             static_cast<float>(1 << 21);
+    };
+    for (auto &q : retval) {
+      q.w = random_float();
+      q.v = {random_float(), random_float(), random_float()};
+    }
+    retval[0] = {-0.0f, {0.0f, -0.0f, 0.0f}};
+    return retval;
+  }();
+  constexpr auto expected = [] {
+    auto retval = std::array<Quatf, quats.size() - 1>{};
+    for (auto i = std::size_t{}; i != retval.size(); ++i) {
+      retval[i] = quats[i] * quats[i + 1];
+    }
+    return retval;
+  }();
+  using Bits = std::array<std::uint32_t, 4>;
+  for (auto i = std::size_t{}; i != expected.size(); ++i) {
+    REQUIRE(std::bit_cast<Bits>(quats[i] * quats[i + 1]) ==
+            std::bit_cast<Bits>(expected[i]));
+  }
+}
+
 TEST_CASE("Quaternions can be divided by scalars.") {
   const auto q = Quatf::identity();
   const auto s = 2.0f;
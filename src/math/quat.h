@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 
 #include <numbers>
 
@@ -31,6 +32,54 @@ template <typename T> struct Quat {
 using Quatf = Quat<float>;
 using Quatd = Quat<double>;
 
+static_assert(std::is_standard_layout_v<Quatf>);
+static_assert(offsetof(Quatf, v) == 4);
+static_assert(sizeof(Quatf) == 16);
+
+#ifdef MARLON_MATH_SSE4_1
+namespace detail {
+// Lanes w, x, y, z
+inline __m128 load(Quatf const &q) noexcept { return _mm_loadu_ps(&q.w); }
+
+inline Quatf to_quatf(__m128 q) noexcept {
+  Quatf retval;
+  _mm_storeu_ps(&retval.w, q);
+  return retval;
+}
+
+inline __m128 multiply(__m128 p, __m128 q) noexcept {
+  // p.w * q.w - (T(0) + p.x * q.x + p.y * q.y + p.z * q.z)
+  auto const products = _mm_mul_ps(p, q);
+  auto dot = _mm_setzero_ps();
+  dot = _mm_add_ss(dot, broadcast<1>(products));
+  dot = _mm_add_ss(dot, broadcast<2>(products));
+  dot = _mm_add_ss(dot, broadcast<3>(products));
+  auto const w = _mm_sub_ss(products, dot);
+  // p.w * q.v + q.w * p.v + cross(p.v, q.v)
+  auto const sum = _mm_add_ps(_mm_mul_ps(broadcast<0>(p), q),
+                              _mm_mul_ps(broadcast<0>(q), p));
+  auto const cross =
+      _mm_sub_ps(_mm_mul_ps(shuffle<0, 2, 3, 1>(p), shuffle<0, 3, 1, 2>(q)),
+                 _mm_mul_ps(shuffle<0, 3, 1, 2>(p), shuffle<0, 2, 3, 1>(q)));
+  return _mm_blend_ps(_mm_add_ps(sum, cross), w, 0b0001);
+}
+
+// cross(a, b) of the x, y and z lanes
+inline __m128 cross(__m128 a, __m128 b) noexcept {
+  return _mm_sub_ps(_mm_mul_ps(shuffle<1, 2, 0, 3>(a), shuffle<2, 0, 1, 3>(b)),
+                    _mm_mul_ps(shuffle<2, 0, 1, 3>(a), shuffle<1, 2, 0, 3>(b)));
+}
+
+// The vector in the x, y and z lanes of v rotated by q, see math::rotate
+inline __m128 rotate(__m128 q, __m128 v) noexcept {
+  auto const u = shuffle<1, 2, 3, 0>(q);
+  auto const t = _mm_mul_ps(_mm_set1_ps(2.0f), cross(u, v));
+  return _mm_add_ps(_mm_add_ps(v, _mm_mul_ps(broadcast<0>(q), t)),
+                    cross(u, t));
+}
+} // namespace detail
+#endif
+
 template <typename T>
 constexpr auto operator==(Quat<T> const &p, Quat<T> const &q) noexcept {
   return p.w == q.w && p.v == q.v;
@@ -45,10 +94,24 @@ template <typename T> constexpr auto operator-(Quat<T> const &q) noexcept {
 }
 
 template <typename T> constexpr auto operator*(T s, Quat<T> const &q) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float>) {
+    if !consteval {
+      return detail::to_quatf(_mm_mul_ps(_mm_set1_ps(s), detail::load(q)));
+    }
+  }
+#endif
   return Quat<T>{s * q.w, s * q.v};
 }
 
 template <typename T> constexpr auto operator*(Quat<T> const &q, T s) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float>) {
+    if !consteval {
+      return detail::to_quatf(_mm_mul_ps(detail::load(q), _mm_set1_ps(s)));
+    }
+  }
+#endif
   return Quat<T>{q.w * s, q.v * s};
 }
 
@@ -62,16 +125,38 @@ template <typename T> constexpr auto operator/(Quat<T> const &q, T s) noexcept {
 
 template <typename T>
 constexpr auto operator*(Quat<T> const &q1, Quat<T> const &q2) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float>) {
+    if !consteval {
+      return detail::to_quatf(
+          detail::multiply(detail::load(q1), detail::load(q2)));
+    }
+  }
+#endif
   return Quat<T>{q1.w * q2.w - dot(q1.v, q2.v),
                  q1.w * q2.v + q2.w * q1.v + cross(q1.v, q2.v)};
 }
 
 template <typename T>
 constexpr auto operator+(Quat<T> const &q1, Quat<T> const &q2) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float>) {
+    if !consteval {
+      return detail::to_quatf(_mm_add_ps(detail::load(q1), detail::load(q2)));
+    }
+  }
+#endif
   return Quat<T>{q1.w + q2.w, q1.v + q2.v};
 }
 template <typename T>
 constexpr auto operator-(Quat<T> const &q1, Quat<T> const &q2) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float>) {
+    if !consteval {
+      return detail::to_quatf(_mm_sub_ps(detail::load(q1), detail::load(q2)));
+    }
+  }
+#endif
   return Quat<T>{q1.w - q2.w, q1.v - q2.v};
 }
 
@@ -119,6 +204,20 @@ template <typename T> constexpr auto conjugate(Quat<T> const &q) noexcept {
   return Quat<T>{q.w, -q.v};
 }
 
+// q * Quat{0, v} * conjugate(q) for a unit q, without forming the products
+template <typename T>
+constexpr auto rotate(Quat<T> const &q, Vec3<T> const &v) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float>) {
+    if !consteval {
+      return detail::to_vec3f(detail::rotate(detail::load(q), detail::load(v)));
+    }
+  }
+#endif
+  auto const t = T(2) * cross(q.v, v);
+  return v + q.w * t + cross(q.v, t);
+}
+
 template <typename T> constexpr auto inverse(Quat<T> const &q) noexcept {
   return conjugate(q) / length_squared(q);
 }
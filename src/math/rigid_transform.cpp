@@ -0,0 +1,144 @@
+#include "rigid_transform.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace math {
+namespace {
+constexpr auto random_float(std::uint32_t &state) noexcept {
+  state = state * 1664525u + 1013904223u;
+  return static_cast<float>(static_cast<std::int32_t>(state >> 8) - (1 << 23)) /
+         static_cast<float>(1 << 21);
+}
+
+constexpr auto random_vec3(std::uint32_t &state) noexcept {
+  auto const x = random_float(state);
+  auto const y = random_float(state);
+  auto const z = random_float(state);
+  return Vec3f{x, y, z};
+}
+
+constexpr auto random_transform(std::uint32_t &state) noexcept {
+  auto const position = random_vec3(state);
+  auto const w = random_float(state);
+  auto const v = random_vec3(state);
+  return Rigid_transform{.position = position,
+                         .orientation = normalize(Quatf{w, v})};
+}
+
+template <typename T> bool bitwise_equal(T const &a, T const &b) noexcept {
+  using Bits = std::array<std::uint32_t, sizeof(T) / 4>;
+  return std::bit_cast<Bits>(a) == std::bit_cast<Bits>(b);
+}
+
+bool approx_equal(Vec3f const &a, Vec3f const &b) noexcept {
+  return length(a - b) <= 1e-4f;
+}
+
+bool approx_equal(Rigid_transform const &a, Rigid_transform const &b) noexcept {
+  return approx_equal(a.position, b.position) &&
+         abs(a.orientation.w - b.orientation.w) <= 1e-5f &&
+         approx_equal(a.orientation.v, b.orientation.v);
+}
+
+constexpr auto count = 16;
+
+struct Input {
+  Rigid_transform a;
+  Rigid_transform b;
+  Vec3f v;
+};
+
+constexpr auto inputs = [] {
+  auto state = std::uint32_t{7};
+  auto retval = std::array<Input, count>{};
+  for (auto &input : retval) {
+    input.a = random_transform(state);
+    input.b = random_transform(state);
+    input.v = random_vec3(state);
+  }
+  return retval;
+}();
+
+struct Output {
+  Vec3f rotated;
+  Vec3f point;
+  Vec3f direction;
+  Vec3f inverse_point;
+  Vec3f inverse_direction;
+  Rigid_transform product;
+  Rigid_transform inverse;
+  Mat3x4f matrix;
+};
+
+constexpr auto compute(Input const &input) noexcept {
+  return Output{
+      .rotated = rotate(input.a.orientation, input.v),
+      .point = transform_point(input.a, input.v),
+      .direction = transform_direction(input.a, input.v),
+      .inverse_point = inverse_transform_point(input.a, input.v),
+      .inverse_direction = inverse_transform_direction(input.a, input.v),
+      .product = input.a * input.b,
+      .inverse = inverse(input.a),
+      .matrix = to_mat3x4f(input.a)};
+}
+
+constexpr auto expected = [] {
+  auto retval = std::array<Output, count>{};
+  for (auto i = 0; i != count; ++i) {
+    retval[i] = compute(inputs[i]);
+  }
+  return retval;
+}();
+} // namespace
+
+TEST_CASE("Rigid transforms match their matrices") {
+  for (auto const &input : inputs) {
+    auto const m = to_mat3x4f(input.a);
+    auto const m_inv = rigid_inverse(m);
+    REQUIRE(approx_equal(transform_point(input.a, input.v),
+                         m * Vec4f{input.v, 1.0f}));
+    REQUIRE(approx_equal(transform_direction(input.a, input.v),
+                         m * Vec4f{input.v, 0.0f}));
+    REQUIRE(approx_equal(inverse_transform_point(input.a, input.v),
+                         m_inv * Vec4f{input.v, 1.0f}));
+    REQUIRE(approx_equal(inverse_transform_direction(input.a, input.v),
+                         m_inv * Vec4f{input.v, 0.0f}));
+    auto const product = to_mat3x4f(input.a * input.b);
+    auto const matrix_product =
+        m * Mat4x4f{to_mat3x4f(input.b)[0],
+                    to_mat3x4f(input.b)[1],
+                    to_mat3x4f(input.b)[2],
+                    {0.0f, 0.0f, 0.0f, 1.0f}};
+    for (auto i = 0; i != 3; ++i) {
+      for (auto j = 0; j != 4; ++j) {
+        REQUIRE(abs(product[i][j] - matrix_product[i][j]) <= 1e-4f);
+      }
+    }
+    REQUIRE(approx_equal(input.a * inverse(input.a),
+                         Rigid_transform::identity()));
+    REQUIRE(approx_equal(inverse(input.a) * input.a,
+                         Rigid_transform::identity()));
+  }
+}
+
+TEST_CASE("Vectorized rigid transforms match the scalar ones bit for bit") {
+  for (auto i = 0; i != count; ++i) {
+    auto const actual = compute(inputs[i]);
+    REQUIRE(bitwise_equal(actual.rotated, expected[i].rotated));
+    REQUIRE(bitwise_equal(actual.point, expected[i].point));
+    REQUIRE(bitwise_equal(actual.direction, expected[i].direction));
+    REQUIRE(bitwise_equal(actual.inverse_point, expected[i].inverse_point));
+    REQUIRE(
+        bitwise_equal(actual.inverse_direction, expected[i].inverse_direction));
+    REQUIRE(bitwise_equal(actual.product, expected[i].product));
+    REQUIRE(bitwise_equal(actual.inverse, expected[i].inverse));
+    REQUIRE(bitwise_equal(actual.matrix, expected[i].matrix));
+  }
+}
+} // namespace math
+} // namespace marlon
@@ -0,0 +1,130 @@
+#ifndef MARLON_MATH_RIGID_TRANSFORM_H
+#define MARLON_MATH_RIGID_TRANSFORM_H
+
+#include <cstddef>
+
+#include <type_traits>
+
+#include "mat.h"
+#include "quat.h"
+#include "simd.h"
+#include "vec.h"
+
+namespace marlon {
+namespace math {
+// A rotation followed by a translation. At 28 bytes it is smaller than the
+// Mat3x4f it stands for, and composing, inverting and applying it rotates
+// by the quaternion directly instead of building and inverting matrices.
+struct Rigid_transform {
+  static constexpr auto identity() noexcept {
+    return Rigid_transform{.position = Vec3f::zero(),
+                           .orientation = Quatf{1.0f, Vec3f::zero()}};
+  }
+
+  Vec3f position;
+  Quatf orientation;
+};
+
+// The 16 bytes at position and at orientation both lie within the transform,
+// so each loads with a single unaligned load
+static_assert(std::is_standard_layout_v<Rigid_transform>);
+static_assert(offsetof(Rigid_transform, orientation) == 12);
+static_assert(sizeof(Rigid_transform) == 28);
+
+namespace detail {
+#ifdef MARLON_MATH_SSE4_1
+// Lanes x, y, z and orientation.w
+inline __m128 load_position(Rigid_transform const &t) noexcept {
+  return _mm_loadu_ps(&t.position.x);
+}
+
+inline Rigid_transform to_rigid_transform(__m128 position,
+                                          __m128 orientation) noexcept {
+  auto retval = Rigid_transform{};
+  _mm_storeu_ps(&retval.position.x, position);
+  _mm_storeu_ps(&retval.orientation.w, orientation);
+  return retval;
+}
+#endif
+} // namespace detail
+
+constexpr auto transform_point(Rigid_transform const &t,
+                               Vec3f const &p) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if !consteval {
+    return detail::to_vec3f(
+        _mm_add_ps(detail::rotate(detail::load(t.orientation), detail::load(p)),
+                   detail::load_position(t)));
+  }
+#endif
+  return rotate(t.orientation, p) + t.position;
+}
+
+constexpr auto transform_direction(Rigid_transform const &t,
+                                   Vec3f const &d) noexcept {
+  return rotate(t.orientation, d);
+}
+
+constexpr auto inverse_transform_point(Rigid_transform const &t,
+                                       Vec3f const &p) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if !consteval {
+    return detail::to_vec3f(detail::rotate(
+        detail::negate<false, true, true, true>(detail::load(t.orientation)),
+        _mm_sub_ps(detail::load(p), detail::load_position(t))));
+  }
+#endif
+  return rotate(conjugate(t.orientation), p - t.position);
+}
+
+constexpr auto inverse_transform_direction(Rigid_transform const &t,
+                                           Vec3f const &d) noexcept {
+  return rotate(conjugate(t.orientation), d);
+}
+
+// The transform that applies b, then a
+constexpr auto operator*(Rigid_transform const &a,
+                         Rigid_transform const &b) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if !consteval {
+    auto const a_orientation = detail::load(a.orientation);
+    auto const b_position = detail::load_position(b);
+    return detail::to_rigid_transform(
+        _mm_add_ps(detail::rotate(a_orientation, b_position),
+                   detail::load_position(a)),
+        detail::multiply(a_orientation, detail::load(b.orientation)));
+  }
+#endif
+  return Rigid_transform{.position = transform_point(a, b.position),
+                         .orientation = a.orientation * b.orientation};
+}
+
+constexpr auto inverse(Rigid_transform const &t) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if !consteval {
+    auto const orientation =
+        detail::negate<false, true, true, true>(detail::load(t.orientation));
+    return detail::to_rigid_transform(
+        detail::negate<true, true, true, false>(
+            detail::rotate(orientation, detail::load_position(t))),
+        orientation);
+  }
+#endif
+  auto const orientation = conjugate(t.orientation);
+  return Rigid_transform{.position = -rotate(orientation, t.position),
+                         .orientation = orientation};
+}
+
+constexpr auto to_mat3x4f(Rigid_transform const &t) noexcept {
+  return Mat3x4f::rigid(t.position, t.orientation);
+}
+
+// to_mat3x4f(t) * Mat4x4f{m, {0, 0, 0, 1}}, e.g. to place a pretransformed
+// mesh without going through 4x4 matrices
+constexpr auto operator*(Rigid_transform const &t, Mat3x4f const &m) noexcept {
+  return to_mat3x4f(t) * Mat4x4f{m, {0.0f, 0.0f, 0.0f, 1.0f}};
+}
+} // namespace math
+} // namespace marlon
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef MARLON_MATH_SIMD_H
+#define MARLON_MATH_SIMD_H
+
+// The 4-wide float types, their matrix products, the quaternion product and
+// Mat3x4f::rigid switch to SSE4.1, and AVX2 where it pays off, outside of
+// constant evaluation. The vector code performs the same float operations
+// in the same order as the scalar code, down to the zero that starts each
+// sum, so both produce bit identical results and the memory layout of every
+// type stays as it is.
+#if defined(__AVX2__)
+#define MARLON_MATH_AVX2
+#define MARLON_MATH_SSE4_1
+#include <immintrin.h>
+#elif defined(__SSE4_1__) || defined(__AVX__)
+#define MARLON_MATH_SSE4_1
+#include <smmintrin.h>
+#endif
+
+namespace marlon {
+namespace math {
+namespace detail {
+#ifdef MARLON_MATH_SSE4_1
+template <int I0, int I1, int I2, int I3>
+inline __m128 shuffle(__m128 v) noexcept {
+  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(I3, I2, I1, I0));
+}
+
+template <int I> inline __m128 broadcast(__m128 v) noexcept {
+  return shuffle<I, I, I, I>(v);
+}
+
+// Flips the signs of the lanes whose template argument is true, exact like
+// the negation of the scalar code
+template <bool N0, bool N1, bool N2, bool N3>
+inline __m128 negate(__m128 v) noexcept {
+  return _mm_xor_ps(v,
+                    _mm_set_ps(N3 ? -0.0f : 0.0f,
+                               N2 ? -0.0f : 0.0f,
+                               N1 ? -0.0f : 0.0f,
+                               N0 ? -0.0f : 0.0f));
+}
+
+// T(0) + v0 * m0 + v1 * m1 + ..., associated like the scalar loops
+inline __m128 linear_combination(__m128 v,
+                                 __m128 m0,
+                                 __m128 m1,
+                                 __m128 m2,
+                                 __m128 m3) noexcept {
+  auto retval = _mm_setzero_ps();
+  retval = _mm_add_ps(retval, _mm_mul_ps(broadcast<0>(v), m0));
+  retval = _mm_add_ps(retval, _mm_mul_ps(broadcast<1>(v), m1));
+  retval = _mm_add_ps(retval, _mm_mul_ps(broadcast<2>(v), m2));
+  retval = _mm_add_ps(retval, _mm_mul_ps(broadcast<3>(v), m3));
+  return retval;
+}
+#endif
+
+#ifdef MARLON_MATH_AVX2
+// linear_combination of two vectors at once, one per 128 bit lane
+inline __m256 linear_combination(__m256 v,
+                                 __m256 m0,
+                                 __m256 m1,
+                                 __m256 m2,
+                                 __m256 m3) noexcept {
+  auto retval = _mm256_setzero_ps();
+  retval = _mm256_add_ps(
+      retval, _mm256_mul_ps(_mm256_permute_ps(v, 0b00'00'00'00), m0));
+  retval = _mm256_add_ps(
+      retval, _mm256_mul_ps(_mm256_permute_ps(v, 0b01'01'01'01), m1));
+  retval = _mm256_add_ps(
+      retval, _mm256_mul_ps(_mm256_permute_ps(v, 0b10'10'10'10), m2));
+  retval = _mm256_add_ps(
+      retval, _mm256_mul_ps(_mm256_permute_ps(v, 0b11'11'11'11), m3));
+  return retval;
+}
+#endif
+} // namespace detail
+} // namespace math
+} // namespace marlon
+
+#endif
@@ -0,0 +1,136 @@
+#include "transform.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace math {
+namespace {
+auto random_float(std::uint32_t &state) noexcept {
+  state = state * 1664525u + 1013904223u;
+  return static_cast<float>(static_cast<std::int32_t>(state >> 8) - (1 << 23)) /
+         static_cast<float>(1 << 21);
+}
+
+auto random_vec3(std::uint32_t &state) noexcept {
+  auto const x = random_float(state);
+  auto const y = random_float(state);
+  auto const z = random_float(state);
+  return Vec3f{x, y, z};
+}
+
+auto random_mat(std::uint32_t &state) noexcept {
+  auto retval = Mat3x4f::zero();
+  for (auto i = 0; i < 3; ++i) {
+    for (auto j = 0; j < 4; ++j) {
+      retval[i][j] = random_float(state);
+    }
+  }
+  return retval;
+}
+
+template <typename T> bool bitwise_equal(T const &a, T const &b) noexcept {
+  using Bits = std::array<std::uint32_t, sizeof(T) / 4>;
+  return std::bit_cast<Bits>(a) == std::bit_cast<Bits>(b);
+}
+
+template <int W>
+void check_vec3s(Mat3x4f const &transform, std::vector<Vec3f> const &input) {
+  auto const expected = [&](Vec3f const &v) {
+    return transform * Vec4f{v, static_cast<float>(W)};
+  };
+  auto const apply = [&](auto input, auto output) {
+    if constexpr (W == 1) {
+      transform_points(transform, input, output);
+    } else {
+      transform_directions(transform, input, output);
+    }
+  };
+  auto output = std::vector<Vec3f>(input.size());
+  apply(std::span<Vec3f const>{input}, std::span{output});
+  for (auto i = std::size_t{}; i != input.size(); ++i) {
+    REQUIRE(bitwise_equal(output[i], expected(input[i])));
+  }
+  output = input;
+  apply(std::span<Vec3f const>{output}, std::span{output});
+  for (auto i = std::size_t{}; i != input.size(); ++i) {
+    REQUIRE(bitwise_equal(output[i], expected(input[i])));
+  }
+  auto x = std::vector<float>{};
+  auto y = std::vector<float>{};
+  auto z = std::vector<float>{};
+  for (auto const &v : input) {
+    x.push_back(v.x);
+    y.push_back(v.y);
+    z.push_back(v.z);
+  }
+  auto output_x = std::vector<float>(input.size());
+  auto output_y = std::vector<float>(input.size());
+  auto output_z = std::vector<float>(input.size());
+  apply(Soa_vec3f_const_span{x, y, z},
+        Soa_vec3f_span{output_x, output_y, output_z});
+  for (auto i = std::size_t{}; i != input.size(); ++i) {
+    REQUIRE(bitwise_equal(Vec3f{output_x[i], output_y[i], output_z[i]},
+                          expected(input[i])));
+  }
+}
+} // namespace
+
+TEST_CASE("Points and directions can be transformed in batches") {
+  auto state = std::uint32_t{1};
+  for (auto size = std::size_t{}; size != 21; ++size) {
+    auto const transform = random_mat(state);
+    auto input = std::vector<Vec3f>{};
+    for (auto i = std::size_t{}; i != size; ++i) {
+      input.push_back(random_vec3(state));
+    }
+    check_vec3s<1>(transform, input);
+    check_vec3s<0>(transform, input);
+  }
+}
+
+TEST_CASE("Aabbs can be transformed in batches") {
+  auto state = std::uint32_t{2};
+  auto transforms = std::vector<Mat3x4f>{};
+  auto boxes = std::vector<Aabb3f>{};
+  for (auto i = 0; i != 13; ++i) {
+    transforms.push_back(random_mat(state));
+    auto const a = random_vec3(state);
+    auto const b = random_vec3(state);
+    boxes.emplace_back(min(a, b), max(a, b));
+  }
+  auto const expected = [](Mat3x4f const &transform, Aabb3f const &box) {
+    auto const center = transform * Vec4f{(box.min + box.max) * 0.5f, 1.0f};
+    auto const half_extents =
+        abs(transform) * Vec4f{0.5f * (box.max - box.min), 0.0f};
+    return Aabb3f{center - half_extents, center + half_extents};
+  };
+  auto output = std::vector<Aabb3f>(boxes.size());
+  transform_aabbs(transforms, boxes, output);
+  for (auto i = std::size_t{}; i != boxes.size(); ++i) {
+    REQUIRE(bitwise_equal(output[i], expected(transforms[i], boxes[i])));
+    for (auto corner = 0; corner != 8; ++corner) {
+      auto const p =
+          transforms[i] *
+          Vec4f{corner & 1 ? boxes[i].max.x : boxes[i].min.x,
+                corner & 2 ? boxes[i].max.y : boxes[i].min.y,
+                corner & 4 ? boxes[i].max.z : boxes[i].min.z,
+                1.0f};
+      for (auto j = 0; j != 3; ++j) {
+        REQUIRE(p[j] >= output[i].min[j] - 1e-4f);
+        REQUIRE(p[j] <= output[i].max[j] + 1e-4f);
+      }
+    }
+  }
+  output = boxes;
+  transform_aabbs(transforms[0], output, output);
+  for (auto i = std::size_t{}; i != boxes.size(); ++i) {
+    REQUIRE(bitwise_equal(output[i], expected(transforms[0], boxes[i])));
+  }
+}
+} // namespace math
+} // namespace marlon
@@ -0,0 +1,305 @@
+#ifndef MARLON_MATH_TRANSFORM_H
+#define MARLON_MATH_TRANSFORM_H
+
+#include <cassert>
+#include <cstddef>
+
+#include <span>
+
+#include "aabb.h"
+#include "mat.h"
+#include "simd.h"
+#include "vec.h"
+
+namespace marlon {
+namespace math {
+// Structure of arrays view of Vec3s, the three spans have the same size
+template <typename T> struct Soa_vec3_span {
+  std::span<T> x;
+  std::span<T> y;
+  std::span<T> z;
+
+  constexpr std::size_t size() const noexcept { return x.size(); }
+};
+
+using Soa_vec3f_span = Soa_vec3_span<float>;
+using Soa_vec3f_const_span = Soa_vec3_span<float const>;
+
+namespace detail {
+// transform * Vec4f{v, W} as computed by the scalar operator
+template <int W>
+inline Vec3f transform_vec3(Mat3x4f const &transform,
+                            Vec3f const &v) noexcept {
+  return transform * Vec4f{v, static_cast<float>(W)};
+}
+
+#ifdef MARLON_MATH_SSE4_1
+// The columns of m, the last one already multiplied by W
+template <int W> struct Transform_columns {
+  explicit Transform_columns(Mat3x4f const &m) noexcept {
+    c0 = load(m[0]);
+    c1 = load(m[1]);
+    c2 = load(m[2]);
+    auto row3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(c0, c1, c2, row3);
+    c3 = _mm_mul_ps(row3, _mm_set1_ps(static_cast<float>(W)));
+  }
+
+  __m128 operator*(__m128 v) const noexcept {
+    auto retval = _mm_setzero_ps();
+    retval = _mm_add_ps(retval, _mm_mul_ps(broadcast<0>(v), c0));
+    retval = _mm_add_ps(retval, _mm_mul_ps(broadcast<1>(v), c1));
+    retval = _mm_add_ps(retval, _mm_mul_ps(broadcast<2>(v), c2));
+    return _mm_add_ps(retval, c3);
+  }
+
+  __m128 c0, c1, c2, c3;
+};
+
+inline __m128 add(__m128 a, __m128 b) noexcept { return _mm_add_ps(a, b); }
+
+inline __m128 mul(__m128 a, __m128 b) noexcept { return _mm_mul_ps(a, b); }
+
+inline void set(__m128 &v, float s) noexcept { v = _mm_set1_ps(s); }
+
+#ifdef MARLON_MATH_AVX2
+inline __m256 add(__m256 a, __m256 b) noexcept { return _mm256_add_ps(a, b); }
+
+inline __m256 mul(__m256 a, __m256 b) noexcept { return _mm256_mul_ps(a, b); }
+
+inline void set(__m256 &v, float s) noexcept { v = _mm256_set1_ps(s); }
+#endif
+
+template <int Lanes> struct Float_vector;
+
+template <> struct Float_vector<4> {
+  using Type = __m128;
+};
+
+#ifdef MARLON_MATH_AVX2
+template <> struct Float_vector<8> {
+  using Type = __m256;
+};
+#endif
+
+// One Vec3f per lane of x, y and z, the entries broadcast to every lane
+template <int W, int Lanes> struct Soa_transform {
+  using V = typename Float_vector<Lanes>::Type;
+
+  explicit Soa_transform(Mat3x4f const &m) noexcept {
+    for (auto i = 0; i != 3; ++i) {
+      for (auto j = 0; j != 4; ++j) {
+        set(entries[i][j],
+            j == 3 ? m[i][j] * static_cast<float>(W) : m[i][j]);
+      }
+    }
+  }
+
+  void apply(V &x, V &y, V &z) const noexcept {
+    V results[3];
+    for (auto i = 0; i != 3; ++i) {
+      auto result = add(V{}, mul(entries[i][0], x));
+      result = add(result, mul(entries[i][1], y));
+      result = add(result, mul(entries[i][2], z));
+      results[i] = add(result, entries[i][3]);
+    }
+    x = results[0];
+    y = results[1];
+    z = results[2];
+  }
+
+  V entries[3][4];
+};
+
+inline void
+load_soa(float const *aos, __m128 &x, __m128 &y, __m128 &z) noexcept {
+  auto const a = _mm_loadu_ps(aos);
+  auto const b = _mm_loadu_ps(aos + 4);
+  auto const c = _mm_loadu_ps(aos + 8);
+  auto const x23y23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+  auto const y01z01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+  x = _mm_shuffle_ps(a, x23y23, _MM_SHUFFLE(2, 0, 3, 0));
+  y = _mm_shuffle_ps(y01z01, x23y23, _MM_SHUFFLE(3, 1, 2, 0));
+  z = _mm_shuffle_ps(y01z01, c, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+inline void store_aos(float *aos, __m128 x, __m128 y, __m128 z) noexcept {
+  auto const xy01 = _mm_unpacklo_ps(x, y);
+  auto const xy23 = _mm_unpackhi_ps(x, y);
+  auto const z0x1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+  auto const y1z1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+  auto const z2x3 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+  auto const y3z3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+  _mm_storeu_ps(aos, _mm_shuffle_ps(xy01, z0x1, _MM_SHUFFLE(2, 0, 1, 0)));
+  _mm_storeu_ps(aos + 4,
+                _mm_shuffle_ps(y1z1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+  _mm_storeu_ps(aos + 8,
+                _mm_shuffle_ps(z2x3, y3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+// The box is loaded as min.xyz, max.x and min.z, max.xyz, both within its 24
+// bytes, and stored the same way
+inline void transform_aabb(Transform_columns<1> const &transform,
+                           Transform_columns<0> const &abs_transform,
+                           Aabb3f const &box,
+                           Aabb3f &output) noexcept {
+  auto const min = _mm_loadu_ps(&box.min.x);
+  auto const max = shuffle<1, 2, 3, 3>(_mm_loadu_ps(&box.min.z));
+  auto const half = _mm_set1_ps(0.5f);
+  auto const center = transform * _mm_mul_ps(_mm_add_ps(min, max), half);
+  auto const half_extents =
+      abs_transform * _mm_mul_ps(half, _mm_sub_ps(max, min));
+  auto const output_min = _mm_sub_ps(center, half_extents);
+  auto const output_max = _mm_add_ps(center, half_extents);
+  _mm_storeu_ps(&output.min.x, output_min);
+  auto const min_z_max_x =
+      _mm_shuffle_ps(output_min, output_max, _MM_SHUFFLE(0, 0, 2, 2));
+  _mm_storeu_ps(
+      &output.min.z,
+      _mm_shuffle_ps(min_z_max_x, output_max, _MM_SHUFFLE(2, 1, 2, 0)));
+}
+#endif
+
+template <int W>
+inline void transform_vec3s(Mat3x4f const &transform,
+                            std::span<Vec3f const> input,
+                            std::span<Vec3f> output) noexcept {
+  assert(output.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_SSE4_1
+  auto const soa_transform = Soa_transform<W, 4>{transform};
+  for (; i + 4 <= input.size(); i += 4) {
+    __m128 x, y, z;
+    load_soa(&input[i].x, x, y, z);
+    soa_transform.apply(x, y, z);
+    store_aos(&output[i].x, x, y, z);
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    output[i] = transform_vec3<W>(transform, input[i]);
+  }
+}
+
+template <int W>
+inline void transform_vec3s(Mat3x4f const &transform,
+                            Soa_vec3f_const_span input,
+                            Soa_vec3f_span output) noexcept {
+  assert(input.y.size() == input.size() && input.z.size() == input.size());
+  assert(output.x.size() == input.size() && output.y.size() == input.size() &&
+         output.z.size() == input.size());
+  auto i = std::size_t{};
+#ifdef MARLON_MATH_AVX2
+  auto const wide_transform = Soa_transform<W, 8>{transform};
+  for (; i + 8 <= input.size(); i += 8) {
+    auto x = _mm256_loadu_ps(&input.x[i]);
+    auto y = _mm256_loadu_ps(&input.y[i]);
+    auto z = _mm256_loadu_ps(&input.z[i]);
+    wide_transform.apply(x, y, z);
+    _mm256_storeu_ps(&output.x[i], x);
+    _mm256_storeu_ps(&output.y[i], y);
+    _mm256_storeu_ps(&output.z[i], z);
+  }
+#endif
+#ifdef MARLON_MATH_SSE4_1
+  auto const soa_transform = Soa_transform<W, 4>{transform};
+  for (; i + 4 <= input.size(); i += 4) {
+    auto x = _mm_loadu_ps(&input.x[i]);
+    auto y = _mm_loadu_ps(&input.y[i]);
+    auto z = _mm_loadu_ps(&input.z[i]);
+    soa_transform.apply(x, y, z);
+    _mm_storeu_ps(&output.x[i], x);
+    _mm_storeu_ps(&output.y[i], y);
+    _mm_storeu_ps(&output.z[i], z);
+  }
+#endif
+  for (; i != input.size(); ++i) {
+    auto const v = transform_vec3<W>(
+        transform, Vec3f{input.x[i], input.y[i], input.z[i]});
+    output.x[i] = v.x;
+    output.y[i] = v.y;
+    output.z[i] = v.z;
+  }
+}
+
+inline Aabb3f transform_aabb(Mat3x4f const &transform,
+                             Mat3x4f const &abs_transform,
+                             Aabb3f const &box) noexcept {
+  auto const center =
+      transform_vec3<1>(transform, (box.min + box.max) * 0.5f);
+  auto const half_extents =
+      transform_vec3<0>(abs_transform, 0.5f * (box.max - box.min));
+  return {center - half_extents, center + half_extents};
+}
+} // namespace detail
+
+// output[i] = transform * Vec4f{points[i], 1.0f}, bit for bit. The output may
+// be the input span itself.
+inline void transform_points(Mat3x4f const &transform,
+                             std::span<Vec3f const> points,
+                             std::span<Vec3f> output) noexcept {
+  detail::transform_vec3s<1>(transform, points, output);
+}
+
+inline void transform_points(Mat3x4f const &transform,
+                             Soa_vec3f_const_span points,
+                             Soa_vec3f_span output) noexcept {
+  detail::transform_vec3s<1>(transform, points, output);
+}
+
+// output[i] = transform * Vec4f{directions[i], 0.0f}, bit for bit. The output
+// may be the input span itself.
+inline void transform_directions(Mat3x4f const &transform,
+                                 std::span<Vec3f const> directions,
+                                 std::span<Vec3f> output) noexcept {
+  detail::transform_vec3s<0>(transform, directions, output);
+}
+
+inline void transform_directions(Mat3x4f const &transform,
+                                 Soa_vec3f_const_span directions,
+                                 Soa_vec3f_span output) noexcept {
+  detail::transform_vec3s<0>(transform, directions, output);
+}
+
+// output[i] bounds boxes[i] transformed by transforms[i]: the transformed
+// center of the box plus and minus abs(transforms[i]) times its half extents.
+// The output may be the boxes span itself.
+inline void transform_aabbs(std::span<Mat3x4f const> transforms,
+                            std::span<Aabb3f const> boxes,
+                            std::span<Aabb3f> output) noexcept {
+  assert(transforms.size() == boxes.size());
+  assert(output.size() == boxes.size());
+  for (auto i = std::size_t{}; i != boxes.size(); ++i) {
+#ifdef MARLON_MATH_SSE4_1
+    detail::transform_aabb(detail::Transform_columns<1>{transforms[i]},
+                           detail::Transform_columns<0>{abs(transforms[i])},
+                           boxes[i],
+                           output[i]);
+#else
+    output[i] =
+        detail::transform_aabb(transforms[i], abs(transforms[i]), boxes[i]);
+#endif
+  }
+}
+
+// transform_aabbs with the same transform for every box
+inline void transform_aabbs(Mat3x4f const &transform,
+                            std::span<Aabb3f const> boxes,
+                            std::span<Aabb3f> output) noexcept {
+  assert(output.size() == boxes.size());
+#ifdef MARLON_MATH_SSE4_1
+  auto const columns = detail::Transform_columns<1>{transform};
+  auto const abs_columns = detail::Transform_columns<0>{abs(transform)};
+  for (auto i = std::size_t{}; i != boxes.size(); ++i) {
+    detail::transform_aabb(columns, abs_columns, boxes[i], output[i]);
+  }
+#else
+  auto const abs_transform = abs(transform);
+  for (auto i = std::size_t{}; i != boxes.size(); ++i) {
+    output[i] = detail::transform_aabb(transform, abs_transform, boxes[i]);
+  }
+#endif
+}
+} // namespace math
+} // namespace marlon
+
+#endif
@@ -78,6 +78,23 @@ TEST_CASE("Vectors can be divided by scalars.") {
   REQUIRE(v == u_over_s);
 }
 
+TEST_CASE("4-wide float vectors match the scalar operations.") {
+  constexpr Vec4f u{0.1f, -2.5f, 3.0f, -0.0f};
+  constexpr Vec4f v{0.7f, 1.25f, -3.0f, 0.0f};
+  constexpr auto s = 1.3f;
+  constexpr auto u_plus_v = u + v;
+  constexpr auto u_minus_v = u - v;
+  constexpr auto s_times_u = s * u;
+  constexpr auto minus_u = -u;
+  REQUIRE(u + v == u_plus_v);
+  REQUIRE(u - v == u_minus_v);
+  REQUIRE(s * u == s_times_u);
+  REQUIRE(u * s == s_times_u);
+  REQUIRE(-u == minus_u);
+  REQUIRE(std::signbit((u + v).w) == std::signbit(u_plus_v.w));
+  REQUIRE(std::signbit((-u).w) == std::signbit(minus_u.w));
+}
+
 TEST_CASE("The length of a vector can be taken") {
   const Vec2i u{3, 4};
   REQUIRE(length(u) == 5);
@@ -9,6 +9,7 @@
 #include <type_traits>
 
 #include "scalar.h"
+#include "simd.h"
 #include "unreachable.h"
 
 namespace marlon {
@@ -300,6 +301,29 @@ static_assert(offsetof(Vec4d, z) == 16);
 static_assert(offsetof(Vec4d, w) == 24);
 static_assert(sizeof(Vec4d) == 32);
 
+#ifdef MARLON_MATH_SSE4_1
+namespace detail {
+// Lanes x, y, z, 0
+inline __m128 load(Vec3f const &v) noexcept {
+  return _mm_setr_ps(v.x, v.y, v.z, 0.0f);
+}
+
+inline Vec3f to_vec3f(__m128 v) noexcept {
+  alignas(16) float components[4];
+  _mm_store_ps(components, v);
+  return {components[0], components[1], components[2]};
+}
+
+inline __m128 load(Vec4f const &v) noexcept { return _mm_loadu_ps(&v.x); }
+
+inline Vec4f to_vec4f(__m128 v) noexcept {
+  Vec4f retval;
+  _mm_storeu_ps(&retval.x, v);
+  return retval;
+}
+} // namespace detail
+#endif
+
 template <typename T, int N>
 constexpr bool operator==(Vec<T, N> const &u, Vec<T, N> const &v) noexcept {
   for (int i = 0; i < N; ++i) {
@@ -317,26 +341,61 @@ constexpr auto operator+(Vec<T, N> const &v) noexcept {
 
 template <typename T, int N>
 constexpr auto operator-(Vec<T, N> const &v) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float> && N == 4) {
+    if !consteval {
+      return detail::to_vec4f(_mm_xor_ps(detail::load(v), _mm_set1_ps(-0.0f)));
+    }
+  }
+#endif
   return Vec<T, N>{[&](int i) { return -v[i]; }};
 }
 
 template <typename T, int N>
 constexpr auto operator+(Vec<T, N> const &u, Vec<T, N> const &v) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float> && N == 4) {
+    if !consteval {
+      return detail::to_vec4f(_mm_add_ps(detail::load(u), detail::load(v)));
+    }
+  }
+#endif
   return Vec<T, N>{[&](int i) { return u[i] + v[i]; }};
 }
 
 template <typename T, int N>
 constexpr auto operator-(Vec<T, N> const &u, Vec<T, N> const &v) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float> && N == 4) {
+    if !consteval {
+      return detail::to_vec4f(_mm_sub_ps(detail::load(u), detail::load(v)));
+    }
+  }
+#endif
   return Vec<T, N>{[&](int i) { return u[i] - v[i]; }};
 }
 
 template <typename T, int N>
 constexpr auto operator*(T s, Vec<T, N> const &v) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float> && N == 4) {
+    if !consteval {
+      return detail::to_vec4f(_mm_mul_ps(_mm_set1_ps(s), detail::load(v)));
+    }
+  }
+#endif
   return Vec<T, N>{[&](int i) { return s * v[i]; }};
 }
 
 template <typename T, int N>
 constexpr auto operator*(Vec<T, N> const &v, T s) noexcept {
+#ifdef MARLON_MATH_SSE4_1
+  if constexpr (std::is_same_v<T, float> && N == 4) {
+    if !consteval {
+      return detail::to_vec4f(_mm_mul_ps(detail::load(v), _mm_set1_ps(s)));
+    }
+  }
+#endif
   return Vec<T, N>{[&](int i) { return v[i] * s; }};
 }
 
@@ -1,16 +1,18 @@
 #ifndef MARLON_PHYSICS_BOUNDS_TREE_H
 #define MARLON_PHYSICS_BOUNDS_TREE_H
 
+#include <algorithm>
 #include <array>
 #include <span>
 #include <utility>
 #include <variant>
 
 #include <math/aabb.h>
+#include <util/flat_set.h>
 #include <util/list.h>
 #include <util/memory.h>
+#include <util/parallel_for.h>
 #include <util/pool.h>
-#include <util/set.h>
 
 namespace marlon {
 namespace physics {
@@ -65,7 +67,7 @@ public:
                              leaf_node_capacity)),
                          leaf_node_capacity};
     _leaf_node_set =
-        util::Set<Node *>::make(allocator, leaf_node_capacity).second;
+        util::Flat_set<Node *>::make(allocator, leaf_node_capacity).second;
     _leaf_node_list =
         util::List<Node *>::make(allocator, leaf_node_capacity).second;
     _internal_nodes =
@@ -122,7 +124,107 @@ public:
     }
   }
 
+  // Calls f(payload, payload, thread_index) on the pool, so f must be safe to
+  // call from several threads at once. The traversal is split into
+  // independent subtraversals until every thread gets a few of them.
+  template <typename F>
+  void for_each_overlapping_leaf_pair(util::Thread_pool &pool, F &&f) {
+    if (_root_node == nullptr) {
+      return;
+    }
+    auto traversals = std::array<Traversal, max_parallel_traversals>{};
+    auto const traversal_count = split_traversal(
+        std::span{traversals},
+        std::min(max_parallel_traversals,
+                 util::parallel_for_chunks_per_thread * (pool.size() + 1)));
+    util::parallel_for(
+        pool,
+        std::span{traversals.data(), static_cast<std::size_t>(traversal_count)},
+        1,
+        [&](auto traversal_range, util::Size thread_index) {
+          auto const g = [&](Payload const &first, Payload const &second) {
+            f(first, second, thread_index);
+          };
+          for (auto const &traversal : traversal_range) {
+            if (traversal.right == nullptr) {
+              for_each_overlapping_leaf_pair(traversal.left, g);
+            } else {
+              for_each_overlapping_leaf_pair(
+                  traversal.left, traversal.right, g);
+            }
+          }
+        });
+  }
+
 private:
+  // Overlapping leaf pairs within left if right is nullptr, or between left
+  // and right otherwise
+  struct Traversal {
+    Node *left;
+    Node *right;
+  };
+
+  static constexpr auto max_parallel_traversals = Size{256};
+
+  static bool is_internal(Node const *node) noexcept {
+    return node->payload.index() == 0;
+  }
+
+  // Starting from the whole tree, replaces traversals with the ones they
+  // recurse into until there are at least target_count of them or they can't
+  // be split any further. Returns how many there are.
+  Size split_traversal(std::span<Traversal> traversals,
+                       Size target_count) const noexcept {
+    auto const max_count = static_cast<Size>(traversals.size());
+    traversals[0] = {_root_node, nullptr};
+    auto count = Size{1};
+    for (auto split = true; split && count < target_count;) {
+      split = false;
+      for (auto i = Size{}; i < count && count + 3 <= max_count;) {
+        auto const [left, right] = traversals[i];
+        auto children = std::array<Traversal, 4>{};
+        auto child_count = 0;
+        if (right == nullptr) {
+          if (is_internal(left)) {
+            auto const &nodes = std::get<0>(left->payload);
+            children[child_count++] = {nodes[0], nullptr};
+            children[child_count++] = {nodes[1], nullptr};
+            children[child_count++] = {nodes[0], nodes[1]};
+          }
+        } else if (overlaps(left->bounds, right->bounds)) {
+          if (!is_internal(left) && !is_internal(right)) {
+            ++i;
+            continue;
+          }
+          auto const lefts = is_internal(left)
+                                 ? std::get<0>(left->payload)
+                                 : std::array<Node *, 2>{left, nullptr};
+          auto const rights = is_internal(right)
+                                  ? std::get<0>(right->payload)
+                                  : std::array<Node *, 2>{right, nullptr};
+          for (auto const l : lefts) {
+            for (auto const r : rights) {
+              if (l != nullptr && r != nullptr) {
+                children[child_count++] = {l, r};
+              }
+            }
+          }
+        }
+        if (child_count == 0) {
+          // nothing to find, drop the traversal
+          traversals[i] = traversals[--count];
+          continue;
+        }
+        traversals[i++] = children[0];
+        for (auto j = 1; j != child_count; ++j) {
+          traversals[count++] = children[j];
+        }
+        split = true;
+      }
+    }
+    return count;
+  }
+
   // TODO: handle exceptions here. for now just marking as noexcept so that
   // exceptions instantly kill the app
   Node *build_internal_node(std::span<Node *> leaf_nodes) noexcept {
@@ -271,7 +373,7 @@ private:
   }
 
   util::Pool<Node> _leaf_node_pool;
-  util::Set<Node *> _leaf_node_set;
+  util::Flat_set<Node *> _leaf_node_set;
   util::List<Node *> _leaf_node_list;
   util::List<Node> _internal_nodes;
   Node *_root_node{};
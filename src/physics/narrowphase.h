@@ -48,67 +48,29 @@ object_object_contact(Particle_data const &first,
 std::optional<Contact>
 object_object_contact(Particle_data const &first,
                       Rigid_body_data const &second) noexcept {
-  using namespace math;
-  auto const transform =
-      Mat3x4f::rigid(second.position(), second.orientation());
-  auto const transform_inv = rigid_inverse(transform);
-  return particle_shape_contact(first.radius(),
-                                first.position(),
-                                second.shape(),
-                                transform,
-                                transform_inv);
+  return particle_shape_contact(
+      first.radius(), first.position(), second.shape(), second.transform());
 }
 
 std::optional<Contact>
 object_object_contact(Particle_data const &first,
                       Static_body_data const &second) noexcept {
-  using namespace math;
-  auto const transform =
-      Mat3x4f::rigid(second.position(), second.orientation());
-  auto const inverse_transform = rigid_inverse(transform);
-  return particle_shape_contact(first.radius(),
-                                first.position(),
-                                second.shape(),
-                                transform,
-                                inverse_transform);
+  return particle_shape_contact(
+      first.radius(), first.position(), second.shape(), second.transform());
 }
 
 std::optional<Contact>
 object_object_contact(Rigid_body_data const &first,
                       Rigid_body_data const &second) noexcept {
-  using namespace math;
-  auto const transforms =
-      std::pair{Mat3x4f::rigid(first.position(), first.orientation()),
-                Mat3x4f::rigid(second.position(), second.orientation())};
-  auto const inverse_transforms = std::pair{rigid_inverse(transforms.first),
-                                            rigid_inverse(transforms.second)};
-  return shape_shape_contact(first.shape(),
-                             transforms.first,
-                             inverse_transforms.first,
-                             second.shape(),
-                             transforms.second,
-                             inverse_transforms.second);
+  return shape_shape_contact(
+      first.shape(), first.transform(), second.shape(), second.transform());
 }
 
 std::optional<Contact>
 object_object_contact(Rigid_body_data const &first,
                       Static_body_data const &second) noexcept {
-  using namespace math;
-  auto const transforms = std::array<Mat3x4f, 2>{
-      Mat3x4f::rigid(first.position(), first.orientation()),
-      Mat3x4f::rigid(second.position(), second.orientation()),
-  };
-  auto const inverse_transforms = std::array<Mat3x4f, 2>{
-      rigid_inverse(transforms[0]),
-      rigid_inverse(transforms[1]),
-  };
-  return shape_shape_contact(first.shape(),
-                             transforms[0],
-                             inverse_transforms[0],
-                             second.shape(),
-                             transforms[1],
-                             inverse_transforms[1]);
-  return std::nullopt;
+  return shape_shape_contact(
+      first.shape(), first.transform(), second.shape(), second.transform());
 }
 } // namespace physics
 } // namespace marlon
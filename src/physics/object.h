@@ -6,16 +6,34 @@
 #include <concepts>
 #include <type_traits>
 
+#include "../util/inline_list.h"
+
 namespace marlon {
 namespace physics {
 using Object_handle = std::uint32_t;
 
 enum class Object_type : std::uint8_t { particle, rigid_body, static_body };
 
+// A handle is made of the object's type, the generation of its storage slot
+// and the slot's index, from the most to the least significant bits
 auto constexpr object_handle_type_bits = 2;
-auto constexpr object_handle_index_bits = 32 - object_handle_type_bits;
+auto constexpr object_handle_generation_bits = 8;
+auto constexpr object_handle_index_bits =
+    32 - object_handle_type_bits - object_handle_generation_bits;
 auto constexpr object_handle_index_mask =
-    std::uint32_t{0xffffffffu} >> object_handle_type_bits;
+    std::uint32_t{0xffffffffu} >> (32 - object_handle_index_bits);
+auto constexpr object_handle_generation_mask =
+    std::uint32_t{0xffffffffu} >> (32 - object_handle_generation_bits);
+
+constexpr Object_handle make_object_handle(Object_type type,
+                                           std::uint32_t index,
+                                           std::uint32_t generation) noexcept {
+  return static_cast<Object_handle>(type)
+             << (object_handle_index_bits + object_handle_generation_bits) |
+         (generation & object_handle_generation_mask)
+             << object_handle_index_bits |
+         index;
+}
 
 class Particle;
 class Rigid_body;
@@ -27,6 +45,8 @@ struct Object_integrate_info {
   float damping_factor;
   float motion_smoothing_factor;
   float motion_limit;
+  // renormalize orientations with math::fast::renormalize
+  bool fast_renormalization;
 };
 
 class Object {
@@ -38,13 +58,19 @@ public:
   constexpr Object_handle handle() const noexcept { return _handle; }
 
   constexpr Object_type type() const noexcept {
-    return static_cast<Object_type>(_handle >> object_handle_index_bits);
+    return static_cast<Object_type>(
+        _handle >> (object_handle_index_bits + object_handle_generation_bits));
   }
 
   constexpr int index() const noexcept {
     return static_cast<int>(_handle & object_handle_index_mask);
   }
 
+  constexpr std::uint32_t generation() const noexcept {
+    return (_handle >> object_handle_index_bits) &
+           object_handle_generation_mask;
+  }
+
   constexpr std::variant<Particle, Rigid_body, Static_body>
   specific() const noexcept;
 
@@ -58,15 +84,19 @@ class Particle {
 public:
   Particle() = default;
 
-  constexpr explicit Particle(int index) noexcept
-      : Particle{Object{static_cast<Object_handle>(Object_type::particle)
-                            << object_handle_index_bits |
-                        static_cast<Object_handle>(index)}} {}
+  constexpr explicit Particle(std::uint32_t index,
+                              std::uint32_t generation) noexcept
+      : Particle{Object{make_object_handle(
+            Object_type::particle, index, generation)}} {}
 
   constexpr explicit Particle(Object generic) noexcept : _generic{generic} {}
 
   constexpr int index() const noexcept { return _generic.index(); }
 
+  constexpr std::uint32_t generation() const noexcept {
+    return _generic.generation();
+  }
+
   constexpr Object generic() const noexcept { return _generic; }
 
   friend constexpr bool operator==(Particle lhs,
@@ -80,15 +110,19 @@ class Rigid_body {
 public:
   Rigid_body() = default;
 
-  constexpr explicit Rigid_body(int index) noexcept
-      : Rigid_body{Object{static_cast<Object_handle>(Object_type::rigid_body)
-                              << object_handle_index_bits |
-                          static_cast<Object_handle>(index)}} {}
+  constexpr explicit Rigid_body(std::uint32_t index,
+                                std::uint32_t generation) noexcept
+      : Rigid_body{Object{make_object_handle(
+            Object_type::rigid_body, index, generation)}} {}
 
   constexpr explicit Rigid_body(Object generic) noexcept : _generic{generic} {}
 
   constexpr Object_handle index() const noexcept { return _generic.index(); }
 
+  constexpr std::uint32_t generation() const noexcept {
+    return _generic.generation();
+  }
+
   constexpr Object generic() const noexcept { return _generic; }
 
   friend constexpr bool operator==(Rigid_body lhs,
@@ -102,15 +136,19 @@ class Static_body {
 public:
   Static_body() = default;
 
-  constexpr explicit Static_body(int index) noexcept
-      : Static_body{Object{static_cast<Object_handle>(Object_type::static_body)
-                               << object_handle_index_bits |
-                           static_cast<Object_handle>(index)}} {}
+  constexpr explicit Static_body(std::uint32_t index,
+                                 std::uint32_t generation) noexcept
+      : Static_body{Object{make_object_handle(
+            Object_type::static_body, index, generation)}} {}
 
   constexpr explicit Static_body(Object generic) noexcept : _generic{generic} {}
 
   constexpr Object_handle index() const noexcept { return _generic.index(); }
 
+  constexpr std::uint32_t generation() const noexcept {
+    return _generic.generation();
+  }
+
   constexpr Object generic() const noexcept { return _generic; }
 
   friend constexpr bool operator==(Static_body lhs,
@@ -259,6 +297,14 @@ Object::specific() const noexcept {
     return Static_body{*this};
   }
 }
+
+// Neighbors of an object are kept in its data and spill into an arena of the
+// world that is reset on every step
+auto constexpr object_inline_neighbor_count = util::Size{4};
+
+using Neighbor_list = util::Inline_list<Object, object_inline_neighbor_count>;
+
+using Neighbor_arena = util::Stack_allocator<alignof(Object)>;
 } // namespace physics
 namespace util {
 template <> struct Hash<physics::Object_pair> {
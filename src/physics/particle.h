@@ -4,14 +4,14 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <algorithm>
 #include <bitset>
 #include <functional>
 #include <span>
 
 #include "../math/vec.h"
-#include "../util/bit_list.h"
-#include "../util/lifetime_box.h"
 #include "../util/list.h"
+#include "../util/slot_map.h"
 #include "broadphase.h"
 #include "material.h"
 #include "object.h"
@@ -46,29 +46,21 @@ public:
 
   Broadphase_bvh::Node *bvh_node() noexcept { return _bvh_node; }
 
-  std::span<Object const> neighbors() const noexcept {
-    return {_neighbors, static_cast<std::size_t>(_neighbor_count)};
-  }
-
-  std::span<Object> neighbors() noexcept {
-    return {_neighbors, static_cast<std::size_t>(_neighbor_count)};
-  }
+  std::span<Object const> neighbors() const noexcept { return _neighbors; }
 
-  void reset_neighbors() noexcept {
-    _neighbors = nullptr;
-    _neighbor_count = 0;
-  }
+  std::span<Object> neighbors() noexcept { return _neighbors; }
 
-  void count_neighbor() noexcept { ++_neighbor_count; }
+  // Leaves spilled neighbors to the arena, which must be reset as well
+  void reset_neighbors() noexcept { _neighbors.reset(); }
 
-  void reserve_neighbors(util::List<Object> &neighbors) {
-    _neighbors = neighbors.data() + neighbors.size();
-    neighbors.resize(neighbors.size() + _neighbor_count);
-    _neighbor_count = 0;
+  void push_neighbor(Neighbor_arena &arena, Object neighbor) {
+    _neighbors.push_back(arena, neighbor);
   }
 
-  void push_neighbor(Object neighbor) {
-    _neighbors[_neighbor_count++] = neighbor;
+  void sort_neighbors() noexcept {
+    std::ranges::sort(_neighbors, [](Object const &a, Object const &b) {
+      return a.handle() < b.handle();
+    });
   }
 
   Particle_motion_callback *motion_callback() const noexcept {
@@ -124,7 +116,7 @@ public:
 
 private:
   Broadphase_bvh::Node *_bvh_node{};
-  Object *_neighbors{};
+  Neighbor_list _neighbors;
   Particle_motion_callback *_motion_callback{};
   math::Vec3f _position{};
   math::Vec3f _velocity{};
@@ -132,7 +124,6 @@ private:
   float _inverse_mass{};
   float _radius{};
   Material _material{};
-  int _neighbor_count{};
   std::bitset<2> _flags;
 };
 
@@ -146,8 +137,6 @@ public:
 };
 
 class Particle_storage {
-  using Allocator = util::Stack_allocator<>;
-
 public:
   template <typename Allocator>
   static std::pair<util::Block, Particle_storage>
@@ -158,75 +147,61 @@ public:
 
   static constexpr util::Size
   memory_requirement(util::Size max_particles) noexcept {
-    return Allocator::memory_requirement({
-        decltype(_data)::memory_requirement(max_particles),
-        decltype(_available_handles)::memory_requirement(max_particles),
-        decltype(_occupancy_bits)::memory_requirement(max_particles),
-    });
+    return decltype(_data)::memory_requirement(max_particles);
   }
 
-  constexpr Particle_storage() noexcept = default;
+  constexpr Particle_storage() = default;
 
   explicit Particle_storage(util::Block block,
                             util::Size max_particles) noexcept
       : Particle_storage{block.begin, max_particles} {}
 
   explicit Particle_storage(std::byte *block_begin,
-                            util::Size max_particles) noexcept {
-    auto allocator =
-        Allocator{{block_begin, memory_requirement(max_particles)}};
-    _data = decltype(_data)::make(allocator, max_particles).second;
-    _data.resize(max_particles);
-    _available_handles =
-        decltype(_available_handles)::make(allocator, max_particles).second;
-    _available_handles.resize(max_particles);
-    for (auto i = util::Size{}; i != max_particles; ++i) {
-      _available_handles[i] = Particle{static_cast<int>(max_particles - i - 1)};
-    }
-    _occupancy_bits = util::Bit_list::make(allocator, max_particles).second;
-    _occupancy_bits.resize(max_particles);
-  }
+                            util::Size max_particles) noexcept
+      : _data{block_begin, max_particles} {}
 
   template <typename... Args> Particle create(Args &&...args) {
-    if (_available_handles.empty()) {
+    if (_data.size() == _data.max_size()) {
       throw util::Capacity_error{"Capacity_error in Particle_storage::create"};
     }
-    auto const result = _available_handles.back();
-    _available_handles.pop_back();
-    _data[result.index()].construct(std::forward<Args>(args)...);
-    _occupancy_bits.set(result.index());
-    return result;
+    auto const handle = _data.emplace(std::forward<Args>(args)...);
+    return Particle{handle.index, handle.generation};
   }
 
-  void destroy(Particle particle) {
-    _available_handles.emplace_back(particle);
-    _occupancy_bits.reset(particle.index());
+  // The object must be contained
+  void destroy(Particle particle) noexcept { _data.erase(handle(particle)); }
+
+  // False once the object is destroyed
+  bool contains(Particle particle) const noexcept {
+    return _data.contains(handle(particle));
   }
 
+  // nullptr if the object was destroyed
   Particle_data const *data(Particle particle) const noexcept {
-    return _data[particle.index()].get();
+    return _data.find(handle(particle));
   }
 
+  // nullptr if the object was destroyed
   Particle_data *data(Particle particle) noexcept {
-    return _data[particle.index()].get();
+    return _data.find(handle(particle));
   }
 
+  // Visits live objects only
   template <typename F> void for_each(F &&f) {
-    auto const n = _data.size();
-    auto const m = _data.size() - _available_handles.size();
-    auto k = util::Size{};
-    for (auto i = util::Size{}; i != n && k != m; ++i) {
-      if (_occupancy_bits.get(i)) {
-        f(Particle{static_cast<int>(i)});
-        ++k;
-      }
+    for (auto const handle : _data.handles()) {
+      f(Particle{handle.index, handle.generation});
     }
   }
 
 private:
-  util::List<util::Lifetime_box<Particle_data>> _data;
-  util::List<Particle> _available_handles;
-  util::Bit_list _occupancy_bits;
+  static util::Slot_map_handle handle(Particle particle) noexcept {
+    return {
+        .index = static_cast<std::uint32_t>(particle.index()),
+        .generation = particle.generation(),
+    };
+  }
+
+  util::Slot_map<Particle_data, object_handle_generation_bits> _data;
 };
 } // namespace physics
 } // namespace marlon
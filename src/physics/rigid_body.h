@@ -1,12 +1,14 @@
 #ifndef MARLON_PHYSICS_RIGID_BODY_H
 #define MARLON_PHYSICS_RIGID_BODY_H
 
+#include <cstdint>
+
+#include <algorithm>
 #include <bitset>
 
 #include "../math/math.h"
-#include "../util/bit_list.h"
-#include "../util/lifetime_box.h"
 #include "../util/list.h"
+#include "../util/slot_map.h"
 #include "broadphase.h"
 #include "material.h"
 #include "object.h"
@@ -48,29 +50,21 @@ public:
 
   Broadphase_bvh::Node *bvh_node() noexcept { return _bvh_node; }
 
-  std::span<Object const> neighbors() const noexcept {
-    return {_neighbors, static_cast<std::size_t>(_neighbor_count)};
-  }
+  std::span<Object const> neighbors() const noexcept { return _neighbors; }
 
-  std::span<Object> neighbors() noexcept {
-    return {_neighbors, static_cast<std::size_t>(_neighbor_count)};
-  }
-
-  void reset_neighbors() noexcept {
-    _neighbors = nullptr;
-    _neighbor_count = 0;
-  }
+  std::span<Object> neighbors() noexcept { return _neighbors; }
 
-  void count_neighbor() noexcept { ++_neighbor_count; }
+  // Leaves spilled neighbors to the arena, which must be reset as well
+  void reset_neighbors() noexcept { _neighbors.reset(); }
 
-  void reserve_neighbors(util::List<Object> &neighbors) {
-    _neighbors = neighbors.data() + neighbors.size();
-    neighbors.resize(neighbors.size() + _neighbor_count);
-    _neighbor_count = 0;
+  void push_neighbor(Neighbor_arena &arena, Object neighbor) {
+    _neighbors.push_back(arena, neighbor);
   }
 
-  void push_neighbor(Object neighbor) noexcept {
-    _neighbors[_neighbor_count++] = neighbor;
+  void sort_neighbors() noexcept {
+    std::ranges::sort(_neighbors, [](Object const &a, Object const &b) {
+      return a.handle() < b.handle();
+    });
   }
 
   Rigid_body_motion_callback *motion_callback() const noexcept {
@@ -91,6 +85,10 @@ public:
     _orientation = orientation;
   }
 
+  math::Rigid_transform transform() const noexcept {
+    return {.position = _position, .orientation = _orientation};
+  }
+
   math::Vec3f const &angular_velocity() const noexcept {
     return _angular_velocity;
   }
@@ -141,7 +139,8 @@ public:
     _angular_velocity *= info.damping_factor;
     _orientation +=
         Quatf{0.0f, 0.5f * info.delta_time * _angular_velocity} * _orientation;
-    _orientation = normalize(_orientation);
+    _orientation = info.fast_renormalization ? fast::renormalize(_orientation)
+                                             : normalize(_orientation);
     _motion = min(
         (1.0f - info.motion_smoothing_factor) * _motion +
             info.motion_smoothing_factor *
@@ -151,7 +150,7 @@ public:
 
 private:
   Broadphase_bvh::Node *_bvh_node{};
-  Object *_neighbors{};
+  Neighbor_list _neighbors;
   Rigid_body_motion_callback *_motion_callback{};
   math::Vec3f _position{};
   math::Vec3f _velocity{};
@@ -162,7 +161,6 @@ private:
   math::Mat3x3f _inverse_inertia_tensor{};
   Shape _shape;
   Material _material{};
-  int _neighbor_count{};
   std::bitset<2> _flags;
 
   // bool visited() const noexcept { return flags[2]; }
@@ -181,8 +179,6 @@ public:
 };
 
 class Rigid_body_storage {
-  using Allocator = util::Stack_allocator<>;
-
 public:
   template <typename Allocator>
   static std::pair<util::Block, Rigid_body_storage>
@@ -193,11 +189,7 @@ public:
 
   static constexpr util::Size
   memory_requirement(util::Size max_rigid_bodies) noexcept {
-    return Allocator::memory_requirement({
-        decltype(_data)::memory_requirement(max_rigid_bodies),
-        decltype(_available_handles)::memory_requirement(max_rigid_bodies),
-        decltype(_occupancy_bits)::memory_requirement(max_rigid_bodies),
-    });
+    return decltype(_data)::memory_requirement(max_rigid_bodies);
   }
 
   constexpr Rigid_body_storage() = default;
@@ -207,63 +199,54 @@ public:
       : Rigid_body_storage{block.begin, max_rigid_bodies} {}
 
   explicit Rigid_body_storage(std::byte *block_begin,
-                              util::Size max_rigid_bodies) noexcept {
-    auto allocator =
-        Allocator{{block_begin, memory_requirement(max_rigid_bodies)}};
-    _data = decltype(_data)::make(allocator, max_rigid_bodies).second;
-    _data.resize(max_rigid_bodies);
-    _available_handles =
-        decltype(_available_handles)::make(allocator, max_rigid_bodies).second;
-    _available_handles.resize(max_rigid_bodies);
-    for (auto i = util::Size{}; i != max_rigid_bodies; ++i) {
-      _available_handles[i] =
-          Rigid_body{static_cast<int>(max_rigid_bodies - i - 1)};
-    }
-    _occupancy_bits = util::Bit_list::make(allocator, max_rigid_bodies).second;
-    _occupancy_bits.resize(max_rigid_bodies);
-  }
+                              util::Size max_rigid_bodies) noexcept
+      : _data{block_begin, max_rigid_bodies} {}
 
   template <typename... Args> Rigid_body create(Args &&...args) {
-    if (_available_handles.empty()) {
+    if (_data.size() == _data.max_size()) {
       throw util::Capacity_error{
           "Capacity_error in Rigid_body_storage::create"};
     }
-    auto const result = _available_handles.back();
-    _available_handles.pop_back();
-    _data[result.index()].construct(std::forward<Args>(args)...);
-    _occupancy_bits.set(result.index());
-    return result;
+    auto const handle = _data.emplace(std::forward<Args>(args)...);
+    return Rigid_body{handle.index, handle.generation};
   }
 
-  void destroy(Rigid_body rigid_body) {
-    _available_handles.emplace_back(rigid_body);
-    _occupancy_bits.reset(rigid_body.index());
+  // The object must be contained
+  void destroy(Rigid_body rigid_body) noexcept {
+    _data.erase(handle(rigid_body));
   }
 
+  // False once the object is destroyed
+  bool contains(Rigid_body rigid_body) const noexcept {
+    return _data.contains(handle(rigid_body));
+  }
+
+  // nullptr if the object was destroyed
   Rigid_body_data const *data(Rigid_body rigid_body) const noexcept {
-    return _data[rigid_body.index()].get();
+    return _data.find(handle(rigid_body));
   }
 
+  // nullptr if the object was destroyed
   Rigid_body_data *data(Rigid_body rigid_body) noexcept {
-    return _data[rigid_body.index()].get();
+    return _data.find(handle(rigid_body));
   }
 
+  // Visits live objects only
   template <typename F> void for_each(F &&f) {
-    auto const n = _data.size();
-    auto const m = _data.size() - _available_handles.size();
-    auto k = util::Size{};
-    for (auto i = util::Size{}; i != n && k != m; ++i) {
-      if (_occupancy_bits.get(i)) {
-        f(Rigid_body{static_cast<int>(i)});
-        ++k;
-      }
+    for (auto const handle : _data.handles()) {
+      f(Rigid_body{handle.index, handle.generation});
     }
   }
 
 private:
-  util::List<util::Lifetime_box<Rigid_body_data>> _data;
-  util::List<Rigid_body> _available_handles;
-  util::Bit_list _occupancy_bits;
+  static util::Slot_map_handle handle(Rigid_body rigid_body) noexcept {
+    return {
+        .index = static_cast<std::uint32_t>(rigid_body.index()),
+        .generation = rigid_body.generation(),
+    };
+  }
+
+  util::Slot_map<Rigid_body_data, object_handle_generation_bits> _data;
 };
 } // namespace physics
 } // namespace marlon
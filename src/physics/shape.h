@@ -35,6 +35,12 @@ public:
 
   Shape(Box const &box) noexcept : _v{box} {}
 
+  // The T the shape holds, or null if it holds another kind of shape
+  template <typename T>
+  friend T const *get_if(Shape const &shape) noexcept {
+    return std::get_if<T>(&shape._v);
+  }
+
   friend math::Aabb3f bounds(Shape const &shape,
                              math::Mat3x4f const &transform) noexcept;
 
@@ -42,16 +48,13 @@ public:
   particle_shape_contact(float particle_radius,
                          math::Vec3f const &particle_position,
                          Shape const &shape,
-                         math::Mat3x4f const &shape_transform,
-                         math::Mat3x4f const &shape_transform_inv) noexcept;
+                         math::Rigid_transform const &shape_transform) noexcept;
 
   friend std::optional<Contact>
   shape_shape_contact(Shape const &shape_a,
-                      math::Mat3x4f const &transform_a,
-                      math::Mat3x4f const &transform_a_inv,
+                      math::Rigid_transform const &transform_a,
                       Shape const &shape_b,
-                      math::Mat3x4f const &transform_b,
-                      math::Mat3x4f const &transform_b_inv) noexcept;
+                      math::Rigid_transform const &transform_b) noexcept;
 
 private:
   std::variant<Ball, Capsule, Box> _v;
@@ -187,10 +190,9 @@ inline std::optional<Contact>
 particle_shape_contact(float particle_radius,
                        math::Vec3f const &particle_position,
                        Ball const &ball,
-                       math::Mat3x4f const &ball_transform,
-                       math::Mat3x4f const &ball_transform_inv) noexcept {
+                       math::Rigid_transform const &ball_transform) noexcept {
   using namespace math;
-  auto const ball_position = column(ball_transform, 3);
+  auto const ball_position = ball_transform.position;
   auto const displacement = particle_position - ball_position;
   auto const distance2 = length_squared(displacement);
   auto const contact_distance = ball.radius + particle_radius;
@@ -200,7 +202,7 @@ particle_shape_contact(float particle_radius,
     auto const normal = displacement / distance;
     auto const ball_relative_position = min(ball.radius, distance) * normal;
     auto const ball_local_position =
-        ball_transform_inv * Vec4f{ball_relative_position, 0.0f};
+        inverse_transform_direction(ball_transform, ball_relative_position);
     auto const position = ball_position + ball_relative_position;
     auto const particle_local_position = particle_position - position;
     return Contact{
@@ -217,8 +219,7 @@ inline std::optional<Contact> particle_shape_contact(
     float /*particle_radius*/,
     math::Vec3f const & /*particle_position*/,
     Capsule const & /*capsule*/,
-    math::Mat3x4f const & /*capsule_transform*/,
-    math::Mat3x4f const & /*capsule_transform_inv*/) noexcept {
+    math::Rigid_transform const & /*capsule_transform*/) noexcept {
   return std::nullopt;
 }
 
@@ -226,11 +227,10 @@ inline std::optional<Contact>
 particle_shape_contact(float particle_radius,
                        math::Vec3f const &particle_position,
                        Box const &box,
-                       math::Mat3x4f const &box_transform,
-                       math::Mat3x4f const &box_transform_inverse) noexcept {
+                       math::Rigid_transform const &box_transform) noexcept {
   using namespace math;
   auto const box_local_particle_position =
-      box_transform_inverse * Vec4f{particle_position, 1.0f};
+      inverse_transform_point(box_transform, particle_position);
   if (abs(box_local_particle_position.x) - particle_radius >
           box.half_extents[0] ||
       abs(box_local_particle_position.y) - particle_radius >
@@ -250,7 +250,7 @@ particle_shape_contact(float particle_radius,
   } else if (distance_squared != 0.0f) {
     auto const distance = sqrt(distance_squared);
     auto const position =
-        box_transform * Vec4f{box_local_clamped_particle_position, 1.0f};
+        transform_point(box_transform, box_local_clamped_particle_position);
     auto const particle_local_position = position - particle_position;
     auto const normal = -particle_local_position / distance;
     auto const separation = distance - particle_radius;
@@ -273,12 +273,12 @@ particle_shape_contact(float particle_radius,
         std::min_element(face_distances.begin(), face_distances.end()) -
         face_distances.begin();
     auto const face_normals = std::array<Vec3f, 6>{
-        -column(box_transform, 0),
-        column(box_transform, 0),
-        -column(box_transform, 1),
-        column(box_transform, 1),
-        -column(box_transform, 2),
-        column(box_transform, 2),
+        -transform_direction(box_transform, Vec3f::x_axis()),
+        transform_direction(box_transform, Vec3f::x_axis()),
+        -transform_direction(box_transform, Vec3f::y_axis()),
+        transform_direction(box_transform, Vec3f::y_axis()),
+        -transform_direction(box_transform, Vec3f::z_axis()),
+        transform_direction(box_transform, Vec3f::z_axis()),
     };
     // auto const position =
     //     box_transform * Vec4f{box_local_clamped_particle_position, 1.0f};
@@ -297,29 +297,25 @@ inline std::optional<Contact>
 particle_shape_contact(float particle_radius,
                        math::Vec3f const &particle_position,
                        Shape const &shape,
-                       math::Mat3x4f const &shape_transform,
-                       math::Mat3x4f const &shape_transform_inv) noexcept {
+                       math::Rigid_transform const &shape_transform) noexcept {
   return std::visit(
       [&](auto &&arg) {
         return particle_shape_contact(particle_radius,
                                       particle_position,
                                       arg,
-                                      shape_transform,
-                                      shape_transform_inv);
+                                      shape_transform);
       },
       shape._v);
 }
 
 inline std::optional<Contact>
 shape_shape_contact(Ball const &b1,
-                    math::Mat3x4f const &b1_transform,
-                    math::Mat3x4f const &b1_transform_inv,
+                    math::Rigid_transform const &b1_transform,
                     Ball const &b2,
-                    math::Mat3x4f const &b2_transform,
-                    math::Mat3x4f const &b2_transform_inv) {
+                    math::Rigid_transform const &b2_transform) {
   using namespace math;
-  auto const b1_position = column(b1_transform, 3);
-  auto const b2_position = column(b2_transform, 3);
+  auto const b1_position = b1_transform.position;
+  auto const b2_position = b2_transform.position;
   auto const displacement = b1_position - b2_position;
   auto const distance_squared = length_squared(displacement);
   auto const contact_distance = b1.radius + b2.radius;
@@ -334,9 +330,9 @@ shape_shape_contact(Ball const &b1,
     auto const b1_relative_position = position - b1_position;
     auto const b2_relative_position = position - b2_position;
     auto const b1_local_position =
-        b1_transform_inv * Vec4f{b1_relative_position, 0.0f};
+        inverse_transform_direction(b1_transform, b1_relative_position);
     auto const b2_local_position =
-        b2_transform_inv * Vec4f{b2_relative_position, 0.0f};
+        inverse_transform_direction(b2_transform, b2_relative_position);
     return Contact{
         .normal = normal,
         .local_positions = {b1_local_position, b2_local_position},
@@ -351,27 +347,23 @@ shape_shape_contact(Ball const &b1,
   }
 }
 
-inline std::optional<Contact>
-shape_shape_contact(Ball const & /*ball*/,
-                    math::Mat3x4f const & /*ball_transform*/,
-                    math::Mat3x4f const & /*ball_transform_inv*/,
-                    Capsule const & /*capsule*/,
-                    math::Mat3x4f const & /*capsule_transform*/,
-                    math::Mat3x4f const & /*capsule_transform_inv*/) noexcept {
+inline std::optional<Contact> shape_shape_contact(
+    Ball const & /*ball*/,
+    math::Rigid_transform const & /*ball_transform*/,
+    Capsule const & /*capsule*/,
+    math::Rigid_transform const & /*capsule_transform*/) noexcept {
   return std::nullopt;
 }
 
 inline std::optional<Contact>
 shape_shape_contact(Ball const &ball,
-                    math::Mat3x4f const &ball_transform,
-                    math::Mat3x4f const &ball_transform_inv,
+                    math::Rigid_transform const &ball_transform,
                     Box const &box,
-                    math::Mat3x4f const &box_transform,
-                    math::Mat3x4f const &box_transform_inv) {
+                    math::Rigid_transform const &box_transform) {
   using namespace math;
-  auto const ball_position = column(ball_transform, 3);
+  auto const ball_position = ball_transform.position;
   auto const box_local_ball_position =
-      box_transform_inv * Vec4f{ball_position, 1.0f};
+      inverse_transform_point(box_transform, ball_position);
   if (abs(box_local_ball_position.x) - ball.radius > box.half_extents[0] ||
       abs(box_local_ball_position.y) - ball.radius > box.half_extents[1] ||
       abs(box_local_ball_position.z) - ball.radius > box.half_extents[2]) {
@@ -386,8 +378,9 @@ shape_shape_contact(Ball const &ball,
     return std::nullopt;
   } else if (distance2 != 0.0f) {
     auto const position =
-        box_transform * Vec4f{box_local_clamped_ball_position, 1.0f};
-    auto const ball_local_position = ball_transform_inv * Vec4f{position, 1.0f};
+        transform_point(box_transform, box_local_clamped_ball_position);
+    auto const ball_local_position =
+        inverse_transform_point(ball_transform, position);
     auto const distance = sqrt(distance2);
     auto const normal = (ball_position - position) / distance;
     return Contact{
@@ -402,11 +395,10 @@ shape_shape_contact(Ball const &ball,
                           ? 0
                       : distances.y <= distances.z ? 1
                                                    : 2;
+    auto const box_axis = Vec3f{[&](int i) { return i == axis ? 1.0f : 0.0f; }};
     auto const normal =
         (std::signbit(box_local_ball_position[axis]) ? -1.0f : 1.0f) *
-        Vec3f{box_transform[0][axis],
-              box_transform[1][axis],
-              box_transform[2][axis]};
+        transform_direction(box_transform, box_axis);
     return Contact{
         .normal = normal,
         .local_positions = {Vec3f::zero(), box_local_ball_position},
@@ -417,17 +409,13 @@ shape_shape_contact(Ball const &ball,
 
 inline std::optional<Contact>
 shape_shape_contact(Capsule const &capsule,
-                    math::Mat3x4f const &capsule_transform,
-                    math::Mat3x4f const &capsule_transform_inv,
+                    math::Rigid_transform const &capsule_transform,
                     Ball const &ball,
-                    math::Mat3x4f const &ball_transform,
-                    math::Mat3x4f const &ball_transform_inv) noexcept {
+                    math::Rigid_transform const &ball_transform) noexcept {
   auto result = shape_shape_contact(ball,
                                     ball_transform,
-                                    ball_transform_inv,
                                     capsule,
-                                    capsule_transform,
-                                    capsule_transform_inv);
+                                    capsule_transform);
   if (result) {
     result->normal = -result->normal;
     std::swap(result->local_positions[0], result->local_positions[1]);
@@ -437,37 +425,29 @@ shape_shape_contact(Capsule const &capsule,
 
 inline std::optional<Contact>
 shape_shape_contact(Capsule const & /*c1*/,
-                    math::Mat3x4f const & /*c1_transform*/,
-                    math::Mat3x4f const & /*c1_transform_inv*/,
+                    math::Rigid_transform const & /*c1_transform*/,
                     Capsule const & /*c2*/,
-                    math::Mat3x4f const & /*c2_transform*/,
-                    math::Mat3x4f const & /*c2_transform_inv*/) noexcept {
+                    math::Rigid_transform const & /*c2_transform*/) noexcept {
   return std::nullopt;
 }
 
 inline std::optional<Contact>
 shape_shape_contact(Capsule const & /*capsule*/,
-                    math::Mat3x4f const & /*capsule_transform*/,
-                    math::Mat3x4f const & /*capsule_transform_inv*/,
+                    math::Rigid_transform const & /*capsule_transform*/,
                     Box const & /*box*/,
-                    math::Mat3x4f const & /*box_transform*/,
-                    math::Mat3x4f const & /*box_transform_inv*/) noexcept {
+                    math::Rigid_transform const & /*box_transform*/) noexcept {
   return std::nullopt;
 }
 
 inline std::optional<Contact>
 shape_shape_contact(Box const &box,
-                    math::Mat3x4f const &box_transform,
-                    math::Mat3x4f const &box_transform_inv,
+                    math::Rigid_transform const &box_transform,
                     Ball const &ball,
-                    math::Mat3x4f const &ball_transform,
-                    math::Mat3x4f const &ball_transform_inv) noexcept {
+                    math::Rigid_transform const &ball_transform) noexcept {
   auto result = shape_shape_contact(ball,
                                     ball_transform,
-                                    ball_transform_inv,
                                     box,
-                                    box_transform,
-                                    box_transform_inv);
+                                    box_transform);
   if (result) {
     result->normal = -result->normal;
     std::swap(result->local_positions[0], result->local_positions[1]);
@@ -477,17 +457,13 @@ shape_shape_contact(Box const &box,
 
 inline std::optional<Contact>
 shape_shape_contact(Box const &box,
-                    math::Mat3x4f const &box_transform,
-                    math::Mat3x4f const &box_transform_inv,
+                    math::Rigid_transform const &box_transform,
                     Capsule const &capsule,
-                    math::Mat3x4f const &capsule_transform,
-                    math::Mat3x4f const &capsule_transform_inv) noexcept {
+                    math::Rigid_transform const &capsule_transform) noexcept {
   auto result = shape_shape_contact(capsule,
                                     capsule_transform,
-                                    capsule_transform_inv,
                                     box,
-                                    box_transform,
-                                    box_transform_inv);
+                                    box_transform);
   if (result) {
     result->normal = -result->normal;
     std::swap(result->local_positions[0], result->local_positions[1]);
@@ -497,12 +473,13 @@ shape_shape_contact(Box const &box,
 
 inline std::optional<Contact>
 shape_shape_contact(Box const &b1,
-                    math::Mat3x4f const &b1_transform,
-                    math::Mat3x4f const &b1_transform_inv,
+                    math::Rigid_transform const &b1_transform,
                     Box const &b2,
-                    math::Mat3x4f const &b2_transform,
-                    math::Mat3x4f const &b2_transform_inv) {
+                    math::Rigid_transform const &b2_transform) {
   using namespace math;
+  // The separating axis test reads all the box axes, take them from matrices
+  auto const b1_matrix = to_mat3x4f(b1_transform);
+  auto const b2_matrix = to_mat3x4f(b2_transform);
   auto const project_to_axis =
       [](Box const &b, Mat3x4f const &m, Vec3f const &v) {
         return b.half_extents[0] * abs(dot(v, column(m, 0))) +
@@ -510,10 +487,10 @@ shape_shape_contact(Box const &b1,
                b.half_extents[2] * abs(dot(v, column(m, 2)));
       };
   auto const center_displacement =
-      column(b1_transform, 3) - column(b2_transform, 3);
+      b1_transform.position - b2_transform.position;
   auto const separation_on_axis = [&](Vec3f const &v) {
-    auto const b1_projection = project_to_axis(b1, b1_transform, v);
-    auto const b2_projection = project_to_axis(b2, b2_transform, v);
+    auto const b1_projection = project_to_axis(b1, b1_matrix, v);
+    auto const b2_projection = project_to_axis(b2, b2_matrix, v);
     auto const distance = abs(dot(center_displacement, v));
     return distance - (b1_projection + b2_projection);
   };
@@ -548,21 +525,21 @@ shape_shape_contact(Box const &b1,
     }
   };
   auto separating_axes = std::array<Vec3f, 15>{
-      column(b1_transform, 0),
-      column(b1_transform, 1),
-      column(b1_transform, 2),
-      column(b2_transform, 0),
-      column(b2_transform, 1),
-      column(b2_transform, 2),
-      cross(column(b1_transform, 0), column(b2_transform, 0)),
-      cross(column(b1_transform, 0), column(b2_transform, 1)),
-      cross(column(b1_transform, 0), column(b2_transform, 2)),
-      cross(column(b1_transform, 1), column(b2_transform, 0)),
-      cross(column(b1_transform, 1), column(b2_transform, 1)),
-      cross(column(b1_transform, 1), column(b2_transform, 2)),
-      cross(column(b1_transform, 2), column(b2_transform, 0)),
-      cross(column(b1_transform, 2), column(b2_transform, 1)),
-      cross(column(b1_transform, 2), column(b2_transform, 2)),
+      column(b1_matrix, 0),
+      column(b1_matrix, 1),
+      column(b1_matrix, 2),
+      column(b2_matrix, 0),
+      column(b2_matrix, 1),
+      column(b2_matrix, 2),
+      cross(column(b1_matrix, 0), column(b2_matrix, 0)),
+      cross(column(b1_matrix, 0), column(b2_matrix, 1)),
+      cross(column(b1_matrix, 0), column(b2_matrix, 2)),
+      cross(column(b1_matrix, 1), column(b2_matrix, 0)),
+      cross(column(b1_matrix, 1), column(b2_matrix, 1)),
+      cross(column(b1_matrix, 1), column(b2_matrix, 2)),
+      cross(column(b1_matrix, 2), column(b2_matrix, 0)),
+      cross(column(b1_matrix, 2), column(b2_matrix, 1)),
+      cross(column(b1_matrix, 2), column(b2_matrix, 2)),
   };
   auto best_separation = -std::numeric_limits<float>::max();
   auto best_separating_axis_index = -1;
@@ -608,8 +585,9 @@ shape_shape_contact(Box const &b1,
                                                       : -b2.half_extents[1],
               dot(separating_axes[5], normal) >= 0.0f ? b2.half_extents[2]
                                                       : -b2.half_extents[2]};
-    auto const position = b2_transform * Vec4f{b2_local_position, 1.0f};
-    auto const b1_local_position = b1_transform_inv * Vec4f{position, 1.0f};
+    auto const position = b2_matrix * Vec4f{b2_local_position, 1.0f};
+    auto const b1_local_position =
+        inverse_transform_point(b1_transform, position);
     return Contact{
         .normal = normal,
         .local_positions = {b1_local_position, b2_local_position},
@@ -626,8 +604,9 @@ shape_shape_contact(Box const &b1,
                                                       : b1.half_extents[1],
               dot(separating_axes[2], normal) >= 0.0f ? -b1.half_extents[2]
                                                       : b1.half_extents[2]};
-    auto const position = b1_transform * Vec4f{b1_local_position, 1.0f};
-    auto const b2_local_position = b2_transform_inv * Vec4f{position, 1.0f};
+    auto const position = b1_matrix * Vec4f{b1_local_position, 1.0f};
+    auto const b2_local_position =
+        inverse_transform_point(b2_transform, position);
     return Contact{
         .normal = normal,
         .local_positions = {b1_local_position, b2_local_position},
@@ -641,7 +620,7 @@ shape_shape_contact(Box const &b1,
     auto const b1_extents =
         Vec3f{b1.half_extents[0], b1.half_extents[1], b1.half_extents[2]};
     auto const on_b1_edge =
-        b1_transform *
+        b1_matrix *
         Vec4f{Vec3f{[&](int axis_index) {
                 if (axis_index == b1_axis_index) {
                   return 0.0f;
@@ -655,7 +634,7 @@ shape_shape_contact(Box const &b1,
     auto const b2_extents =
         Vec3f{b2.half_extents[0], b2.half_extents[1], b2.half_extents[2]};
     auto const on_b2_edge =
-        b2_transform *
+        b2_matrix *
         Vec4f{Vec3f{[&](int axis_index) {
                 if (axis_index == b2_axis_index) {
                   return 0.0f;
@@ -674,8 +653,10 @@ shape_shape_contact(Box const &b1,
                                    separating_axes[b2_axis_index + 3],
                                    b2_extents[b2_axis_index],
                                    best_basis_separating_axis_index >= 3);
-    auto const b1_local_position = b1_transform_inv * Vec4f{position, 1.0f};
-    auto const b2_local_position = b2_transform_inv * Vec4f{position, 1.0f};
+    auto const b1_local_position =
+        inverse_transform_point(b1_transform, position);
+    auto const b2_local_position =
+        inverse_transform_point(b2_transform, position);
     return Contact{
         .normal = normal,
         .local_positions = {b1_local_position, b2_local_position},
@@ -686,21 +667,17 @@ shape_shape_contact(Box const &b1,
 
 inline std::optional<Contact>
 shape_shape_contact(Shape const &shape_a,
-                    math::Mat3x4f const &transform_a,
-                    math::Mat3x4f const &transform_a_inv,
+                    math::Rigid_transform const &transform_a,
                     Shape const &shape_b,
-                    math::Mat3x4f const &transform_b,
-                    math::Mat3x4f const &transform_b_inv) noexcept {
+                    math::Rigid_transform const &transform_b) noexcept {
   return std::visit(
       [&](auto &&a) {
         return std::visit(
             [&](auto &&b) {
               return shape_shape_contact(a,
                                          transform_a,
-                                         transform_a_inv,
                                          b,
-                                         transform_b,
-                                         transform_b_inv);
+                                         transform_b);
             },
             shape_b._v);
       },
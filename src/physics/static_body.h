@@ -1,9 +1,12 @@
 #ifndef MARLON_PHYSICS_STATIC_BODY_H
 #define MARLON_PHYSICS_STATIC_BODY_H
 
+#include <cstdint>
+
 #include <bitset>
 
 #include "../math/math.h"
+#include "../util/slot_map.h"
 #include "material.h"
 #include "object.h"
 #include "shape.h"
@@ -31,6 +34,10 @@ public:
 
   math::Quatf const &orientation() const noexcept { return _orientation; }
 
+  math::Rigid_transform transform() const noexcept {
+    return {.position = _position, .orientation = _orientation};
+  }
+
   Shape const &shape() const noexcept { return _shape; }
 
   Material const &material() const noexcept { return _material; }
@@ -44,8 +51,6 @@ private:
 };
 
 class Static_body_storage {
-  using Allocator = util::Stack_allocator<>;
-
 public:
   template <typename Allocator>
   static std::pair<util::Block, Static_body_storage>
@@ -56,11 +61,7 @@ public:
 
   static constexpr util::Size
   memory_requirement(util::Size max_static_bodies) noexcept {
-    return Allocator::memory_requirement({
-        decltype(_data)::memory_requirement(max_static_bodies),
-        decltype(_available_handles)::memory_requirement(max_static_bodies),
-        decltype(_occupancy_bits)::memory_requirement(max_static_bodies),
-    });
+    return decltype(_data)::memory_requirement(max_static_bodies);
   }
 
   constexpr Static_body_storage() = default;
@@ -70,62 +71,53 @@ public:
       : Static_body_storage{block.begin, max_static_bodies} {}
 
   explicit Static_body_storage(std::byte *block_begin,
-                               util::Size max_static_bodies) noexcept {
-    auto allocator =
-        Allocator{{block_begin, memory_requirement(max_static_bodies)}};
-    _data = decltype(_data)::make(allocator, max_static_bodies).second;
-    _data.resize(max_static_bodies);
-    _available_handles =
-        decltype(_available_handles)::make(allocator, max_static_bodies).second;
-    _available_handles.resize(max_static_bodies);
-    for (auto i = util::Size{}; i != max_static_bodies; ++i) {
-      _available_handles[i] =
-          Static_body{static_cast<int>(max_static_bodies - i - 1)};
-    }
-    _occupancy_bits = util::Bit_list::make(allocator, max_static_bodies).second;
-    _occupancy_bits.resize(max_static_bodies);
-  }
+                               util::Size max_static_bodies) noexcept
+      : _data{block_begin, max_static_bodies} {}
 
   template <typename... Args> Static_body create(Args &&...args) {
-    if (_available_handles.empty()) {
+    if (_data.size() == _data.max_size()) {
       throw util::Capacity_error{"Out of space for static rigid bodies"};
     }
-    auto const result = _available_handles.back();
-    _available_handles.pop_back();
-    _data[result.index()].construct(std::forward<Args>(args)...);
-    _occupancy_bits.set(result.index());
-    return result;
+    auto const handle = _data.emplace(std::forward<Args>(args)...);
+    return Static_body{handle.index, handle.generation};
+  }
+
+  // The object must be contained
+  void destroy(Static_body static_body) noexcept {
+    _data.erase(handle(static_body));
   }
 
-  void destroy(Static_body static_body) {
-    _available_handles.emplace_back(static_body);
-    _occupancy_bits.reset(static_body.index());
+  // False once the object is destroyed
+  bool contains(Static_body static_body) const noexcept {
+    return _data.contains(handle(static_body));
   }
 
+  // nullptr if the object was destroyed
   Static_body_data const *data(Static_body static_body) const noexcept {
-    return _data[static_body.index()].get();
+    return _data.find(handle(static_body));
   }
 
+  // nullptr if the object was destroyed
   Static_body_data *data(Static_body static_body) noexcept {
-    return _data[static_body.index()].get();
+    return _data.find(handle(static_body));
   }
 
+  // Visits live objects only
   template <typename F> void for_each(F &&f) {
-    auto const n = _occupancy_bits.size();
-    auto const m = _occupancy_bits.size() - _free_indices.size();
-    auto k = util::Size{};
-    for (auto i = util::Size{}; i != n && k != m; ++i) {
-      if (_occupancy_bits[i]) {
-        f(Static_body{i});
-        ++k;
-      }
+    for (auto const handle : _data.handles()) {
+      f(Static_body{handle.index, handle.generation});
     }
   }
 
 private:
-  util::List<util::Lifetime_box<Static_body_data>> _data;
-  util::List<Static_body> _available_handles;
-  util::Bit_list _occupancy_bits;
+  static util::Slot_map_handle handle(Static_body static_body) noexcept {
+    return {
+        .index = static_cast<std::uint32_t>(static_body.index()),
+        .generation = static_body.generation(),
+    };
+  }
+
+  util::Slot_map<Static_body_data, object_handle_generation_bits> _data;
 };
 } // namespace physics
 } // namespace marlon
@@ -4,13 +4,19 @@
 
 #include <chrono>
 #include <iostream>
-#include <latch>
+#include <limits>
+#include <stdexcept>
 
+#include "../math/fast.h"
 #include "../math/scalar.h"
 #include "../util/bit_list.h"
+#include "../util/concurrent_map.h"
+#include "../util/cpu_topology.h"
 #include "../util/lifetime_box.h"
 #include "../util/list.h"
-#include "../util/map.h"
+#include "../util/parallel_for.h"
+#include "../util/task_graph.h"
+#include "../util/tracking_allocator.h"
 #include "broadphase.h"
 #include "contact.h"
 #include "narrowphase.h"
@@ -20,6 +26,26 @@ namespace physics {
 using namespace math;
 using namespace util;
 namespace {
+constinit auto world_allocation_tag = Allocation_tag{"physics::World"};
+
+Tracking_allocator<System_allocator> world_allocator() noexcept {
+  return Tracking_allocator<System_allocator>{System_allocator{},
+                                              world_allocation_tag};
+}
+
+// Handles address at most 1 << object_handle_index_bits objects of each type
+World_create_info const &
+check_capacities(World_create_info const &create_info) {
+  auto constexpr max_objects = 1 << object_handle_index_bits;
+  if (create_info.max_particles > max_objects ||
+      create_info.max_rigid_bodies > max_objects ||
+      create_info.max_static_bodies > max_objects) {
+    throw std::invalid_argument{
+        "World: object capacity exceeds the object handle index range"};
+  }
+  return create_info;
+}
+
 // auto constexpr color_unmarked{static_cast<std::uint16_t>(-1)};
 // auto constexpr color_marked{static_cast<std::uint16_t>(-2)};
 // auto constexpr reserved_colors{std::size_t{2}};
@@ -209,7 +235,6 @@ public:
     Particle_storage *particles;
     Rigid_body_storage *rigid_bodies;
     Static_body_storage *static_bodies;
-    std::latch *latch;
   };
 
   explicit Narrowphase_task(
@@ -252,9 +277,6 @@ public:
         contact_manifold.clear();
       }
     }
-    if (auto const latch = _intrinsic_state->latch) {
-      latch->count_down();
-    }
   }
 
 private:
@@ -318,7 +340,6 @@ public:
     Particle_storage *particles;
     Rigid_body_storage *rigid_bodies;
     Static_body_storage *static_bodies;
-    std::latch *latch;
   };
 
   struct Work_item {
@@ -396,9 +417,6 @@ public:
           },
           work_item.objects.specific());
     }
-    if (auto const latch = _intrinsic_state->latch) {
-      latch->count_down();
-    }
   }
 
 private:
@@ -508,8 +526,8 @@ public:
     Particle_storage *particles;
     Rigid_body_storage *rigid_bodies;
     Static_body_storage *static_bodies;
-    std::latch *latch;
     float restitution_separating_velocity_epsilon;
+    bool fast_friction;
   };
 
   struct Work_item {
@@ -589,10 +607,24 @@ public:
             auto const tangential_velocity =
                 relative_velocity -
                 separating_velocity * work_item.contact->normal;
-            if (tangential_velocity != Vec3f::zero()) {
-              auto const tangential_speed = length(tangential_velocity);
-              auto const global_tangent =
-                  tangential_velocity / tangential_speed;
+            auto const tangential_speed_squared =
+                length_squared(tangential_velocity);
+            // below the smallest normal float the exact path divides by zero
+            // and fast::rsqrt returns nan, and there is no friction to speak of
+            if (tangential_speed_squared >=
+                std::numeric_limits<float>::min()) {
+              auto tangential_speed = 0.0f;
+              auto global_tangent = Vec3f{};
+              if (_intrinsic_state->fast_friction) {
+                auto const inverse_tangential_speed =
+                    fast::rsqrt(tangential_speed_squared);
+                tangential_speed =
+                    tangential_speed_squared * inverse_tangential_speed;
+                global_tangent = tangential_velocity * inverse_tangential_speed;
+              } else {
+                tangential_speed = sqrt(tangential_speed_squared);
+                global_tangent = tangential_velocity / tangential_speed;
+              }
               auto const local_tangents = std::array<Vec3f, 2>{
                   object_derived_data[0].inverse_rotation * global_tangent,
                   object_derived_data[1].inverse_rotation * global_tangent,
@@ -658,9 +690,6 @@ public:
           },
           work_item.objects.specific());
     }
-    if (auto const latch = _intrinsic_state->latch) {
-      latch->count_down();
-    }
   }
 
 private:
@@ -757,6 +786,61 @@ auto constexpr max_narrowphase_task_size = Size{32};
 } // namespace
 
 class World::Impl {
+  enum class Substep_phase {
+    integrate,
+    narrowphase,
+    solve_positions,
+    solve_velocities,
+  };
+
+  static constexpr auto substep_phase_count = Size{4};
+
+  // Awake neighbor groups are split into lanes of about equal work. Groups
+  // share no dynamic objects, so each lane runs through the phases of a
+  // substep without waiting for the other lanes.
+  struct Substep_lane {
+    // range of _awake_neighbor_group_indices
+    Size groups_begin;
+    Size groups_end;
+    // range of _awake_contact_manifolds
+    Size contact_manifolds_begin;
+    Size contact_manifolds_end;
+    double integration_wall_time;
+    double narrowphase_wall_time;
+    double position_solve_wall_time;
+    double velocity_solve_wall_time;
+  };
+
+  struct Substep_info {
+    float delta_time;
+    float velocity_damping_factor;
+    float waking_motion_smoothing_factor;
+    float restitution_separating_velocity_epsilon;
+    bool fast_integration;
+    bool fast_friction;
+  };
+
+  class Substep_task final : public util::Task {
+  public:
+    explicit Substep_task(Impl *impl,
+                          Size lane_index,
+                          Substep_phase phase) noexcept
+        : _impl{impl}, _lane_index{lane_index}, _phase{phase} {}
+
+    void run(Size) final { _impl->run_substep_phase(_lane_index, _phase); }
+
+  private:
+    Impl *_impl;
+    Size _lane_index;
+    Substep_phase _phase;
+  };
+
+  static constexpr Size
+  substep_lane_count(World_create_info const &create_info) noexcept {
+    return util::parallel_for_chunks_per_thread *
+           (create_info.worker_thread_count + 1);
+  }
+
 public:
   friend class World;
 
@@ -771,9 +855,7 @@ public:
         decltype(_bvh)::memory_requirement(
             create_info.max_aabb_tree_leaf_nodes,
             create_info.max_aabb_tree_internal_nodes),
-        decltype(_neighbor_pairs)::memory_requirement(
-            create_info.max_neighbor_pairs),
-        decltype(_neighbors)::memory_requirement(
+        Neighbor_list::spill_memory_requirement(
             2 * create_info.max_neighbor_pairs),
         decltype(_neighbor_groups)::memory_requirement(
             create_info.max_particles + create_info.max_rigid_bodies,
@@ -789,16 +871,31 @@ public:
             create_info.max_neighbor_pairs),
         decltype(_awake_contact_manifolds)::memory_requirement(
             create_info.max_neighbor_pairs),
-        decltype(_narrowphase_tasks)::memory_requirement(
-            (create_info.max_neighbor_pairs + max_narrowphase_task_size - 1) /
-            max_narrowphase_task_size),
+        decltype(_awake_contact_manifold_ends)::memory_requirement(
+            create_info.max_neighbor_groups),
+        decltype(_substep_lanes)::memory_requirement(
+            substep_lane_count(create_info)),
+        decltype(_substep_tasks)::memory_requirement(
+            substep_phase_count * substep_lane_count(create_info)),
+        decltype(_substep_graph)::memory_requirement(
+            substep_phase_count * substep_lane_count(create_info),
+            (substep_phase_count - 1) * substep_lane_count(create_info)),
     });
   }
 
   explicit Impl(World_create_info const &create_info)
-      : _threads{create_info.worker_thread_count},
-        _block{util::System_allocator{}.alloc(memory_requirement(create_info))},
+      : _threads{{
+            .thread_count = create_info.worker_thread_count,
+            .scheduling_policy = util::Scheduling_policy::adaptive,
+            .affinity = create_info.worker_affinity,
+            .numa_node = create_info.numa_node,
+        }},
+        _block{world_allocator().alloc(memory_requirement(create_info))},
         _gravitational_acceleration{create_info.gravitational_acceleration} {
+    if (create_info.numa_node >= 0) {
+      // must happen before the pages are first touched below
+      util::bind_to_numa_node(_block, create_info.numa_node);
+    }
     auto allocator = Stack_allocator<>{_block};
     _particles =
         Particle_storage::make(allocator, create_info.max_particles).second;
@@ -812,12 +909,9 @@ public:
                                 create_info.max_aabb_tree_leaf_nodes,
                                 create_info.max_aabb_tree_internal_nodes)
                .second;
-    _neighbor_pairs =
-        List<Object_pair>::make(allocator, create_info.max_neighbor_pairs)
-            .second;
-    _neighbors =
-        List<Object>::make(allocator, 2 * create_info.max_neighbor_pairs)
-            .second;
+    _neighbor_arena = Neighbor_arena{allocator.alloc(
+        Neighbor_list::spill_memory_requirement(
+            2 * create_info.max_neighbor_pairs))};
     _neighbor_groups =
         Neighbor_group_storage::make(allocator,
                                      create_info.max_particles +
@@ -844,16 +938,34 @@ public:
     _narrowphase_task_intrinsic_state.particles = &_particles;
     _narrowphase_task_intrinsic_state.rigid_bodies = &_rigid_bodies;
     _narrowphase_task_intrinsic_state.static_bodies = &_static_bodies;
-    _narrowphase_tasks =
-        List<Narrowphase_task>::make(
-            allocator,
-            (create_info.max_neighbor_pairs + max_narrowphase_task_size - 1) /
-                max_narrowphase_task_size)
+    _awake_contact_manifold_ends =
+        List<Size>::make(allocator, create_info.max_neighbor_groups).second;
+    auto const lane_count = substep_lane_count(create_info);
+    _substep_lanes = List<Substep_lane>::make(allocator, lane_count).second;
+    _substep_lanes.resize(lane_count);
+    _substep_tasks =
+        List<Substep_task>::make(allocator, substep_phase_count * lane_count)
             .second;
+    _substep_graph = Task_graph::make(allocator,
+                                      substep_phase_count * lane_count,
+                                      (substep_phase_count - 1) * lane_count)
+                         .second;
+    for (auto i = Size{}; i != lane_count; ++i) {
+      for (auto j = Size{}; j != substep_phase_count; ++j) {
+        auto const node = _substep_graph.add_node(&_substep_tasks.emplace_back(
+            this, i, static_cast<Substep_phase>(j)));
+        if (j != 0) {
+          _substep_graph.add_edge(node - 1, node);
+        }
+      }
+    }
   }
 
   ~Impl() {
-    _narrowphase_tasks = {};
+    _substep_graph = {};
+    _substep_tasks = {};
+    _substep_lanes = {};
+    _awake_contact_manifold_ends = {};
     _awake_contact_manifolds = {};
     _contact_manifolds = {};
     // _color_groups = {};
@@ -861,13 +973,12 @@ public:
     // _coloring_bits = {};
     _awake_neighbor_group_indices = {};
     _neighbor_groups = {};
-    _neighbors = {};
-    _neighbor_pairs = {};
+    _neighbor_arena = {};
     _bvh = {};
     _static_bodies = {};
     _rigid_bodies = {};
     _particles = {};
-    util::System_allocator{}.free(_block);
+    world_allocator().free(_block);
   }
 
   Particle create_particle(Particle_create_info const &create_info) {
@@ -890,6 +1001,9 @@ public:
   }
 
   void destroy_particle(Particle particle) {
+    if (!_particles.contains(particle)) {
+      throw std::invalid_argument{"World: particle already destroyed"};
+    }
     _bvh.destroy_leaf(data(particle)->bvh_node());
     _particles.destroy(particle);
   }
@@ -918,6 +1032,9 @@ public:
   }
 
   void destroy_rigid_body(Rigid_body rigid_body) {
+    if (!_rigid_bodies.contains(rigid_body)) {
+      throw std::invalid_argument{"World: rigid body already destroyed"};
+    }
     _bvh.destroy_leaf(data(rigid_body)->bvh_node());
     _rigid_bodies.destroy(rigid_body);
   }
@@ -942,6 +1059,9 @@ public:
   }
 
   void destroy_static_body(Static_body static_body) {
+    if (!_static_bodies.contains(static_body)) {
+      throw std::invalid_argument{"World: static body already destroyed"};
+    }
     _bvh.destroy_leaf(data(static_body)->bvh_node());
     _static_bodies.destroy(static_body);
   }
@@ -959,7 +1079,7 @@ public:
     find_neighbor_groups();
     find_awake_neighbor_groups();
     find_awake_contact_manifolds();
-    make_narrowphase_tasks();
+    assign_substep_lanes();
     auto const broadphase_end = clock::now();
     result.broadphase_wall_time =
         std::chrono::duration_cast<duration>(broadphase_end - broadphase_begin)
@@ -988,38 +1108,32 @@ public:
     //     break;
     //   }
     // }
+    auto const damping_pow =
+        simulate_info.fast_integration ? &fast::pow : &math::pow<float>;
     auto const time_compensated_velocity_damping_factor =
-        pow(velocity_damping_factor, h);
+        damping_pow(velocity_damping_factor, h);
     auto const time_compensating_waking_motion_smoothing_factor =
-        1.0f - pow(1.0f - motion_smoothing_factor, h);
+        1.0f - damping_pow(1.0f - motion_smoothing_factor, h);
     auto const restitution_separating_velocity_epsilon =
         2.0f * h * length(_gravitational_acceleration);
+    _substep_info = {
+        .delta_time = h,
+        .velocity_damping_factor = time_compensated_velocity_damping_factor,
+        .waking_motion_smoothing_factor =
+            time_compensating_waking_motion_smoothing_factor,
+        .restitution_separating_velocity_epsilon =
+            restitution_separating_velocity_epsilon,
+        .fast_integration = simulate_info.fast_integration,
+        .fast_friction = simulate_info.fast_friction,
+    };
     for (auto i = 0; i < simulate_info.substep_count; ++i) {
-      auto const integration_begin = clock::now();
-      integrate(h,
-                time_compensated_velocity_damping_factor,
-                time_compensating_waking_motion_smoothing_factor);
-      auto const integration_end = clock::now();
-      run_narrowphase_tasks();
-      auto const narrowphase_end = clock::now();
-      solve_positions();
-      auto const position_solve_end = clock::now();
-      solve_velocities(restitution_separating_velocity_epsilon);
-      auto const velocity_solve_end = clock::now();
-      result.integration_wall_time += std::chrono::duration_cast<duration>(
-                                          integration_end - integration_begin)
-                                          .count();
-      result.narrowphase_wall_time += std::chrono::duration_cast<duration>(
-                                          narrowphase_end - integration_end)
-                                          .count();
-      result.position_solve_wall_time +=
-          std::chrono::duration_cast<duration>(position_solve_end -
-                                               narrowphase_end)
-              .count();
-      result.velocity_solve_wall_time +=
-          std::chrono::duration_cast<duration>(velocity_solve_end -
-                                               position_solve_end)
-              .count();
+      _substep_graph.run(_threads);
+    }
+    for (auto const &lane : _substep_lanes) {
+      result.integration_wall_time += lane.integration_wall_time;
+      result.narrowphase_wall_time += lane.narrowphase_wall_time;
+      result.position_solve_wall_time += lane.position_solve_wall_time;
+      result.velocity_solve_wall_time += lane.velocity_solve_wall_time;
     }
     auto const simulate_end = clock::now();
     result.total_wall_time =
@@ -1048,17 +1162,45 @@ private:
           expand(Aabb3f{object_data->position(), object_data->position()},
                  half_extent);
     });
+    // Box bounds are transformed in batches, balls and capsules only need
+    // their position and axis
+    auto constexpr box_batch_size = std::size_t{64};
+    auto box_transforms = std::array<Mat3x4f, box_batch_size>{};
+    auto box_bounds = std::array<Aabb3f, box_batch_size>{};
+    auto box_safety_terms = std::array<float, box_batch_size>{};
+    auto box_nodes = std::array<Broadphase_bvh::Node *, box_batch_size>{};
+    auto box_count = std::size_t{};
+    auto const flush_boxes = [&] {
+      auto const boxes = std::span{box_bounds}.first(box_count);
+      transform_aabbs(std::span{box_transforms}.first(box_count), boxes, boxes);
+      for (auto i = std::size_t{}; i != box_count; ++i) {
+        box_nodes[i]->bounds = expand(box_bounds[i], box_safety_terms[i]);
+      }
+      box_count = 0;
+    };
     _rigid_bodies.for_each([&](Rigid_body object) {
       auto const object_data = data(object);
       auto const transform =
           Mat3x4f::rigid(object_data->position(), object_data->orientation());
-      object_data->bvh_node()->bounds =
-          expand(bounds(object_data->shape(), transform),
-                 constant_safety_term +
-                     velocity_safety_factor * length(object_data->velocity()) *
-                         delta_time +
-                     gravity_safety_term);
+      auto const safety_term =
+          constant_safety_term +
+          velocity_safety_factor * length(object_data->velocity()) *
+              delta_time +
+          gravity_safety_term;
+      if (auto const box = get_if<Box>(object_data->shape())) {
+        box_transforms[box_count] = transform;
+        box_bounds[box_count] = {-box->half_extents, box->half_extents};
+        box_safety_terms[box_count] = safety_term;
+        box_nodes[box_count] = object_data->bvh_node();
+        if (++box_count == box_batch_size) {
+          flush_boxes();
+        }
+      } else {
+        object_data->bvh_node()->bounds =
+            expand(bounds(object_data->shape(), transform), safety_term);
+      }
     });
+    flush_boxes();
     _bvh.build();
   }
 
@@ -1068,65 +1210,56 @@ private:
     };
     _particles.for_each(reset_neighbors);
     _rigid_bodies.for_each(reset_neighbors);
-    _neighbor_pairs.clear();
-    _neighbors.clear();
+    _neighbor_arena.reset();
     _neighbor_groups.clear();
-    _bvh.for_each_overlapping_leaf_pair([this](Object first_generic,
-                                               Object second_generic) {
-      visit(
-          [&](auto const first_specific, auto const second_specific) {
-            using T = std::decay_t<decltype(first_specific)>;
-            using U = std::decay_t<decltype(second_specific)>;
-            if constexpr (!std::is_same_v<T, Static_body> ||
-                          !std::is_same_v<U, Static_body>) {
-              auto const pair =
-                  _neighbor_pairs.emplace_back(first_specific, second_specific);
-              auto const it = _contact_manifolds
-                                  .emplace(std::piecewise_construct,
-                                           std::tuple{pair},
-                                           std::tuple{})
-                                  .first;
-              it->second.marked(true);
-              if constexpr (!std::is_same_v<T, Static_body>) {
-                data(first_specific)->count_neighbor();
-              }
-              if constexpr (!std::is_same_v<U, Static_body>) {
-                data(second_specific)->count_neighbor();
-              }
-            }
-          },
-          first_generic.specific(),
-          second_generic.specific());
-    });
-    for (auto it = _contact_manifolds.begin();
-         it != _contact_manifolds.end();) {
-      if (it->second.marked()) {
-        it->second.marked(false);
-        ++it;
-      } else {
-        it = _contact_manifolds.erase(it);
+    _bvh.for_each_overlapping_leaf_pair(
+        _threads, [this](Object first_generic, Object second_generic, Size) {
+          visit(
+              [&](auto const first_specific, auto const second_specific) {
+                using T = std::decay_t<decltype(first_specific)>;
+                using U = std::decay_t<decltype(second_specific)>;
+                if constexpr (!std::is_same_v<T, Static_body> ||
+                              !std::is_same_v<U, Static_body>) {
+                  auto const pair =
+                      Object_pair{first_specific, second_specific};
+                  _contact_manifolds.try_emplace(pair).first->second.marked(
+                      true);
+                }
+              },
+              first_generic.specific(),
+              second_generic.specific());
+        });
+    // drops the manifolds of pairs that stopped overlapping and hands the
+    // others to their objects as neighbors
+    _contact_manifolds.erase_if([this](auto &item) {
+      if (!item.second.marked()) {
+        return true;
       }
-    }
-    auto const reserve_neighbors = [this](auto const object) {
-      data(object)->reserve_neighbors(_neighbors);
-    };
-    _particles.for_each(reserve_neighbors);
-    _rigid_bodies.for_each(reserve_neighbors);
-    for (auto &pair : _neighbor_pairs) {
+      item.second.marked(false);
+      auto const pair = item.first;
       std::visit(
           [&](auto const object) {
-            data(object)->push_neighbor(pair.second_generic());
+            data(object)->push_neighbor(_neighbor_arena, pair.second_generic());
           },
           pair.first_specific());
       std::visit(
           [&](auto const object) {
             using T = std::decay_t<decltype(object)>;
             if constexpr (!std::is_same_v<T, Static_body>) {
-              data(object)->push_neighbor(pair.first_generic());
+              data(object)->push_neighbor(_neighbor_arena,
+                                          pair.first_generic());
             }
           },
           pair.second_specific());
-    }
+      return false;
+    });
+    // the order of the table depends on the order of insertion, sorting keeps
+    // the simulation deterministic
+    auto const sort_neighbors = [&](auto const object) {
+      data(object)->sort_neighbors();
+    };
+    _particles.for_each(sort_neighbors);
+    _rigid_bodies.for_each(sort_neighbors);
   }
 
   void find_neighbor_groups() {
@@ -1226,6 +1359,7 @@ private:
 
   void find_awake_contact_manifolds() {
     _awake_contact_manifolds.clear();
+    _awake_contact_manifold_ends.clear();
     for (auto const group_index : _awake_neighbor_group_indices) {
       auto const group = _neighbor_groups.group(group_index);
       for (auto object_index = group.objects_begin;
@@ -1247,11 +1381,11 @@ private:
                       using U = std::decay_t<decltype(neighbor_specific)>;
                       if constexpr (std::is_same_v<U, Static_body>) {
                         _awake_contact_manifolds.emplace_back(
-                            &*_contact_manifolds.find(
+                            _contact_manifolds.find(
                                 Object_pair{object, neighbor_specific}));
                       } else if (!data(neighbor_specific)->marked()) {
                         _awake_contact_manifolds.emplace_back(
-                            &*_contact_manifolds.find(
+                            _contact_manifolds.find(
                                 Object_pair{object, neighbor_specific}));
                       }
                     },
@@ -1260,28 +1394,48 @@ private:
             },
             _neighbor_groups.object_specific(object_index));
       }
+      _awake_contact_manifold_ends.emplace_back(
+          _awake_contact_manifolds.size());
     }
     // std::ranges::sort(_awake_contact_manifolds);
   }
 
-  void make_narrowphase_tasks() noexcept {
-    auto const complete_task_count =
-        _awake_contact_manifolds.size() / max_narrowphase_task_size;
-    auto const partial_task_size =
-        _awake_contact_manifolds.size() % max_narrowphase_task_size;
-    _narrowphase_tasks.clear();
-    for (auto i = Size{}; i != complete_task_count; ++i) {
-      _narrowphase_tasks.emplace_back(
-          &_narrowphase_task_intrinsic_state,
-          std::span{&_awake_contact_manifolds[i * max_narrowphase_task_size],
-                    static_cast<std::size_t>(max_narrowphase_task_size)});
+  void assign_substep_lanes() {
+    auto const group_cost = [this](Size awake_group_position) {
+      auto const &group = _neighbor_groups.group(
+          _awake_neighbor_group_indices[awake_group_position]);
+      auto const contact_manifolds_begin =
+          awake_group_position != 0
+              ? _awake_contact_manifold_ends[awake_group_position - 1]
+              : Size{};
+      return (group.objects_end - group.objects_begin) +
+             (_awake_contact_manifold_ends[awake_group_position] -
+              contact_manifolds_begin);
+    };
+    auto const awake_group_count = _awake_neighbor_group_indices.size();
+    auto total_cost = Size{};
+    for (auto i = Size{}; i != awake_group_count; ++i) {
+      total_cost += group_cost(i);
     }
-    if (partial_task_size != 0) {
-      _narrowphase_tasks.emplace_back(
-          &_narrowphase_task_intrinsic_state,
-          std::span{&_awake_contact_manifolds[complete_task_count *
-                                              max_narrowphase_task_size],
-                    static_cast<std::size_t>(partial_task_size)});
+    auto const lane_count = _substep_lanes.size();
+    auto cost = Size{};
+    auto group_position = Size{};
+    for (auto i = Size{}; i != lane_count; ++i) {
+      auto &lane = _substep_lanes[i];
+      lane = {};
+      lane.groups_begin = group_position;
+      lane.contact_manifolds_begin =
+          group_position != 0 ? _awake_contact_manifold_ends[group_position - 1]
+                              : Size{};
+      auto const lane_end_cost = total_cost * (i + 1) / lane_count;
+      while (group_position != awake_group_count && cost < lane_end_cost) {
+        cost += group_cost(group_position);
+        ++group_position;
+      }
+      lane.groups_end = group_position;
+      lane.contact_manifolds_end =
+          group_position != 0 ? _awake_contact_manifold_ends[group_position - 1]
+                              : Size{};
     }
   }
 
@@ -1348,21 +1502,51 @@ private:
   //   }
   // }
 
-  void integrate(float delta_time,
-                 float velocity_damping_factor,
-                 float waking_motion_smoothing_factor) noexcept {
-    for (auto const i : _awake_neighbor_group_indices) {
-      integrate_neighbor_group(i,
-                               delta_time,
-                               velocity_damping_factor,
-                               waking_motion_smoothing_factor);
+  void run_substep_phase(Size lane_index, Substep_phase phase) {
+    using clock = std::chrono::system_clock;
+    using duration = std::chrono::duration<double>;
+    auto &lane = _substep_lanes[lane_index];
+    auto const contact_manifolds = std::span{
+        _awake_contact_manifolds.data() + lane.contact_manifolds_begin,
+        _awake_contact_manifolds.data() + lane.contact_manifolds_end};
+    auto const begin = clock::now();
+    switch (phase) {
+    case Substep_phase::integrate:
+      for (auto i = lane.groups_begin; i != lane.groups_end; ++i) {
+        integrate_neighbor_group(_awake_neighbor_group_indices[i],
+                                 _substep_info.delta_time,
+                                 _substep_info.velocity_damping_factor,
+                                 _substep_info.waking_motion_smoothing_factor,
+                                 _substep_info.fast_integration);
+      }
+      lane.integration_wall_time +=
+          std::chrono::duration_cast<duration>(clock::now() - begin).count();
+      break;
+    case Substep_phase::narrowphase:
+      run_narrowphase_tasks(contact_manifolds);
+      lane.narrowphase_wall_time +=
+          std::chrono::duration_cast<duration>(clock::now() - begin).count();
+      break;
+    case Substep_phase::solve_positions:
+      solve_positions(contact_manifolds);
+      lane.position_solve_wall_time +=
+          std::chrono::duration_cast<duration>(clock::now() - begin).count();
+      break;
+    case Substep_phase::solve_velocities:
+      solve_velocities(contact_manifolds,
+                       _substep_info.restitution_separating_velocity_epsilon,
+                       _substep_info.fast_friction);
+      lane.velocity_solve_wall_time +=
+          std::chrono::duration_cast<duration>(clock::now() - begin).count();
+      break;
     }
   }
 
   void integrate_neighbor_group(util::Size group_index,
                                 float delta_time,
                                 float damping_factor,
-                                float motion_smoothing_factor) {
+                                float motion_smoothing_factor,
+                                bool fast_renormalization) {
     auto const &group = _neighbor_groups.group(group_index);
     for (auto i = group.objects_begin; i != group.objects_end; ++i) {
       std::visit(
@@ -1373,44 +1557,37 @@ private:
                 .damping_factor = damping_factor,
                 .motion_smoothing_factor = motion_smoothing_factor,
                 .motion_limit = motion_limit,
+                .fast_renormalization = fast_renormalization,
             });
           },
           _neighbor_groups.object_specific(i));
     }
   }
 
-  void run_narrowphase_tasks() {
-    if (_threads.empty()) {
-      _narrowphase_task_intrinsic_state.latch = nullptr;
-      for (auto &task : _narrowphase_tasks) {
-        task.run({});
-      }
-    } else {
-      auto latch = std::latch{_narrowphase_tasks.size()};
-      _narrowphase_task_intrinsic_state.latch = &latch;
-      for (auto &task : _narrowphase_tasks) {
-        _threads.push_silent(&task);
-      }
-      // _threads.set_scheduling_policy(Scheduling_policy::spin);
-      _threads.notify();
-      for (;;) {
-        if (latch.try_wait()) {
-          return;
-        }
-      }
-      // _threads.set_scheduling_policy(Scheduling_policy::block);
-    }
+  void run_narrowphase_tasks(
+      std::span<std::pair<Object_pair, Contact_manifold> *const>
+          contact_manifolds) {
+    // a single large island still spreads over the pool
+    parallel_for(_threads,
+                 contact_manifolds,
+                 max_narrowphase_task_size,
+                 [this](auto const items, Size thread_index) {
+                   Narrowphase_task{&_narrowphase_task_intrinsic_state,
+                                    std::span{items}}
+                       .run(thread_index);
+                 });
   }
 
-  void solve_positions() {
+  void solve_positions(
+      std::span<std::pair<Object_pair, Contact_manifold> *const>
+          contact_manifolds) {
     auto const intrinsic_state = Position_solve_task::Intrinsic_state{
         .particles = &_particles,
         .rigid_bodies = &_rigid_bodies,
         .static_bodies = &_static_bodies,
-        .latch = nullptr,
     };
     for (auto i = 0; i != 4; ++i) {
-      for (auto const p : _awake_contact_manifolds) {
+      for (auto const p : contact_manifolds) {
         auto &[objects, contact_manifold] = *p;
         for (auto &contact : contact_manifold.contacts()) {
           auto const work_item = Position_solve_task::Work_item{
@@ -1423,17 +1600,21 @@ private:
     }
   }
 
-  void solve_velocities(float restitution_separating_velocity_epsilon) {
+  void solve_velocities(
+      std::span<std::pair<Object_pair, Contact_manifold> *const>
+          contact_manifolds,
+      float restitution_separating_velocity_epsilon,
+      bool fast_friction) {
     auto const intrinsic_state = Velocity_solve_task::Intrinsic_state{
         .particles = &_particles,
         .rigid_bodies = &_rigid_bodies,
         .static_bodies = &_static_bodies,
-        .latch = nullptr,
         .restitution_separating_velocity_epsilon =
             restitution_separating_velocity_epsilon,
+        .fast_friction = fast_friction,
     };
     for (auto i = 0; i != 1; ++i) {
-      for (auto const p : _awake_contact_manifolds) {
+      for (auto const p : contact_manifolds) {
         auto &[objects, contact_manifold] = *p;
         for (auto const &contact : contact_manifold.contacts()) {
           auto const work_item = Velocity_solve_task::Work_item{
@@ -1486,6 +1667,18 @@ private:
     _rigid_bodies.for_each(call_object_motion_callback);
   }
 
+  bool contains(Particle object) const noexcept {
+    return _particles.contains(object);
+  }
+
+  bool contains(Rigid_body object) const noexcept {
+    return _rigid_bodies.contains(object);
+  }
+
+  bool contains(Static_body object) const noexcept {
+    return _static_bodies.contains(object);
+  }
+
   Particle_data const *data(Particle object) const noexcept {
     return _particles.data(object);
   }
@@ -1516,23 +1709,26 @@ private:
   Static_body_storage _static_bodies;
   Rigid_body_storage _rigid_bodies;
   Broadphase_bvh _bvh;
-  List<Object_pair> _neighbor_pairs;
-  List<Object> _neighbors;
+  Neighbor_arena _neighbor_arena;
   Neighbor_group_storage _neighbor_groups;
   List<Size> _awake_neighbor_group_indices;
   // Bit_list _coloring_bits;
   // Queue<Object_pair *> _coloring_fringe;
   // Color_group_storage _color_groups;
   // List<Contact> _contacts;
-  Map<Object_pair, Contact_manifold> _contact_manifolds;
+  Concurrent_map<Object_pair, Contact_manifold> _contact_manifolds;
   List<std::pair<Object_pair, Contact_manifold> *> _awake_contact_manifolds;
+  List<Size> _awake_contact_manifold_ends;
   Narrowphase_task::Intrinsic_state _narrowphase_task_intrinsic_state;
-  List<Narrowphase_task> _narrowphase_tasks;
+  List<Substep_lane> _substep_lanes;
+  List<Substep_task> _substep_tasks;
+  Task_graph _substep_graph;
+  Substep_info _substep_info;
   Vec3f _gravitational_acceleration;
 };
 
 World::World(World_create_info const &create_info)
-    : _impl{std::make_unique<Impl>(create_info)} {}
+    : _impl{std::make_unique<Impl>(check_capacities(create_info))} {}
 
 World::~World() {}
 
@@ -1561,6 +1757,18 @@ void World::destroy_static_body(Static_body static_rigid_body) {
   _impl->destroy_static_body(static_rigid_body);
 }
 
+bool World::contains(Particle object) const noexcept {
+  return _impl->contains(object);
+}
+
+bool World::contains(Rigid_body object) const noexcept {
+  return _impl->contains(object);
+}
+
+bool World::contains(Static_body object) const noexcept {
+  return _impl->contains(object);
+}
+
 Particle_data const *World::data(Particle object) const noexcept {
   return _impl->data(object);
 }
@@ -16,6 +16,12 @@ struct World_create_info {
   util::Size worker_thread_count{math::max(
       static_cast<util::Size>(std::thread::hardware_concurrency()) / 2 - 1,
       util::Size{0})};
+  util::Thread_affinity worker_affinity{util::Thread_affinity::none};
+  // Places the workers and the world's memory on this numa node if not
+  // negative
+  int numa_node{-1};
+  // At most 1 << object_handle_index_bits each, World throws
+  // std::invalid_argument otherwise
   int max_particles{10000};
   int max_rigid_bodies{10000};
   int max_static_bodies{100000};
@@ -57,8 +63,16 @@ struct Static_body_create_info {
 struct World_simulate_info {
   float delta_time{1.0f / 128.0f};
   int substep_count{10};
+  // Trade a few ulp for speed with the approximations of math::fast, see
+  // math/fast.h. fast_integration renormalizes orientations to first order
+  // and computes the damping factors with fast::pow, fast_friction finds the
+  // tangential direction and speed with a single fast::rsqrt.
+  bool fast_integration{false};
+  bool fast_friction{false};
 };
 
+// The substep phase times are summed over the lanes of islands that run them
+// concurrently, so together they can exceed total_wall_time.
 struct World_simulate_result {
   double total_wall_time;
   double broadphase_wall_time;
@@ -86,6 +100,14 @@ public:
 
   void destroy_static_body(Static_body handle);
 
+  // False once the object is destroyed. Destroying an object that is not
+  // contained throws std::invalid_argument, data returns nullptr for it.
+  bool contains(Particle object) const noexcept;
+
+  bool contains(Rigid_body object) const noexcept;
+
+  bool contains(Static_body object) const noexcept;
+
   Particle_data const *data(Particle object) const noexcept;
 
   Particle_data *data(Particle object) noexcept;
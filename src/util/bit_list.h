@@ -1,9 +1,21 @@
 #ifndef MARLON_UTIL_BIT_LIST_H
 #define MARLON_UTIL_BIT_LIST_H
 
+#if defined(__AVX2__)
+#define MARLON_UTIL_BIT_LIST_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MARLON_UTIL_BIT_LIST_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
 
+#include <algorithm>
+#include <bit>
 #include <limits>
 #include <span>
 #include <utility>
@@ -13,6 +25,82 @@
 
 namespace marlon {
 namespace util {
+namespace detail {
+enum class Bit_list_op { and_, or_, and_not };
+
+// Applies op to size words of lhs and rhs, storing the result in lhs. Whole
+// SIMD registers of words are combined at once where available.
+template <Bit_list_op Op>
+void bit_list_combine(std::uint64_t *lhs,
+                      std::uint64_t const *rhs,
+                      Size size) noexcept {
+  auto i = Size{};
+#if defined(MARLON_UTIL_BIT_LIST_AVX2)
+  for (; i + 4 <= size; i += 4) {
+    auto const a = _mm256_loadu_si256(reinterpret_cast<__m256i *>(lhs + i));
+    auto const b =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(rhs + i));
+    auto const result = Op == Bit_list_op::and_  ? _mm256_and_si256(a, b)
+                        : Op == Bit_list_op::or_ ? _mm256_or_si256(a, b)
+                                                 : _mm256_andnot_si256(b, a);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lhs + i), result);
+  }
+#elif defined(MARLON_UTIL_BIT_LIST_SSE2)
+  for (; i + 2 <= size; i += 2) {
+    auto const a = _mm_loadu_si128(reinterpret_cast<__m128i *>(lhs + i));
+    auto const b = _mm_loadu_si128(reinterpret_cast<__m128i const *>(rhs + i));
+    auto const result = Op == Bit_list_op::and_  ? _mm_and_si128(a, b)
+                        : Op == Bit_list_op::or_ ? _mm_or_si128(a, b)
+                                                 : _mm_andnot_si128(b, a);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lhs + i), result);
+  }
+#endif
+  for (; i != size; ++i) {
+    lhs[i] = Op == Bit_list_op::and_  ? lhs[i] & rhs[i]
+             : Op == Bit_list_op::or_ ? lhs[i] | rhs[i]
+                                      : lhs[i] & ~rhs[i];
+  }
+}
+
+// Whether lhs[i] & rhs[i] is nonzero for any of size words, rhs may be lhs
+inline bool bit_list_intersects(std::uint64_t const *lhs,
+                                std::uint64_t const *rhs,
+                                Size size) noexcept {
+  auto i = Size{};
+#if defined(MARLON_UTIL_BIT_LIST_AVX2)
+  for (; i + 4 <= size; i += 4) {
+    auto const a =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(lhs + i));
+    auto const b =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(rhs + i));
+    if (!_mm256_testz_si256(a, b)) {
+      return true;
+    }
+  }
+#elif defined(MARLON_UTIL_BIT_LIST_SSE2)
+  for (; i + 2 <= size; i += 2) {
+    auto const a = _mm_loadu_si128(reinterpret_cast<__m128i const *>(lhs + i));
+    auto const b = _mm_loadu_si128(reinterpret_cast<__m128i const *>(rhs + i));
+    auto const zero = _mm_cmpeq_epi8(_mm_and_si128(a, b), _mm_setzero_si128());
+    if (_mm_movemask_epi8(zero) != 0xffff) {
+      return true;
+    }
+  }
+#endif
+  for (; i != size; ++i) {
+    if ((lhs[i] & rhs[i]) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace detail
+
+// Fixed capacity list of bits packed into 64 bit words. Besides per-bit
+// access it works a word at a time: set bits are visited with countr_zero,
+// rank, select and find skip whole words by their popcount, and the bulk
+// operations between lists use SIMD where available. Bits past size() are
+// ignored by every operation.
 class Bit_list {
 public:
   template <typename Allocator>
@@ -119,6 +207,117 @@ public:
 
   void pop_back() noexcept { --_size; }
 
+  // Number of set bits
+  Size count() const noexcept {
+    auto result = Size{};
+    for (auto n = Size{}; n != word_count(); ++n) {
+      result += std::popcount(masked_word(n));
+    }
+    return result;
+  }
+
+  // Number of set bits before index
+  Size rank(Size index) const noexcept {
+    assert(index >= 0 && index <= size());
+    auto result = Size{};
+    auto const n = index >> 6;
+    for (auto i = Size{}; i != n; ++i) {
+      result += std::popcount(_data[i]);
+    }
+    if (auto const m = index & 63; m != 0) {
+      result += std::popcount(_data[n] & ((std::uint64_t{1} << m) - 1));
+    }
+    return result;
+  }
+
+  // Index of the set bit with the given rank, size() if there is none
+  Size select(Size rank) const noexcept {
+    assert(rank >= 0);
+    for (auto n = Size{}; n != word_count(); ++n) {
+      auto word = masked_word(n);
+      auto const set_count = Size{std::popcount(word)};
+      if (rank < set_count) {
+        for (; rank != 0; --rank) {
+          word &= word - 1;
+        }
+        return (n << 6) + std::countr_zero(word);
+      }
+      rank -= set_count;
+    }
+    return size();
+  }
+
+  // Index of the first set bit at or after begin, size() if there is none
+  Size find_first_set(Size begin = 0) const noexcept {
+    return find_first(begin, [](std::uint64_t word) { return word; });
+  }
+
+  // Index of the first clear bit at or after begin, size() if there is none
+  Size find_first_clear(Size begin = 0) const noexcept {
+    return find_first(begin, [](std::uint64_t word) { return ~word; });
+  }
+
+  // Calls f with the index of every set bit in increasing order
+  template <typename F> void for_each_set_bit(F &&f) const {
+    auto const full_word_count = _size >> 6;
+    for (auto n = Size{}; n != full_word_count; ++n) {
+      for (auto word = _data[n]; word != 0; word &= word - 1) {
+        f((n << 6) + std::countr_zero(word));
+      }
+    }
+    if (full_word_count != word_count()) {
+      auto word = masked_word(full_word_count);
+      for (; word != 0; word &= word - 1) {
+        f((full_word_count << 6) + std::countr_zero(word));
+      }
+    }
+  }
+
+  bool any() const noexcept {
+    for (auto n = Size{}; n != word_count(); ++n) {
+      if (masked_word(n) != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool none() const noexcept { return !any(); }
+
+  // Whether a bit is set in both lists, which must have the same size
+  bool intersects(Bit_list const &other) const noexcept {
+    assert(other.size() == size());
+    auto const full_word_count = _size >> 6;
+    return detail::bit_list_intersects(
+               _data.data(), other._data.data(), full_word_count) ||
+           (full_word_count != word_count() &&
+            (masked_word(full_word_count) & other._data[full_word_count]) !=
+                0);
+  }
+
+  // The bulk operations combine with a list of the same size
+  Bit_list &operator&=(Bit_list const &other) noexcept {
+    assert(other.size() == size());
+    detail::bit_list_combine<detail::Bit_list_op::and_>(
+        _data.data(), other._data.data(), word_count());
+    return *this;
+  }
+
+  Bit_list &operator|=(Bit_list const &other) noexcept {
+    assert(other.size() == size());
+    detail::bit_list_combine<detail::Bit_list_op::or_>(
+        _data.data(), other._data.data(), word_count());
+    return *this;
+  }
+
+  // Clears every bit that is set in other
+  Bit_list &and_not(Bit_list const &other) noexcept {
+    assert(other.size() == size());
+    detail::bit_list_combine<detail::Bit_list_op::and_not>(
+        _data.data(), other._data.data(), word_count());
+    return *this;
+  }
+
   void resize(Size count) {
     if (max_size() < count) {
       throw Capacity_error{"Capacity_error in Bit_list::resize"};
@@ -147,6 +346,34 @@ public:
   }
 
 private:
+  constexpr Size word_count() const noexcept { return (_size + 63) >> 6; }
+
+  // The nth word with the bits past size() cleared
+  constexpr std::uint64_t masked_word(Size n) const noexcept {
+    auto const bit_count = _size - (n << 6);
+    return bit_count >= 64
+               ? _data[n]
+               : _data[n] & ((std::uint64_t{1} << bit_count) - 1);
+  }
+
+  template <typename Transform>
+  Size find_first(Size begin, Transform transform) const noexcept {
+    if (begin >= _size) {
+      return _size;
+    }
+    auto n = begin >> 6;
+    auto word = transform(_data[n]) & (~std::uint64_t{} << (begin & 63));
+    for (;;) {
+      if (word != 0) {
+        return std::min((n << 6) + std::countr_zero(word), _size);
+      }
+      if (++n == word_count()) {
+        return _size;
+      }
+      word = transform(_data[n]);
+    }
+  }
+
   constexpr void swap(Bit_list &other) noexcept {
     std::swap(_data, other._data);
     std::swap(_size, other._size);
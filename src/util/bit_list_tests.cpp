@@ -1,34 +1,39 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 #include "bit_list.h"
 
 namespace marlon {
 namespace util {
 TEST_CASE("marlon::util::Bit_list") {
-  auto constexpr requested_max_size = std::size_t{100};
+  auto constexpr requested_max_size = Size{100};
+  auto allocator = System_allocator{};
   auto [block, bit_list] =
-      Bit_list::make(*System_allocator::instance(), requested_max_size);
+      Bit_list::make(allocator, requested_max_size);
   REQUIRE(bit_list.max_size() >= requested_max_size);
   REQUIRE(bit_list.capacity() >= requested_max_size);
-  for (auto i{std::size_t{}}; i != requested_max_size; ++i) {
+  for (auto i{Size{}}; i != requested_max_size; ++i) {
     bit_list.push_back(true);
   }
-  for (auto i{std::size_t{}}; i != requested_max_size; ++i) {
+  for (auto i{Size{}}; i != requested_max_size; ++i) {
     REQUIRE(bit_list.get(i) == true);
   }
   REQUIRE(bit_list.size() == requested_max_size);
   bit_list.clear();
   REQUIRE(bit_list.size() == 0);
-  for (auto i{std::size_t{}}; i != requested_max_size; ++i) {
+  for (auto i{Size{}}; i != requested_max_size; ++i) {
     bit_list.push_back(false);
   }
-  for (auto i{std::size_t{}}; i != requested_max_size; ++i) {
+  for (auto i{Size{}}; i != requested_max_size; ++i) {
     REQUIRE(bit_list.get(i) == false);
   }
   REQUIRE(bit_list.size() == requested_max_size);
   bit_list.clear();
   REQUIRE(bit_list.size() == 0);
-  for (auto i{std::size_t{}}; i != requested_max_size; ++i) {
+  for (auto i{Size{}}; i != requested_max_size; ++i) {
     bit_list.push_back(i % 2 == 0);
   }
   REQUIRE(bit_list.size() == requested_max_size);
@@ -36,14 +41,97 @@ TEST_CASE("marlon::util::Bit_list") {
   REQUIRE(bit_list.size() == 16);
   bit_list.resize(requested_max_size);
   REQUIRE(bit_list.size() == requested_max_size);
-  for (auto i{std::size_t{}}; i != requested_max_size; ++i) {
+  for (auto i{Size{}}; i != requested_max_size; ++i) {
     if (i < 16) {
       REQUIRE(bit_list.get(i) == (i % 2 == 0));
     } else {
       REQUIRE(bit_list.get(i) == false);
     }
   }
-  System_allocator::instance()->free(block);
+  allocator.free(block);
+}
+
+TEST_CASE("marlon::util::Bit_list word operations") {
+  auto const empty_bits = Bit_list{};
+  REQUIRE(empty_bits.count() == 0);
+  REQUIRE(empty_bits.none());
+  REQUIRE(empty_bits.find_first_set() == 0);
+  REQUIRE(empty_bits.find_first_clear() == 0);
+  REQUIRE(empty_bits.select(0) == 0);
+  auto random_engine = std::mt19937{42};
+  for (auto const size : {1, 63, 64, 65, 200, 1000}) {
+    auto const block = Unique_block<>{Bit_list::memory_requirement(size)};
+    auto const other_block =
+        Unique_block<>{Bit_list::memory_requirement(size)};
+    auto bits = Bit_list{block.get(), size};
+    auto other_bits = Bit_list{other_block.get(), size};
+    // leaves garbage past the size of the last word
+    bits.set();
+    other_bits.set();
+    bits.resize(size);
+    other_bits.resize(size);
+    auto expected = std::vector<bool>(size);
+    auto other_expected = std::vector<bool>(size);
+    for (auto i = 0; i != size; ++i) {
+      // sparse, so that whole words are empty
+      expected[i] = random_engine() % 16 == 0;
+      other_expected[i] = random_engine() % 2 == 0;
+      bits.set(i, expected[i]);
+      other_bits.set(i, other_expected[i]);
+    }
+    auto const set_indices = [&] {
+      auto result = std::vector<Size>{};
+      bits.for_each_set_bit([&](Size i) { result.emplace_back(i); });
+      return result;
+    };
+    auto expected_set_indices = std::vector<Size>{};
+    for (auto i = 0; i != size; ++i) {
+      if (expected[i]) {
+        expected_set_indices.emplace_back(i);
+      }
+    }
+    REQUIRE(set_indices() == expected_set_indices);
+    REQUIRE(bits.count() == static_cast<Size>(expected_set_indices.size()));
+    REQUIRE(bits.any() == !expected_set_indices.empty());
+    for (auto i = 0; i <= size; ++i) {
+      auto const rank = std::ranges::count(expected.begin(),
+                                           expected.begin() + i, true);
+      REQUIRE(bits.rank(i) == rank);
+      auto const first_set = std::ranges::find(
+          expected.begin() + i, expected.end(), true);
+      REQUIRE(bits.find_first_set(i) == first_set - expected.begin());
+      auto const first_clear = std::ranges::find(
+          expected.begin() + i, expected.end(), false);
+      REQUIRE(bits.find_first_clear(i) == first_clear - expected.begin());
+    }
+    for (auto rank = Size{}; rank <= bits.count(); ++rank) {
+      REQUIRE(bits.select(rank) ==
+              (rank < bits.count() ? expected_set_indices[rank] : size));
+    }
+    auto intersects = false;
+    for (auto i = 0; i != size; ++i) {
+      intersects = intersects || (expected[i] && other_expected[i]);
+    }
+    REQUIRE(bits.intersects(other_bits) == intersects);
+    bits |= other_bits;
+    for (auto i = 0; i != size; ++i) {
+      REQUIRE(bits.get(i) == (expected[i] || other_expected[i]));
+    }
+    bits.and_not(other_bits);
+    for (auto i = 0; i != size; ++i) {
+      REQUIRE(bits.get(i) == (expected[i] && !other_expected[i]));
+    }
+    REQUIRE(!bits.intersects(other_bits));
+    bits.set();
+    bits &= other_bits;
+    for (auto i = 0; i != size; ++i) {
+      REQUIRE(bits.get(i) == other_expected[i]);
+    }
+    bits.reset();
+    REQUIRE(bits.none());
+    REQUIRE(bits.find_first_set() == size);
+    REQUIRE(bits.select(0) == size);
+  }
 }
 } // namespace util
 } // namespace marlon
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "co_task.h"
+
+#include <thread>
+
+namespace marlon {
+namespace util {
+namespace {
+class Spin_lock_guard {
+public:
+  explicit Spin_lock_guard(std::atomic_flag *flag) noexcept : _flag{flag} {
+    while (_flag->test_and_set(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+
+  Spin_lock_guard(Spin_lock_guard const &other) = delete;
+
+  Spin_lock_guard &operator=(Spin_lock_guard const &other) = delete;
+
+  ~Spin_lock_guard() { _flag->clear(std::memory_order_release); }
+
+private:
+  std::atomic_flag *_flag;
+};
+} // namespace
+
+Block Co_frame_allocator::alloc(Size size) {
+  if (size > max_frame_size) {
+    throw std::bad_alloc{};
+  }
+  auto const lock = Spin_lock_guard{&_locked};
+  return _pool.alloc(size);
+}
+
+void Co_frame_allocator::free(Const_block block) noexcept {
+  auto const lock = Spin_lock_guard{&_locked};
+  _pool.free(block);
+}
+
+void Co_event::set() {
+  auto const state = _state.exchange(this, std::memory_order_acq_rel);
+  if (state != nullptr && state != this) {
+    detail::co_resume_on(
+        *_pool, _resume_task, std::coroutine_handle<>::from_address(state));
+  }
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,428 @@
+#ifndef MARLON_UTIL_CO_TASK_H
+#define MARLON_UTIL_CO_TASK_H
+
+#include <cstring>
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <utility>
+
+#include "memory.h"
+#include "thread_pool.h"
+
+namespace marlon {
+namespace util {
+// Fixed capacity pool of coroutine frames. Every coroutine returning a
+// Co_task takes a Co_frame_allocator & as its first parameter (after the
+// object parameter for member functions), its frame comes from that
+// allocator. Allocation and deallocation may happen on any thread.
+class Co_frame_allocator {
+public:
+  // frames larger than this throw std::bad_alloc
+  static constexpr auto max_frame_size = Size{1024};
+
+  template <typename Allocator>
+  static std::pair<Block, Co_frame_allocator>
+  make(Allocator &allocator, Size max_frame_count) {
+    auto const block = allocator.alloc(memory_requirement(max_frame_count));
+    return {block, Co_frame_allocator{block}};
+  }
+
+  static constexpr Size memory_requirement(Size max_frame_count) noexcept {
+    return Frame_pool::memory_requirement(max_frame_count);
+  }
+
+  Co_frame_allocator() noexcept = default;
+
+  explicit Co_frame_allocator(Block block) noexcept : _pool{block} {}
+
+  Co_frame_allocator(Co_frame_allocator &&other) noexcept
+      : _pool{std::exchange(other._pool, {})} {}
+
+  Co_frame_allocator &operator=(Co_frame_allocator &&other) noexcept {
+    auto temp{std::move(other)};
+    std::swap(_pool, temp._pool);
+    return *this;
+  }
+
+  Const_block block() const noexcept { return _pool.block(); }
+
+  Size max_frame_count() const noexcept { return _pool.max_blocks(); }
+
+  Block alloc(Size size);
+
+  void free(Const_block block) noexcept;
+
+private:
+  using Frame_pool = Pool_allocator<1, max_frame_size>;
+
+  Frame_pool _pool;
+  std::atomic_flag _locked{};
+};
+
+namespace detail {
+// Completion counter of a when_all, the last task to finish resumes the
+// continuation
+struct Co_join {
+  std::atomic<Size> remaining_count;
+  std::coroutine_handle<> continuation;
+};
+
+class Co_resume_task final : public Task {
+public:
+  void run(Size) final { _handle.resume(); }
+
+  std::coroutine_handle<> _handle;
+};
+
+// Pushes a task resuming handle to the pool. If the calling thread's queue is
+// full the pool resumes the coroutine on the calling thread instead.
+inline void co_resume_on(Thread_pool &pool,
+                         Co_resume_task &task,
+                         std::coroutine_handle<> handle) {
+  task._handle = handle;
+  pool.push_notify(&task);
+}
+
+class Co_promise_base {
+public:
+  class Final_awaiter {
+  public:
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<Promise> handle) const noexcept {
+      auto &promise = static_cast<Co_promise_base &>(handle.promise());
+      auto const join = promise._join;
+      auto const continuation = promise._continuation;
+      // the frame may be destroyed by another thread from here on
+      promise._done.store(true, std::memory_order_release);
+      if (join != nullptr) {
+        if (join->remaining_count.fetch_sub(1, std::memory_order_acq_rel) ==
+            1) {
+          return join->continuation;
+        }
+        return std::noop_coroutine();
+      }
+      return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  // the frame allocator's address is stored after the frame. gcc reports these
+  // as mismatched with operator delete since they are templates, the build
+  // turns -Wmismatched-new-delete off for users of util.
+  template <typename... Args>
+  static void *operator new(std::size_t size,
+                            Co_frame_allocator &allocator,
+                            Args const &...) {
+    return alloc_frame(size, allocator);
+  }
+
+  template <typename Object, typename... Args>
+  static void *operator new(std::size_t size,
+                            Object const &,
+                            Co_frame_allocator &allocator,
+                            Args const &...) {
+    return alloc_frame(size, allocator);
+  }
+
+  static void operator delete(void *frame, std::size_t size) noexcept {
+    auto const offset = allocator_offset(size);
+    auto allocator = static_cast<Co_frame_allocator *>(nullptr);
+    std::memcpy(&allocator,
+                static_cast<std::byte *>(frame) + offset,
+                sizeof(allocator));
+    allocator->free(
+        {static_cast<std::byte *>(frame), offset + Size{sizeof(allocator)}});
+  }
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+
+  Final_awaiter final_suspend() const noexcept { return {}; }
+
+  void unhandled_exception() noexcept {
+    _exception = std::current_exception();
+  }
+
+  bool done() const noexcept { return _done.load(std::memory_order_acquire); }
+
+  void start(Thread_pool &pool,
+             Co_join *join,
+             std::coroutine_handle<> handle) {
+    _join = join;
+    co_resume_on(pool, _resume_task, handle);
+  }
+
+  std::coroutine_handle<> _continuation;
+
+protected:
+  void rethrow_if_failed() const {
+    if (_exception) {
+      std::rethrow_exception(_exception);
+    }
+  }
+
+private:
+  static constexpr Size allocator_offset(std::size_t frame_size) noexcept {
+    constexpr auto alignment = alignof(Co_frame_allocator *);
+    return (static_cast<Size>(frame_size) + alignment - 1) & ~(alignment - 1);
+  }
+
+  static void *alloc_frame(std::size_t size, Co_frame_allocator &allocator) {
+    auto const offset = allocator_offset(size);
+    auto const block = allocator.alloc(offset + Size{sizeof(&allocator)});
+    auto const allocator_address = &allocator;
+    std::memcpy(block.begin + offset,
+                &allocator_address,
+                sizeof(allocator_address));
+    return block.begin;
+  }
+
+  Co_join *_join{};
+  std::atomic<bool> _done{};
+  std::exception_ptr _exception;
+  Co_resume_task _resume_task;
+};
+
+template <typename T> class Co_promise;
+} // namespace detail
+
+// Lazily started coroutine. A Co_task runs either when it is awaited from
+// another coroutine, on the awaiting thread, or when it is started on a
+// Thread_pool, in which case completion can be polled with done() without
+// blocking. Awaiters in this file resume coroutines on the pool's workers.
+template <typename T = void> class [[nodiscard]] Co_task {
+public:
+  using promise_type = detail::Co_promise<T>;
+
+  constexpr Co_task() noexcept = default;
+
+  explicit Co_task(std::coroutine_handle<promise_type> handle) noexcept
+      : _handle{handle} {}
+
+  Co_task(Co_task &&other) noexcept
+      : _handle{std::exchange(other._handle, {})} {}
+
+  Co_task &operator=(Co_task &&other) noexcept {
+    auto temp{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  // Must not be destroyed while it is running
+  ~Co_task() {
+    if (_handle) {
+      _handle.destroy();
+    }
+  }
+
+  bool valid() const noexcept { return static_cast<bool>(_handle); }
+
+  std::coroutine_handle<promise_type> handle() const noexcept {
+    return _handle;
+  }
+
+  // Safe to call from any thread while the task is running
+  bool done() const noexcept { return _handle.promise().done(); }
+
+  // Runs the task on pool. May only be called once, and not on a task that
+  // is awaited.
+  void start(Thread_pool &pool) {
+    _handle.promise().start(pool, nullptr, _handle);
+  }
+
+  // Returns the task's result or rethrows its exception. Requires done().
+  T result() { return _handle.promise().result(); }
+
+  auto operator co_await() const noexcept {
+    struct Awaiter {
+      bool await_ready() const noexcept { return false; }
+
+      std::coroutine_handle<>
+      await_suspend(std::coroutine_handle<> continuation) const noexcept {
+        handle.promise()._continuation = continuation;
+        return handle;
+      }
+
+      T await_resume() const { return handle.promise().result(); }
+
+      std::coroutine_handle<promise_type> handle;
+    };
+    return Awaiter{_handle};
+  }
+
+private:
+  void swap(Co_task &other) noexcept { std::swap(_handle, other._handle); }
+
+  std::coroutine_handle<promise_type> _handle;
+};
+
+namespace detail {
+template <typename T> class Co_promise : public Co_promise_base {
+public:
+  Co_task<T> get_return_object() noexcept {
+    return Co_task<T>{std::coroutine_handle<Co_promise>::from_promise(*this)};
+  }
+
+  template <typename U> void return_value(U &&value) {
+    _value.emplace(std::forward<U>(value));
+  }
+
+  T result() {
+    rethrow_if_failed();
+    return std::move(*_value);
+  }
+
+private:
+  std::optional<T> _value;
+};
+
+template <> class Co_promise<void> : public Co_promise_base {
+public:
+  Co_task<void> get_return_object() noexcept {
+    return Co_task<void>{
+        std::coroutine_handle<Co_promise>::from_promise(*this)};
+  }
+
+  void return_void() const noexcept {}
+
+  void result() const { rethrow_if_failed(); }
+};
+
+template <typename Start_all> class Co_when_all_awaiter {
+public:
+  explicit Co_when_all_awaiter(Thread_pool *pool,
+                               Size task_count,
+                               Start_all start_all) noexcept
+      : _pool{pool}, _task_count{task_count}, _start_all{start_all} {}
+
+  bool await_ready() const noexcept { return _task_count == 0; }
+
+  bool await_suspend(std::coroutine_handle<> continuation) {
+    _join.continuation = continuation;
+    // one extra count keeps the tasks from resuming the continuation before
+    // all of them are started
+    _join.remaining_count.store(_task_count + 1, std::memory_order_relaxed);
+    _start_all(*_pool, &_join);
+    return _join.remaining_count.fetch_sub(1, std::memory_order_acq_rel) != 1;
+  }
+
+  void await_resume() const noexcept {}
+
+private:
+  Thread_pool *_pool;
+  Size _task_count;
+  Start_all _start_all;
+  Co_join _join;
+};
+} // namespace detail
+
+// co_await schedule(pool) resumes the awaiting coroutine on one of pool's
+// workers
+class Co_schedule_awaiter {
+public:
+  explicit Co_schedule_awaiter(Thread_pool *pool) noexcept : _pool{pool} {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    detail::co_resume_on(*_pool, _task, handle);
+  }
+
+  void await_resume() const noexcept {}
+
+private:
+  Thread_pool *_pool;
+  detail::Co_resume_task _task;
+};
+
+inline Co_schedule_awaiter schedule(Thread_pool &pool) noexcept {
+  return Co_schedule_awaiter{&pool};
+}
+
+// Starts every task on pool and resumes the awaiting coroutine once all of
+// them are done, on the thread that finished last. Results are read with
+// Co_task::result afterwards.
+template <typename T, std::size_t Extent>
+auto when_all(Thread_pool &pool, std::span<Co_task<T>, Extent> tasks) noexcept {
+  auto const start_all = [tasks](Thread_pool &pool, detail::Co_join *join) {
+    for (auto &task : tasks) {
+      task.handle().promise().start(pool, join, task.handle());
+    }
+  };
+  return detail::Co_when_all_awaiter<decltype(start_all)>{
+      &pool, static_cast<Size>(tasks.size()), start_all};
+}
+
+template <typename... Ts>
+auto when_all(Thread_pool &pool, Co_task<Ts> &...tasks) noexcept {
+  auto const start_all = [handles = std::tuple{tasks.handle()...}](
+                             Thread_pool &pool, detail::Co_join *join) {
+    std::apply(
+        [&](auto... handles) {
+          (handles.promise().start(pool, join, handles), ...);
+        },
+        handles);
+  };
+  return detail::Co_when_all_awaiter<decltype(start_all)>{
+      &pool, Size{sizeof...(Ts)}, start_all};
+}
+
+// One-shot event a coroutine can wait on, e.g. for the completion of an I/O
+// request. The event may be set before or after the coroutine waits on it,
+// the waiting coroutine is resumed on pool.
+class Co_event {
+public:
+  explicit Co_event(Thread_pool *pool) noexcept : _pool{pool} {}
+
+  Co_event(Co_event const &other) = delete;
+
+  Co_event &operator=(Co_event const &other) = delete;
+
+  bool is_set() const noexcept {
+    return _state.load(std::memory_order_acquire) == this;
+  }
+
+  // Must be called from one of pool's workers or from the thread outside of
+  // the pool that pushes tasks to it
+  void set();
+
+  // Rearms the event. No coroutine may be waiting on it.
+  void reset() noexcept { _state.store(nullptr, std::memory_order_relaxed); }
+
+  auto operator co_await() noexcept {
+    struct Awaiter {
+      bool await_ready() const noexcept { return event->is_set(); }
+
+      bool await_suspend(std::coroutine_handle<> handle) noexcept {
+        auto expected = static_cast<void *>(nullptr);
+        return event->_state.compare_exchange_strong(expected,
+                                                     handle.address(),
+                                                     std::memory_order_acq_rel,
+                                                     std::memory_order_acquire);
+      }
+
+      void await_resume() const noexcept {}
+
+      Co_event *event;
+    };
+    return Awaiter{this};
+  }
+
+private:
+  Thread_pool *_pool;
+  // nullptr: not set, this: set, otherwise the waiting coroutine's address
+  std::atomic<void *> _state{};
+  detail::Co_resume_task _resume_task;
+};
+} // namespace util
+} // namespace marlon
+
+#endif
@@ -0,0 +1,114 @@
+#include "co_task.h"
+
+#include <array>
+#include <atomic>
+#include <stdexcept>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+namespace {
+Co_task<int> add(Co_frame_allocator &, Thread_pool &pool, int a, int b) {
+  co_await schedule(pool);
+  co_return a + b;
+}
+
+Co_task<int> sum(Co_frame_allocator &frames, Thread_pool &pool) {
+  co_await schedule(pool);
+  auto const three = co_await add(frames, pool, 1, 2);
+  auto tasks = std::array<Co_task<int>, 8>{};
+  for (auto i = 0; i != 8; ++i) {
+    tasks[i] = add(frames, pool, i, three);
+  }
+  co_await when_all(pool, std::span{tasks});
+  auto result = 0;
+  for (auto &task : tasks) {
+    result += task.result();
+  }
+  co_return result;
+}
+
+Co_task<> fail(Co_frame_allocator &, Thread_pool &pool) {
+  co_await schedule(pool);
+  throw std::runtime_error{"fail"};
+}
+
+Co_task<int> wait_for_event(Co_frame_allocator &,
+                            Thread_pool &pool,
+                            Co_event &event,
+                            std::atomic<bool> &waiting) {
+  co_await schedule(pool);
+  waiting.store(true, std::memory_order_release);
+  co_await event;
+  co_return 7;
+}
+
+template <typename T> void poll(Thread_pool &pool, Co_task<T> const &task) {
+  while (!task.done()) {
+    pool.run_task();
+  }
+}
+} // namespace
+
+TEST_CASE("marlon::util::Co_task") {
+  auto frames_block =
+      Unique_block<>{Co_frame_allocator::memory_requirement(16)};
+  auto frames = Co_frame_allocator{frames_block.get()};
+  for (auto const thread_count : {0, 4}) {
+    auto pool = Thread_pool{thread_count};
+    for (auto i = 0; i != 100; ++i) {
+      auto task = sum(frames, pool);
+      task.start(pool);
+      poll(pool, task);
+      REQUIRE(task.result() == 52);
+    }
+  }
+}
+
+TEST_CASE("marlon::util::Co_task exceptions") {
+  auto frames_block = Unique_block<>{Co_frame_allocator::memory_requirement(4)};
+  auto frames = Co_frame_allocator{frames_block.get()};
+  auto pool = Thread_pool{2};
+  auto failing = fail(frames, pool);
+  auto adding = add(frames, pool, 2, 3);
+  auto both = [](Co_frame_allocator &,
+                 Thread_pool &pool,
+                 Co_task<> &failing,
+                 Co_task<int> &adding) -> Co_task<> {
+    co_await when_all(pool, failing, adding);
+  }(frames, pool, failing, adding);
+  both.start(pool);
+  poll(pool, both);
+  REQUIRE_NOTHROW(both.result());
+  REQUIRE_THROWS_AS(failing.result(), std::runtime_error);
+  REQUIRE(adding.result() == 5);
+  // one frame left
+  auto const last = add(frames, pool, 0, 0);
+  REQUIRE_THROWS_AS(add(frames, pool, 0, 0), std::bad_alloc);
+}
+
+TEST_CASE("marlon::util::Co_event") {
+  auto frames_block = Unique_block<>{Co_frame_allocator::memory_requirement(1)};
+  auto frames = Co_frame_allocator{frames_block.get()};
+  auto pool = Thread_pool{4};
+  auto event = Co_event{&pool};
+  for (auto i = 0; i != 100; ++i) {
+    auto waiting = std::atomic<bool>{};
+    auto task = wait_for_event(frames, pool, event, waiting);
+    task.start(pool);
+    if (i % 2 == 0) {
+      while (!waiting.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+    }
+    REQUIRE(!event.is_set());
+    event.set();
+    REQUIRE(event.is_set());
+    poll(pool, task);
+    REQUIRE(task.result() == 7);
+    event.reset();
+  }
+}
+} // namespace util
+} // namespace marlon
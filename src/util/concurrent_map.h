@@ -0,0 +1,304 @@
+#ifndef MARLON_UTIL_CONCURRENT_MAP_H
+#define MARLON_UTIL_CONCURRENT_MAP_H
+
+#include <cassert>
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "capacity_error.h"
+#include "hash.h"
+#include "memory.h"
+
+namespace marlon {
+namespace util {
+// Fixed capacity map for phases in which many threads insert and find keys
+// at once, followed by a single threaded pass that erases in bulk. Every key
+// is identified by a 64-bit code from Encode, which must be injective and
+// never produce empty_code or busy_code. Hash<K> qualifies for integers,
+// pointers and other keys whose hash is their bit pattern.
+//
+// Slots are claimed with a compare-and-swap on their code. A claimed slot
+// reads busy_code until its element is constructed, threads looking for a
+// key spin on such slots, so an element is never seen half built. The
+// table is at most half full, which keeps linear probing short, and it never
+// rehashes; erase_if closes gaps by shifting elements back instead of
+// leaving tombstones.
+template <typename K, typename V, typename Encode = Hash<K>>
+class Concurrent_map {
+  static_assert(std::is_nothrow_move_constructible_v<std::pair<K, V>>);
+
+public:
+  using Value_type = std::pair<K, V>;
+
+  static constexpr auto empty_code = ~std::uint64_t{};
+  static constexpr auto busy_code = empty_code - 1;
+
+  template <typename Allocator>
+  static std::pair<Block, Concurrent_map> make(Allocator &allocator,
+                                               Size max_size) {
+    auto const block = allocator.alloc(memory_requirement(max_size));
+    return {block, Concurrent_map{block, max_size}};
+  }
+
+  static constexpr Size memory_requirement(Size max_size) noexcept {
+    auto const capacity = capacity_for(max_size);
+    return Stack_allocator<alignment>::memory_requirement({
+        capacity * static_cast<Size>(sizeof(std::atomic<std::uint64_t>)),
+        capacity * static_cast<Size>(sizeof(Value_type)),
+    });
+  }
+
+  constexpr Concurrent_map() noexcept = default;
+
+  explicit Concurrent_map(Block block, Size max_size) noexcept
+      : Concurrent_map{block.begin, max_size} {}
+
+  explicit Concurrent_map(void *block, Size max_size) noexcept
+      : _capacity{capacity_for(max_size)},
+        _mask{_capacity - 1},
+        _max_size{max_size} {
+    auto allocator = Stack_allocator<alignment>{
+        {static_cast<std::byte *>(block), memory_requirement(max_size)}};
+    _codes = reinterpret_cast<std::atomic<std::uint64_t> *>(
+        allocator
+            .alloc(_capacity *
+                   static_cast<Size>(sizeof(std::atomic<std::uint64_t>)))
+            .begin);
+    _slots = reinterpret_cast<Value_type *>(
+        allocator.alloc(_capacity * static_cast<Size>(sizeof(Value_type)))
+            .begin);
+    for (auto i = Size{}; i != _capacity; ++i) {
+      new (_codes + i) std::atomic<std::uint64_t>{empty_code};
+    }
+  }
+
+  Concurrent_map(Concurrent_map &&other) noexcept
+      : _codes{std::exchange(other._codes, nullptr)},
+        _slots{std::exchange(other._slots, nullptr)},
+        _capacity{std::exchange(other._capacity, 0)},
+        _mask{std::exchange(other._mask, 0)},
+        _max_size{std::exchange(other._max_size, 0)},
+        _size{other._size.exchange(0, std::memory_order_relaxed)} {}
+
+  Concurrent_map &operator=(Concurrent_map &&other) noexcept {
+    auto temp{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  ~Concurrent_map() { clear(); }
+
+  Const_block block() const noexcept {
+    return _codes != nullptr
+               ? Const_block{reinterpret_cast<std::byte const *>(_codes),
+                             memory_requirement(_max_size)}
+               : Const_block{};
+  }
+
+  bool empty() const noexcept { return size() == 0; }
+
+  Size size() const noexcept { return _size.load(std::memory_order_relaxed); }
+
+  Size max_size() const noexcept { return _max_size; }
+
+  Size capacity() const noexcept { return _capacity; }
+
+  // Thread safe. Constructs the value from args only if key isn't in the
+  // map, and throws Capacity_error if the map is full.
+  template <typename... Args>
+  std::pair<Value_type *, bool> try_emplace(K const &key, Args &&...args) {
+    if (_capacity == 0) {
+      throw Capacity_error{"Capacity_error in Concurrent_map::try_emplace"};
+    }
+    auto const code = static_cast<std::uint64_t>(Encode{}(key));
+    assert(code != empty_code && code != busy_code);
+    for (auto i = home(code);; i = (i + 1) & _mask) {
+      auto current = load_code(i);
+      while (current == empty_code) {
+        if (_codes[i].compare_exchange_strong(current,
+                                              busy_code,
+                                              std::memory_order_relaxed,
+                                              std::memory_order_relaxed)) {
+          return {construct(i, code, key, std::forward<Args>(args)...), true};
+        }
+        if (current == busy_code) {
+          current = load_code(i);
+        }
+      }
+      if (current == code) {
+        return {_slots + i, false};
+      }
+    }
+  }
+
+  // Thread safe, returns nullptr if key isn't in the map
+  Value_type *find(K const &key) noexcept {
+    if (_capacity == 0) {
+      return nullptr;
+    }
+    auto const code = static_cast<std::uint64_t>(Encode{}(key));
+    for (auto i = home(code);; i = (i + 1) & _mask) {
+      auto const current = load_code(i);
+      if (current == code) {
+        return _slots + i;
+      }
+      if (current == empty_code) {
+        return nullptr;
+      }
+    }
+  }
+
+  Value_type const *find(K const &key) const noexcept {
+    return const_cast<Concurrent_map *>(this)->find(key);
+  }
+
+  bool contains(K const &key) const noexcept { return find(key) != nullptr; }
+
+  // Not thread safe. Calls f on every element.
+  template <typename F> void for_each(F &&f) {
+    for (auto i = Size{}; i != _capacity; ++i) {
+      if (raw_code(i) != empty_code) {
+        f(_slots[i]);
+      }
+    }
+  }
+
+  // Not thread safe. Calls pred once on every element and erases those it
+  // returns true for. Returns the number of erased elements.
+  template <typename Pred> Size erase_if(Pred &&pred) {
+    if (_capacity == 0) {
+      return 0;
+    }
+    // starting after an empty slot means that no run of full slots wraps
+    // around past the start, so shifting never moves visited elements
+    auto start = Size{};
+    while (raw_code(start) != empty_code) {
+      ++start;
+    }
+    auto erased = Size{};
+    for (auto n = Size{1}; n <= _capacity;) {
+      auto const i = (start + n) & _mask;
+      if (raw_code(i) != empty_code && pred(_slots[i])) {
+        // another element may have moved into i, so look at i again
+        erase_at(i);
+        ++erased;
+      } else {
+        ++n;
+      }
+    }
+    _size.fetch_sub(erased, std::memory_order_relaxed);
+    return erased;
+  }
+
+  // Not thread safe
+  void clear() noexcept {
+    for (auto i = Size{}; i != _capacity; ++i) {
+      if (raw_code(i) != empty_code) {
+        _slots[i].~Value_type();
+        _codes[i].store(empty_code, std::memory_order_relaxed);
+      }
+    }
+    _size.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr auto alignment =
+      std::max(alignof(Value_type), alignof(std::atomic<std::uint64_t>));
+
+  static constexpr Size capacity_for(Size max_size) noexcept {
+    return max_size != 0 ? static_cast<Size>(std::bit_ceil(
+                               static_cast<std::size_t>(std::max(
+                                   2 * max_size, Size{16}))))
+                         : 0;
+  }
+
+  Size home(std::uint64_t code) const noexcept {
+    return static_cast<Size>(hash_mix(code)) & _mask;
+  }
+
+  // Waits for claimed slots to be published
+  std::uint64_t load_code(Size i) const noexcept {
+    auto result = _codes[i].load(std::memory_order_acquire);
+    while (result == busy_code) {
+      result = _codes[i].load(std::memory_order_acquire);
+    }
+    return result;
+  }
+
+  std::uint64_t raw_code(Size i) const noexcept {
+    return _codes[i].load(std::memory_order_relaxed);
+  }
+
+  template <typename... Args>
+  Value_type *construct(Size i, std::uint64_t code, K const &key,
+                        Args &&...args) {
+    // giving the slot back is safe, everyone waits for busy slots
+    if (_size.fetch_add(1, std::memory_order_relaxed) >= _max_size) {
+      _size.fetch_sub(1, std::memory_order_relaxed);
+      _codes[i].store(empty_code, std::memory_order_release);
+      throw Capacity_error{"Capacity_error in Concurrent_map::try_emplace"};
+    }
+    try {
+      new (_slots + i) Value_type(
+          std::piecewise_construct,
+          std::forward_as_tuple(key),
+          std::forward_as_tuple(std::forward<Args>(args)...));
+    } catch (...) {
+      _size.fetch_sub(1, std::memory_order_relaxed);
+      _codes[i].store(empty_code, std::memory_order_release);
+      throw;
+    }
+    _codes[i].store(code, std::memory_order_release);
+    return _slots + i;
+  }
+
+  // Backward shift deletion, see erase_if
+  void erase_at(Size hole) noexcept {
+    _slots[hole].~Value_type();
+    for (auto i = (hole + 1) & _mask;; i = (i + 1) & _mask) {
+      auto const code = raw_code(i);
+      if (code == empty_code) {
+        break;
+      }
+      // the element can fill the hole if the hole lies between its home
+      // slot and its current one
+      if (((i - home(code)) & _mask) >= ((i - hole) & _mask)) {
+        new (_slots + hole) Value_type(std::move(_slots[i]));
+        _slots[i].~Value_type();
+        _codes[hole].store(code, std::memory_order_relaxed);
+        hole = i;
+      }
+    }
+    _codes[hole].store(empty_code, std::memory_order_relaxed);
+  }
+
+  void swap(Concurrent_map &other) noexcept {
+    std::swap(_codes, other._codes);
+    std::swap(_slots, other._slots);
+    std::swap(_capacity, other._capacity);
+    std::swap(_mask, other._mask);
+    std::swap(_max_size, other._max_size);
+    auto const size = _size.load(std::memory_order_relaxed);
+    _size.store(other._size.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+    other._size.store(size, std::memory_order_relaxed);
+  }
+
+  std::atomic<std::uint64_t> *_codes{};
+  Value_type *_slots{};
+  Size _capacity{};
+  Size _mask{};
+  Size _max_size{};
+  std::atomic<Size> _size{};
+};
+} // namespace util
+} // namespace marlon
+
+#endif
@@ -0,0 +1,81 @@
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <ranges>
+#include <string>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "concurrent_map.h"
+#include "flat_map.h"
+#include "parallel_for.h"
+#include "thread_pool.h"
+
+namespace marlon {
+namespace util {
+namespace {
+constexpr auto bench_grain = Size{1024};
+
+// Keys shaped like object pairs, two 32-bit handles, with every key showing
+// up twice the way persistent pairs are found again on the next step
+std::vector<std::uint64_t> pair_keys(Size size) {
+  auto random_engine = std::mt19937_64{};
+  auto result = std::vector<std::uint64_t>(size);
+  for (auto i = Size{}; i < size; i += 2) {
+    auto const first = static_cast<std::uint32_t>(random_engine() >> 40);
+    auto const second = static_cast<std::uint32_t>(random_engine() >> 40);
+    result[i] = static_cast<std::uint64_t>(first) << 32 | second;
+    if (i + 1 < size) {
+      result[i + 1] = result[i];
+    }
+  }
+  std::shuffle(result.begin(), result.end(), random_engine);
+  return result;
+}
+
+std::string bench_name(std::string const &container,
+                       Size size,
+                       Size thread_count) {
+  return container + ", " + std::to_string(size) + " keys, " +
+         std::to_string(thread_count) + " threads";
+}
+} // namespace
+
+// Every measurement empties the container again, like the broadphase drops
+// the pairs that stopped overlapping
+TEST_CASE("marlon::util::Concurrent_map insertion scaling") {
+  for (auto const size : {Size{10000}, Size{1000000}}) {
+    auto const keys = pair_keys(size);
+    auto const flat_block =
+        Unique_block<>{Flat_map<std::uint64_t, int>::memory_requirement(size)};
+    auto flat_map = Flat_map<std::uint64_t, int>{flat_block.get(), size};
+    BENCHMARK(bench_name("Flat_map", size, 0)) {
+      for (auto const key : keys) {
+        flat_map.try_emplace(key, 0);
+      }
+      flat_map.clear();
+    };
+    using Map = Concurrent_map<std::uint64_t, int>;
+    auto const block = Unique_block<>{Map::memory_requirement(size)};
+    auto map = Map{block.get(), size};
+    for (auto const thread_count : {0, 1, 2, 4, 8}) {
+      auto pool = Thread_pool{thread_count};
+      BENCHMARK(bench_name("Concurrent_map", size, thread_count)) {
+        parallel_for(pool,
+                     std::views::iota(Size{}, size),
+                     bench_grain,
+                     [&](auto range, Size) {
+                       for (auto const i : range) {
+                         map.try_emplace(keys[i], 0);
+                       }
+                     });
+        return map.erase_if([](auto const &) { return true; });
+      };
+    }
+  }
+}
+} // namespace util
+} // namespace marlon
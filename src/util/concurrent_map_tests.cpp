@@ -0,0 +1,131 @@
+#include "concurrent_map.h"
+
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <ranges>
+#include <set>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "parallel_for.h"
+#include "thread_pool.h"
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::Concurrent_map") {
+  using Map = Concurrent_map<std::uint64_t, int>;
+  auto const max_size = 100;
+  auto const block = Unique_block<>{Map::memory_requirement(max_size)};
+  auto map = Map{};
+  REQUIRE(map.size() == 0);
+  REQUIRE(map.find(1) == nullptr);
+  REQUIRE_THROWS_AS(map.try_emplace(1, 1), Capacity_error);
+  map = Map{block.get(), max_size};
+  REQUIRE(map.capacity() >= 2 * max_size);
+  for (auto i = 0; i != max_size; ++i) {
+    auto const [element, inserted] = map.try_emplace(i * 1000, i);
+    REQUIRE(inserted);
+    REQUIRE(element->first == std::uint64_t(i * 1000));
+    REQUIRE(element->second == i);
+  }
+  REQUIRE(map.size() == max_size);
+  REQUIRE_THROWS_AS(map.try_emplace(1, 0), Capacity_error);
+  REQUIRE(map.size() == max_size);
+  auto const [element, inserted] = map.try_emplace(5000, -1);
+  REQUIRE(!inserted);
+  REQUIRE(element->second == 5);
+  for (auto i = 0; i != max_size; ++i) {
+    REQUIRE(map.contains(i * 1000));
+    REQUIRE(!map.contains(i * 1000 + 1));
+  }
+  auto const erased =
+      map.erase_if([](auto const &item) { return item.second % 3 == 0; });
+  REQUIRE(erased == 34);
+  REQUIRE(map.size() == max_size - 34);
+  for (auto i = 0; i != max_size; ++i) {
+    auto const found = map.find(i * 1000);
+    if (i % 3 == 0) {
+      REQUIRE(found == nullptr);
+    } else {
+      REQUIRE(found != nullptr);
+      REQUIRE(found->second == i);
+    }
+  }
+  auto visited = Size{};
+  map.for_each([&](auto const &) { ++visited; });
+  REQUIRE(visited == map.size());
+  map.clear();
+  REQUIRE(map.empty());
+  REQUIRE(map.find(1000) == nullptr);
+}
+
+TEST_CASE("marlon::util::Concurrent_map erase_if with collisions") {
+  using Map = Concurrent_map<std::uint64_t, std::uint64_t>;
+  auto const max_size = 1000;
+  auto const block = Unique_block<>{Map::memory_requirement(max_size)};
+  auto map = Map{block.get(), max_size};
+  auto random_engine = std::mt19937_64{};
+  auto reference = std::set<std::uint64_t>{};
+  for (auto round = 0; round != 20; ++round) {
+    while (map.size() != max_size) {
+      auto const key = random_engine() % 4000;
+      auto const inserted = map.try_emplace(key, key).second;
+      REQUIRE(inserted == reference.insert(key).second);
+    }
+    auto const erased_bit = std::uint64_t{1} << (round % 4);
+    auto calls = Size{};
+    map.erase_if([&](auto const &item) {
+      ++calls;
+      return (item.first & erased_bit) != 0;
+    });
+    REQUIRE(calls == max_size);
+    std::erase_if(reference, [&](auto key) { return (key & erased_bit) != 0; });
+    REQUIRE(map.size() == static_cast<Size>(reference.size()));
+    for (auto key = std::uint64_t{}; key != 4000; ++key) {
+      REQUIRE(map.contains(key) == reference.contains(key));
+    }
+  }
+}
+
+TEST_CASE("marlon::util::Concurrent_map parallel try_emplace") {
+  using Map = Concurrent_map<std::uint64_t, std::uint64_t>;
+  auto const key_count = Size{20000};
+  auto const block = Unique_block<>{Map::memory_requirement(key_count)};
+  auto map = Map{block.get(), key_count};
+  auto pool = Thread_pool{3};
+  // every key is inserted by several iterations at once
+  auto inserted_count = std::atomic<Size>{};
+  parallel_for(pool,
+               std::views::iota(Size{}, 4 * key_count),
+               64,
+               [&](auto range, Size) {
+                 for (auto const i : range) {
+                   auto const key = static_cast<std::uint64_t>(i % key_count);
+                   auto const [element, inserted] =
+                       map.try_emplace(key, key * 7);
+                   REQUIRE(element->second == key * 7);
+                   if (inserted) {
+                     inserted_count.fetch_add(1, std::memory_order_relaxed);
+                   }
+                 }
+               });
+  REQUIRE(inserted_count.load() == key_count);
+  REQUIRE(map.size() == key_count);
+  parallel_for(pool,
+               std::views::iota(Size{}, key_count),
+               64,
+               [&](auto range, Size) {
+                 for (auto const i : range) {
+                   auto const element =
+                       map.find(static_cast<std::uint64_t>(i));
+                   REQUIRE(element != nullptr);
+                   REQUIRE(element->second ==
+                           static_cast<std::uint64_t>(i) * 7);
+                 }
+               });
+}
+} // namespace util
+} // namespace marlon
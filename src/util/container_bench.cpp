@@ -0,0 +1,409 @@
+#include <cstdint>
+
+#include <algorithm>
+#include <bit>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "bit_list.h"
+#include "flat_map.h"
+#include "flat_set.h"
+#include "list.h"
+#include "map.h"
+#include "queue.h"
+#include "set.h"
+
+namespace marlon {
+namespace util {
+namespace {
+constexpr Size bench_sizes[]{100, 10000, 1000000};
+
+// Stands in for the objects the pointer keys point to, never dereferenced
+struct Pool_object {
+  std::byte data[96];
+};
+
+// Keys shaped like physics::Object handles: the type in the top 2 bits, a
+// small generation in the next 8 bits and a densely packed slot index
+std::vector<std::uint32_t> handle_keys(Size size) {
+  auto random_engine = std::mt19937{};
+  auto result = std::vector<std::uint32_t>(size);
+  for (auto i = Size{}; i != size; ++i) {
+    auto const type = static_cast<std::uint32_t>(random_engine() % 3);
+    auto const generation = static_cast<std::uint32_t>(random_engine() % 4);
+    result[i] = type << 30 | generation << 22 | static_cast<std::uint32_t>(i);
+  }
+  std::ranges::shuffle(result, random_engine);
+  return result;
+}
+
+// Keys shaped like pointers into a pool of objects: one base address and a
+// fixed stride, so the low bits are all the same
+std::vector<Pool_object const *> pointer_keys(Size size) {
+  auto random_engine = std::mt19937{};
+  auto result = std::vector<Pool_object const *>(size);
+  auto const base = std::uintptr_t{0x7f3a12340000};
+  for (auto i = Size{}; i != size; ++i) {
+    result[i] = std::bit_cast<Pool_object const *>(
+        base + static_cast<std::uintptr_t>(i) * sizeof(Pool_object));
+  }
+  std::ranges::shuffle(result, random_engine);
+  return result;
+}
+
+template <typename Key> std::vector<Key> shuffled(std::vector<Key> keys) {
+  auto random_engine = std::mt19937{1};
+  std::ranges::shuffle(keys, random_engine);
+  return keys;
+}
+
+std::uint64_t key_bits(std::uint32_t key) noexcept { return key; }
+
+std::uint64_t key_bits(Pool_object const *key) noexcept {
+  return std::bit_cast<std::uintptr_t>(key);
+}
+
+template <typename K, typename V>
+std::uint64_t key_bits(std::pair<K, V> const &element) noexcept {
+  return key_bits(element.first);
+}
+
+std::string bench_name(std::string const &container,
+                       std::string const &operation,
+                       Size size,
+                       char const *distribution) {
+  return container + " " + operation + ", " + std::to_string(size) + " " +
+         distribution + " keys";
+}
+
+// Insertions clear the container again as part of the measurement, erasures
+// insert every key first, so only differences between the contenders mean
+// something.
+template <typename Container, typename Key, typename Insert>
+void bench_associative(std::string const &container_name,
+                       Container &container,
+                       std::vector<Key> const &keys,
+                       std::vector<Key> const &lookups,
+                       char const *distribution,
+                       Insert insert) {
+  auto const size = static_cast<Size>(keys.size());
+  BENCHMARK(bench_name(container_name, "insert", size, distribution)) {
+    for (auto const key : keys) {
+      insert(container, key);
+    }
+    container.clear();
+  };
+  BENCHMARK(bench_name(container_name, "insert, erase", size, distribution)) {
+    for (auto const key : keys) {
+      insert(container, key);
+    }
+    for (auto const key : lookups) {
+      container.erase(key);
+    }
+    return container.size();
+  };
+  for (auto const key : keys) {
+    insert(container, key);
+  }
+  BENCHMARK(bench_name(container_name, "find", size, distribution)) {
+    auto result = Size{};
+    for (auto const key : lookups) {
+      result += container.find(key) != container.end();
+    }
+    return result;
+  };
+  BENCHMARK(bench_name(container_name, "iterate", size, distribution)) {
+    auto result = std::uint64_t{};
+    for (auto const &element : container) {
+      result += key_bits(element);
+    }
+    return result;
+  };
+  container.clear();
+}
+
+template <typename Key>
+void bench_sets(std::vector<Key> const &keys, char const *distribution) {
+  auto const size = static_cast<Size>(keys.size());
+  auto const lookups = shuffled(keys);
+  auto const insert = [](auto &set, Key key) { set.insert(key); };
+  auto const set_block = Unique_block<>{Set<Key>::memory_requirement(size)};
+  auto set = Set<Key>{set_block.get(), size};
+  bench_associative("Set", set, keys, lookups, distribution, insert);
+  auto const flat_set_block =
+      Unique_block<>{Flat_set<Key>::memory_requirement(size)};
+  auto flat_set = Flat_set<Key>{flat_set_block.get(), size};
+  bench_associative("Flat_set", flat_set, keys, lookups, distribution, insert);
+  auto std_set = std::unordered_set<Key>{};
+  std_set.reserve(size);
+  bench_associative(
+      "std::unordered_set", std_set, keys, lookups, distribution, insert);
+}
+
+template <typename Key>
+void bench_maps(std::vector<Key> const &keys, char const *distribution) {
+  auto const size = static_cast<Size>(keys.size());
+  auto const lookups = shuffled(keys);
+  auto const insert = [](auto &map, Key key) { map.emplace(key, 0); };
+  auto const map_block =
+      Unique_block<>{Map<Key, int>::memory_requirement(size)};
+  auto map = Map<Key, int>{map_block.get(), size};
+  bench_associative("Map", map, keys, lookups, distribution, insert);
+  auto const flat_map_block =
+      Unique_block<>{Flat_map<Key, int>::memory_requirement(size)};
+  auto flat_map = Flat_map<Key, int>{flat_map_block.get(), size};
+  bench_associative("Flat_map", flat_map, keys, lookups, distribution, insert);
+  auto std_map = std::unordered_map<Key, int>{};
+  std_map.reserve(size);
+  bench_associative(
+      "std::unordered_map", std_map, keys, lookups, distribution, insert);
+}
+
+struct Allocation_counter {
+  Size current_bytes;
+};
+
+// Counts the bytes a standard container holds on to
+template <typename T> class Counting_allocator {
+public:
+  using value_type = T;
+
+  explicit Counting_allocator(Allocation_counter *counter) noexcept
+      : _counter{counter} {}
+
+  template <typename U>
+  Counting_allocator(Counting_allocator<U> const &other) noexcept
+      : _counter{other.counter()} {}
+
+  Allocation_counter *counter() const noexcept { return _counter; }
+
+  T *allocate(std::size_t count) {
+    _counter->current_bytes += static_cast<Size>(count * sizeof(T));
+    return std::allocator<T>{}.allocate(count);
+  }
+
+  void deallocate(T *pointer, std::size_t count) noexcept {
+    _counter->current_bytes -= static_cast<Size>(count * sizeof(T));
+    std::allocator<T>{}.deallocate(pointer, count);
+  }
+
+  template <typename U>
+  bool operator==(Counting_allocator<U> const &other) const noexcept {
+    return _counter == other.counter();
+  }
+
+private:
+  Allocation_counter *_counter;
+};
+
+void print_bytes_per_element(std::string const &container,
+                             Size size,
+                             Size bytes) {
+  std::cout << container << ", " << size << " elements: "
+            << static_cast<double>(bytes) / static_cast<double>(size)
+            << " bytes per element\n";
+}
+
+// Fixed capacity containers are sized for exactly size elements, the
+// standard ones grow as usual
+template <typename Key> void print_memory_per_element(Size size) {
+  print_bytes_per_element("Set", size, Set<Key>::memory_requirement(size));
+  print_bytes_per_element(
+      "Flat_set", size, Flat_set<Key>::memory_requirement(size));
+  print_bytes_per_element(
+      "Map<K, int>", size, Map<Key, int>::memory_requirement(size));
+  print_bytes_per_element(
+      "Flat_map<K, int>", size, Flat_map<Key, int>::memory_requirement(size));
+  auto counter = Allocation_counter{};
+  {
+    auto set = std::unordered_set<Key,
+                                  std::hash<Key>,
+                                  std::equal_to<Key>,
+                                  Counting_allocator<Key>>{
+        Counting_allocator<Key>{&counter}};
+    for (auto i = Size{}; i != size; ++i) {
+      set.insert(static_cast<Key>(i));
+    }
+    print_bytes_per_element(
+        "std::unordered_set", size, counter.current_bytes);
+  }
+  {
+    using Pair = std::pair<Key const, int>;
+    auto map = std::unordered_map<Key,
+                                  int,
+                                  std::hash<Key>,
+                                  std::equal_to<Key>,
+                                  Counting_allocator<Pair>>{
+        Counting_allocator<Pair>{&counter}};
+    for (auto i = Size{}; i != size; ++i) {
+      map.emplace(static_cast<Key>(i), 0);
+    }
+    print_bytes_per_element(
+        "std::unordered_map<K, int>", size, counter.current_bytes);
+  }
+  {
+    auto deque = std::deque<Key, Counting_allocator<Key>>{
+        Counting_allocator<Key>{&counter}};
+    for (auto i = Size{}; i != size; ++i) {
+      deque.push_back(static_cast<Key>(i));
+    }
+    print_bytes_per_element("std::deque", size, counter.current_bytes);
+  }
+  print_bytes_per_element("Queue", size, Queue<Key>::memory_requirement(size));
+  print_bytes_per_element(
+      "Bit_list", size, Bit_list::memory_requirement(size));
+  {
+    auto bits = std::vector<bool, Counting_allocator<bool>>{
+        Counting_allocator<bool>{&counter}};
+    for (auto i = Size{}; i != size; ++i) {
+      bits.push_back(i % 3 == 0);
+    }
+    print_bytes_per_element("std::vector<bool>", size, counter.current_bytes);
+  }
+}
+} // namespace
+
+TEST_CASE("marlon::util::Set and Flat_set versus std::unordered_set") {
+  for (auto const size : bench_sizes) {
+    bench_sets(handle_keys(size), "handle");
+    bench_sets(pointer_keys(size), "pointer");
+  }
+}
+
+TEST_CASE("marlon::util::Map and Flat_map versus std::unordered_map") {
+  for (auto const size : bench_sizes) {
+    bench_maps(handle_keys(size), "handle");
+    bench_maps(pointer_keys(size), "pointer");
+  }
+}
+
+TEST_CASE("marlon::util::List versus std::vector") {
+  for (auto const size : bench_sizes) {
+    auto const list_block = Unique_block<>{List<int>::memory_requirement(size)};
+    auto list = List<int>{list_block.get(), size};
+    auto vector = std::vector<int>{};
+    vector.reserve(size);
+    auto const name = [&](char const *container, char const *operation) {
+      return std::string{container} + " " + operation + ", " +
+             std::to_string(size) + " elements";
+    };
+    BENCHMARK(name("List", "push_back")) {
+      for (auto i = 0; i != size; ++i) {
+        list.push_back(i);
+      }
+      list.clear();
+    };
+    BENCHMARK(name("std::vector", "push_back")) {
+      for (auto i = 0; i != size; ++i) {
+        vector.push_back(i);
+      }
+      vector.clear();
+    };
+    for (auto i = 0; i != size; ++i) {
+      list.push_back(i);
+      vector.push_back(i);
+    }
+    BENCHMARK(name("List", "iterate")) {
+      auto result = std::int64_t{};
+      for (auto const value : list) {
+        result += value;
+      }
+      return result;
+    };
+    BENCHMARK(name("std::vector", "iterate")) {
+      auto result = std::int64_t{};
+      for (auto const value : vector) {
+        result += value;
+      }
+      return result;
+    };
+  }
+}
+
+// Every element passes through the queue once, like a breadth first
+// traversal
+TEST_CASE("marlon::util::Queue versus std::deque") {
+  for (auto const size : bench_sizes) {
+    auto const queue_block =
+        Unique_block<>{Queue<int>::memory_requirement(size)};
+    auto queue = Queue<int>{queue_block.get(), size};
+    auto deque = std::deque<int>{};
+    auto const name = [&](char const *container) {
+      return std::string{container} + " push_back, pop_front, " +
+             std::to_string(size) + " elements";
+    };
+    BENCHMARK(name("Queue")) {
+      auto result = std::int64_t{};
+      for (auto i = 0; i != size; ++i) {
+        queue.push_back(i);
+      }
+      while (!queue.empty()) {
+        result += queue.front();
+        queue.pop_front();
+      }
+      return result;
+    };
+    BENCHMARK(name("std::deque")) {
+      auto result = std::int64_t{};
+      for (auto i = 0; i != size; ++i) {
+        deque.push_back(i);
+      }
+      while (!deque.empty()) {
+        result += deque.front();
+        deque.pop_front();
+      }
+      return result;
+    };
+  }
+}
+
+TEST_CASE("marlon::util::Bit_list versus std::vector<bool>") {
+  for (auto const size : bench_sizes) {
+    auto const bits_block =
+        Unique_block<>{Bit_list::memory_requirement(size)};
+    auto bits = Bit_list{bits_block.get(), size};
+    auto vector = std::vector<bool>{};
+    vector.reserve(size);
+    auto const name = [&](char const *container, char const *operation) {
+      return std::string{container} + " " + operation + ", " +
+             std::to_string(size) + " bits";
+    };
+    BENCHMARK(name("Bit_list", "push_back")) {
+      for (auto i = Size{}; i != size; ++i) {
+        bits.push_back(i % 3 == 0);
+      }
+      bits.clear();
+    };
+    BENCHMARK(name("std::vector<bool>", "push_back")) {
+      for (auto i = Size{}; i != size; ++i) {
+        vector.push_back(i % 3 == 0);
+      }
+      vector.clear();
+    };
+    for (auto i = Size{}; i != size; ++i) {
+      bits.push_back(i % 3 == 0);
+      vector.push_back(i % 3 == 0);
+    }
+    BENCHMARK(name("Bit_list", "count")) { return bits.count(); };
+    BENCHMARK(name("std::vector<bool>", "count")) {
+      return std::ranges::count(vector, true);
+    };
+  }
+}
+
+TEST_CASE("marlon::util containers memory per element") {
+  for (auto const size : bench_sizes) {
+    print_memory_per_element<std::uint32_t>(size);
+  }
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,183 @@
+#include "cpu_topology.h"
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace marlon {
+namespace util {
+namespace {
+#ifdef __linux__
+auto const sysfs_cpu_path = std::filesystem::path{"/sys/devices/system/cpu"};
+
+int read_int(std::filesystem::path const &path, int fallback) {
+  auto file = std::ifstream{path};
+  auto result = fallback;
+  if (!(file >> result)) {
+    return fallback;
+  }
+  return result;
+}
+
+// Parses the kernel's cpu list format, e.g. "0-3,8,10-11"
+template <typename F> bool for_each_in_cpu_list(std::string const &list, F f) {
+  auto position = std::size_t{};
+  while (position < list.size()) {
+    auto end = list.find(',', position);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    auto const range = list.substr(position, end - position);
+    auto const dash = range.find('-');
+    try {
+      auto const first = std::stoi(range.substr(0, dash));
+      auto const last =
+          dash != std::string::npos ? std::stoi(range.substr(dash + 1)) : first;
+      for (auto cpu = first; cpu <= last; ++cpu) {
+        f(cpu);
+      }
+    } catch (std::exception const &) {
+      return false;
+    }
+    position = end + 1;
+  }
+  return true;
+}
+
+int find_numa_node(std::filesystem::path const &cpu_path) {
+  auto error = std::error_code{};
+  for (auto const &entry :
+       std::filesystem::directory_iterator{cpu_path, error}) {
+    auto const name = entry.path().filename().string();
+    if (name.starts_with("node")) {
+      try {
+        return std::stoi(name.substr(4));
+      } catch (std::exception const &) {
+      }
+    }
+  }
+  return 0;
+}
+
+bool read_sysfs_topology(Allocating_list<Logical_cpu> &logical_cpus) {
+  auto online_file = std::ifstream{sysfs_cpu_path / "online"};
+  auto online = std::string{};
+  if (!std::getline(online_file, online)) {
+    return false;
+  }
+  return for_each_in_cpu_list(online, [&](int cpu) {
+    auto const cpu_path = sysfs_cpu_path / ("cpu" + std::to_string(cpu));
+    logical_cpus.push_back({
+        .index = cpu,
+        .core = read_int(cpu_path / "topology" / "core_id", cpu),
+        .package = read_int(cpu_path / "topology" / "physical_package_id", 0),
+        .numa_node = find_numa_node(cpu_path),
+    });
+  });
+}
+#endif
+} // namespace
+
+Cpu_topology::Cpu_topology() {
+#ifdef __linux__
+  if (read_sysfs_topology(_logical_cpus) && !_logical_cpus.empty()) {
+    return;
+  }
+  _logical_cpus.clear();
+#endif
+  auto const cpu_count =
+      std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  for (auto cpu = 0; cpu != cpu_count; ++cpu) {
+    _logical_cpus.push_back(
+        {.index = cpu, .core = cpu, .package = 0, .numa_node = 0});
+  }
+}
+
+Size Cpu_topology::physical_core_count(int numa_node) const noexcept {
+  auto result = Size{};
+  auto const cpus = logical_cpus();
+  for (auto it = cpus.begin(); it != cpus.end(); ++it) {
+    if (numa_node >= 0 && it->numa_node != numa_node) {
+      continue;
+    }
+    auto const sibling = std::find_if(cpus.begin(), it, [&](auto const &cpu) {
+      return cpu.package == it->package && cpu.core == it->core;
+    });
+    if (sibling == it) {
+      ++result;
+    }
+  }
+  return result;
+}
+
+Size Cpu_topology::numa_node_count() const noexcept {
+  auto max_node = 0;
+  for (auto const &cpu : logical_cpus()) {
+    max_node = std::max(max_node, cpu.numa_node);
+  }
+  return max_node + 1;
+}
+
+bool set_current_thread_affinity(std::span<int const> cpus) noexcept {
+#ifdef __linux__
+  auto set = cpu_set_t{};
+  CPU_ZERO(&set);
+  for (auto const cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(cpu, &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+bool bind_to_numa_node(Block block, int numa_node) noexcept {
+#ifdef __linux__
+  auto node_mask = std::array<unsigned long, 16>{};
+  auto constexpr bits_per_word = static_cast<int>(8 * sizeof(unsigned long));
+  if (numa_node < 0 || numa_node >= bits_per_word * 16) {
+    return false;
+  }
+  node_mask[numa_node / bits_per_word] = 1ul << (numa_node % bits_per_word);
+  // mbind works on whole pages, pages only partially covered by the block
+  // keep their policy
+  auto const page_size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+  auto const begin =
+      (reinterpret_cast<std::uintptr_t>(block.begin) + page_size - 1) &
+      ~(page_size - 1);
+  auto const end =
+      reinterpret_cast<std::uintptr_t>(block.end) & ~(page_size - 1);
+  if (end <= begin) {
+    return true;
+  }
+  return syscall(SYS_mbind,
+                 begin,
+                 static_cast<unsigned long>(end - begin),
+                 MPOL_PREFERRED,
+                 node_mask.data(),
+                 static_cast<unsigned long>(bits_per_word * 16),
+                 0) == 0;
+#else
+  (void)block;
+  (void)numa_node;
+  return false;
+#endif
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,50 @@
+#ifndef MARLON_UTIL_CPU_TOPOLOGY_H
+#define MARLON_UTIL_CPU_TOPOLOGY_H
+
+#include <span>
+
+#include "list.h"
+#include "memory.h"
+
+namespace marlon {
+namespace util {
+struct Logical_cpu {
+  // operating system cpu number
+  int index;
+  int core;
+  int package;
+  int numa_node;
+};
+
+// Logical cpus of the machine. Reads /sys/devices/system/cpu on Linux. Where
+// the topology is unavailable every logical cpu is reported as its own core
+// on package 0 and numa node 0.
+class Cpu_topology {
+public:
+  Cpu_topology();
+
+  std::span<Logical_cpu const> logical_cpus() const noexcept {
+    return {_logical_cpus.data(),
+            static_cast<std::size_t>(_logical_cpus.size())};
+  }
+
+  // Counts every numa node if numa_node is negative
+  Size physical_core_count(int numa_node = -1) const noexcept;
+
+  Size numa_node_count() const noexcept;
+
+private:
+  Allocating_list<Logical_cpu> _logical_cpus;
+};
+
+// Restricts the calling thread to the given logical cpus. Returns false if the
+// platform does not support it or the call failed.
+bool set_current_thread_affinity(std::span<int const> cpus) noexcept;
+
+// Prefers numa_node for the pages of block that are faulted in after the call.
+// Returns false if the platform does not support it or the call failed.
+bool bind_to_numa_node(Block block, int numa_node) noexcept;
+} // namespace util
+} // namespace marlon
+
+#endif
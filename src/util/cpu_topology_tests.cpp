@@ -0,0 +1,26 @@
+#include "cpu_topology.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::Cpu_topology") {
+  auto const topology = Cpu_topology{};
+  auto const logical_cpus = topology.logical_cpus();
+  REQUIRE(!logical_cpus.empty());
+  REQUIRE(topology.numa_node_count() >= 1);
+  REQUIRE(topology.physical_core_count() >= 1);
+  REQUIRE(topology.physical_core_count() <=
+          static_cast<Size>(logical_cpus.size()));
+  auto node_core_count = Size{};
+  for (auto node = 0; node != topology.numa_node_count(); ++node) {
+    node_core_count += topology.physical_core_count(node);
+  }
+  REQUIRE(node_core_count == topology.physical_core_count());
+  for (auto const &cpu : logical_cpus) {
+    REQUIRE(cpu.index >= 0);
+    REQUIRE(cpu.numa_node >= 0);
+  }
+}
+} // namespace util
+} // namespace marlon
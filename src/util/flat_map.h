@@ -0,0 +1,139 @@
+#ifndef MARLON_UTIL_FLAT_MAP_H
+#define MARLON_UTIL_FLAT_MAP_H
+
+#include <concepts>
+#include <tuple>
+
+#include "flat_set.h"
+
+namespace marlon {
+namespace util {
+// Flat_set of key-value pairs that hashes and compares keys only
+template <typename K,
+          typename V,
+          typename KeyHash = Hash<K>,
+          typename KeyEqual = Equal<K>>
+class Flat_map {
+  struct Pair_hash {
+    template <std::convertible_to<std::pair<K, V>> P>
+    constexpr std::size_t operator()(P const &x) const noexcept {
+      return KeyHash{}(x.first);
+    }
+
+    template <typename T>
+    constexpr std::size_t operator()(T const &x) const noexcept {
+      return KeyHash{}(x);
+    }
+  };
+
+  struct Pair_equal {
+    template <std::convertible_to<std::pair<K, V>> P>
+    constexpr bool operator()(std::pair<K, V> const &lhs,
+                              P const &rhs) const noexcept {
+      return KeyEqual{}(lhs.first, rhs.first);
+    }
+
+    template <typename T>
+    constexpr bool operator()(std::pair<K, V> const &lhs,
+                              T const &rhs) const noexcept {
+      return KeyEqual{}(lhs.first, rhs);
+    }
+  };
+
+  Flat_set<std::pair<K, V>, Pair_hash, Pair_equal> _impl;
+
+public:
+  using Iterator = typename decltype(_impl)::Iterator;
+  using Const_iterator = typename decltype(_impl)::Const_iterator;
+
+  template <typename Allocator>
+  static std::pair<Block, Flat_map> make(Allocator &allocator, Size max_size) {
+    auto const block = allocator.alloc(memory_requirement(max_size));
+    return {block, Flat_map{block, max_size}};
+  }
+
+  static constexpr Size memory_requirement(Size max_size) noexcept {
+    return decltype(_impl)::memory_requirement(max_size);
+  }
+
+  constexpr Flat_map() noexcept = default;
+
+  explicit Flat_map(Block block, Size max_size) noexcept
+      : _impl{block, max_size} {}
+
+  explicit Flat_map(void *block, Size max_size) noexcept
+      : _impl{block, max_size} {}
+
+  Const_block block() const noexcept { return _impl.block(); }
+
+  Iterator begin() noexcept { return _impl.begin(); }
+
+  Const_iterator begin() const noexcept { return _impl.begin(); }
+
+  Const_iterator cbegin() const noexcept { return _impl.cbegin(); }
+
+  Iterator end() noexcept { return _impl.end(); }
+
+  Const_iterator end() const noexcept { return _impl.end(); }
+
+  Const_iterator cend() const noexcept { return _impl.cend(); }
+
+  bool empty() const noexcept { return _impl.empty(); }
+
+  Size size() const noexcept { return _impl.size(); }
+
+  Size max_size() const noexcept { return _impl.max_size(); }
+
+  Size capacity() const noexcept { return _impl.capacity(); }
+
+  void clear() noexcept { _impl.clear(); }
+
+  template <typename P> std::pair<Iterator, bool> insert(P &&x) {
+    return _impl.insert(std::forward<P>(x));
+  }
+
+  template <typename... Args>
+  std::pair<Iterator, bool> emplace(Args &&...args) {
+    return _impl.emplace(std::forward<Args>(args)...);
+  }
+
+  // Constructs the value from args only if key isn't in the map
+  template <typename T, typename... Args>
+  std::pair<Iterator, bool> try_emplace(T &&key, Args &&...args) {
+    return _impl.try_emplace(
+        key,
+        std::piecewise_construct,
+        std::forward_as_tuple(std::forward<T>(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  Iterator erase(Iterator pos) noexcept { return _impl.erase(pos); }
+
+  Iterator erase(Const_iterator pos) noexcept { return _impl.erase(pos); }
+
+  template <typename T> Size erase(T const &x) noexcept {
+    return _impl.erase(x);
+  }
+
+  template <typename T> Iterator find(T const &x) noexcept {
+    return _impl.find(x);
+  }
+
+  template <typename T> Const_iterator find(T const &x) const noexcept {
+    return _impl.find(x);
+  }
+
+  template <typename T> bool contains(T const &x) const noexcept {
+    return _impl.contains(x);
+  }
+
+  template <typename T> V &at(T const &k) noexcept { return find(k)->second; }
+
+  template <typename T> V const &at(T const &k) const noexcept {
+    return find(k)->second;
+  }
+};
+} // namespace util
+} // namespace marlon
+
+#endif
@@ -0,0 +1,69 @@
+#include "flat_map.h"
+
+#include <memory>
+#include <random>
+#include <unordered_map>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::Flat_map") {
+  auto random_engine = std::mt19937{std::random_device{}()};
+  auto random_distribution = std::uniform_int_distribution<>{};
+  auto const max_size = 64;
+  auto const block =
+      Unique_block<>{Flat_map<int, int>::memory_requirement(max_size)};
+  auto marlon_map = Flat_map<int, int>{};
+  auto std_map = std::unordered_map<int, int>{};
+  REQUIRE(marlon_map.begin() == marlon_map.end());
+  REQUIRE(marlon_map.size() == 0);
+  REQUIRE(marlon_map.max_size() == 0);
+  for (int i = 1; i <= max_size; ++i) {
+    marlon_map = Flat_map<int, int>{block.get(), i};
+    std_map = std::unordered_map<int, int>{};
+    REQUIRE(marlon_map.begin() == marlon_map.end());
+    REQUIRE(marlon_map.max_size() == i);
+    for (int j = 0; j < i; ++j) {
+      auto const key = random_distribution(random_engine);
+      auto const value = random_distribution(random_engine);
+      REQUIRE(marlon_map.insert(std::pair{key, value}).second ==
+              std_map.insert({key, value}).second);
+      REQUIRE(marlon_map.emplace(key, value).second ==
+              std_map.emplace(key, value).second);
+      REQUIRE(marlon_map.size() == static_cast<Size>(std_map.size()));
+      for (auto const &p : marlon_map) {
+        REQUIRE(marlon_map.at(p.first) == p.second);
+      }
+      for (auto const &p : std_map) {
+        REQUIRE(marlon_map.at(p.first) == p.second);
+      }
+    }
+    for (auto const &p : std_map) {
+      REQUIRE(marlon_map.erase(p.first) == 1);
+      REQUIRE(!marlon_map.contains(p.first));
+    }
+    REQUIRE(marlon_map.size() == 0);
+  }
+  marlon_map = {};
+}
+
+TEST_CASE("marlon::util::Flat_map::try_emplace") {
+  auto const block = Unique_block<>{
+      Flat_map<int, std::unique_ptr<int>>::memory_requirement(4)};
+  auto map = Flat_map<int, std::unique_ptr<int>>{block.get(), 4};
+  auto const first = map.try_emplace(1, std::make_unique<int>(2));
+  REQUIRE(first.second);
+  REQUIRE(*first.first->second == 2);
+  auto value = std::make_unique<int>(3);
+  auto const second = map.try_emplace(1, std::move(value));
+  REQUIRE(!second.second);
+  REQUIRE(second.first == first.first);
+  // nothing was moved from
+  REQUIRE(value != nullptr);
+  REQUIRE(*map.at(1) == 2);
+  map.clear();
+  REQUIRE(map.size() == 0);
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,517 @@
+#ifndef MARLON_UTIL_FLAT_SET_H
+#define MARLON_UTIL_FLAT_SET_H
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MARLON_UTIL_FLAT_SET_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <bit>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "capacity_error.h"
+#include "equal.h"
+#include "hash.h"
+#include "memory.h"
+
+namespace marlon {
+namespace util {
+namespace detail {
+// Control bytes of free slots, a full slot's control byte holds the low 7
+// bits of its element's mixed hash
+inline constexpr auto flat_empty = std::int8_t{-128};
+inline constexpr auto flat_deleted = std::int8_t{-2};
+
+// Control bytes of tables without slots, so that lookups need no branch
+inline constexpr std::int8_t flat_empty_group[16]{
+    flat_empty, flat_empty, flat_empty, flat_empty, flat_empty, flat_empty,
+    flat_empty, flat_empty, flat_empty, flat_empty, flat_empty, flat_empty,
+    flat_empty, flat_empty, flat_empty, flat_empty,
+};
+
+#ifdef MARLON_UTIL_FLAT_SET_SSE2
+// Matches the control bytes of width consecutive slots at once. Bit i of a
+// mask stands for slot i.
+class Flat_group {
+public:
+  using Mask = std::uint32_t;
+
+  static constexpr auto width = Size{16};
+
+  static Size lowest(Mask mask) noexcept { return std::countr_zero(mask); }
+
+  static Size leading(Mask mask) noexcept {
+    return std::countl_zero(static_cast<std::uint16_t>(mask));
+  }
+
+  explicit Flat_group(std::int8_t const *ctrl) noexcept
+      : _ctrl{_mm_loadu_si128(reinterpret_cast<__m128i const *>(ctrl))} {}
+
+  Mask match(std::int8_t h2) const noexcept {
+    return static_cast<Mask>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), _ctrl)));
+  }
+
+  Mask match_empty() const noexcept { return match(flat_empty); }
+
+  // empty or deleted
+  Mask match_free() const noexcept {
+    return static_cast<Mask>(_mm_movemask_epi8(_ctrl));
+  }
+
+  Mask match_full() const noexcept { return match_free() ^ 0xffff; }
+
+private:
+  __m128i _ctrl;
+};
+#else
+// Matches the control bytes of width consecutive slots at once in a 64 bit
+// word. Bit 8 * i + 7 of a mask stands for slot i, match may report false
+// positives after a true one.
+class Flat_group {
+public:
+  using Mask = std::uint64_t;
+
+  static constexpr auto width = Size{8};
+
+  static Size lowest(Mask mask) noexcept {
+    return std::countr_zero(mask) >> 3;
+  }
+
+  static Size leading(Mask mask) noexcept {
+    return std::countl_zero(mask) >> 3;
+  }
+
+  explicit Flat_group(std::int8_t const *ctrl) noexcept {
+    static_assert(std::endian::native == std::endian::little);
+    std::memcpy(&_ctrl, ctrl, sizeof(_ctrl));
+  }
+
+  Mask match(std::int8_t h2) const noexcept {
+    auto const x = _ctrl ^ (lsbs * static_cast<std::uint8_t>(h2));
+    return (x - lsbs) & ~x & msbs;
+  }
+
+  Mask match_empty() const noexcept { return _ctrl & ~(_ctrl << 6) & msbs; }
+
+  // empty or deleted
+  Mask match_free() const noexcept { return _ctrl & msbs; }
+
+  Mask match_full() const noexcept { return ~_ctrl & msbs; }
+
+private:
+  static constexpr auto lsbs = Mask{0x0101010101010101};
+  static constexpr auto msbs = Mask{0x8080808080808080};
+
+  Mask _ctrl;
+};
+#endif
+} // namespace detail
+
+// Fixed capacity hash set with open addressing. Every slot has a control
+// byte with 7 bits of its element's hash, lookups compare a whole group of
+// control bytes at once and only compare elements whose bits match. Hashes
+// are mixed with hash_mix, so identity hashes of handles and pointers are
+// fine. Elements don't move while they are in the set, except when an
+// insertion finds every free slot taken by erased elements, which rehashes
+// the set in place.
+template <typename T, typename Hash = Hash<T>, typename Equal = Equal<T>>
+class Flat_set {
+  using Group = detail::Flat_group;
+
+public:
+  class Iterator {
+    friend class Flat_set;
+    friend class Const_iterator;
+
+  public:
+    T &operator*() const noexcept { return *_slot; }
+
+    T *operator->() const noexcept { return _slot; }
+
+    Iterator &operator++() noexcept {
+      ++_ctrl;
+      ++_slot;
+      --_remaining;
+      skip_free();
+      return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+      auto temp{*this};
+      ++*this;
+      return temp;
+    }
+
+    friend bool operator==(Iterator lhs, Iterator rhs) noexcept {
+      return lhs._slot == rhs._slot;
+    }
+
+  private:
+    explicit Iterator(std::int8_t const *ctrl, T *slot, Size remaining) noexcept
+        : _ctrl{ctrl}, _slot{slot}, _remaining{remaining} {}
+
+    void skip_free() noexcept {
+      while (_remaining != 0) {
+        auto const mask = Group{_ctrl}.match_full();
+        auto const n = std::min(
+            mask != 0 ? Group::lowest(mask) : Group::width, _remaining);
+        _ctrl += n;
+        _slot += n;
+        _remaining -= n;
+        if (mask != 0) {
+          return;
+        }
+      }
+    }
+
+    std::int8_t const *_ctrl;
+    T *_slot;
+    Size _remaining;
+  };
+
+  class Const_iterator {
+    friend class Flat_set;
+
+  public:
+    Const_iterator(Iterator it) noexcept : _it{it} {}
+
+    T const &operator*() const noexcept { return *_it; }
+
+    T const *operator->() const noexcept { return _it.operator->(); }
+
+    Const_iterator &operator++() noexcept {
+      ++_it;
+      return *this;
+    }
+
+    Const_iterator operator++(int) noexcept {
+      auto temp{*this};
+      ++*this;
+      return temp;
+    }
+
+    friend bool operator==(Const_iterator lhs, Const_iterator rhs) noexcept {
+      return lhs._it == rhs._it;
+    }
+
+  private:
+    Iterator _it;
+  };
+
+  template <typename Allocator>
+  static std::pair<Block, Flat_set> make(Allocator &allocator, Size max_size) {
+    auto const block = allocator.alloc(memory_requirement(max_size));
+    return {block, Flat_set{block, max_size}};
+  }
+
+  static constexpr Size memory_requirement(Size max_size) noexcept {
+    auto const capacity = capacity_for(max_size);
+    return Stack_allocator<alignof(T)>::memory_requirement({
+        capacity + Group::width,
+        capacity * static_cast<Size>(sizeof(T)),
+    });
+  }
+
+  constexpr Flat_set() noexcept = default;
+
+  explicit Flat_set(Block block, Size max_size) noexcept
+      : Flat_set{block.begin, max_size} {}
+
+  explicit Flat_set(void *block, Size max_size) noexcept
+      : _capacity{capacity_for(max_size)},
+        _mask{_capacity - 1},
+        _max_size{max_size},
+        _growth_left{max_load(_capacity)} {
+    auto allocator = Stack_allocator<alignof(T)>{
+        {static_cast<std::byte *>(block), memory_requirement(max_size)}};
+    _ctrl = reinterpret_cast<std::int8_t *>(
+        allocator.alloc(_capacity + Group::width).begin);
+    _slots = reinterpret_cast<T *>(
+        allocator.alloc(_capacity * static_cast<Size>(sizeof(T))).begin);
+    std::memset(_ctrl, detail::flat_empty, _capacity + Group::width);
+  }
+
+  Flat_set(Flat_set &&other) noexcept
+      : _ctrl{std::exchange(
+            other._ctrl, const_cast<std::int8_t *>(detail::flat_empty_group))},
+        _slots{std::exchange(other._slots, nullptr)},
+        _capacity{std::exchange(other._capacity, 0)},
+        _mask{std::exchange(other._mask, 0)},
+        _size{std::exchange(other._size, 0)},
+        _max_size{std::exchange(other._max_size, 0)},
+        _growth_left{std::exchange(other._growth_left, 0)} {}
+
+  Flat_set &operator=(Flat_set &&other) noexcept {
+    auto temp{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  ~Flat_set() { destroy_elements(); }
+
+  Const_block block() const noexcept {
+    return _slots != nullptr
+               ? Const_block{reinterpret_cast<std::byte const *>(_ctrl),
+                             memory_requirement(_max_size)}
+               : Const_block{};
+  }
+
+  Iterator begin() noexcept {
+    auto result = Iterator{_ctrl, _slots, _capacity};
+    result.skip_free();
+    return result;
+  }
+
+  Const_iterator begin() const noexcept {
+    return const_cast<Flat_set *>(this)->begin();
+  }
+
+  Const_iterator cbegin() const noexcept { return begin(); }
+
+  Iterator end() noexcept {
+    return Iterator{_ctrl + _capacity, _slots + _capacity, 0};
+  }
+
+  Const_iterator end() const noexcept {
+    return const_cast<Flat_set *>(this)->end();
+  }
+
+  Const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return _size == 0; }
+
+  Size size() const noexcept { return _size; }
+
+  Size max_size() const noexcept { return _max_size; }
+
+  // Number of slots, a power of two with at least an eighth of them free
+  Size capacity() const noexcept { return _capacity; }
+
+  void clear() noexcept {
+    destroy_elements();
+    if (_capacity != 0) {
+      std::memset(_ctrl, detail::flat_empty, _capacity + Group::width);
+    }
+    _size = 0;
+    _growth_left = max_load(_capacity);
+  }
+
+  template <typename K> std::pair<Iterator, bool> insert(K &&x) {
+    return try_emplace(x, std::forward<K>(x));
+  }
+
+  template <typename... Args>
+  std::pair<Iterator, bool> emplace(Args &&...args) {
+    auto value = T(std::forward<Args>(args)...);
+    return try_emplace(value, std::move(value));
+  }
+
+  // Constructs an element from args unless one equal to key is in the set
+  template <typename K, typename... Args>
+  std::pair<Iterator, bool> try_emplace(K const &key, Args &&...args) {
+    auto const hash = hash_mix(Hash{}(key));
+    if (auto const index = find_index(key, hash); index != -1) {
+      return {iterator_at(index), false};
+    }
+    if (_size == _max_size) {
+      throw Capacity_error{"Capacity_error in Flat_set::try_emplace"};
+    }
+    auto index = find_free(hash);
+    if (_growth_left == 0 && _ctrl[index] == detail::flat_empty) {
+      rehash_in_place();
+      index = find_free(hash);
+    }
+    new (_slots + index) T(std::forward<Args>(args)...);
+    _growth_left -= _ctrl[index] == detail::flat_empty;
+    set_ctrl(index, h2(hash));
+    ++_size;
+    return {iterator_at(index), true};
+  }
+
+  Iterator erase(Iterator pos) noexcept { return erase(Const_iterator{pos}); }
+
+  // Returns the iterator following pos, erasing doesn't move any element
+  Iterator erase(Const_iterator pos) noexcept {
+    auto const index = pos._it._slot - _slots;
+    _slots[index].~T();
+    auto const before = (index - Group::width) & _mask;
+    auto const empty_after = Group{_ctrl + index}.match_empty();
+    auto const empty_before = Group{_ctrl + before}.match_empty();
+    // unless a whole group of non-empty slots spans index, no lookup ever
+    // probed past it and it can become empty instead of deleted
+    auto const was_never_full =
+        empty_before != 0 && empty_after != 0 &&
+        Group::lowest(empty_after) + Group::leading(empty_before) <
+            Group::width;
+    set_ctrl(index, was_never_full ? detail::flat_empty : detail::flat_deleted);
+    _growth_left += was_never_full;
+    --_size;
+    auto result = iterator_at(index);
+    return ++result;
+  }
+
+  template <typename K> Size erase(K const &x) noexcept {
+    auto const index = find_index(x, hash_mix(Hash{}(x)));
+    if (index != -1) {
+      erase(iterator_at(index));
+      return 1;
+    } else {
+      return 0;
+    }
+  }
+
+  template <typename K> Iterator find(K const &x) noexcept {
+    auto const index = find_index(x, hash_mix(Hash{}(x)));
+    return index != -1 ? iterator_at(index) : end();
+  }
+
+  template <typename K> Const_iterator find(K const &x) const noexcept {
+    return const_cast<Flat_set *>(this)->find(x);
+  }
+
+  template <typename K> bool contains(K const &x) const noexcept {
+    return find_index(x, hash_mix(Hash{}(x))) != -1;
+  }
+
+private:
+  // A power of two of at least one group, at most 7/8 of which is used
+  static constexpr Size capacity_for(Size max_size) noexcept {
+    auto result = Group::width;
+    while (max_load(result) < max_size) {
+      result *= 2;
+    }
+    return result;
+  }
+
+  static constexpr Size max_load(Size capacity) noexcept {
+    return capacity - capacity / 8;
+  }
+
+  static std::int8_t h2(std::size_t hash) noexcept {
+    return static_cast<std::int8_t>(hash & 0x7f);
+  }
+
+  Size probe_begin(std::size_t hash) const noexcept {
+    return static_cast<Size>(hash >> 7) & _mask;
+  }
+
+  // Returns -1 if there is no such element
+  template <typename K>
+  Size find_index(K const &x, std::size_t hash) const noexcept {
+    auto const hash_bits = h2(hash);
+    auto offset = probe_begin(hash);
+    for (auto step = Group::width;; step += Group::width) {
+      auto const group = Group{_ctrl + offset};
+      for (auto mask = group.match(hash_bits); mask != 0; mask &= mask - 1) {
+        auto const index = (offset + Group::lowest(mask)) & _mask;
+        if (Equal{}(_slots[index], x)) {
+          return index;
+        }
+      }
+      if (group.match_empty() != 0) {
+        return -1;
+      }
+      offset = (offset + step) & _mask;
+    }
+  }
+
+  // First empty or deleted slot of hash's probe sequence
+  Size find_free(std::size_t hash) const noexcept {
+    auto offset = probe_begin(hash);
+    for (auto step = Group::width;; step += Group::width) {
+      if (auto const mask = Group{_ctrl + offset}.match_free(); mask != 0) {
+        return (offset + Group::lowest(mask)) & _mask;
+      }
+      offset = (offset + step) & _mask;
+    }
+  }
+
+  // The first group's control bytes are cloned after the last slot's, so
+  // that groups starting at any slot can be loaded without wrapping
+  void set_ctrl(Size index, std::int8_t ctrl) noexcept {
+    _ctrl[index] = ctrl;
+    _ctrl[((index - Group::width) & _mask) + Group::width] = ctrl;
+  }
+
+  Iterator iterator_at(Size index) const noexcept {
+    return Iterator{_ctrl + index, _slots + index, _capacity - index};
+  }
+
+  // Turns every deleted slot into an empty one, moving elements into the
+  // first free slot of their probe sequences
+  void rehash_in_place() noexcept {
+    static_assert(std::is_nothrow_move_constructible_v<T> &&
+                  std::is_nothrow_swappable_v<T>);
+    // deleted slots mark the elements that still have to be placed
+    for (auto i = Size{}; i != _capacity; ++i) {
+      _ctrl[i] = _ctrl[i] < 0 ? detail::flat_empty : detail::flat_deleted;
+    }
+    std::memcpy(_ctrl + _capacity, _ctrl, Group::width);
+    for (auto i = Size{}; i != _capacity; ++i) {
+      if (_ctrl[i] != detail::flat_deleted) {
+        continue;
+      }
+      auto const hash = hash_mix(Hash{}(_slots[i]));
+      auto const begin = probe_begin(hash);
+      auto const target = find_free(hash);
+      auto const probe_group = [&](Size index) {
+        return ((index - begin) & _mask) / Group::width;
+      };
+      if (probe_group(target) == probe_group(i)) {
+        set_ctrl(i, h2(hash));
+      } else if (_ctrl[target] == detail::flat_empty) {
+        new (_slots + target) T(std::move(_slots[i]));
+        _slots[i].~T();
+        set_ctrl(target, h2(hash));
+        set_ctrl(i, detail::flat_empty);
+      } else {
+        // target holds another element that still has to be placed, which
+        // gets placed from i next
+        using std::swap;
+        swap(_slots[i], _slots[target]);
+        set_ctrl(target, h2(hash));
+        --i;
+      }
+    }
+    _growth_left = max_load(_capacity) - _size;
+  }
+
+  void destroy_elements() noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (auto &element : *this) {
+        element.~T();
+      }
+    }
+  }
+
+  void swap(Flat_set &other) noexcept {
+    std::swap(_ctrl, other._ctrl);
+    std::swap(_slots, other._slots);
+    std::swap(_capacity, other._capacity);
+    std::swap(_mask, other._mask);
+    std::swap(_size, other._size);
+    std::swap(_max_size, other._max_size);
+    std::swap(_growth_left, other._growth_left);
+  }
+
+  std::int8_t *_ctrl{const_cast<std::int8_t *>(detail::flat_empty_group)};
+  T *_slots{};
+  Size _capacity{};
+  Size _mask{};
+  Size _size{};
+  Size _max_size{};
+  // slots that can still become full without any deleted slot being reused
+  Size _growth_left{};
+};
+} // namespace util
+} // namespace marlon
+
+#endif
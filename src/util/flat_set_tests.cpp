@@ -0,0 +1,104 @@
+#include "flat_set.h"
+
+#include <cstdint>
+
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::Flat_set") {
+  auto const max_size = 64;
+  auto const block =
+      Unique_block<>{Flat_set<int>::memory_requirement(max_size)};
+  auto set = Flat_set<int>{};
+  REQUIRE(set.begin() == set.cbegin());
+  REQUIRE(set.end() == set.cend());
+  REQUIRE(set.begin() == set.end());
+  REQUIRE(set.size() == 0);
+  REQUIRE(set.max_size() == 0);
+  REQUIRE(set.find(1) == set.end());
+  REQUIRE_THROWS_AS(set.insert(1), Capacity_error);
+  set = Flat_set<int>{block.get(), max_size};
+  REQUIRE(set.max_size() == max_size);
+  REQUIRE(set.capacity() - set.capacity() / 8 >= max_size);
+  for (auto j = 0; j < 2; ++j) {
+    for (int i = 1; i <= max_size; ++i) {
+      auto const it = set.emplace(i);
+      REQUIRE(*it.first == i);
+      REQUIRE(it.second);
+      REQUIRE(set.size() == i);
+    }
+    for (int i = 1; i <= max_size; ++i) {
+      auto const it = set.insert(i);
+      REQUIRE(*it.first == i);
+      REQUIRE(!it.second);
+      REQUIRE(set.size() == max_size);
+    }
+    REQUIRE_THROWS_AS(set.insert(max_size + 1), Capacity_error);
+    auto v = std::vector<bool>(max_size);
+    for (auto const i : set) {
+      REQUIRE(!v[i - 1]);
+      v[i - 1] = true;
+    }
+    for (auto const b : v) {
+      REQUIRE(b);
+    }
+    set.clear();
+    REQUIRE(set.size() == 0);
+    REQUIRE(set.begin() == set.end());
+  }
+}
+
+TEST_CASE("marlon::util::Flat_set random operations") {
+  // pointer-like keys whose low bits are all 0
+  auto random_engine = std::mt19937{42};
+  auto random_distribution = std::uniform_int_distribution<std::uint64_t>{
+      0, 255};
+  for (auto const max_size : {1, 14, 100, 1000}) {
+    auto const block = Unique_block<>{
+        Flat_set<std::uint64_t>::memory_requirement(max_size)};
+    auto set = Flat_set<std::uint64_t>{block.get(), max_size};
+    auto std_set = std::unordered_set<std::uint64_t>{};
+    for (auto i = 0; i != 20000; ++i) {
+      auto const key = random_distribution(random_engine) % (2 * max_size)
+                       << 6;
+      if (random_distribution(random_engine) % 2 == 0) {
+        if (std_set.size() == static_cast<std::size_t>(max_size) &&
+            !std_set.contains(key)) {
+          REQUIRE_THROWS_AS(set.insert(key), Capacity_error);
+        } else {
+          REQUIRE(set.insert(key).second == std_set.insert(key).second);
+        }
+      } else {
+        REQUIRE(set.erase(key) == static_cast<Size>(std_set.erase(key)));
+      }
+      REQUIRE(set.size() == static_cast<Size>(std_set.size()));
+      REQUIRE(set.contains(key) == std_set.contains(key));
+    }
+    auto count = Size{};
+    for (auto const key : set) {
+      REQUIRE(std_set.contains(key));
+      ++count;
+    }
+    REQUIRE(count == set.size());
+    for (auto it = set.begin(); it != set.end();) {
+      if (*it % 128 == 0) {
+        std_set.erase(*it);
+        it = set.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    REQUIRE(set.size() == static_cast<Size>(std_set.size()));
+    for (auto const key : std_set) {
+      REQUIRE(set.find(key) != set.end());
+      REQUIRE(*set.find(key) == key);
+    }
+  }
+}
+} // namespace util
+} // namespace marlon
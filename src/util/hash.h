@@ -43,6 +43,21 @@ template <typename T> struct Hash<T *> {
     return std::bit_cast<std::size_t>(ptr);
   }
 };
+
+// Spreads every bit of x over every bit of the result. The Hash
+// specializations for integers and pointers are the identity, so tables that
+// index by the low or high bits of a hash mix it first to keep sequential
+// handles and aligned pointers from clustering. Uses the finalizer of
+// MurmurHash3.
+constexpr std::size_t hash_mix(std::size_t x) noexcept {
+  static_assert(sizeof(std::size_t) == 8);
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return x;
+}
 } // namespace util
 } // namespace marlon
 
@@ -9,5 +9,19 @@ TEST_CASE("marlon::util::Hash") {
   REQUIRE(Hash<std::nullptr_t>{}(nullptr) == 0);
   REQUIRE(Hash<int *>{}(&a) != Hash<int *>{}(&b));
 }
+
+TEST_CASE("marlon::util::hash_mix") {
+  // flipping any input bit flips about half of the output bits
+  for (auto x : {std::size_t{}, std::size_t{1}, std::size_t{0x1000}}) {
+    auto total_flipped_bits = 0;
+    for (auto bit = 0; bit != 64; ++bit) {
+      auto const y = x ^ (std::size_t{1} << bit);
+      total_flipped_bits += std::popcount(hash_mix(x) ^ hash_mix(y));
+    }
+    REQUIRE(total_flipped_bits > 64 * 24);
+    REQUIRE(total_flipped_bits < 64 * 40);
+  }
+  REQUIRE(hash_mix(1) != hash_mix(2));
+}
 } // namespace util
 } // namespace marlon
\ No newline at end of file
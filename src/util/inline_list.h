@@ -0,0 +1,181 @@
+#ifndef MARLON_UTIL_INLINE_LIST_H
+#define MARLON_UTIL_INLINE_LIST_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "memory.h"
+
+namespace marlon {
+namespace util {
+// List that keeps up to N elements inside itself and moves them into memory
+// from a caller-supplied allocator, usually a Stack_allocator that is reset as
+// a whole, once it outgrows them. The capacity doubles on every spill. The
+// list never frees spilled memory by itself, see reset. T must be trivially
+// copyable so that elements can be moved around with memcpy.
+template <typename T, Size N> class Inline_list {
+  static_assert(N > 0);
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  using Iterator = T *;
+  using Const_iterator = T const *;
+
+  static constexpr Size inline_capacity = N;
+
+  // Upper bound of the memory that lists whose sizes add up to total_size
+  // spill into an allocator that doesn't pad allocations of multiples of
+  // sizeof(T), like Stack_allocator<alignof(T)>
+  static constexpr Size spill_memory_requirement(Size total_size) noexcept {
+    // a list of size s allocates 2N, 4N, ..., C with C < 2s, less than 4s
+    return 4 * static_cast<Size>(sizeof(T)) * total_size;
+  }
+
+  constexpr Inline_list() noexcept = default;
+
+  Inline_list(Inline_list &&other) noexcept
+      : _size{std::exchange(other._size, 0)},
+        _capacity{std::exchange(other._capacity, N)} {
+    std::memcpy(&_storage, &other._storage, sizeof(_storage));
+  }
+
+  Inline_list &operator=(Inline_list &&other) noexcept {
+    auto temp{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  bool empty() const noexcept { return _size == 0; }
+
+  Size size() const noexcept { return _size; }
+
+  Size capacity() const noexcept { return _capacity; }
+
+  // Whether the elements are still stored inside the list
+  bool is_inline() const noexcept { return _capacity == N; }
+
+  T *data() noexcept {
+    return is_inline() ? std::launder(reinterpret_cast<T *>(_storage.elements))
+                       : _storage.spilled;
+  }
+
+  T const *data() const noexcept {
+    return const_cast<Inline_list *>(this)->data();
+  }
+
+  Iterator begin() noexcept { return data(); }
+
+  Const_iterator begin() const noexcept { return data(); }
+
+  Const_iterator cbegin() const noexcept { return data(); }
+
+  Iterator end() noexcept { return data() + _size; }
+
+  Const_iterator end() const noexcept { return data() + _size; }
+
+  Const_iterator cend() const noexcept { return data() + _size; }
+
+  operator std::span<T>() noexcept {
+    return {data(), static_cast<std::size_t>(_size)};
+  }
+
+  operator std::span<T const>() const noexcept {
+    return {data(), static_cast<std::size_t>(_size)};
+  }
+
+  T &operator[](Size index) noexcept {
+    assert(index >= 0 && index < _size);
+    return data()[index];
+  }
+
+  T const &operator[](Size index) const noexcept {
+    assert(index >= 0 && index < _size);
+    return data()[index];
+  }
+
+  T &back() noexcept { return (*this)[_size - 1]; }
+
+  T const &back() const noexcept { return (*this)[_size - 1]; }
+
+  // Spills into allocator if the list is full. Throws whatever
+  // allocator.alloc throws, in which case the list is unchanged.
+  template <typename Allocator, typename... Args>
+  T &emplace_back(Allocator &allocator, Args &&...args) {
+    if (_size == _capacity) {
+      grow(allocator);
+    }
+    return *new (data() + _size++) T(std::forward<Args>(args)...);
+  }
+
+  template <typename Allocator>
+  T &push_back(Allocator &allocator, T const &value) {
+    return emplace_back(allocator, value);
+  }
+
+  void pop_back() noexcept {
+    assert(_size > 0);
+    --_size;
+  }
+
+  // Keeps the capacity
+  void clear() noexcept { _size = 0; }
+
+  // Empties the list and forgets its spilled memory, for when the allocator
+  // frees it all at once
+  void reset() noexcept {
+    _size = 0;
+    _capacity = N;
+  }
+
+  // Empties the list and gives its spilled memory back to allocator
+  template <typename Allocator> void reset(Allocator &allocator) noexcept {
+    if (!is_inline()) {
+      allocator.free(spilled_block());
+    }
+    reset();
+  }
+
+private:
+  template <typename Allocator> void grow(Allocator &allocator) {
+    auto const new_capacity = 2 * _capacity;
+    auto const block =
+        allocator.alloc(static_cast<Size>(sizeof(T)) * new_capacity);
+    auto const new_data = reinterpret_cast<T *>(block.begin);
+    std::memcpy(new_data, data(), sizeof(T) * _size);
+    if (!is_inline()) {
+      allocator.free(spilled_block());
+    }
+    _storage.spilled = new_data;
+    _capacity = new_capacity;
+  }
+
+  Const_block spilled_block() const noexcept {
+    return {reinterpret_cast<std::byte const *>(_storage.spilled),
+            static_cast<Size>(sizeof(T)) * _capacity};
+  }
+
+  void swap(Inline_list &other) noexcept {
+    std::swap(_storage, other._storage);
+    std::swap(_size, other._size);
+    std::swap(_capacity, other._capacity);
+  }
+
+  union Storage {
+    alignas(T) std::byte elements[sizeof(T) * N];
+    T *spilled;
+  };
+
+  Storage _storage{};
+  Size _size{};
+  Size _capacity{N};
+};
+} // namespace util
+} // namespace marlon
+
+#endif
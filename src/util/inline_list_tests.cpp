@@ -0,0 +1,99 @@
+#include "inline_list.h"
+
+#include <numeric>
+#include <span>
+#include <utility>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::Inline_list") {
+  using List = Inline_list<int, 4>;
+  auto const max_size = 100;
+  auto const block =
+      Unique_block<>{List::spill_memory_requirement(max_size)};
+  auto allocator = Stack_allocator<alignof(int)>{block.get()};
+  auto list = List{};
+  REQUIRE(list.empty());
+  REQUIRE(list.capacity() == 4);
+  for (auto i = 0; i != 4; ++i) {
+    list.push_back(allocator, i);
+  }
+  REQUIRE(list.is_inline());
+  REQUIRE(allocator.used_size() == 0);
+  list.emplace_back(allocator, 4);
+  REQUIRE(!list.is_inline());
+  REQUIRE(list.capacity() == 8);
+  for (auto i = 5; i != max_size; ++i) {
+    list.push_back(allocator, i);
+  }
+  REQUIRE(list.size() == max_size);
+  REQUIRE(allocator.used_size() <= List::spill_memory_requirement(max_size));
+  for (auto i = 0; i != max_size; ++i) {
+    REQUIRE(list[i] == i);
+  }
+  auto const span = std::span<int const>{std::as_const(list)};
+  REQUIRE(std::accumulate(span.begin(), span.end(), 0) ==
+          max_size * (max_size - 1) / 2);
+  auto moved = std::move(list);
+  REQUIRE(list.empty());
+  REQUIRE(list.is_inline());
+  REQUIRE(moved.size() == max_size);
+  REQUIRE(moved.back() == max_size - 1);
+  moved.pop_back();
+  REQUIRE(moved.back() == max_size - 2);
+  moved.clear();
+  REQUIRE(moved.empty());
+  REQUIRE(!moved.is_inline());
+  moved.reset(allocator);
+  REQUIRE(moved.is_inline());
+  allocator.reset();
+  // inline elements move along with the list
+  auto small = List{};
+  small.push_back(allocator, 1);
+  small.push_back(allocator, 2);
+  list = std::move(small);
+  REQUIRE(list.size() == 2);
+  REQUIRE(list[0] == 1);
+  REQUIRE(list[1] == 2);
+  REQUIRE(allocator.used_size() == 0);
+}
+
+TEST_CASE("marlon::util::Inline_list shared arena") {
+  using List = Inline_list<int, 2>;
+  auto const sizes = {1, 3, 17, 2, 40};
+  auto const total_size = std::accumulate(sizes.begin(), sizes.end(), 0);
+  auto const block =
+      Unique_block<>{List::spill_memory_requirement(total_size)};
+  auto allocator = Stack_allocator<alignof(int)>{block.get()};
+  List lists[5];
+  // interleaved pushes, like neighbors found pair by pair
+  for (auto i = 0; i != 40; ++i) {
+    auto j = 0;
+    for (auto const size : sizes) {
+      if (i < size) {
+        lists[j].push_back(allocator, i);
+      }
+      ++j;
+    }
+  }
+  auto j = 0;
+  for (auto const size : sizes) {
+    REQUIRE(lists[j].size() == size);
+    for (auto i = 0; i != size; ++i) {
+      REQUIRE(lists[j][i] == i);
+    }
+    ++j;
+  }
+  REQUIRE_THROWS_AS(
+      [&] {
+        for (;;) {
+          lists[0].push_back(allocator, 0);
+        }
+      }(),
+      std::bad_alloc);
+  REQUIRE(lists[0].data()[0] == 0);
+}
+} // namespace util
+} // namespace marlon
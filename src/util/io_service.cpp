@@ -0,0 +1,580 @@
+#include "io_service.h"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define MARLON_UTIL_HAS_IO_URING
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define MARLON_UTIL_HAS_PREAD
+#else
+#include <cstdio>
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+
+#include "co_task.h"
+#include "list.h"
+
+namespace marlon {
+namespace util {
+namespace {
+// Intrusive FIFO of requests, linked through Io_request::_next
+class Io_request_list {
+public:
+  bool empty() const noexcept { return _head == nullptr; }
+
+  Io_request *front() const noexcept { return _head; }
+
+  void push_back(Io_request *request) noexcept {
+    request->_next = nullptr;
+    if (_tail != nullptr) {
+      _tail->_next = request;
+    } else {
+      _head = request;
+    }
+    _tail = request;
+  }
+
+  Io_request *pop_front() noexcept {
+    auto const result = _head;
+    _head = result->_next;
+    if (_head == nullptr) {
+      _tail = nullptr;
+    }
+    return result;
+  }
+
+private:
+  Io_request *_head{};
+  Io_request *_tail{};
+};
+
+// Requests move from the pending lists to the backend and from the backend
+// to the completed list
+class Io_queue {
+public:
+  void push(Io_request *request) {
+    {
+      auto const lock = std::scoped_lock{_mutex};
+      _pending[static_cast<int>(request->priority)].push_back(request);
+      ++_incomplete_count;
+    }
+    _work_condition.notify_one();
+  }
+
+  // Blocks until a request is pending. Returns nullptr once stop is
+  // requested.
+  Io_request *pop(std::stop_token const &stop_token) {
+    auto lock = std::unique_lock{_mutex};
+    if (!_work_condition.wait(
+            lock, stop_token, [this]() { return has_pending(); })) {
+      return nullptr;
+    }
+    return pop_pending();
+  }
+
+  // Pops up to max_count requests without blocking, highest priority first
+  Io_request_list try_pop(Size max_count) {
+    auto result = Io_request_list{};
+    auto const lock = std::scoped_lock{_mutex};
+    for (auto i = Size{}; i != max_count && has_pending(); ++i) {
+      result.push_back(pop_pending());
+    }
+    return result;
+  }
+
+  void complete(Io_request *request) {
+    {
+      auto const lock = std::scoped_lock{_mutex};
+      _completed.push_back(request);
+      --_incomplete_count;
+    }
+    _completion_condition.notify_all();
+  }
+
+  Io_request_list take_completed() {
+    auto const lock = std::scoped_lock{_mutex};
+    return std::exchange(_completed, Io_request_list{});
+  }
+
+  void wait_until_complete() {
+    auto lock = std::unique_lock{_mutex};
+    _completion_condition.wait(lock,
+                               [this]() { return _incomplete_count == 0; });
+  }
+
+private:
+  bool has_pending() const noexcept {
+    return std::ranges::any_of(_pending, [](auto const &requests) {
+      return !requests.empty();
+    });
+  }
+
+  Io_request *pop_pending() noexcept {
+    for (auto &requests : _pending) {
+      if (!requests.empty()) {
+        return requests.pop_front();
+      }
+    }
+    return nullptr;
+  }
+
+  std::mutex _mutex;
+  std::condition_variable_any _work_condition;
+  std::condition_variable _completion_condition;
+  std::array<Io_request_list, io_priority_count> _pending;
+  Io_request_list _completed;
+  // pending or in flight
+  Size _incomplete_count{};
+};
+
+class Io_backend_impl {
+public:
+  virtual ~Io_backend_impl() = default;
+
+  virtual Io_backend kind() const noexcept = 0;
+
+  // Called after a request was pushed
+  virtual void notify() noexcept {}
+};
+
+void read_blocking(Io_request &request) noexcept {
+  auto const size = request.destination.size();
+#ifdef MARLON_UTIL_HAS_PREAD
+  auto const fd = open(request.path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    request.error = errno;
+    return;
+  }
+  while (request.result != size) {
+    auto const count = pread(fd,
+                             request.destination.begin + request.result,
+                             static_cast<std::size_t>(size - request.result),
+                             request.offset + request.result);
+    if (count > 0) {
+      request.result += count;
+    } else if (count == 0) {
+      break;
+    } else if (errno != EINTR) {
+      request.error = errno;
+      break;
+    }
+  }
+  close(fd);
+#else
+  auto const file = std::fopen(request.path, "rb");
+  if (file == nullptr) {
+    request.error = errno != 0 ? errno : EIO;
+    return;
+  }
+  if (std::fseek(file, static_cast<long>(request.offset), SEEK_SET) != 0) {
+    request.error = EIO;
+  } else {
+    request.result = static_cast<Size>(std::fread(
+        request.destination.begin, 1, static_cast<std::size_t>(size), file));
+    if (std::ferror(file)) {
+      request.error = EIO;
+    }
+  }
+  std::fclose(file);
+#endif
+}
+
+// Every thread blocks in one read at a time
+class Thread_io_backend final : public Io_backend_impl {
+public:
+  explicit Thread_io_backend(Io_queue &queue, Size thread_count) {
+    _threads.reserve(thread_count);
+    for (auto i = Size{}; i != thread_count; ++i) {
+      _threads.emplace_back([&queue](std::stop_token stop_token) {
+        while (auto const request = queue.pop(stop_token)) {
+          read_blocking(*request);
+          queue.complete(request);
+        }
+      });
+    }
+  }
+
+  Io_backend kind() const noexcept final { return Io_backend::threads; }
+
+private:
+  Allocating_list<std::jthread> _threads;
+};
+
+#ifdef MARLON_UTIL_HAS_IO_URING
+[[noreturn]] void throw_system_error(char const *what) {
+  throw std::system_error{errno, std::generic_category(), what};
+}
+
+// The submission and completion rings of an io_uring instance, talked to
+// through the raw system calls
+class Io_uring {
+public:
+  explicit Io_uring(unsigned entries) {
+    auto params = io_uring_params{};
+    _fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (_fd == -1) {
+      throw_system_error("io_uring_setup");
+    }
+    _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_ring_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    auto const single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      _sq_ring_size = _cq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+    }
+    _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    _sq_ring = map(_sq_ring_size, IORING_OFF_SQ_RING);
+    _cq_ring = single_mmap ? _sq_ring : map(_cq_ring_size, IORING_OFF_CQ_RING);
+    _sqes = static_cast<io_uring_sqe *>(map(_sqes_size, IORING_OFF_SQES));
+    if (_sq_ring == MAP_FAILED || _cq_ring == MAP_FAILED ||
+        _sqes == MAP_FAILED) {
+      auto const error = errno;
+      destroy();
+      errno = error;
+      throw_system_error("io_uring mmap");
+    }
+    auto const sq_ring = static_cast<std::byte *>(_sq_ring);
+    auto const cq_ring = static_cast<std::byte *>(_cq_ring);
+    _sq_entries = params.sq_entries;
+    _sq_tail = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.tail);
+    _sq_mask = *reinterpret_cast<unsigned *>(sq_ring + params.sq_off.ring_mask);
+    _sq_array = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.array);
+    _cq_head = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.tail);
+    _cq_mask = *reinterpret_cast<unsigned *>(cq_ring + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe *>(cq_ring + params.cq_off.cqes);
+    _local_sq_tail = *_sq_tail;
+  }
+
+  Io_uring(Io_uring const &other) = delete;
+
+  Io_uring &operator=(Io_uring const &other) = delete;
+
+  ~Io_uring() { destroy(); }
+
+  unsigned sq_entries() const noexcept { return _sq_entries; }
+
+  // The caller keeps the number of entries that are queued or in flight at
+  // or below sq_entries
+  io_uring_sqe *next_sqe() noexcept {
+    auto const index = _local_sq_tail & _sq_mask;
+    _sq_array[index] = index;
+    ++_local_sq_tail;
+    ++_unsubmitted_count;
+    auto const result = &_sqes[index];
+    std::memset(result, 0, sizeof(io_uring_sqe));
+    return result;
+  }
+
+  // Submits the queued entries in one system call and blocks until at least
+  // wait_count completions are available
+  void submit_and_wait(unsigned wait_count) noexcept {
+    std::atomic_ref<unsigned>{*_sq_tail}.store(_local_sq_tail,
+                                               std::memory_order_release);
+    for (;;) {
+      auto const result =
+          syscall(__NR_io_uring_enter,
+                  _fd,
+                  _unsubmitted_count,
+                  wait_count,
+                  wait_count != 0 ? IORING_ENTER_GETEVENTS : 0u,
+                  nullptr,
+                  0);
+      if (result >= 0) {
+        _unsubmitted_count -= static_cast<unsigned>(result);
+        return;
+      }
+      // EAGAIN and EBUSY mean the kernel is short on resources, the
+      // entries stay queued for the next call
+      if (errno != EINTR) {
+        return;
+      }
+    }
+  }
+
+  template <typename F> void for_each_completion(F &&f) {
+    auto head = std::atomic_ref<unsigned>{*_cq_head}.load(
+        std::memory_order_relaxed);
+    auto const tail = std::atomic_ref<unsigned>{*_cq_tail}.load(
+        std::memory_order_acquire);
+    for (; head != tail; ++head) {
+      f(_cqes[head & _cq_mask]);
+    }
+    std::atomic_ref<unsigned>{*_cq_head}.store(head,
+                                               std::memory_order_release);
+  }
+
+private:
+  void *map(std::size_t size, off_t offset) noexcept {
+    return mmap(nullptr,
+                size,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE,
+                _fd,
+                offset);
+  }
+
+  void destroy() noexcept {
+    if (_sqes != MAP_FAILED) {
+      munmap(_sqes, _sqes_size);
+    }
+    if (_cq_ring != MAP_FAILED && _cq_ring != _sq_ring) {
+      munmap(_cq_ring, _cq_ring_size);
+    }
+    if (_sq_ring != MAP_FAILED) {
+      munmap(_sq_ring, _sq_ring_size);
+    }
+    if (_fd != -1) {
+      close(_fd);
+    }
+  }
+
+  int _fd{-1};
+  void *_sq_ring{MAP_FAILED};
+  void *_cq_ring{MAP_FAILED};
+  io_uring_sqe *_sqes{static_cast<io_uring_sqe *>(MAP_FAILED)};
+  std::size_t _sq_ring_size{};
+  std::size_t _cq_ring_size{};
+  std::size_t _sqes_size{};
+  unsigned _sq_entries{};
+  unsigned *_sq_tail{};
+  unsigned _sq_mask{};
+  unsigned *_sq_array{};
+  unsigned *_cq_head{};
+  unsigned *_cq_tail{};
+  unsigned _cq_mask{};
+  io_uring_cqe *_cqes{};
+  unsigned _local_sq_tail{};
+  unsigned _unsubmitted_count{};
+};
+
+// One thread opens the files of the pending requests and submits their
+// reads to an io_uring in a single system call per batch. An eventfd read
+// wakes the thread up when new requests arrive while it waits for
+// completions.
+class Io_uring_backend final : public Io_backend_impl {
+public:
+  explicit Io_uring_backend(Io_queue &queue, Size queue_depth)
+      : _queue{&queue},
+        _ring{static_cast<unsigned>(std::max(queue_depth, Size{1}) + 1)} {
+    _wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (_wake_fd == -1) {
+      throw_system_error("eventfd");
+    }
+    // one entry stays reserved for the wake up read
+    _reads.resize(_ring.sq_entries() - 1);
+    for (auto &read : _reads) {
+      read.next_free = std::exchange(_free_reads, &read);
+    }
+    _thread = std::jthread{[this](std::stop_token stop_token) {
+      run(stop_token);
+    }};
+  }
+
+  ~Io_uring_backend() {
+    _thread.request_stop();
+    notify();
+    _thread.join();
+    close(_wake_fd);
+  }
+
+  Io_backend kind() const noexcept final { return Io_backend::io_uring; }
+
+  void notify() noexcept final {
+    auto const value = std::uint64_t{1};
+    [[maybe_unused]] auto const result = write(_wake_fd, &value, sizeof(value));
+  }
+
+private:
+  struct Read {
+    Io_request *request;
+    int fd;
+    iovec iov;
+    Read *next_free;
+  };
+
+  void run(std::stop_token const &stop_token) {
+    // after a stop request the reads in flight still write to their
+    // destinations, so they are waited for
+    while (!stop_token.stop_requested() || _in_flight_count != 0) {
+      if (!_wake_armed) {
+        _wake_iov = {.iov_base = &_wake_value, .iov_len = sizeof(_wake_value)};
+        auto const sqe = _ring.next_sqe();
+        sqe->opcode = IORING_OP_READV;
+        sqe->fd = _wake_fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(&_wake_iov);
+        sqe->len = 1;
+        sqe->user_data = 0;
+        _wake_armed = true;
+      }
+      if (!stop_token.stop_requested()) {
+        start_reads();
+      }
+      _ring.submit_and_wait(1);
+      _ring.for_each_completion(
+          [this](io_uring_cqe const &cqe) { handle_completion(cqe); });
+    }
+  }
+
+  void start_reads() {
+    auto requests = _queue->try_pop(_reads.size() - _in_flight_count);
+    while (!requests.empty()) {
+      auto const request = requests.pop_front();
+      auto const fd = open(request->path, O_RDONLY | O_CLOEXEC);
+      if (fd == -1) {
+        request->error = errno;
+        _queue->complete(request);
+        continue;
+      }
+      auto const read = std::exchange(_free_reads, _free_reads->next_free);
+      *read = Read{.request = request, .fd = fd, .iov = {}, .next_free = {}};
+      ++_in_flight_count;
+      submit_read(*read);
+    }
+  }
+
+  // Reads the rest of the request's destination
+  void submit_read(Read &read) noexcept {
+    auto const request = read.request;
+    read.iov = {
+        .iov_base = request->destination.begin + request->result,
+        .iov_len = static_cast<std::size_t>(request->destination.size() -
+                                            request->result),
+    };
+    auto const sqe = _ring.next_sqe();
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = read.fd;
+    sqe->off = static_cast<std::uint64_t>(request->offset + request->result);
+    sqe->addr = reinterpret_cast<std::uint64_t>(&read.iov);
+    sqe->len = 1;
+    sqe->user_data = reinterpret_cast<std::uint64_t>(&read);
+  }
+
+  void handle_completion(io_uring_cqe const &cqe) {
+    if (cqe.user_data == 0) {
+      _wake_armed = false;
+      return;
+    }
+    auto &read = *reinterpret_cast<Read *>(cqe.user_data);
+    auto const request = read.request;
+    if (cqe.res > 0) {
+      request->result += cqe.res;
+      if (request->result != request->destination.size()) {
+        // short read, e.g. interrupted by a signal
+        submit_read(read);
+        return;
+      }
+    } else if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+      submit_read(read);
+      return;
+    } else if (cqe.res < 0) {
+      request->error = -cqe.res;
+    }
+    close(read.fd);
+    read.next_free = std::exchange(_free_reads, &read);
+    --_in_flight_count;
+    _queue->complete(request);
+  }
+
+  Io_queue *_queue;
+  int _wake_fd{-1};
+  std::uint64_t _wake_value{};
+  iovec _wake_iov{};
+  bool _wake_armed{};
+  Allocating_list<Read> _reads;
+  Read *_free_reads{};
+  Size _in_flight_count{};
+  // destroyed before the wake up read's buffer
+  Io_uring _ring;
+  std::jthread _thread;
+};
+#endif
+} // namespace
+
+class Io_service::Impl {
+public:
+  Io_queue queue;
+  // stopped before the queue is destroyed
+  std::unique_ptr<Io_backend_impl> backend;
+};
+
+Io_service::Io_service(Io_service_create_info const &create_info)
+    : _impl{std::make_unique<Impl>()} {
+#ifdef MARLON_UTIL_HAS_IO_URING
+  if (create_info.backend != Io_backend::threads) {
+    try {
+      _impl->backend = std::make_unique<Io_uring_backend>(
+          _impl->queue, create_info.queue_depth);
+      return;
+    } catch (std::system_error const &) {
+      if (create_info.backend == Io_backend::io_uring) {
+        throw;
+      }
+    }
+  }
+#else
+  if (create_info.backend == Io_backend::io_uring) {
+    throw std::system_error{
+        std::make_error_code(std::errc::function_not_supported), "io_uring"};
+  }
+#endif
+  _impl->backend = std::make_unique<Thread_io_backend>(
+      _impl->queue, std::max(create_info.thread_count, Size{1}));
+}
+
+Io_service::~Io_service() {}
+
+Io_backend Io_service::backend() const noexcept {
+  return _impl->backend->kind();
+}
+
+void Io_service::submit(Io_request *request) {
+  request->result = 0;
+  request->error = 0;
+  _impl->queue.push(request);
+  _impl->backend->notify();
+}
+
+Size Io_service::poll() {
+  auto requests = _impl->queue.take_completed();
+  auto count = Size{};
+  while (!requests.empty()) {
+    // the callback may resubmit or destroy the request
+    auto const request = requests.pop_front();
+    auto const event = request->event;
+    if (request->callback != nullptr) {
+      request->callback(*request);
+    }
+    if (event != nullptr) {
+      event->set();
+    }
+    ++count;
+  }
+  return count;
+}
+
+Size Io_service::wait() {
+  _impl->queue.wait_until_complete();
+  return poll();
+}
+} // namespace util
+} // namespace marlon
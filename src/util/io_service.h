@@ -0,0 +1,91 @@
+#ifndef MARLON_UTIL_IO_SERVICE_H
+#define MARLON_UTIL_IO_SERVICE_H
+
+#include <memory>
+
+#include "memory.h"
+
+namespace marlon {
+namespace util {
+class Co_event;
+class Io_service;
+struct Io_request;
+
+// Pending requests are started highest priority first, in submission order
+// within a priority
+enum class Io_priority { high, normal, low };
+
+inline constexpr auto io_priority_count = 3;
+
+// automatic: io_uring if the kernel supports it, threads otherwise
+// io_uring: a single thread submits batches to an io_uring, Linux only
+// threads: a few threads block in read calls
+enum class Io_backend { automatic, io_uring, threads };
+
+// Run by Io_service::poll once the request completed
+using Io_callback = void (*)(Io_request &request);
+
+// Reads destination.size() bytes from offset of the file at path. The
+// request, its path and its destination belong to the service from submit
+// until the request completes.
+struct Io_request {
+  char const *path;
+  Size offset;
+  Block destination;
+  Io_priority priority{Io_priority::normal};
+  // Either may be null, the event is set after the callback ran
+  Io_callback callback{};
+  Co_event *event{};
+  void *user_data{};
+  // Number of bytes read, less than requested at the end of the file
+  Size result{};
+  // errno of a failed request, 0 on success
+  int error{};
+  // used by Io_service
+  Io_request *_next{};
+};
+
+struct Io_service_create_info {
+  Io_backend backend{Io_backend::automatic};
+  // Maximum number of reads in flight at once
+  Size queue_depth{64};
+  // Number of threads of the threads backend
+  Size thread_count{2};
+};
+
+// Loads files in the background so that streaming never blocks the frame
+// loop on disk. Requests may be submitted from any thread, but completions
+// are only reported by poll, which the frame loop calls once per iteration.
+// Callbacks therefore run on the polling thread, e.g. the one owning the
+// graphics context, and Co_events may be set from there.
+class Io_service {
+public:
+  // Throws std::system_error if io_uring is requested but unavailable
+  explicit Io_service(Io_service_create_info const &create_info = {});
+
+  // Waits for the reads in flight. Requests that were not started yet are
+  // dropped without running their callbacks.
+  ~Io_service();
+
+  // Either io_uring or threads
+  Io_backend backend() const noexcept;
+
+  void submit(Io_request *request);
+
+  // Runs the callbacks of the requests that completed since the last poll
+  // and returns their number. Never blocks on I/O. Only one thread may poll
+  // at a time.
+  Size poll();
+
+  // Blocks until every submitted request completed, then polls
+  Size wait();
+
+private:
+  class Impl;
+
+  std::unique_ptr<Impl> _impl;
+};
+} // namespace util
+} // namespace marlon
+
+#endif
@@ -0,0 +1,159 @@
+#include "io_service.h"
+
+#include <cerrno>
+#include <cstdint>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "co_task.h"
+#include "list.h"
+
+namespace marlon {
+namespace util {
+namespace {
+constexpr auto test_file_size = Size{1} << 20;
+
+std::uint8_t test_byte(Size offset) noexcept {
+  return static_cast<std::uint8_t>(offset * 7 + offset / 251);
+}
+
+std::string write_test_file() {
+  auto const path =
+      (std::filesystem::temp_directory_path() / "marlon_io_service_test")
+          .string();
+  auto file = std::ofstream{path, std::ios_base::binary};
+  for (auto i = Size{}; i != test_file_size; ++i) {
+    file.put(static_cast<char>(test_byte(i)));
+  }
+  return path;
+}
+
+bool has_test_bytes(Io_request const &request) {
+  for (auto i = Size{}; i != request.result; ++i) {
+    if (request.destination.begin[i] !=
+        std::byte{test_byte(request.offset + i)}) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void count_completion(Io_request &request) {
+  ++*static_cast<int *>(request.user_data);
+}
+
+Co_task<Size> read_async(Co_frame_allocator &,
+                         Thread_pool &pool,
+                         Io_service &service,
+                         Io_request &request) {
+  co_await schedule(pool);
+  auto event = Co_event{&pool};
+  request.event = &event;
+  service.submit(&request);
+  co_await event;
+  co_return request.result;
+}
+} // namespace
+
+TEST_CASE("marlon::util::Io_service") {
+  auto const path = write_test_file();
+  for (auto const backend : {Io_backend::threads, Io_backend::automatic}) {
+    auto service = Io_service{{.backend = backend, .queue_depth = 8}};
+    REQUIRE(service.backend() != Io_backend::automatic);
+    constexpr auto request_count = 64;
+    constexpr auto request_size = Size{10000};
+    auto const buffer_block = Unique_block<>{request_count * request_size};
+    auto const buffer = buffer_block.get();
+    auto requests = Allocating_list<Io_request>{};
+    auto completion_count = 0;
+    for (auto i = 0; i != request_count; ++i) {
+      requests.push_back({
+          .path = path.c_str(),
+          .offset = i * (test_file_size / request_count) + i,
+          .destination = Block{buffer.begin + i * request_size, request_size},
+          .priority = static_cast<Io_priority>(i % io_priority_count),
+          .callback = count_completion,
+          .user_data = &completion_count,
+      });
+    }
+    for (auto &request : requests) {
+      service.submit(&request);
+    }
+    auto polled_count = Size{};
+    while (polled_count != request_count) {
+      polled_count += service.poll();
+      std::this_thread::yield();
+    }
+    REQUIRE(completion_count == request_count);
+    for (auto const &request : requests) {
+      REQUIRE(request.error == 0);
+      REQUIRE(request.result == request_size);
+      REQUIRE(has_test_bytes(request));
+    }
+    SECTION("short read at the end of the file") {
+      auto request = Io_request{
+          .path = path.c_str(),
+          .offset = test_file_size - 100,
+          .destination = Block{buffer.begin, 1000},
+      };
+      service.submit(&request);
+      REQUIRE(service.wait() == 1);
+      REQUIRE(request.error == 0);
+      REQUIRE(request.result == 100);
+      REQUIRE(has_test_bytes(request));
+    }
+    SECTION("missing file") {
+      auto request = Io_request{
+          .path = "marlon_io_service_file_that_does_not_exist",
+          .offset = 0,
+          .destination = Block{buffer.begin, 1000},
+      };
+      service.submit(&request);
+      REQUIRE(service.wait() == 1);
+      REQUIRE(request.error == ENOENT);
+      REQUIRE(request.result == 0);
+    }
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("marlon::util::Io_service coroutine") {
+  auto const path = write_test_file();
+  auto frames_block = Unique_block<>{Co_frame_allocator::memory_requirement(1)};
+  auto frames = Co_frame_allocator{frames_block.get()};
+  auto pool = Thread_pool{2};
+  auto service = Io_service{};
+  auto const buffer = Unique_block<>{4096};
+  auto request = Io_request{
+      .path = path.c_str(),
+      .offset = 12345,
+      .destination = buffer.get(),
+  };
+  auto task = read_async(frames, pool, service, request);
+  task.start(pool);
+  // the frame loop: polls completions and helps out with tasks
+  while (!task.done()) {
+    service.poll();
+    pool.run_task();
+  }
+  REQUIRE(task.result() == 4096);
+  REQUIRE(has_test_bytes(request));
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("marlon::util::Io_service forced io_uring") {
+  try {
+    auto service = Io_service{{.backend = Io_backend::io_uring}};
+    REQUIRE(service.backend() == Io_backend::io_uring);
+  } catch (std::system_error const &) {
+    // no io_uring in this kernel or sandbox
+  }
+}
+} // namespace util
+} // namespace marlon
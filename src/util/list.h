@@ -3,6 +3,8 @@
 
 #include <cstddef>
 
+#include <algorithm>
+#include <limits>
 #include <utility>
 
 #include "capacity_error.h"
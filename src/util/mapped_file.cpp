@@ -0,0 +1,151 @@
+#include "mapped_file.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MARLON_UTIL_HAS_MMAP
+#else
+#include <cstdio>
+#endif
+
+#include <cerrno>
+
+#include <string>
+#include <system_error>
+
+namespace marlon {
+namespace util {
+namespace {
+[[noreturn]] void throw_file_error(char const *what, char const *path) {
+  throw std::system_error{
+      errno, std::generic_category(), std::string{what} + " " + path};
+}
+
+#ifdef MARLON_UTIL_HAS_MMAP
+int madvise_advice(File_access_pattern access_pattern) noexcept {
+  switch (access_pattern) {
+  case File_access_pattern::sequential:
+    return MADV_SEQUENTIAL;
+  case File_access_pattern::random:
+    return MADV_RANDOM;
+  case File_access_pattern::will_need:
+    return MADV_WILLNEED;
+  default:
+    return MADV_NORMAL;
+  }
+}
+
+// Closes the descriptor once mapped, the mapping keeps the file alive
+class File_descriptor {
+public:
+  explicit File_descriptor(int fd) noexcept : _fd{fd} {}
+
+  File_descriptor(File_descriptor const &other) = delete;
+
+  File_descriptor &operator=(File_descriptor const &other) = delete;
+
+  ~File_descriptor() {
+    if (_fd != -1) {
+      close(_fd);
+    }
+  }
+
+  int get() const noexcept { return _fd; }
+
+private:
+  int _fd;
+};
+#endif
+} // namespace
+
+#ifdef MARLON_UTIL_HAS_MMAP
+Mapped_file::Mapped_file(Mapped_file_create_info const &create_info) {
+  auto const fd = File_descriptor{open(create_info.path, O_RDONLY | O_CLOEXEC)};
+  if (fd.get() == -1) {
+    throw_file_error("Failed to open", create_info.path);
+  }
+  struct stat status;
+  if (fstat(fd.get(), &status) == -1) {
+    throw_file_error("Failed to stat", create_info.path);
+  }
+  auto const size = static_cast<Size>(status.st_size);
+  // mmap rejects empty mappings, an empty file maps to an empty block
+  if (size == 0) {
+    return;
+  }
+  auto flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+  if (create_info.populate) {
+    flags |= MAP_POPULATE;
+  }
+#endif
+  auto const data = mmap(nullptr,
+                         static_cast<std::size_t>(size),
+                         PROT_READ,
+                         flags,
+                         fd.get(),
+                         0);
+  if (data == MAP_FAILED) {
+    throw_file_error("Failed to map", create_info.path);
+  }
+  _data = Const_block{static_cast<std::byte const *>(data), size};
+  if (create_info.access_pattern != File_access_pattern::normal) {
+    advise(create_info.access_pattern, 0, size);
+  }
+}
+
+Mapped_file::~Mapped_file() {
+  if (_data.size() != 0) {
+    munmap(const_cast<std::byte *>(_data.begin),
+           static_cast<std::size_t>(_data.size()));
+  }
+}
+
+void Mapped_file::advise(File_access_pattern access_pattern,
+                         Size offset,
+                         Size size) const noexcept {
+  if (size == 0) {
+    return;
+  }
+  // madvise wants a page aligned address
+  auto const page_size = static_cast<Size>(sysconf(_SC_PAGESIZE));
+  auto const begin = offset & -page_size;
+  // A hint that fails changes nothing, so errors are ignored
+  madvise(const_cast<std::byte *>(_data.begin + begin),
+          static_cast<std::size_t>(offset + size - begin),
+          madvise_advice(access_pattern));
+}
+#else
+Mapped_file::Mapped_file(Mapped_file_create_info const &create_info) {
+  auto const file = std::fopen(create_info.path, "rb");
+  if (file == nullptr) {
+    throw_file_error("Failed to open", create_info.path);
+  }
+  std::fseek(file, 0, SEEK_END);
+  auto const size = static_cast<Size>(std::ftell(file));
+  std::fseek(file, 0, SEEK_SET);
+  if (size > 0) {
+    auto const block = System_allocator{}.alloc(size);
+    if (std::fread(block.begin, 1, static_cast<std::size_t>(size), file) !=
+        static_cast<std::size_t>(size)) {
+      System_allocator{}.free(block);
+      std::fclose(file);
+      throw_file_error("Failed to read", create_info.path);
+    }
+    _data = block;
+  }
+  std::fclose(file);
+}
+
+Mapped_file::~Mapped_file() {
+  if (_data.size() != 0) {
+    System_allocator{}.free(_data);
+  }
+}
+
+void Mapped_file::advise(File_access_pattern, Size, Size) const noexcept {}
+#endif
+} // namespace util
+} // namespace marlon
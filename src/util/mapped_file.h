@@ -0,0 +1,82 @@
+#ifndef MARLON_UTIL_MAPPED_FILE_H
+#define MARLON_UTIL_MAPPED_FILE_H
+
+#include <cassert>
+
+#include <span>
+#include <utility>
+
+#include "memory.h"
+
+namespace marlon {
+namespace util {
+// Hints for the page cache, see madvise
+enum class File_access_pattern {
+  normal,
+  sequential,
+  random,
+  // Starts reading the whole file ahead in the background
+  will_need,
+};
+
+struct Mapped_file_create_info {
+  char const *path;
+  File_access_pattern access_pattern{File_access_pattern::normal};
+  // Faults every page in up front (MAP_POPULATE) instead of on first access
+  bool populate{};
+};
+
+// Maps a whole file read-only. Where mmap is unavailable the file is read
+// into memory instead. Throws std::system_error if the file cannot be opened.
+class Mapped_file {
+public:
+  constexpr Mapped_file() noexcept = default;
+
+  explicit Mapped_file(Mapped_file_create_info const &create_info);
+
+  constexpr Mapped_file(Mapped_file &&other) noexcept
+      : _data{std::exchange(other._data, Const_block{})} {}
+
+  constexpr Mapped_file &operator=(Mapped_file &&other) noexcept {
+    auto temp{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  ~Mapped_file();
+
+  // Points into the page cache, valid until the file is unmapped
+  Const_block data() const noexcept { return _data; }
+
+  Size size() const noexcept { return _data.size(); }
+
+  // Views size bytes from offset as elements of T, e.g. the vertices of a
+  // mesh. The range must lie in the file and be aligned for T.
+  template <typename T>
+  std::span<T const> as_span(Size offset, Size size) const noexcept {
+    assert(offset >= 0 && size >= 0 && offset + size <= _data.size());
+    assert(ptrdiff(_data.begin + offset, nullptr) % alignof(T) == 0);
+    return util::as_span<T>(
+        Const_block{_data.begin + offset, _data.begin + offset + size});
+  }
+
+  template <typename T> std::span<T const> as_span() const noexcept {
+    return util::as_span<T>(_data);
+  }
+
+  // Changes the hint for part of the file, e.g. before streaming one mip
+  void advise(File_access_pattern access_pattern,
+              Size offset,
+              Size size) const noexcept;
+
+private:
+  constexpr void swap(Mapped_file &other) noexcept {
+    std::swap(_data, other._data);
+  }
+
+  Const_block _data{nullptr, nullptr};
+};
+} // namespace util
+} // namespace marlon
+
+#endif
@@ -0,0 +1,76 @@
+#include "mapped_file.h"
+
+#include <cstdint>
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+namespace {
+std::filesystem::path write_temp_file(char const *name,
+                                      void const *data,
+                                      std::size_t size) {
+  auto const path = std::filesystem::temp_directory_path() / name;
+  auto file = std::ofstream{path, std::ios_base::binary};
+  file.write(static_cast<char const *>(data), size);
+  return path;
+}
+} // namespace
+
+TEST_CASE("marlon::util::Mapped_file") {
+  auto const values = std::array<std::uint32_t, 4>{1, 2, 3, 0xdeadbeef};
+  auto const path =
+      write_temp_file("marlon_mapped_file_test", values.data(), sizeof(values));
+  SECTION("maps the contents of the file") {
+    auto const path_string = path.string();
+    auto const file = Mapped_file{{
+        .path = path_string.c_str(),
+        .access_pattern = File_access_pattern::sequential,
+        .populate = true,
+    }};
+    REQUIRE(file.size() == sizeof(values));
+    auto const span = file.as_span<std::uint32_t>();
+    REQUIRE(span.size() == values.size());
+    for (auto i = std::size_t{}; i != values.size(); ++i) {
+      REQUIRE(span[i] == values[i]);
+    }
+    auto const tail = file.as_span<std::uint32_t>(8, 8);
+    REQUIRE(tail.size() == 2);
+    REQUIRE(tail[1] == 0xdeadbeef);
+    file.advise(File_access_pattern::random, 4, 8);
+  }
+  SECTION("moves the mapping") {
+    auto const path_string = path.string();
+    auto file = Mapped_file{{.path = path_string.c_str()}};
+    auto const data = file.data();
+    auto other = Mapped_file{std::move(file)};
+    REQUIRE(file.size() == 0);
+    REQUIRE(other.data().begin == data.begin);
+    file = std::move(other);
+    REQUIRE(file.data().begin == data.begin);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("marlon::util::Mapped_file empty file") {
+  auto const path = write_temp_file("marlon_mapped_file_empty", nullptr, 0);
+  auto const path_string = path.string();
+  auto const file = Mapped_file{{.path = path_string.c_str()}};
+  REQUIRE(file.size() == 0);
+  REQUIRE(file.as_span<std::uint32_t>().empty());
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("marlon::util::Mapped_file missing file") {
+  REQUIRE_THROWS_AS(
+      Mapped_file{{.path = "marlon_mapped_file_that_does_not_exist"}},
+      std::system_error);
+}
+} // namespace util
+} // namespace marlon
@@ -2,11 +2,13 @@
 #define MARLON_UTIL_MEMORY_H
 
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 
 #include <bit>
 #include <functional>
 #include <new>
+#include <span>
 #include <type_traits>
 #include <utility>
 
@@ -46,6 +48,15 @@ struct Block {
   constexpr Size size() const noexcept { return end - begin; }
 };
 
+// Views the bytes of block as elements of T. The block must be aligned for T
+// and its size a multiple of sizeof(T).
+template <typename T>
+std::span<T const> as_span(Const_block block) noexcept {
+  static_assert(std::is_trivially_copyable_v<T>);
+  return {reinterpret_cast<T const *>(block.begin),
+          static_cast<std::size_t>(block.size()) / sizeof(T)};
+}
+
 // constexpr Const_block make_block(std::byte const *begin,
 //                                  std::byte const *end) noexcept {
 //   return {begin, end};
@@ -84,6 +95,8 @@ constexpr Size align(Size size, Size alignment) noexcept {
   return (size + alignment - 1) & -alignment;
 }
 
+inline constexpr auto cache_line_size = Size{64};
+
 inline Size ptrdiff(void const *p1, void const *p2) noexcept {
   return std::bit_cast<std::uintptr_t>(p1) - std::bit_cast<std::uintptr_t>(p2);
 }
@@ -116,6 +129,8 @@ public:
 
   Const_block block() const noexcept { return _block; }
 
+  Size used_size() const noexcept { return _top - _block.begin; }
+
   Block alloc(Size size) {
     auto const block_end = _top + size;
     auto const aligned_block_end = _top + align(size, Alignment);
@@ -136,6 +151,9 @@ public:
     }
   }
 
+  // Frees every allocation at once
+  void reset() noexcept { _top = _block.begin; }
+
   bool owns(Const_block block) const noexcept {
     return block.begin >= _block.begin && block.begin < _block.end;
   }
@@ -0,0 +1,133 @@
+#include <cstdint>
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "parallel_reduce.h"
+#include "parallel_scan.h"
+#include "parallel_sort.h"
+
+namespace marlon {
+namespace util {
+namespace {
+constexpr auto bench_grain = Size{4096};
+
+std::vector<std::uint32_t> random_keys(Size size) {
+  auto random_engine = std::mt19937{};
+  auto result = std::vector<std::uint32_t>(size);
+  for (auto &key : result) {
+    key = random_engine();
+  }
+  return result;
+}
+
+std::string bench_name(std::string const &algorithm,
+                       Size size,
+                       Size thread_count) {
+  return algorithm + ", " + std::to_string(size) + " elements, " +
+         std::to_string(thread_count) + " threads";
+}
+} // namespace
+
+// The copies of the input are part of every measurement, so only the
+// differences between the contenders are meaningful
+TEST_CASE("marlon::util::parallel_sort throughput") {
+  for (auto const size : {Size{10000}, Size{1000000}}) {
+    auto const keys = random_keys(size);
+    auto const indices = [&] {
+      auto result = std::vector<std::uint32_t>(size);
+      std::iota(result.begin(), result.end(), 0u);
+      return result;
+    }();
+    auto sorted_keys = keys;
+    auto sorted_indices = indices;
+    auto scratch = Unique_block<>{std::max(
+        parallel_sort_memory_requirement<std::uint32_t>(size),
+        parallel_radix_sort_memory_requirement<std::uint32_t, std::uint32_t>(
+            size, bench_grain))};
+    BENCHMARK(bench_name("std::sort", size, 0)) {
+      sorted_keys = keys;
+      std::sort(sorted_keys.begin(), sorted_keys.end());
+    };
+    BENCHMARK(bench_name("std::sort, std::execution::par", size, 0)) {
+      sorted_keys = keys;
+      std::sort(std::execution::par, sorted_keys.begin(), sorted_keys.end());
+    };
+    for (auto const thread_count : {1, 2, 4, 8}) {
+      auto pool = Thread_pool{thread_count};
+      BENCHMARK(bench_name("parallel_sort", size, thread_count)) {
+        sorted_keys = keys;
+        parallel_sort(pool, sorted_keys, bench_grain, scratch.get());
+      };
+      BENCHMARK(bench_name("parallel_radix_sort with payload",
+                           size,
+                           thread_count)) {
+        sorted_keys = keys;
+        sorted_indices = indices;
+        parallel_radix_sort(pool,
+                            std::span{sorted_keys},
+                            std::span{sorted_indices},
+                            bench_grain,
+                            scratch.get());
+      };
+    }
+  }
+}
+
+TEST_CASE("marlon::util::parallel_exclusive_scan throughput") {
+  for (auto const size : {Size{10000}, Size{1000000}}) {
+    auto const values = random_keys(size);
+    auto output = std::vector<std::uint32_t>(size);
+    auto scratch = Unique_block<>{
+        parallel_scan_memory_requirement<std::uint32_t>(size, bench_grain)};
+    BENCHMARK(bench_name("std::exclusive_scan", size, 0)) {
+      std::exclusive_scan(values.begin(), values.end(), output.begin(), 0u);
+    };
+    BENCHMARK(
+        bench_name("std::exclusive_scan, std::execution::par", size, 0)) {
+      std::exclusive_scan(std::execution::par,
+                          values.begin(),
+                          values.end(),
+                          output.begin(),
+                          0u);
+    };
+    for (auto const thread_count : {1, 2, 4, 8}) {
+      auto pool = Thread_pool{thread_count};
+      BENCHMARK(bench_name("parallel_exclusive_scan", size, thread_count)) {
+        return parallel_exclusive_scan(
+            pool, values, output.begin(), bench_grain, scratch.get(), 0u);
+      };
+    }
+  }
+}
+
+TEST_CASE("marlon::util::parallel_reduce throughput") {
+  for (auto const size : {Size{10000}, Size{1000000}}) {
+    auto const values = random_keys(size);
+    auto scratch = Unique_block<>{
+        parallel_reduce_memory_requirement<std::uint64_t>(size, bench_grain)};
+    BENCHMARK(bench_name("std::reduce", size, 0)) {
+      return std::reduce(values.begin(), values.end(), std::uint64_t{});
+    };
+    BENCHMARK(bench_name("std::reduce, std::execution::par", size, 0)) {
+      return std::reduce(
+          std::execution::par, values.begin(), values.end(), std::uint64_t{});
+    };
+    for (auto const thread_count : {1, 2, 4, 8}) {
+      auto pool = Thread_pool{thread_count};
+      BENCHMARK(bench_name("parallel_reduce", size, thread_count)) {
+        return parallel_reduce(
+            pool, values, bench_grain, scratch.get(), std::uint64_t{});
+      };
+    }
+  }
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,99 @@
+#ifndef MARLON_UTIL_PARALLEL_FOR_H
+#define MARLON_UTIL_PARALLEL_FOR_H
+
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+
+#include "thread_pool.h"
+
+namespace marlon {
+namespace util {
+namespace detail {
+// Runs fn on [begin, end), forking off the right half of the range as a new
+// task until chunks are no larger than grain. The forked tasks live on the
+// stack of the splitting thread, which helps out until they are done.
+template <std::random_access_iterator Iterator, typename Fn>
+class Parallel_for_task final : public Task {
+public:
+  explicit Parallel_for_task(Thread_pool *pool,
+                             Iterator begin,
+                             Iterator end,
+                             Size grain,
+                             Fn *fn) noexcept
+      : _pool{pool}, _begin{begin}, _end{end}, _grain{grain}, _fn{fn} {}
+
+  void run(Size thread_index) final {
+    split_and_run(_pool, _begin, _end, _grain, *_fn, thread_index);
+  }
+
+  static void split_and_run(Thread_pool *pool,
+                            Iterator begin,
+                            Iterator end,
+                            Size grain,
+                            Fn &fn,
+                            Size thread_index) {
+    if (end - begin <= grain) {
+      fn(std::ranges::subrange<Iterator>{begin, end}, thread_index);
+    } else {
+      auto const middle = begin + (end - begin) / 2;
+      auto right = Parallel_for_task{pool, middle, end, grain, &fn};
+      auto group = Task_group{pool};
+      group.push_notify(&right);
+      split_and_run(pool, begin, middle, grain, fn, thread_index);
+      group.wait();
+    }
+  }
+
+private:
+  Thread_pool *_pool;
+  Iterator _begin;
+  Iterator _end;
+  Size _grain;
+  Fn *_fn;
+};
+} // namespace detail
+
+// Number of chunks per thread parallel_for aims for when the range is large
+// enough, more chunks than threads leaves room for stealing to balance load.
+inline constexpr auto parallel_for_chunks_per_thread = Size{4};
+
+// Number of chunks of grain elements that cover size elements. The parallel
+// algorithms split their input into these chunks regardless of the pool's
+// size, which keeps their results deterministic.
+constexpr Size parallel_chunk_count(Size size, Size grain) noexcept {
+  grain = std::max(grain, Size{1});
+  return (size + grain - 1) / grain;
+}
+
+// Calls fn(subrange, thread_index) on disjoint chunks of range that together
+// cover all of it, and returns once every call has returned. The calling
+// thread runs chunks itself. Chunks hold at least grain elements unless the
+// whole range is smaller; for large ranges the chunk size grows so that each
+// thread, including the calling one, gets a few chunks.
+template <std::ranges::random_access_range Range, typename Fn>
+void parallel_for(Thread_pool &pool, Range &&range, Size grain, Fn &&fn) {
+  using Iterator = std::ranges::iterator_t<Range>;
+  auto const begin = std::ranges::begin(range);
+  auto const end = std::ranges::end(range);
+  auto const size = static_cast<Size>(end - begin);
+  auto const thread_count = pool.size() + 1;
+  auto const adapted_grain =
+      std::max({grain,
+                Size{1},
+                (size + parallel_for_chunks_per_thread * thread_count - 1) /
+                    (parallel_for_chunks_per_thread * thread_count)});
+  auto const thread_index = pool.thread_index();
+  if (pool.empty() || size <= adapted_grain) {
+    if (size != 0) {
+      fn(std::ranges::subrange<Iterator>{begin, end}, thread_index);
+    }
+  } else {
+    detail::Parallel_for_task<Iterator, std::remove_reference_t<Fn>>::
+        split_and_run(&pool, begin, end, adapted_grain, fn, thread_index);
+  }
+}
+} // namespace util
+} // namespace marlon
+
+#endif
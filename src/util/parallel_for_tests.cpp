@@ -0,0 +1,59 @@
+#include "parallel_for.h"
+
+#include <atomic>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::parallel_for") {
+  for (auto const thread_count : {0, 1, 4}) {
+    auto pool = Thread_pool{thread_count};
+    for (auto const size : {0, 1, 7, 1000, 100000}) {
+      auto visits = std::vector<std::atomic<int>>(size);
+      auto max_chunk_size = std::atomic<Size>{};
+      auto thread_indices_valid = std::atomic<bool>{true};
+      parallel_for(pool, visits, 16, [&](auto chunk, Size thread_index) {
+        if (thread_index != pool.thread_index()) {
+          thread_indices_valid = false;
+        }
+        auto chunk_size = static_cast<Size>(chunk.size());
+        auto expected = max_chunk_size.load();
+        while (chunk_size > expected &&
+               !max_chunk_size.compare_exchange_weak(expected, chunk_size)) {
+        }
+        for (auto &visit_count : chunk) {
+          visit_count.fetch_add(1, std::memory_order_relaxed);
+        }
+      });
+      REQUIRE(thread_indices_valid.load());
+      for (auto const &visit_count : visits) {
+        REQUIRE(visit_count.load() == 1);
+      }
+      if (thread_count != 0 && size > 16) {
+        REQUIRE(max_chunk_size.load() < size);
+      }
+    }
+  }
+}
+
+TEST_CASE("marlon::util::parallel_for nested") {
+  auto pool = Thread_pool{4};
+  auto outer = std::vector<int>(64);
+  auto total = std::atomic<int>{};
+  parallel_for(pool, outer, 1, [&](auto outer_chunk, Size) {
+    for ([[maybe_unused]] auto const &_ : outer_chunk) {
+      parallel_for(pool,
+                   std::views::iota(0, 1000),
+                   1,
+                   [&](auto inner_chunk, Size) {
+                     total.fetch_add(static_cast<int>(inner_chunk.size()),
+                                     std::memory_order_relaxed);
+                   });
+    }
+  });
+  REQUIRE(total.load() == 64 * 1000);
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,85 @@
+#ifndef MARLON_UTIL_PARALLEL_REDUCE_H
+#define MARLON_UTIL_PARALLEL_REDUCE_H
+
+#include <algorithm>
+#include <functional>
+#include <ranges>
+#include <utility>
+
+#include "memory.h"
+#include "parallel_for.h"
+
+namespace marlon {
+namespace util {
+// Bytes of scratch memory parallel_reduce and parallel_transform_reduce need
+template <typename T>
+constexpr Size parallel_reduce_memory_requirement(Size size,
+                                                  Size grain) noexcept {
+  return static_cast<Size>(sizeof(T)) * parallel_chunk_count(size, grain);
+}
+
+// Combines init with transform(x) for every element x of range using reduce,
+// which must be associative. Chunks of grain elements are reduced on the pool
+// and their results are combined in order on the calling thread, so the
+// result depends on grain but not on the pool or on scheduling, even for
+// floating point types.
+template <std::ranges::random_access_range Range,
+          typename T,
+          typename Reduce,
+          typename Transform>
+T parallel_transform_reduce(Thread_pool &pool,
+                            Range &&range,
+                            Size grain,
+                            Block scratch,
+                            T init,
+                            Reduce reduce,
+                            Transform transform) {
+  grain = std::max(grain, Size{1});
+  auto const begin = std::ranges::begin(range);
+  auto const size = static_cast<Size>(std::ranges::end(range) - begin);
+  auto const chunk_count = parallel_chunk_count(size, grain);
+  auto const partials = reinterpret_cast<T *>(scratch.begin);
+  parallel_for(
+      pool,
+      std::views::iota(Size{}, chunk_count),
+      1,
+      [&](auto chunk_range, Size) {
+        for (auto const chunk : chunk_range) {
+          auto it = begin + chunk * grain;
+          auto const end = begin + std::min(size, (chunk + 1) * grain);
+          auto partial = T(std::invoke(transform, *it));
+          for (++it; it != end; ++it) {
+            partial = std::invoke(
+                reduce, std::move(partial), std::invoke(transform, *it));
+          }
+          new (&partials[chunk]) T(std::move(partial));
+        }
+      });
+  for (auto chunk = Size{}; chunk != chunk_count; ++chunk) {
+    init = std::invoke(reduce, std::move(init), std::move(partials[chunk]));
+    partials[chunk].~T();
+  }
+  return init;
+}
+
+template <std::ranges::random_access_range Range,
+          typename T,
+          typename Reduce = std::plus<>>
+T parallel_reduce(Thread_pool &pool,
+                  Range &&range,
+                  Size grain,
+                  Block scratch,
+                  T init,
+                  Reduce reduce = {}) {
+  return parallel_transform_reduce(pool,
+                                   std::forward<Range>(range),
+                                   grain,
+                                   scratch,
+                                   std::move(init),
+                                   std::move(reduce),
+                                   std::identity{});
+}
+} // namespace util
+} // namespace marlon
+
+#endif
@@ -0,0 +1,45 @@
+#include "parallel_reduce.h"
+
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::parallel_reduce") {
+  auto random_engine = std::minstd_rand{};
+  auto distribution = std::uniform_real_distribution<float>{-1.0f, 1.0f};
+  auto floats = std::vector<float>(100000);
+  for (auto &value : floats) {
+    value = distribution(random_engine);
+  }
+  auto scratch = Unique_block<>{
+      parallel_reduce_memory_requirement<double>(100000, 1)};
+  for (auto const size : {0, 1, 7, 1000, 100000}) {
+    auto const items = std::span{floats}.first(size);
+    auto float_sums = std::vector<float>{};
+    for (auto const thread_count : {0, 1, 4}) {
+      auto pool = Thread_pool{thread_count};
+      auto const count = parallel_transform_reduce(
+          pool, items, 100, scratch.get(), Size{}, std::plus<>{}, [](float) {
+            return Size{1};
+          });
+      REQUIRE(count == size);
+      auto const maximum = parallel_reduce(
+          pool, items, 64, scratch.get(), -2.0f, [](float a, float b) {
+            return std::max(a, b);
+          });
+      REQUIRE(maximum ==
+              (size != 0 ? *std::ranges::max_element(items) : -2.0f));
+      float_sums.push_back(
+          parallel_reduce(pool, items, 256, scratch.get(), 0.0f));
+    }
+    // floating point sums are the same no matter how many threads added them
+    REQUIRE(float_sums[0] == float_sums[1]);
+    REQUIRE(float_sums[0] == float_sums[2]);
+  }
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,81 @@
+#ifndef MARLON_UTIL_PARALLEL_SCAN_H
+#define MARLON_UTIL_PARALLEL_SCAN_H
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <utility>
+
+#include "memory.h"
+#include "parallel_for.h"
+
+namespace marlon {
+namespace util {
+// Bytes of scratch memory parallel_exclusive_scan needs
+template <typename T>
+constexpr Size parallel_scan_memory_requirement(Size size,
+                                                Size grain) noexcept {
+  return static_cast<Size>(sizeof(T)) * parallel_chunk_count(size, grain);
+}
+
+// Writes init, op(init, x0), op(op(init, x0), x1), ... to output and returns
+// the combination of init with every element. op must be associative and
+// output may be the beginning of range. The sums of chunks of grain elements
+// are computed on the pool, scanned on the calling thread and then used as
+// the starting values of each chunk's scan, so the results depend on grain
+// but not on the pool or on scheduling.
+template <std::ranges::random_access_range Range,
+          std::random_access_iterator Output,
+          typename T,
+          typename Op = std::plus<>>
+T parallel_exclusive_scan(Thread_pool &pool,
+                          Range &&range,
+                          Output output,
+                          Size grain,
+                          Block scratch,
+                          T init,
+                          Op op = {}) {
+  grain = std::max(grain, Size{1});
+  auto const begin = std::ranges::begin(range);
+  auto const size = static_cast<Size>(std::ranges::end(range) - begin);
+  auto const chunk_count = parallel_chunk_count(size, grain);
+  auto const chunk_sums = reinterpret_cast<T *>(scratch.begin);
+  auto const chunks = std::views::iota(Size{}, chunk_count);
+  parallel_for(pool, chunks, 1, [&](auto chunk_range, Size) {
+    for (auto const chunk : chunk_range) {
+      auto it = begin + chunk * grain;
+      auto const end = begin + std::min(size, (chunk + 1) * grain);
+      auto sum = T(*it);
+      for (++it; it != end; ++it) {
+        sum = std::invoke(op, std::move(sum), *it);
+      }
+      new (&chunk_sums[chunk]) T(std::move(sum));
+    }
+  });
+  // turn the chunk sums into the values that start each chunk
+  for (auto chunk = Size{}; chunk != chunk_count; ++chunk) {
+    auto next = std::invoke(op, init, std::move(chunk_sums[chunk]));
+    chunk_sums[chunk] = std::move(init);
+    init = std::move(next);
+  }
+  parallel_for(pool, chunks, 1, [&](auto chunk_range, Size) {
+    for (auto const chunk : chunk_range) {
+      auto const chunk_begin = chunk * grain;
+      auto const chunk_end = std::min(size, (chunk + 1) * grain);
+      auto sum = std::move(chunk_sums[chunk]);
+      chunk_sums[chunk].~T();
+      for (auto i = chunk_begin; i != chunk_end; ++i) {
+        // read before writing in case output aliases the input
+        auto element = T(begin[i]);
+        output[i] = sum;
+        sum = std::invoke(op, std::move(sum), std::move(element));
+      }
+    }
+  });
+  return init;
+}
+} // namespace util
+} // namespace marlon
+
+#endif
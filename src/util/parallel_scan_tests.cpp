@@ -0,0 +1,63 @@
+#include "parallel_scan.h"
+
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::parallel_exclusive_scan") {
+  auto random_engine = std::minstd_rand{};
+  auto distribution = std::uniform_int_distribution<int>{0, 100};
+  auto values = std::vector<int>(100000);
+  for (auto &value : values) {
+    value = distribution(random_engine);
+  }
+  auto scratch =
+      Unique_block<>{parallel_scan_memory_requirement<int>(100000, 1)};
+  for (auto const thread_count : {0, 1, 4}) {
+    auto pool = Thread_pool{thread_count};
+    for (auto const size : {0, 1, 7, 1000, 100000}) {
+      auto const items = std::span{values}.first(size);
+      auto expected = std::vector<int>(size);
+      std::exclusive_scan(items.begin(), items.end(), expected.begin(), 5);
+      for (auto const grain : {1, 10, 4096}) {
+        auto output = std::vector<int>(size);
+        auto const total = parallel_exclusive_scan(
+            pool, items, output.begin(), grain, scratch.get(), 5);
+        REQUIRE(output == expected);
+        REQUIRE(total ==
+                std::accumulate(items.begin(), items.end(), 5));
+      }
+      // in place
+      auto in_place = std::vector<int>(items.begin(), items.end());
+      parallel_exclusive_scan(
+          pool, in_place, in_place.begin(), 64, scratch.get(), 5);
+      REQUIRE(in_place == expected);
+    }
+  }
+}
+
+TEST_CASE("marlon::util::parallel_exclusive_scan determinism") {
+  auto random_engine = std::minstd_rand{};
+  auto distribution = std::uniform_real_distribution<float>{0.0f, 1.0f};
+  auto values = std::vector<float>(100000);
+  for (auto &value : values) {
+    value = distribution(random_engine);
+  }
+  auto scratch =
+      Unique_block<>{parallel_scan_memory_requirement<float>(100000, 1000)};
+  auto outputs = std::vector<std::vector<float>>{};
+  for (auto const thread_count : {0, 1, 4}) {
+    auto pool = Thread_pool{thread_count};
+    auto &output = outputs.emplace_back(values.size());
+    parallel_exclusive_scan(
+        pool, values, output.begin(), 1000, scratch.get(), 0.0f);
+  }
+  REQUIRE(outputs[0] == outputs[1]);
+  REQUIRE(outputs[0] == outputs[2]);
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,241 @@
+#ifndef MARLON_UTIL_PARALLEL_SORT_H
+#define MARLON_UTIL_PARALLEL_SORT_H
+
+#include <cstdint>
+
+#include <algorithm>
+#include <functional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "memory.h"
+#include "parallel_for.h"
+
+namespace marlon {
+namespace util {
+namespace detail {
+// Number of elements of a that come first among the first k elements of the
+// stable merge of a and b
+template <typename T, typename Compare>
+Size merge_co_rank(Size k,
+                   std::span<T const> a,
+                   std::span<T const> b,
+                   Compare &comp) {
+  auto const a_size = static_cast<Size>(a.size());
+  auto const b_size = static_cast<Size>(b.size());
+  auto low = std::max(Size{}, k - b_size);
+  auto high = std::min(k, a_size);
+  while (low < high) {
+    auto const middle = low + (high - low) / 2;
+    if (std::invoke(comp, b[k - middle - 1], a[middle])) {
+      high = middle;
+    } else {
+      low = middle + 1;
+    }
+  }
+  return low;
+}
+
+template <typename T>
+void parallel_copy(Thread_pool &pool,
+                   T const *source,
+                   T *destination,
+                   Size size,
+                   Size grain) {
+  parallel_for(pool,
+               std::views::iota(Size{}, parallel_chunk_count(size, grain)),
+               1,
+               [&](auto chunk_range, Size) {
+                 for (auto const chunk : chunk_range) {
+                   auto const begin = chunk * grain;
+                   auto const end = std::min(size, begin + grain);
+                   std::copy(
+                       source + begin, source + end, destination + begin);
+                 }
+               });
+}
+} // namespace detail
+
+// Bytes of scratch memory parallel_sort needs
+template <typename T>
+constexpr Size parallel_sort_memory_requirement(Size size) noexcept {
+  return static_cast<Size>(sizeof(T)) * size;
+}
+
+// Sorts chunks of grain elements on the pool, then merges pairs of sorted
+// runs back and forth between range and scratch. Every merge is split into
+// pieces of about grain elements so that the last merges still spread over
+// the pool. Not stable, but the result depends only on the input and grain.
+template <std::ranges::contiguous_range Range,
+          typename Compare = std::ranges::less>
+void parallel_sort(Thread_pool &pool,
+                   Range &&range,
+                   Size grain,
+                   Block scratch,
+                   Compare comp = {}) {
+  using T = std::ranges::range_value_t<Range>;
+  static_assert(std::is_trivially_copyable_v<T>);
+  grain = std::max(grain, Size{1});
+  auto const data = std::ranges::data(range);
+  auto const size = static_cast<Size>(std::ranges::size(range));
+  if (size <= 1) {
+    return;
+  }
+  parallel_for(pool,
+               std::views::iota(Size{}, parallel_chunk_count(size, grain)),
+               1,
+               [&](auto chunk_range, Size) {
+                 for (auto const chunk : chunk_range) {
+                   auto const begin = chunk * grain;
+                   auto const end = std::min(size, begin + grain);
+                   std::sort(data + begin, data + end, comp);
+                 }
+               });
+  auto source = data;
+  auto destination = reinterpret_cast<T *>(scratch.begin);
+  for (auto width = grain; width < size; width *= 2) {
+    auto const pair_count = parallel_chunk_count(size, 2 * width);
+    auto const pieces_per_pair = parallel_chunk_count(2 * width, grain);
+    parallel_for(
+        pool,
+        std::views::iota(Size{}, pair_count * pieces_per_pair),
+        1,
+        [&](auto piece_range, Size) {
+          for (auto const piece : piece_range) {
+            auto const a_begin = piece / pieces_per_pair * 2 * width;
+            auto const a_end = std::min(size, a_begin + width);
+            auto const b_end = std::min(size, a_begin + 2 * width);
+            auto const output_begin =
+                a_begin + piece % pieces_per_pair * grain;
+            if (output_begin >= b_end) {
+              continue;
+            }
+            auto const output_end = std::min(b_end, output_begin + grain);
+            auto const a = std::span<T const>{source + a_begin,
+                                              source + a_end};
+            auto const b = std::span<T const>{source + a_end,
+                                              source + b_end};
+            auto const a_first = detail::merge_co_rank(
+                output_begin - a_begin, a, b, comp);
+            auto const a_last = detail::merge_co_rank(
+                output_end - a_begin, a, b, comp);
+            auto const b_first = output_begin - a_begin - a_first;
+            auto const b_last = output_end - a_begin - a_last;
+            std::merge(a.begin() + a_first,
+                       a.begin() + a_last,
+                       b.begin() + b_first,
+                       b.begin() + b_last,
+                       destination + output_begin,
+                       comp);
+          }
+        });
+    std::swap(source, destination);
+  }
+  if (source != data) {
+    detail::parallel_copy(pool, source, data, size, grain);
+  }
+}
+
+// Number of buckets of each parallel_radix_sort pass, which sorts by 8 bits
+inline constexpr auto radix_sort_bucket_count = Size{256};
+
+// Bytes of scratch memory parallel_radix_sort needs
+template <typename Key, typename Value>
+constexpr Size parallel_radix_sort_memory_requirement(Size size,
+                                                      Size grain) noexcept {
+  return Stack_allocator<>::memory_requirement({
+      static_cast<Size>(sizeof(Key)) * size,
+      static_cast<Size>(sizeof(Value)) * size,
+      static_cast<Size>(sizeof(Size)) * radix_sort_bucket_count *
+          parallel_chunk_count(size, grain),
+  });
+}
+
+// Stable LSD radix sort of 32 or 64 bit unsigned keys, values[i] moves along
+// with keys[i]. Each pass counts the digits of chunks of grain keys on the
+// pool, turns the counts into per-chunk offsets on the calling thread and
+// then scatters the chunks on the pool. Passes in which every key has the
+// same digit are skipped.
+template <typename Key, typename Value>
+void parallel_radix_sort(Thread_pool &pool,
+                         std::span<Key> keys,
+                         std::span<Value> values,
+                         Size grain,
+                         Block scratch) {
+  static_assert(std::is_same_v<Key, std::uint32_t> ||
+                std::is_same_v<Key, std::uint64_t>);
+  static_assert(std::is_trivially_copyable_v<Value>);
+  grain = std::max(grain, Size{1});
+  auto const size = static_cast<Size>(keys.size());
+  if (size <= 1) {
+    return;
+  }
+  auto const chunk_count = parallel_chunk_count(size, grain);
+  auto allocator = Stack_allocator<>{scratch};
+  auto source_keys = keys.data();
+  auto destination_keys = reinterpret_cast<Key *>(
+      allocator.alloc(static_cast<Size>(sizeof(Key)) * size).begin);
+  auto source_values = values.data();
+  auto destination_values = reinterpret_cast<Value *>(
+      allocator.alloc(static_cast<Size>(sizeof(Value)) * size).begin);
+  // counts, then offsets, of every bucket, grouped by chunk
+  auto const buckets = reinterpret_cast<Size *>(
+      allocator
+          .alloc(static_cast<Size>(sizeof(Size)) * radix_sort_bucket_count *
+                 chunk_count)
+          .begin);
+  auto const chunks = std::views::iota(Size{}, chunk_count);
+  for (auto shift = 0; shift != 8 * static_cast<int>(sizeof(Key));
+       shift += 8) {
+    parallel_for(pool, chunks, 1, [&](auto chunk_range, Size) {
+      for (auto const chunk : chunk_range) {
+        auto const chunk_buckets = buckets + chunk * radix_sort_bucket_count;
+        std::fill_n(chunk_buckets, radix_sort_bucket_count, Size{});
+        auto const end = std::min(size, (chunk + 1) * grain);
+        for (auto i = chunk * grain; i != end; ++i) {
+          ++chunk_buckets[(source_keys[i] >> shift) & 0xff];
+        }
+      }
+    });
+    auto const first_digit = (source_keys[0] >> shift) & 0xff;
+    auto first_digit_count = Size{};
+    for (auto chunk = Size{}; chunk != chunk_count; ++chunk) {
+      first_digit_count +=
+          buckets[chunk * radix_sort_bucket_count + first_digit];
+    }
+    if (first_digit_count == size) {
+      continue;
+    }
+    auto offset = Size{};
+    for (auto digit = Size{}; digit != radix_sort_bucket_count; ++digit) {
+      for (auto chunk = Size{}; chunk != chunk_count; ++chunk) {
+        auto &bucket = buckets[chunk * radix_sort_bucket_count + digit];
+        offset += std::exchange(bucket, offset);
+      }
+    }
+    parallel_for(pool, chunks, 1, [&](auto chunk_range, Size) {
+      for (auto const chunk : chunk_range) {
+        auto const chunk_buckets = buckets + chunk * radix_sort_bucket_count;
+        auto const end = std::min(size, (chunk + 1) * grain);
+        for (auto i = chunk * grain; i != end; ++i) {
+          auto const destination =
+              chunk_buckets[(source_keys[i] >> shift) & 0xff]++;
+          destination_keys[destination] = source_keys[i];
+          destination_values[destination] = source_values[i];
+        }
+      }
+    });
+    std::swap(source_keys, destination_keys);
+    std::swap(source_values, destination_values);
+  }
+  if (source_keys != keys.data()) {
+    detail::parallel_copy(pool, source_keys, keys.data(), size, grain);
+    detail::parallel_copy(pool, source_values, values.data(), size, grain);
+  }
+}
+} // namespace util
+} // namespace marlon
+
+#endif
@@ -0,0 +1,84 @@
+#include "parallel_sort.h"
+
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::parallel_sort") {
+  auto random_engine = std::minstd_rand{};
+  auto distribution = std::uniform_int_distribution<int>{0, 1000};
+  auto values = std::vector<int>(100000);
+  for (auto &value : values) {
+    value = distribution(random_engine);
+  }
+  auto scratch =
+      Unique_block<>{parallel_sort_memory_requirement<int>(100000)};
+  for (auto const thread_count : {0, 1, 4}) {
+    auto pool = Thread_pool{thread_count};
+    for (auto const size : {0, 1, 7, 1000, 100000}) {
+      auto expected = std::vector<int>(values.begin(), values.begin() + size);
+      std::sort(expected.begin(), expected.end(), std::greater<>{});
+      for (auto const grain : {1, 3, 256}) {
+        auto sorted = std::vector<int>(values.begin(), values.begin() + size);
+        parallel_sort(pool, sorted, grain, scratch.get(), std::greater<>{});
+        REQUIRE(sorted == expected);
+      }
+    }
+  }
+}
+
+namespace {
+template <typename Key> void test_parallel_radix_sort(int key_shift) {
+  struct Item {
+    Key key;
+    int index;
+  };
+  auto random_engine = std::mt19937_64{};
+  auto items = std::vector<Item>(100000);
+  for (auto i = 0; i != 100000; ++i) {
+    // few distinct keys spread over the high bits, plenty of equal keys
+    items[i] = {.key = static_cast<Key>(random_engine() % 4096) << key_shift,
+                .index = i};
+  }
+  auto scratch = Unique_block<>{
+      parallel_radix_sort_memory_requirement<Key, int>(100000, 1000)};
+  for (auto const thread_count : {0, 4}) {
+    auto pool = Thread_pool{thread_count};
+    for (auto const size : {0, 1, 7, 1000, 100000}) {
+      auto expected = std::vector<Item>(items.begin(), items.begin() + size);
+      std::stable_sort(expected.begin(),
+                       expected.end(),
+                       [](Item const &a, Item const &b) {
+                         return a.key < b.key;
+                       });
+      auto keys = std::vector<Key>{};
+      auto indices = std::vector<int>{};
+      for (auto i = 0; i != size; ++i) {
+        keys.push_back(items[i].key);
+        indices.push_back(items[i].index);
+      }
+      parallel_radix_sort(
+          pool, std::span{keys}, std::span{indices}, 1000, scratch.get());
+      auto mismatch_count = 0;
+      for (auto i = 0; i != size; ++i) {
+        mismatch_count += keys[i] != expected[i].key ||
+                          indices[i] != expected[i].index;
+      }
+      REQUIRE(mismatch_count == 0);
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("marlon::util::parallel_radix_sort") {
+  test_parallel_radix_sort<std::uint32_t>(0);
+  test_parallel_radix_sort<std::uint32_t>(20);
+  test_parallel_radix_sort<std::uint64_t>(3);
+  test_parallel_radix_sort<std::uint64_t>(50);
+}
+} // namespace util
+} // namespace marlon
@@ -3,8 +3,12 @@
 
 #include <cstddef>
 
+#include <atomic>
+#include <bit>
 #include <limits>
+#include <optional>
 #include <span>
+#include <type_traits>
 #include <utility>
 
 #include "capacity_error.h"
@@ -197,25 +201,25 @@ public:
   }
 
   void push_front(T const &object) {
-    if (_size != _slots.size()) {
+    if (_size != static_cast<Size>(_slots.size())) {
       auto const index = (_head + _slots.size() - 1) & (_slots.size() - 1);
       new (&_slots[index]) T(object);
       ++_size;
       _head = index;
     } else {
-      throw Capacity_error{};
+      throw Capacity_error{"Capacity_error in Queue::push_front"};
     }
   }
 
   template <typename... Args> T &emplace_front(Args &&...args) {
-    if (_size != _slots.size()) {
+    if (_size != static_cast<Size>(_slots.size())) {
       auto const index = (_head + _slots.size() - 1) & (_slots.size() - 1);
       auto &result = *new (&_slots[index]) T(std::forward<Args>(args)...);
       ++_size;
       _head = index;
       return result;
     } else {
-      throw Capacity_error{};
+      throw Capacity_error{"Capacity_error in Queue::emplace_front"};
     }
   }
 
@@ -374,7 +378,348 @@ private:
   Allocator _allocator;
   Lifetime_box<Queue<T>> _impl;
 };
+
+// Fixed capacity lock-free queue after Dmitry Vyukov's bounded MPMC queue.
+// Any number of threads may push and pop concurrently. Every slot carries a
+// sequence number that tells pushers and poppers whether it is their turn.
+template <typename T> class Mpmc_queue {
+  static_assert(std::is_nothrow_move_constructible_v<T>);
+
+public:
+  // max_size is rounded up to a power of two, which max_size() returns
+  template <typename Allocator>
+  static std::pair<Block, Mpmc_queue> make(Allocator &allocator,
+                                           Size max_size) {
+    auto const block = allocator.alloc(memory_requirement(max_size));
+    return {block, Mpmc_queue{block, max_size}};
+  }
+
+  // Of a queue of max_size rounded up to a power of two
+  static constexpr Size memory_requirement(Size max_size) noexcept {
+    if (max_size != 0) {
+      return static_cast<Size>(
+          sizeof(Cell) * std::bit_ceil(static_cast<std::size_t>(max_size)));
+    } else {
+      return 0;
+    }
+  }
+
+  constexpr Mpmc_queue() noexcept = default;
+
+  explicit Mpmc_queue(Block block, Size max_size) noexcept
+      : Mpmc_queue{block.begin, max_size} {}
+
+  explicit Mpmc_queue(void *block, Size max_size) noexcept
+      : _cells{static_cast<Cell *>(block),
+               max_size != 0 ? std::bit_ceil(static_cast<std::size_t>(max_size))
+                             : 0} {
+    for (auto i = std::size_t{}; i != _cells.size(); ++i) {
+      new (&_cells[i]) Cell{};
+      _cells[i].sequence.store(static_cast<Size>(i), std::memory_order_relaxed);
+    }
+  }
+
+  // not thread safe
+  Mpmc_queue(Mpmc_queue &&other) noexcept
+      : _cells{std::exchange(other._cells, std::span<Cell>{})},
+        _push_position{
+            other._push_position.exchange(0, std::memory_order_relaxed)},
+        _pop_position{
+            other._pop_position.exchange(0, std::memory_order_relaxed)} {}
+
+  // not thread safe
+  Mpmc_queue &operator=(Mpmc_queue &&other) noexcept {
+    auto temp = Mpmc_queue{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  ~Mpmc_queue() { clear(); }
+
+  Const_block block() const noexcept {
+    return {reinterpret_cast<std::byte const *>(_cells.data()),
+            static_cast<Size>(_cells.size_bytes())};
+  }
+
+  // approximate when called concurrently with push or pop
+  bool empty() const noexcept { return size() <= 0; }
+
+  // approximate when called concurrently with push or pop
+  Size size() const noexcept {
+    auto const pop_position = _pop_position.load(std::memory_order_relaxed);
+    auto const push_position = _push_position.load(std::memory_order_relaxed);
+    return push_position - pop_position;
+  }
+
+  Size max_size() const noexcept { return _cells.size(); }
+
+  Size capacity() const noexcept { return max_size(); }
+
+  // not thread safe
+  void clear() noexcept {
+    while (try_pop()) {
+    }
+  }
+
+  void push(T object) {
+    if (!try_push(std::move(object))) {
+      throw Capacity_error{"Capacity_error in Mpmc_queue::push"};
+    }
+  }
+
+  // Returns false if the queue is full, object is only moved from on success
+  bool try_push(T &&object) noexcept {
+    return try_emplace(std::move(object));
+  }
+
+  // Returns false if the queue is full
+  bool try_push(T const &object) noexcept {
+    return try_emplace(object);
+  }
+
+  // Returns false if the queue is full, args are only used on success
+  template <typename... Args> bool try_emplace(Args &&...args) noexcept {
+    static_assert(std::is_nothrow_constructible_v<T, Args &&...>);
+    if (_cells.empty()) {
+      return false;
+    }
+    auto const mask = max_size() - 1;
+    auto position = _push_position.load(std::memory_order_relaxed);
+    for (;;) {
+      auto &cell = _cells[position & mask];
+      auto const sequence = cell.sequence.load(std::memory_order_acquire);
+      auto const difference = sequence - position;
+      if (difference == 0) {
+        if (_push_position.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          new (cell.storage.data()) T(std::forward<Args>(args)...);
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = _push_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Returns an empty optional if the queue is empty
+  std::optional<T> try_pop() noexcept {
+    if (_cells.empty()) {
+      return std::nullopt;
+    }
+    auto const mask = max_size() - 1;
+    auto position = _pop_position.load(std::memory_order_relaxed);
+    for (;;) {
+      auto &cell = _cells[position & mask];
+      auto const sequence = cell.sequence.load(std::memory_order_acquire);
+      auto const difference = sequence - (position + 1);
+      if (difference == 0) {
+        if (_pop_position.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          auto const object = std::launder(
+              reinterpret_cast<T *>(cell.storage.data()));
+          auto result = std::optional<T>{std::move(*object)};
+          object->~T();
+          cell.sequence.store(position + mask + 1, std::memory_order_release);
+          return result;
+        }
+      } else if (difference < 0) {
+        return std::nullopt;
+      } else {
+        position = _pop_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  struct Cell {
+    std::atomic<Size> sequence;
+    Object_storage<T> storage;
+  };
+
+  void swap(Mpmc_queue &other) noexcept {
+    std::swap(_cells, other._cells);
+    _push_position.store(
+        other._push_position.exchange(
+            _push_position.load(std::memory_order_relaxed),
+            std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    _pop_position.store(other._pop_position.exchange(
+                            _pop_position.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+  }
+
+  // read by every push and pop, so kept off the lines the positions are
+  // written to
+  alignas(cache_line_size) std::span<Cell> _cells;
+  alignas(cache_line_size) std::atomic<Size> _push_position{};
+  alignas(cache_line_size) std::atomic<Size> _pop_position{};
+};
+
+// Fixed capacity lock-free queue for one pushing and one popping thread.
+// Each side caches the other side's position and only reloads it when the
+// queue looks full or empty.
+template <typename T> class Spsc_queue {
+  static_assert(std::is_nothrow_move_constructible_v<T>);
+
+public:
+  // max_size is rounded up to a power of two, which max_size() returns
+  template <typename Allocator>
+  static std::pair<Block, Spsc_queue> make(Allocator &allocator,
+                                           Size max_size) {
+    auto const block = allocator.alloc(memory_requirement(max_size));
+    return {block, Spsc_queue{block, max_size}};
+  }
+
+  // Of a queue of max_size rounded up to a power of two
+  static constexpr Size memory_requirement(Size max_size) noexcept {
+    if (max_size != 0) {
+      return static_cast<Size>(
+          sizeof(Object_storage<T>) *
+          std::bit_ceil(static_cast<std::size_t>(max_size)));
+    } else {
+      return 0;
+    }
+  }
+
+  constexpr Spsc_queue() noexcept = default;
+
+  explicit Spsc_queue(Block block, Size max_size) noexcept
+      : Spsc_queue{block.begin, max_size} {}
+
+  explicit Spsc_queue(void *block, Size max_size) noexcept
+      : _slots{static_cast<Object_storage<T> *>(block),
+               max_size != 0 ? std::bit_ceil(static_cast<std::size_t>(max_size))
+                             : 0} {}
+
+  // not thread safe
+  Spsc_queue(Spsc_queue &&other) noexcept
+      : _slots{std::exchange(other._slots, std::span<Object_storage<T>>{})},
+        _push_position{
+            other._push_position.exchange(0, std::memory_order_relaxed)},
+        _cached_pop_position{std::exchange(other._cached_pop_position, 0)},
+        _pop_position{
+            other._pop_position.exchange(0, std::memory_order_relaxed)},
+        _cached_push_position{std::exchange(other._cached_push_position, 0)} {}
+
+  // not thread safe
+  Spsc_queue &operator=(Spsc_queue &&other) noexcept {
+    auto temp = Spsc_queue{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  ~Spsc_queue() { clear(); }
+
+  Const_block block() const noexcept {
+    return {reinterpret_cast<std::byte const *>(_slots.data()),
+            static_cast<Size>(_slots.size_bytes())};
+  }
+
+  // approximate when called concurrently with push or pop
+  bool empty() const noexcept { return size() <= 0; }
+
+  // approximate when called concurrently with push or pop
+  Size size() const noexcept {
+    auto const pop_position = _pop_position.load(std::memory_order_relaxed);
+    auto const push_position = _push_position.load(std::memory_order_relaxed);
+    return push_position - pop_position;
+  }
+
+  Size max_size() const noexcept { return _slots.size(); }
+
+  Size capacity() const noexcept { return max_size(); }
+
+  // not thread safe
+  void clear() noexcept {
+    while (try_pop()) {
+    }
+  }
+
+  // May only be called by the pushing thread
+  void push(T object) {
+    if (!try_push(std::move(object))) {
+      throw Capacity_error{"Capacity_error in Spsc_queue::push"};
+    }
+  }
+
+  // May only be called by the pushing thread. Returns false if the queue is
+  // full, object is only moved from on success.
+  bool try_push(T &&object) noexcept {
+    return try_emplace(std::move(object));
+  }
+
+  // May only be called by the pushing thread. Returns false if the queue is
+  // full.
+  bool try_push(T const &object) noexcept {
+    return try_emplace(object);
+  }
+
+  // May only be called by the pushing thread. Returns false if the queue is
+  // full, args are only used on success.
+  template <typename... Args> bool try_emplace(Args &&...args) noexcept {
+    static_assert(std::is_nothrow_constructible_v<T, Args &&...>);
+    auto const position = _push_position.load(std::memory_order_relaxed);
+    if (position - _cached_pop_position == max_size()) {
+      _cached_pop_position = _pop_position.load(std::memory_order_acquire);
+      if (position - _cached_pop_position == max_size()) {
+        return false;
+      }
+    }
+    new (_slots[position & (max_size() - 1)].data())
+        T(std::forward<Args>(args)...);
+    _push_position.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // May only be called by the popping thread. Returns an empty optional if
+  // the queue is empty.
+  std::optional<T> try_pop() noexcept {
+    auto const position = _pop_position.load(std::memory_order_relaxed);
+    if (position == _cached_push_position) {
+      _cached_push_position = _push_position.load(std::memory_order_acquire);
+      if (position == _cached_push_position) {
+        return std::nullopt;
+      }
+    }
+    auto const object = std::launder(reinterpret_cast<T *>(
+        _slots[position & (max_size() - 1)].data()));
+    auto result = std::optional<T>{std::move(*object)};
+    object->~T();
+    _pop_position.store(position + 1, std::memory_order_release);
+    return result;
+  }
+
+private:
+  void swap(Spsc_queue &other) noexcept {
+    std::swap(_slots, other._slots);
+    _push_position.store(
+        other._push_position.exchange(
+            _push_position.load(std::memory_order_relaxed),
+            std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    std::swap(_cached_pop_position, other._cached_pop_position);
+    _pop_position.store(other._pop_position.exchange(
+                            _pop_position.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    std::swap(_cached_push_position, other._cached_push_position);
+  }
+
+  // read by every push and pop, so kept off the lines the positions are
+  // written to
+  alignas(cache_line_size) std::span<Object_storage<T>> _slots;
+  // written by the pushing thread
+  alignas(cache_line_size) std::atomic<Size> _push_position{};
+  Size _cached_pop_position{};
+  // written by the popping thread
+  alignas(cache_line_size) std::atomic<Size> _pop_position{};
+  Size _cached_push_position{};
+};
 } // namespace util
 } // namespace marlon
 
-#endif
\ No newline at end of file
+#endif
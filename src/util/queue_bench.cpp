@@ -0,0 +1,96 @@
+#include "queue.h"
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+namespace {
+constexpr auto bench_item_count = 100000;
+
+class Locked_queue {
+public:
+  bool try_push(int value) {
+    auto const lock = std::scoped_lock{_mutex};
+    _queue.push_back(value);
+    return true;
+  }
+
+  std::optional<int> try_pop() {
+    auto const lock = std::scoped_lock{_mutex};
+    if (_queue.empty()) {
+      return std::nullopt;
+    }
+    auto const result = _queue.front();
+    _queue.pop_front();
+    return result;
+  }
+
+private:
+  std::mutex _mutex;
+  Allocating_queue<int> _queue;
+};
+
+// Every producer pushes bench_item_count items, the consumers pop until all
+// of them are through
+template <typename Queue>
+void transfer(Queue &queue, int producer_count, int consumer_count) {
+  auto remaining_count = std::atomic<int>{producer_count * bench_item_count};
+  auto threads = std::vector<std::jthread>{};
+  for (auto i = 0; i != producer_count; ++i) {
+    threads.emplace_back([&] {
+      for (auto j = 0; j != bench_item_count; ++j) {
+        while (!queue.try_push(j)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto i = 0; i != consumer_count; ++i) {
+    threads.emplace_back([&] {
+      while (remaining_count.load(std::memory_order_relaxed) > 0) {
+        if (queue.try_pop()) {
+          remaining_count.fetch_sub(1, std::memory_order_relaxed);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+}
+} // namespace
+
+TEST_CASE("marlon::util::Mpmc_queue throughput") {
+  auto block = Unique_block<>{Mpmc_queue<int>::memory_requirement(1024)};
+  auto queue = Mpmc_queue<int>{block.get(), 1024};
+  auto locked_queue = Locked_queue{};
+  for (auto const thread_count : {1, 2, 4}) {
+    auto const name = std::to_string(thread_count) + " producers, " +
+                      std::to_string(thread_count) + " consumers, ";
+    BENCHMARK(name + "Mpmc_queue") {
+      transfer(queue, thread_count, thread_count);
+    };
+    BENCHMARK(name + "mutex and Allocating_queue") {
+      transfer(locked_queue, thread_count, thread_count);
+    };
+  }
+}
+
+TEST_CASE("marlon::util::Spsc_queue throughput") {
+  auto block = Unique_block<>{Spsc_queue<int>::memory_requirement(1024)};
+  auto queue = Spsc_queue<int>{block.get(), 1024};
+  auto locked_queue = Locked_queue{};
+  BENCHMARK("1 producer, 1 consumer, Spsc_queue") { transfer(queue, 1, 1); };
+  BENCHMARK("1 producer, 1 consumer, mutex and Allocating_queue") {
+    transfer(locked_queue, 1, 1);
+  };
+}
+} // namespace util
+} // namespace marlon
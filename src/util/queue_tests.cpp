@@ -1,11 +1,16 @@
 #include "queue.h"
 
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
 namespace marlon {
 namespace util {
 TEST_CASE("marlon::util::Queue") {
-  auto q = Allocating_queue<int>{System_allocator::instance()};
+  auto q = Allocating_queue<int>{};
   REQUIRE(q.size() == 0);
   REQUIRE(q.empty());
   REQUIRE(q.begin() == q.end());
@@ -30,5 +35,140 @@ TEST_CASE("marlon::util::Queue") {
     q.pop_back();
   }
 }
+TEST_CASE("marlon::util::Mpmc_queue") {
+  auto block = Unique_block<>{
+      Mpmc_queue<std::unique_ptr<int>>::memory_requirement(100)};
+  auto q = Mpmc_queue<std::unique_ptr<int>>{block.get(), 100};
+  REQUIRE(q.max_size() == 128);
+  REQUIRE(q.empty());
+  REQUIRE(!q.try_pop());
+  for (auto i = 0; i != 128; ++i) {
+    REQUIRE(q.try_push(std::make_unique<int>(i)));
+  }
+  REQUIRE(!q.try_push(std::make_unique<int>(128)));
+  REQUIRE_THROWS_AS(q.push(std::make_unique<int>(128)), Capacity_error);
+  REQUIRE(q.size() == 128);
+  for (auto i = 0; i != 64; ++i) {
+    REQUIRE(**q.try_pop() == i);
+  }
+  for (auto i = 128; i != 192; ++i) {
+    q.push(std::make_unique<int>(i));
+  }
+  for (auto i = 64; i != 128; ++i) {
+    REQUIRE(**q.try_pop() == i);
+  }
+  // the rest is destroyed with the queue
+}
+
+TEST_CASE("marlon::util::Mpmc_queue failed pushes keep their argument") {
+  auto block = Unique_block<>{
+      Mpmc_queue<std::unique_ptr<int>>::memory_requirement(2)};
+  auto q = Mpmc_queue<std::unique_ptr<int>>{block.get(), 2};
+  REQUIRE(q.try_emplace(std::make_unique<int>(0)));
+  REQUIRE(q.try_emplace(std::make_unique<int>(1)));
+  auto object = std::make_unique<int>(2);
+  REQUIRE(!q.try_push(std::move(object)));
+  REQUIRE(object);
+  REQUIRE(*object == 2);
+  REQUIRE(**q.try_pop() == 0);
+  REQUIRE(q.try_push(std::move(object)));
+  REQUIRE(!object);
+  REQUIRE(**q.try_pop() == 1);
+  REQUIRE(**q.try_pop() == 2);
+}
+
+TEST_CASE("marlon::util::Mpmc_queue contention") {
+  constexpr auto thread_count = 4;
+  constexpr auto item_count = 20000;
+  auto block = Unique_block<>{Mpmc_queue<int>::memory_requirement(256)};
+  auto q = Mpmc_queue<int>{block.get(), 256};
+  auto popped_count = std::atomic<int>{};
+  auto popped_sum = std::atomic<long long>{};
+  auto seen = std::vector<std::atomic<int>>(thread_count * item_count);
+  {
+    auto threads = std::vector<std::jthread>{};
+    for (auto i = 0; i != thread_count; ++i) {
+      threads.emplace_back([&, i] {
+        for (auto j = 0; j != item_count; ++j) {
+          while (!q.try_push(i * item_count + j)) {
+            std::this_thread::yield();
+          }
+        }
+      });
+      threads.emplace_back([&] {
+        while (popped_count.load(std::memory_order_relaxed) !=
+               thread_count * item_count) {
+          if (auto const item = q.try_pop()) {
+            seen[*item].fetch_add(1, std::memory_order_relaxed);
+            popped_sum.fetch_add(*item, std::memory_order_relaxed);
+            popped_count.fetch_add(1, std::memory_order_relaxed);
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+  }
+  auto const n = static_cast<long long>(thread_count) * item_count;
+  REQUIRE(popped_sum.load() == n * (n - 1) / 2);
+  auto duplicate_count = 0;
+  for (auto const &count : seen) {
+    duplicate_count += count.load() != 1;
+  }
+  REQUIRE(duplicate_count == 0);
+  REQUIRE(q.empty());
+}
+
+TEST_CASE("marlon::util::Spsc_queue") {
+  constexpr auto item_count = 100000;
+  auto block = Unique_block<>{Spsc_queue<int>::memory_requirement(64)};
+  auto q = Spsc_queue<int>{block.get(), 64};
+  REQUIRE(q.max_size() == 64);
+  for (auto i = 0; i != 64; ++i) {
+    q.push(i);
+  }
+  REQUIRE_THROWS_AS(q.push(64), Capacity_error);
+  for (auto i = 0; i != 64; ++i) {
+    REQUIRE(*q.try_pop() == i);
+  }
+  REQUIRE(!q.try_pop());
+  auto out_of_order_count = 0;
+  {
+    auto producer = std::jthread{[&] {
+      for (auto i = 0; i != item_count; ++i) {
+        while (!q.try_push(i)) {
+          std::this_thread::yield();
+        }
+      }
+    }};
+    for (auto expected = 0; expected != item_count;) {
+      if (auto const item = q.try_pop()) {
+        out_of_order_count += *item != expected;
+        ++expected;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+  REQUIRE(out_of_order_count == 0);
+  REQUIRE(q.empty());
+}
+
+TEST_CASE("marlon::util::Spsc_queue failed pushes keep their argument") {
+  auto block = Unique_block<>{
+      Spsc_queue<std::unique_ptr<int>>::memory_requirement(2)};
+  auto q = Spsc_queue<std::unique_ptr<int>>{block.get(), 2};
+  REQUIRE(q.try_emplace(std::make_unique<int>(0)));
+  REQUIRE(q.try_emplace(std::make_unique<int>(1)));
+  auto object = std::make_unique<int>(2);
+  REQUIRE(!q.try_push(std::move(object)));
+  REQUIRE(object);
+  REQUIRE(*object == 2);
+  REQUIRE(**q.try_pop() == 0);
+  REQUIRE(q.try_push(std::move(object)));
+  REQUIRE(!object);
+  REQUIRE(**q.try_pop() == 1);
+  REQUIRE(**q.try_pop() == 2);
+}
 } // namespace util
 } // namespace marlon
\ No newline at end of file
@@ -0,0 +1,221 @@
+#ifndef MARLON_UTIL_SLOT_MAP_H
+#define MARLON_UTIL_SLOT_MAP_H
+
+#include <cassert>
+#include <cstdint>
+
+#include <algorithm>
+#include <span>
+#include <utility>
+
+#include "capacity_error.h"
+#include "list.h"
+#include "memory.h"
+
+namespace marlon {
+namespace util {
+// Handle of a Slot_map element. The generation tells apart the elements that
+// used the same index one after another.
+struct Slot_map_handle {
+  std::uint32_t index;
+  std::uint32_t generation;
+
+  friend constexpr bool operator==(Slot_map_handle lhs,
+                                   Slot_map_handle rhs) noexcept = default;
+};
+
+// Fixed capacity container that hands out a handle for every element. The
+// elements are stored without gaps, so iterating costs O(size()) no matter
+// the capacity, and a sparse list of slots maps handle indices to element
+// positions in O(1). Erasing moves the last element into the gap, which
+// invalidates pointers to it. Every slot counts how often its index was
+// erased, so handles of erased elements are detected until the count wraps
+// around at 2^Generation_bits.
+template <typename T, int Generation_bits = 32> class Slot_map {
+  struct Slot {
+    // position of the element, or the next free slot if the slot is free
+    std::uint32_t position;
+    std::uint32_t generation;
+  };
+
+  static constexpr auto alignment =
+      std::max(alignof(T), alignof(Slot_map_handle));
+
+  static constexpr auto no_slot = ~std::uint32_t{};
+
+public:
+  using Handle = Slot_map_handle;
+  using Iterator = T *;
+  using Const_iterator = T const *;
+
+  static_assert(Generation_bits > 0 && Generation_bits <= 32);
+
+  static constexpr auto generation_mask =
+      ~std::uint32_t{} >> (32 - Generation_bits);
+
+  template <typename Allocator>
+  static std::pair<Block, Slot_map> make(Allocator &allocator, Size max_size) {
+    auto const block = allocator.alloc(memory_requirement(max_size));
+    return {block, Slot_map{block, max_size}};
+  }
+
+  static constexpr Size memory_requirement(Size max_size) noexcept {
+    return Stack_allocator<alignment>::memory_requirement({
+        List<T>::memory_requirement(max_size),
+        List<Handle>::memory_requirement(max_size),
+        List<Slot>::memory_requirement(max_size),
+    });
+  }
+
+  constexpr Slot_map() noexcept = default;
+
+  explicit Slot_map(Block block, Size max_size) noexcept
+      : Slot_map{block.begin, max_size} {}
+
+  explicit Slot_map(void *block, Size max_size) noexcept {
+    auto allocator = Stack_allocator<alignment>{
+        {static_cast<std::byte *>(block), memory_requirement(max_size)}};
+    _elements = List<T>::make(allocator, max_size).second;
+    _handles = List<Handle>::make(allocator, max_size).second;
+    _slots = List<Slot>::make(allocator, max_size).second;
+  }
+
+  Slot_map(Slot_map &&other) noexcept
+      : _elements{std::move(other._elements)},
+        _handles{std::move(other._handles)},
+        _slots{std::move(other._slots)},
+        _free_slot{std::exchange(other._free_slot, no_slot)} {}
+
+  Slot_map &operator=(Slot_map &&other) noexcept {
+    auto temp{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  Const_block block() const noexcept {
+    return {_elements.block().begin, _slots.block().end};
+  }
+
+  Iterator begin() noexcept { return _elements.begin(); }
+
+  Const_iterator begin() const noexcept { return _elements.begin(); }
+
+  Const_iterator cbegin() const noexcept { return _elements.cbegin(); }
+
+  Iterator end() noexcept { return _elements.end(); }
+
+  Const_iterator end() const noexcept { return _elements.end(); }
+
+  Const_iterator cend() const noexcept { return _elements.cend(); }
+
+  // The elements in iteration order
+  std::span<T> elements() noexcept {
+    return {_elements.data(), static_cast<std::size_t>(size())};
+  }
+
+  std::span<T const> elements() const noexcept {
+    return {_elements.data(), static_cast<std::size_t>(size())};
+  }
+
+  // The handle of every element, in iteration order
+  std::span<Handle const> handles() const noexcept {
+    return {_handles.data(), static_cast<std::size_t>(size())};
+  }
+
+  bool empty() const noexcept { return _elements.empty(); }
+
+  Size size() const noexcept { return _elements.size(); }
+
+  Size max_size() const noexcept { return _elements.max_size(); }
+
+  // Handles of erased elements stay detectable
+  void clear() noexcept {
+    while (!empty()) {
+      erase(_handles.back());
+    }
+  }
+
+  template <typename... Args> Handle emplace(Args &&...args) {
+    if (size() == max_size()) {
+      throw Capacity_error{"Capacity_error in Slot_map::emplace"};
+    }
+    _elements.emplace_back(std::forward<Args>(args)...);
+    auto const position = static_cast<std::uint32_t>(size() - 1);
+    auto index = _free_slot;
+    if (index != no_slot) {
+      _free_slot = _slots[index].position;
+      _slots[index].position = position;
+    } else {
+      index = static_cast<std::uint32_t>(_slots.size());
+      _slots.push_back(Slot{.position = position, .generation = 0});
+    }
+    auto const result =
+        Handle{.index = index, .generation = _slots[index].generation};
+    _handles.push_back(result);
+    return result;
+  }
+
+  // The handle must be valid
+  void erase(Handle handle) noexcept {
+    assert(contains(handle));
+    auto &slot = _slots[handle.index];
+    auto const position = slot.position;
+    if (position != static_cast<std::uint32_t>(size() - 1)) {
+      _elements[position] = std::move(_elements.back());
+      _handles[position] = _handles.back();
+      _slots[_handles[position].index].position = position;
+    }
+    _elements.pop_back();
+    _handles.pop_back();
+    slot.position = std::exchange(_free_slot, handle.index);
+    slot.generation = (slot.generation + 1) & generation_mask;
+  }
+
+  bool contains(Handle handle) const noexcept {
+    if (handle.index >= static_cast<std::uint32_t>(_slots.size())) {
+      return false;
+    }
+    // free slots keep the next free slot in position
+    auto const position = _slots[handle.index].position;
+    return position < static_cast<std::uint32_t>(size()) &&
+           _handles[position] == handle;
+  }
+
+  // Returns nullptr if handle's element was erased
+  T *find(Handle handle) noexcept {
+    return contains(handle) ? &_elements[_slots[handle.index].position]
+                            : nullptr;
+  }
+
+  T const *find(Handle handle) const noexcept {
+    return const_cast<Slot_map *>(this)->find(handle);
+  }
+
+  // The handle must be valid
+  T &operator[](Handle handle) noexcept {
+    assert(contains(handle));
+    return _elements[_slots[handle.index].position];
+  }
+
+  T const &operator[](Handle handle) const noexcept {
+    assert(contains(handle));
+    return _elements[_slots[handle.index].position];
+  }
+
+private:
+  void swap(Slot_map &other) noexcept {
+    std::swap(_elements, other._elements);
+    std::swap(_handles, other._handles);
+    std::swap(_slots, other._slots);
+    std::swap(_free_slot, other._free_slot);
+  }
+
+  List<T> _elements;
+  List<Handle> _handles;
+  List<Slot> _slots;
+  std::uint32_t _free_slot{no_slot};
+};
+} // namespace util
+} // namespace marlon
+
+#endif
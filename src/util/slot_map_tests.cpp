@@ -0,0 +1,98 @@
+#include "slot_map.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::Slot_map") {
+  auto const max_size = 8;
+  auto const block =
+      Unique_block<>{Slot_map<std::unique_ptr<int>>::memory_requirement(8)};
+  auto map = Slot_map<std::unique_ptr<int>>{};
+  REQUIRE(map.begin() == map.end());
+  REQUIRE(map.size() == 0);
+  REQUIRE(map.max_size() == 0);
+  REQUIRE(!map.contains({.index = 0, .generation = 0}));
+  map = Slot_map<std::unique_ptr<int>>{block.get(), max_size};
+  auto handles = std::vector<Slot_map_handle>{};
+  for (auto i = 0; i != max_size; ++i) {
+    handles.emplace_back(map.emplace(std::make_unique<int>(i)));
+    REQUIRE(map.size() == i + 1);
+  }
+  REQUIRE_THROWS_AS(map.emplace(), Capacity_error);
+  for (auto i = 0; i != max_size; ++i) {
+    REQUIRE(map.contains(handles[i]));
+    REQUIRE(*map[handles[i]] == i);
+  }
+  map.erase(handles[2]);
+  map.erase(handles[5]);
+  REQUIRE(map.size() == max_size - 2);
+  REQUIRE(!map.contains(handles[2]));
+  REQUIRE(map.find(handles[5]) == nullptr);
+  for (auto i : {0, 1, 3, 4, 6, 7}) {
+    REQUIRE(*map[handles[i]] == i);
+  }
+  // reused slots get new generations
+  auto const reused = map.emplace(std::make_unique<int>(8));
+  REQUIRE((reused.index == handles[2].index ||
+           reused.index == handles[5].index));
+  REQUIRE(reused != handles[2]);
+  REQUIRE(reused != handles[5]);
+  REQUIRE(!map.contains(handles[2]));
+  REQUIRE(!map.contains(handles[5]));
+  REQUIRE(*map[reused] == 8);
+  auto visited = Size{};
+  for (auto const &element : map) {
+    REQUIRE(element != nullptr);
+    ++visited;
+  }
+  REQUIRE(visited == map.size());
+  for (auto i = Size{}; i != map.size(); ++i) {
+    REQUIRE(&map[map.handles()[i]] == &map.elements()[i]);
+  }
+  map.clear();
+  REQUIRE(map.size() == 0);
+  REQUIRE(!map.contains(reused));
+}
+
+TEST_CASE("marlon::util::Slot_map random operations") {
+  auto random_engine = std::mt19937{42};
+  auto const max_size = 100;
+  auto const block =
+      Unique_block<>{Slot_map<int, 4>::memory_requirement(max_size)};
+  auto map = Slot_map<int, 4>{block.get(), max_size};
+  auto expected = std::vector<std::pair<Slot_map_handle, int>>{};
+  auto erased = std::vector<Slot_map_handle>{};
+  for (auto i = 0; i != 10000; ++i) {
+    if (expected.size() != max_size && random_engine() % 2 == 0) {
+      expected.emplace_back(map.emplace(i), i);
+    } else if (!expected.empty()) {
+      auto const j = random_engine() % expected.size();
+      map.erase(expected[j].first);
+      erased.emplace_back(expected[j].first);
+      expected[j] = expected.back();
+      expected.pop_back();
+    }
+    REQUIRE(map.size() == static_cast<Size>(expected.size()));
+    for (auto const &[handle, value] : expected) {
+      REQUIRE(map.contains(handle));
+      REQUIRE(map[handle] == value);
+    }
+    // generations wrap around after 16 erasures of the same slot
+    if (erased.size() > 15) {
+      erased.erase(erased.begin());
+    }
+    for (auto const handle : erased) {
+      auto const live = std::ranges::any_of(
+          expected, [&](auto const &p) { return p.first == handle; });
+      REQUIRE(map.contains(handle) == live);
+    }
+  }
+}
+} // namespace util
+} // namespace marlon
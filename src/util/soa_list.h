@@ -0,0 +1,285 @@
+#ifndef MARLON_UTIL_SOA_LIST_H
+#define MARLON_UTIL_SOA_LIST_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "capacity_error.h"
+#include "memory.h"
+
+namespace marlon {
+namespace util {
+// Non-owning view of size consecutive elements of a structure of arrays, one
+// span per field. Fields may be const qualified for read-only views.
+template <typename... Fields> class Soa_span {
+public:
+  using Reference = std::tuple<Fields &...>;
+
+  template <std::size_t I>
+  using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+  constexpr Soa_span() noexcept = default;
+
+  constexpr explicit Soa_span(Fields *...data, Size size) noexcept
+      : _data{data...}, _size{size} {}
+
+  template <typename... Other_fields>
+    requires(std::is_convertible_v<Other_fields (*)[], Fields (*)[]> && ...)
+  constexpr Soa_span(Soa_span<Other_fields...> other) noexcept
+      : _data{std::apply(
+            [](auto... spans) {
+              return std::tuple<Fields *...>{spans.data()...};
+            },
+            other.spans())},
+        _size{other.size()} {}
+
+  constexpr bool empty() const noexcept { return _size == 0; }
+
+  constexpr Size size() const noexcept { return _size; }
+
+  template <std::size_t I> constexpr std::span<Field<I>> span() const noexcept {
+    return {std::get<I>(_data), static_cast<std::size_t>(_size)};
+  }
+
+  constexpr std::tuple<std::span<Fields>...> spans() const noexcept {
+    return std::apply(
+        [this](auto... data) {
+          return std::tuple<std::span<Fields>...>{
+              std::span<Fields>{data, static_cast<std::size_t>(_size)}...};
+        },
+        _data);
+  }
+
+  constexpr Reference operator[](Size index) const noexcept {
+    assert(index >= 0 && index < _size);
+    return std::apply(
+        [index](auto... data) { return Reference{data[index]...}; }, _data);
+  }
+
+  constexpr Soa_span subspan(Size offset, Size count) const noexcept {
+    assert(offset >= 0 && count >= 0 && offset + count <= _size);
+    auto result = Soa_span{};
+    result._data = std::apply(
+        [offset](auto... data) {
+          return std::tuple<Fields *...>{data + offset...};
+        },
+        _data);
+    result._size = count;
+    return result;
+  }
+
+  // Consecutive subspans of chunk_size elements, the last one may be
+  // shorter. The chunks form a random access range, so they can be handed
+  // to parallel_for.
+  constexpr auto chunks(Size chunk_size) const noexcept {
+    assert(chunk_size > 0);
+    auto const chunk_count = (_size + chunk_size - 1) / chunk_size;
+    return std::views::iota(Size{}, chunk_count) |
+           std::views::transform([span = *this, chunk_size](Size chunk) {
+             auto const offset = chunk * chunk_size;
+             return span.subspan(offset,
+                                 std::min(chunk_size, span.size() - offset));
+           });
+  }
+
+private:
+  std::tuple<Fields *...> _data{};
+  Size _size{};
+};
+
+// Fixed capacity list that stores every field of its elements in a separate
+// array, so that loops over a few fields only touch their memory and can use
+// SIMD. Every array starts at a multiple of field_alignment, and chunks of a
+// multiple of field_alignment / sizeof(field) elements keep that alignment.
+// Fields must be trivially copyable. Element access through tuples of
+// references is meant for code that isn't hot.
+template <typename... Fields> class Soa_list {
+  static_assert(sizeof...(Fields) > 0);
+  static_assert((std::is_trivially_copyable_v<Fields> && ...));
+
+public:
+  using Reference = std::tuple<Fields &...>;
+  using Const_reference = std::tuple<Fields const &...>;
+  using Span = Soa_span<Fields...>;
+  using Const_span = Soa_span<Fields const...>;
+
+  template <std::size_t I>
+  using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+  static constexpr auto field_alignment = cache_line_size;
+
+  template <typename Allocator>
+  static std::pair<Block, Soa_list> make(Allocator &allocator, Size max_size) {
+    auto const block = allocator.alloc(memory_requirement(max_size));
+    return {block, Soa_list{block, max_size}};
+  }
+
+  static constexpr Size memory_requirement(Size max_size) noexcept {
+    // room to align the first array
+    return field_alignment +
+           Stack_allocator<field_alignment>::memory_requirement(
+               {static_cast<Size>(sizeof(Fields)) * max_size...});
+  }
+
+  constexpr Soa_list() noexcept = default;
+
+  explicit Soa_list(Block block, Size max_size) noexcept
+      : Soa_list{block.begin, max_size} {}
+
+  explicit Soa_list(void *block, Size max_size) noexcept
+      : _block{static_cast<std::byte *>(block)}, _max_size{max_size} {
+    auto const address = ptrdiff(_block, nullptr);
+    auto const aligned_begin =
+        _block + (align(address, field_alignment) - address);
+    auto allocator = Stack_allocator<field_alignment>{
+        {aligned_begin, _block + memory_requirement(max_size)}};
+    _data = std::tuple<Fields *...>{reinterpret_cast<Fields *>(
+        allocator.alloc(static_cast<Size>(sizeof(Fields)) * max_size)
+            .begin)...};
+  }
+
+  Soa_list(Soa_list &&other) noexcept
+      : _data{std::exchange(other._data, std::tuple<Fields *...>{})},
+        _block{std::exchange(other._block, nullptr)},
+        _size{std::exchange(other._size, 0)},
+        _max_size{std::exchange(other._max_size, 0)} {}
+
+  Soa_list &operator=(Soa_list &&other) noexcept {
+    auto temp{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  Const_block block() const noexcept {
+    return _block != nullptr
+               ? Const_block{_block, memory_requirement(_max_size)}
+               : Const_block{};
+  }
+
+  bool empty() const noexcept { return _size == 0; }
+
+  Size size() const noexcept { return _size; }
+
+  Size max_size() const noexcept { return _max_size; }
+
+  Size capacity() const noexcept { return max_size(); }
+
+  // The live elements of field I
+  template <std::size_t I> std::span<Field<I>> span() noexcept {
+    return {std::get<I>(_data), static_cast<std::size_t>(_size)};
+  }
+
+  template <std::size_t I> std::span<Field<I> const> span() const noexcept {
+    return {std::get<I>(_data), static_cast<std::size_t>(_size)};
+  }
+
+  // Every live element, see Soa_span::chunks for splitting it up
+  Span view() noexcept {
+    return std::apply([this](auto... data) { return Span{data..., _size}; },
+                      _data);
+  }
+
+  Const_span view() const noexcept {
+    return std::apply(
+        [this](auto... data) { return Const_span{data..., _size}; }, _data);
+  }
+
+  Reference operator[](Size index) noexcept {
+    assert(index >= 0 && index < _size);
+    return std::apply(
+        [index](auto... data) { return Reference{data[index]...}; }, _data);
+  }
+
+  Const_reference operator[](Size index) const noexcept {
+    assert(index >= 0 && index < _size);
+    return std::apply(
+        [index](auto... data) { return Const_reference{data[index]...}; },
+        _data);
+  }
+
+  Reference back() noexcept { return (*this)[_size - 1]; }
+
+  Const_reference back() const noexcept { return (*this)[_size - 1]; }
+
+  void clear() noexcept { _size = 0; }
+
+  // Takes one value per field
+  template <typename... Args>
+    requires(sizeof...(Args) == sizeof...(Fields))
+  Reference emplace_back(Args &&...args) {
+    if (_size == _max_size) {
+      throw Capacity_error{"Capacity_error in Soa_list::emplace_back"};
+    }
+    emplace_at(std::index_sequence_for<Fields...>{},
+               std::forward<Args>(args)...);
+    return (*this)[_size++];
+  }
+
+  void push_back(Fields const &...values) { emplace_back(values...); }
+
+  void pop_back() noexcept {
+    assert(_size > 0);
+    --_size;
+  }
+
+  // Moves the last element into index, doesn't keep the order
+  void swap_remove(Size index) noexcept {
+    assert(index >= 0 && index < _size);
+    --_size;
+    if (index != _size) {
+      std::apply(
+          [this, index](auto... data) {
+            (std::memcpy(data + index, data + _size, sizeof(*data)), ...);
+          },
+          _data);
+    }
+  }
+
+  // Value-initializes new elements
+  void resize(Size count) {
+    if (count > _max_size) {
+      throw Capacity_error{"Capacity_error in Soa_list::resize"};
+    }
+    if (count > _size) {
+      std::apply(
+          [this, count](auto... data) {
+            (std::uninitialized_value_construct(data + _size, data + count),
+             ...);
+          },
+          _data);
+    }
+    _size = count;
+  }
+
+private:
+  template <std::size_t... Is, typename... Args>
+  void emplace_at(std::index_sequence<Is...>, Args &&...args) {
+    (new (std::get<Is>(_data) + _size) Fields(std::forward<Args>(args)), ...);
+  }
+
+  void swap(Soa_list &other) noexcept {
+    std::swap(_data, other._data);
+    std::swap(_block, other._block);
+    std::swap(_size, other._size);
+    std::swap(_max_size, other._max_size);
+  }
+
+  std::tuple<Fields *...> _data{};
+  std::byte *_block{};
+  Size _size{};
+  Size _max_size{};
+};
+} // namespace util
+} // namespace marlon
+
+#endif
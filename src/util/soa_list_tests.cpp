@@ -0,0 +1,102 @@
+#include "soa_list.h"
+
+#include <cstdint>
+
+#include <numeric>
+#include <utility>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "parallel_for.h"
+#include "thread_pool.h"
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::Soa_list") {
+  using List = Soa_list<float, std::int32_t, double>;
+  auto const max_size = 100;
+  auto const block =
+      Unique_block<>{List::memory_requirement(max_size - 1) + 8};
+  auto list = List{};
+  REQUIRE(list.size() == 0);
+  REQUIRE(list.max_size() == 0);
+  REQUIRE(list.view().empty());
+  // misaligned on purpose, the arrays must still be aligned
+  list = List{block.get().begin + 8, max_size - 1};
+  for (auto i = 0; i != max_size - 1; ++i) {
+    auto const [f, n, d] = list.emplace_back(i * 0.5f, i, i * 2.0);
+    REQUIRE(f == i * 0.5f);
+    REQUIRE(n == i);
+    REQUIRE(d == i * 2.0);
+  }
+  REQUIRE_THROWS_AS(list.emplace_back(0.0f, 0, 0.0), Capacity_error);
+  REQUIRE(list.size() == max_size - 1);
+  REQUIRE(ptrdiff(list.span<0>().data(), nullptr) % List::field_alignment ==
+          0);
+  REQUIRE(ptrdiff(list.span<1>().data(), nullptr) % List::field_alignment ==
+          0);
+  REQUIRE(ptrdiff(list.span<2>().data(), nullptr) % List::field_alignment ==
+          0);
+  REQUIRE(list.block().begin == block.get().begin + 8);
+  REQUIRE(list.block().end <= block.get().end);
+  REQUIRE(list.span<1>().size() == max_size - 1);
+  REQUIRE(std::accumulate(list.span<1>().begin(), list.span<1>().end(), 0) ==
+          (max_size - 1) * (max_size - 2) / 2);
+  std::get<1>(list[3]) = 42;
+  REQUIRE(list.span<1>()[3] == 42);
+  list.swap_remove(3);
+  REQUIRE(list.size() == max_size - 2);
+  REQUIRE(list[3] == std::tuple{(max_size - 2) * 0.5f, max_size - 2,
+                                (max_size - 2) * 2.0});
+  list.swap_remove(list.size() - 1);
+  REQUIRE(list.size() == max_size - 3);
+  REQUIRE(std::get<1>(list.back()) == max_size - 4);
+  list.pop_back();
+  list.push_back(1.0f, 2, 3.0);
+  REQUIRE(list.back() == std::tuple{1.0f, 2, 3.0});
+  list.resize(max_size - 1);
+  REQUIRE(list[max_size - 2] == std::tuple{0.0f, 0, 0.0});
+  REQUIRE_THROWS_AS(list.resize(max_size), Capacity_error);
+  auto const &const_list = list;
+  REQUIRE(std::get<2>(const_list[0]) == 0.0);
+  auto moved = std::move(list);
+  REQUIRE(list.size() == 0);
+  REQUIRE(moved.size() == max_size - 1);
+  moved.clear();
+  REQUIRE(moved.empty());
+}
+
+TEST_CASE("marlon::util::Soa_list chunks") {
+  using List = Soa_list<std::int32_t, std::int64_t>;
+  auto const max_size = 1000;
+  auto const block = Unique_block<>{List::memory_requirement(max_size)};
+  auto list = List{block.get(), max_size};
+  for (auto i = 0; i != max_size; ++i) {
+    list.emplace_back(i, std::int64_t{});
+  }
+  auto const chunks = list.view().chunks(64);
+  REQUIRE(std::ranges::size(chunks) == 16);
+  REQUIRE(chunks[15].size() == max_size - 15 * 64);
+  for (auto const chunk : chunks) {
+    REQUIRE(ptrdiff(chunk.span<1>().data(), nullptr) %
+                List::field_alignment ==
+            0);
+  }
+  auto pool = Thread_pool{3};
+  parallel_for(pool, chunks, 1, [](auto chunk_range, Size) {
+    for (auto const chunk : chunk_range) {
+      auto const in = chunk.template span<0>();
+      auto const out = chunk.template span<1>();
+      for (auto i = std::size_t{}; i != in.size(); ++i) {
+        out[i] = std::int64_t{in[i]} * in[i];
+      }
+    }
+  });
+  auto const view = std::as_const(list).view();
+  for (auto i = Size{}; i != view.size(); ++i) {
+    auto const [in, out] = view[i];
+    REQUIRE(out == std::int64_t{in} * in);
+  }
+}
+} // namespace util
+} // namespace marlon
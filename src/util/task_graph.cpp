@@ -0,0 +1,107 @@
+#include "task_graph.h"
+
+#include <iostream>
+
+namespace marlon {
+namespace util {
+Task_graph::Task_graph(void *block,
+                       Size max_node_count,
+                       Size max_edge_count) noexcept {
+  auto allocator = Stack_allocator<>{{static_cast<std::byte *>(block),
+                                      memory_requirement(max_node_count,
+                                                         max_edge_count)}};
+  _nodes = List<Node>::make(allocator, max_node_count).second;
+  _edges = List<Edge>::make(allocator, max_edge_count).second;
+  _successors = List<Node *>::make(allocator, max_edge_count).second;
+}
+
+void Task_graph::clear() noexcept {
+  _successors.clear();
+  _edges.clear();
+  _nodes.clear();
+  _linked = false;
+}
+
+Size Task_graph::add_node(Task *task) {
+  _nodes.emplace_back(task);
+  _linked = false;
+  return _nodes.size() - 1;
+}
+
+void Task_graph::add_edge(Size predecessor, Size successor) {
+  _edges.push_back({.predecessor = predecessor, .successor = successor});
+  _linked = false;
+}
+
+void Task_graph::run(Thread_pool &pool) {
+  if (!_linked) {
+    link();
+  }
+  auto group = Task_group{&pool};
+  for (auto &node : _nodes) {
+    node._remaining_predecessor_count.store(node._predecessor_count,
+                                            std::memory_order_relaxed);
+    node._run_group = &group;
+  }
+  for (auto &node : _nodes) {
+    if (node._predecessor_count == 0) {
+      group.push_silent(&node);
+    }
+  }
+  pool.notify();
+  group.wait();
+}
+
+void Task_graph::link() noexcept {
+  for (auto &node : _nodes) {
+    node._predecessor_count = 0;
+    node._successor_count = 0;
+  }
+  for (auto const &edge : _edges) {
+    ++_nodes[edge.predecessor]._successor_count;
+    ++_nodes[edge.successor]._predecessor_count;
+  }
+  _successors.clear();
+  _successors.resize(_edges.size());
+  auto successors_end = _successors.data();
+  for (auto &node : _nodes) {
+    node._successors_begin = successors_end;
+    node._successors_end = successors_end;
+    successors_end += node._successor_count;
+  }
+  for (auto const &edge : _edges) {
+    *_nodes[edge.predecessor]._successors_end++ = &_nodes[edge.successor];
+  }
+  _linked = true;
+}
+
+void Task_graph::Node::run(Size thread_index) {
+  auto node = this;
+  do {
+    // successors have to be released even if the task fails, otherwise the
+    // graph would never finish
+    try {
+      node->_task->run(thread_index);
+    } catch (std::exception &e) {
+      std::cerr << "Exception in Task::run: " << e.what() << "\n";
+    } catch (...) {
+      std::cerr << "Exception in Task::run\n";
+    }
+    auto continuation = static_cast<Node *>(nullptr);
+    for (auto it = node->_successors_begin; it != node->_successors_end;
+         ++it) {
+      auto const successor = *it;
+      if (successor->_remaining_predecessor_count.fetch_sub(
+              1, std::memory_order_acq_rel) == 1) {
+        if (!continuation) {
+          continuation = successor;
+        } else {
+          node->_run_group->push_notify(successor);
+        }
+      }
+    }
+    node = continuation;
+  } while (node);
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,126 @@
+#ifndef MARLON_UTIL_TASK_GRAPH_H
+#define MARLON_UTIL_TASK_GRAPH_H
+
+#include <atomic>
+#include <utility>
+
+#include "list.h"
+#include "thread_pool.h"
+
+namespace marlon {
+namespace util {
+// Fixed capacity graph of tasks with dependency edges. Running the graph runs
+// every node's task once, each after all of its predecessors finished. A node
+// that finishes pushes its ready successors to the pool, except for one which
+// it runs right away on the same thread. The graph can be run any number of
+// times and must be acyclic.
+class Task_graph {
+public:
+  template <typename Allocator>
+  static std::pair<Block, Task_graph>
+  make(Allocator &allocator, Size max_node_count, Size max_edge_count) {
+    auto const block =
+        allocator.alloc(memory_requirement(max_node_count, max_edge_count));
+    return {block, Task_graph{block, max_node_count, max_edge_count}};
+  }
+
+  static constexpr Size memory_requirement(Size max_node_count,
+                                           Size max_edge_count) noexcept {
+    return Stack_allocator<>::memory_requirement({
+        List<Node>::memory_requirement(max_node_count),
+        List<Edge>::memory_requirement(max_edge_count),
+        List<Node *>::memory_requirement(max_edge_count),
+    });
+  }
+
+  constexpr Task_graph() noexcept = default;
+
+  explicit Task_graph(Block block,
+                      Size max_node_count,
+                      Size max_edge_count) noexcept
+      : Task_graph{block.begin, max_node_count, max_edge_count} {}
+
+  explicit Task_graph(void *block,
+                      Size max_node_count,
+                      Size max_edge_count) noexcept;
+
+  Task_graph(Task_graph &&other) noexcept
+      : _nodes{std::move(other._nodes)},
+        _edges{std::move(other._edges)},
+        _successors{std::move(other._successors)},
+        _linked{std::exchange(other._linked, false)} {}
+
+  Task_graph &operator=(Task_graph &&other) noexcept {
+    auto temp{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  Const_block block() const noexcept {
+    return {_nodes.block().begin, _successors.block().end};
+  }
+
+  bool empty() const noexcept { return _nodes.empty(); }
+
+  Size node_count() const noexcept { return _nodes.size(); }
+
+  Size edge_count() const noexcept { return _edges.size(); }
+
+  Size max_node_count() const noexcept { return _nodes.max_size(); }
+
+  Size max_edge_count() const noexcept { return _edges.max_size(); }
+
+  void clear() noexcept;
+
+  // Returns the index of the new node
+  Size add_node(Task *task);
+
+  // The successor's task runs after the predecessor's task finished
+  void add_edge(Size predecessor, Size successor);
+
+  // Returns once every task finished, the calling thread runs tasks while it
+  // waits. Must not be called while the graph is running.
+  void run(Thread_pool &pool);
+
+private:
+  class Node final : public Task {
+  public:
+    explicit Node(Task *task) noexcept : _task{task} {}
+
+    void run(Size thread_index) final;
+
+  private:
+    friend class Task_graph;
+
+    Task *_task;
+    Size _predecessor_count{};
+    Size _successor_count{};
+    Node **_successors_begin{};
+    Node **_successors_end{};
+    Task_group *_run_group{};
+    std::atomic<Size> _remaining_predecessor_count{};
+  };
+
+  struct Edge {
+    Size predecessor;
+    Size successor;
+  };
+
+  void link() noexcept;
+
+  void swap(Task_graph &other) noexcept {
+    std::swap(_nodes, other._nodes);
+    std::swap(_edges, other._edges);
+    std::swap(_successors, other._successors);
+    std::swap(_linked, other._linked);
+  }
+
+  List<Node> _nodes;
+  List<Edge> _edges;
+  List<Node *> _successors;
+  bool _linked{};
+};
+} // namespace util
+} // namespace marlon
+
+#endif
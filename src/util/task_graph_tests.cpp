@@ -0,0 +1,85 @@
+#include "task_graph.h"
+
+#include <atomic>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+namespace {
+class Stamp_task : public Task {
+public:
+  explicit Stamp_task(std::atomic<Size> *clock) noexcept : _clock{clock} {}
+
+  void run(Size) final {
+    _stamp = _clock->fetch_add(1, std::memory_order_relaxed);
+    ++_run_count;
+  }
+
+  Size stamp() const noexcept { return _stamp; }
+
+  Size run_count() const noexcept { return _run_count; }
+
+private:
+  std::atomic<Size> *_clock;
+  Size _stamp{};
+  Size _run_count{};
+};
+} // namespace
+
+TEST_CASE("marlon::util::Task_graph") {
+  // layered graph where every node of a layer depends on every node of the
+  // previous layer, plus one long chain on the side
+  constexpr auto layer_count = 8;
+  constexpr auto layer_size = 16;
+  constexpr auto chain_size = 32;
+  constexpr auto node_count = layer_count * layer_size + chain_size;
+  constexpr auto edge_count =
+      (layer_count - 1) * layer_size * layer_size + chain_size - 1;
+  auto clock = std::atomic<Size>{};
+  auto tasks = std::vector<Stamp_task>(node_count, Stamp_task{&clock});
+  auto const block =
+      Unique_block<>{Task_graph::memory_requirement(node_count, edge_count)};
+  auto graph = Task_graph{block.get(), node_count, edge_count};
+  for (auto &task : tasks) {
+    graph.add_node(&task);
+  }
+  for (auto layer = 1; layer != layer_count; ++layer) {
+    for (auto i = 0; i != layer_size; ++i) {
+      for (auto j = 0; j != layer_size; ++j) {
+        graph.add_edge((layer - 1) * layer_size + i, layer * layer_size + j);
+      }
+    }
+  }
+  for (auto i = 1; i != chain_size; ++i) {
+    graph.add_edge(layer_count * layer_size + i - 1,
+                   layer_count * layer_size + i);
+  }
+  REQUIRE(graph.node_count() == node_count);
+  REQUIRE(graph.edge_count() == edge_count);
+  for (auto const thread_count : {0, 1, 4}) {
+    auto pool = Thread_pool{thread_count};
+    for (auto repetition = 0; repetition != 3; ++repetition) {
+      graph.run(pool);
+    }
+  }
+  for (auto const &task : tasks) {
+    REQUIRE(task.run_count() == 9);
+  }
+  // stamps are from the last run only, which ran after all earlier ones
+  for (auto layer = 1; layer != layer_count; ++layer) {
+    for (auto i = 0; i != layer_size; ++i) {
+      for (auto j = 0; j != layer_size; ++j) {
+        REQUIRE(tasks[(layer - 1) * layer_size + i].stamp() <
+                tasks[layer * layer_size + j].stamp());
+      }
+    }
+  }
+  for (auto i = 1; i != chain_size; ++i) {
+    REQUIRE(tasks[layer_count * layer_size + i - 1].stamp() <
+            tasks[layer_count * layer_size + i].stamp());
+  }
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,129 @@
+#ifndef MARLON_UTIL_THREAD_ARENAS_H
+#define MARLON_UTIL_THREAD_ARENAS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <bit>
+#include <utility>
+
+#include "list.h"
+#include "memory.h"
+
+namespace marlon {
+namespace util {
+// One bump allocator per thread of a Thread_pool plus one for the threads
+// outside of it, indexed by the thread_index that Task::run receives. Only one
+// thread outside of the pool may use its arena at a time. Tasks
+// take transient memory from the arena of the thread they run on, and reset
+// releases all of it at a frame or step boundary when no task runs. Debug
+// builds fill released memory with poison_byte.
+class Thread_arenas {
+public:
+  static constexpr auto poison_byte = std::byte{0xcd};
+
+  // thread_count is the pool's size()
+  template <typename Allocator>
+  static std::pair<Block, Thread_arenas>
+  make(Allocator &allocator, Size thread_count, Size arena_size) {
+    auto const block =
+        allocator.alloc(memory_requirement(thread_count, arena_size));
+    return {block, Thread_arenas{block, thread_count, arena_size}};
+  }
+
+  // Includes the slack to align a block that is only aligned for
+  // max_align_t to a cache line. Every arena is rounded up to whole cache
+  // lines.
+  static constexpr Size memory_requirement(Size thread_count,
+                                           Size arena_size) noexcept {
+    return cache_line_size - alignof(std::max_align_t) +
+           Allocator::memory_requirement(
+               {List<Arena>::memory_requirement(thread_count + 1)}) +
+           (thread_count + 1) * Allocator::memory_requirement({arena_size});
+  }
+
+  constexpr Thread_arenas() noexcept = default;
+
+  explicit Thread_arenas(Block block,
+                         Size thread_count,
+                         Size arena_size) noexcept
+      : Thread_arenas{block.begin, thread_count, arena_size} {}
+
+  explicit Thread_arenas(void *block,
+                         Size thread_count,
+                         Size arena_size) noexcept {
+    auto const begin = static_cast<std::byte *>(block);
+    auto const aligned_begin =
+        begin + (align(std::bit_cast<std::uintptr_t>(begin), cache_line_size) -
+                 std::bit_cast<std::uintptr_t>(begin));
+    auto allocator =
+        Allocator{{aligned_begin,
+                   begin + memory_requirement(thread_count, arena_size)}};
+    _arenas = List<Arena>::make(allocator, thread_count + 1).second;
+    for (auto i = Size{}; i != thread_count + 1; ++i) {
+      // covers whole cache lines of its own, so the arenas of different
+      // threads share no lines
+      _arenas.emplace_back(Arena{
+          .allocator = Stack_allocator<>{
+              allocator.alloc(align(arena_size, cache_line_size))},
+      });
+    }
+  }
+
+  Thread_arenas(Thread_arenas &&other) noexcept
+      : _arenas{std::move(other._arenas)} {}
+
+  Thread_arenas &operator=(Thread_arenas &&other) noexcept {
+    auto temp{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  Const_block block() const noexcept {
+    return _arenas.empty()
+               ? Const_block{}
+               : Const_block{_arenas.block().begin,
+                             _arenas.back().allocator.block().end};
+  }
+
+  // The pool's size(), the thread outside of the pool uses the arena at that
+  // index
+  Size thread_count() const noexcept { return _arenas.size() - 1; }
+
+  Stack_allocator<> &arena(Size thread_index) noexcept {
+    return _arenas[thread_index].allocator;
+  }
+
+  // Frees every allocation of every arena. No task may use an arena while it
+  // is reset.
+  void reset() noexcept {
+    for (auto &arena : _arenas) {
+#ifndef NDEBUG
+      std::memset(const_cast<std::byte *>(arena.allocator.block().begin),
+                  static_cast<int>(poison_byte),
+                  arena.allocator.used_size());
+#endif
+      arena.allocator.reset();
+    }
+  }
+
+private:
+  // Carves the arenas and the list of their bump pointers out of the block
+  using Allocator = Stack_allocator<cache_line_size>;
+
+  // The bump pointers of different threads on different cache lines
+  struct alignas(cache_line_size) Arena {
+    Stack_allocator<> allocator;
+  };
+
+  void swap(Thread_arenas &other) noexcept {
+    std::swap(_arenas, other._arenas);
+  }
+
+  List<Arena> _arenas;
+};
+} // namespace util
+} // namespace marlon
+
+#endif
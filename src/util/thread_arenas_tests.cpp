@@ -0,0 +1,93 @@
+#include "thread_arenas.h"
+
+#include <cstdint>
+
+#include <atomic>
+#include <bit>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "parallel_for.h"
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::Thread_arenas") {
+  constexpr auto arena_size = Size{1} << 16;
+  auto pool = Thread_pool{4};
+  auto block = Unique_block<>{
+      Thread_arenas::memory_requirement(pool.size(), arena_size)};
+  auto arenas = Thread_arenas{block.get(), pool.size(), arena_size};
+  REQUIRE(arenas.thread_count() == pool.size());
+  for (auto i = Size{}; i <= pool.size(); ++i) {
+    // neither the bump pointers nor the memory of two threads share a line
+    auto &arena = arenas.arena(i);
+    REQUIRE(std::bit_cast<std::uintptr_t>(&arena) % cache_line_size == 0);
+    REQUIRE(std::bit_cast<std::uintptr_t>(arena.block().begin) %
+                cache_line_size ==
+            0);
+  }
+  auto values = std::vector<int>(10000);
+  for (auto i = 0; i != 10000; ++i) {
+    values[i] = i;
+  }
+  auto sum = std::atomic<int>{};
+  for (auto round = 0; round != 3; ++round) {
+    sum = 0;
+    parallel_for(pool, values, 64, [&](auto items, Size thread_index) {
+      auto &arena = arenas.arena(thread_index);
+      auto const scratch = arena.alloc(items.size() * sizeof(int));
+      auto const copies = reinterpret_cast<int *>(scratch.begin);
+      std::copy(items.begin(), items.end(), copies);
+      auto partial_sum = 0;
+      for (auto i = std::size_t{}; i != items.size(); ++i) {
+        partial_sum += copies[i];
+      }
+      sum.fetch_add(partial_sum, std::memory_order_relaxed);
+    });
+    REQUIRE(sum.load() == 10000 * 9999 / 2);
+    auto used_size = Size{};
+    for (auto i = Size{}; i <= pool.size(); ++i) {
+      used_size += arenas.arena(i).used_size();
+    }
+    REQUIRE(used_size >= Size{10000 * sizeof(int)});
+    arenas.reset();
+    for (auto i = Size{}; i <= pool.size(); ++i) {
+      REQUIRE(arenas.arena(i).used_size() == 0);
+    }
+  }
+}
+
+TEST_CASE("marlon::util::Thread_arenas with arenas of partial lines") {
+  constexpr auto arena_size = Size{100};
+  auto allocator = System_allocator{};
+  auto [block, arenas] = Thread_arenas::make(allocator, 2, arena_size);
+  REQUIRE(block.size() == Thread_arenas::memory_requirement(2, arena_size));
+  for (auto i = Size{}; i <= 2; ++i) {
+    auto &arena = arenas.arena(i);
+    REQUIRE(arena.block().size() == align(arena_size, cache_line_size));
+    REQUIRE(std::bit_cast<std::uintptr_t>(arena.block().begin) %
+                cache_line_size ==
+            0);
+    REQUIRE(arena.alloc(arena_size).size() == arena_size);
+  }
+  allocator.free(block);
+}
+
+TEST_CASE("marlon::util::Thread_arenas poisoning") {
+  auto block = Unique_block<>{Thread_arenas::memory_requirement(0, 64)};
+  auto arenas = Thread_arenas{block.get(), 0, 64};
+  auto &arena = arenas.arena(0);
+  auto const allocation = arena.alloc(16);
+  std::fill(allocation.begin, allocation.end, std::byte{1});
+  REQUIRE_THROWS_AS(arena.alloc(64), std::bad_alloc);
+  arenas.reset();
+#ifndef NDEBUG
+  for (auto it = allocation.begin; it != allocation.end; ++it) {
+    REQUIRE(*it == Thread_arenas::poison_byte);
+  }
+#endif
+  REQUIRE(arena.alloc(64).size() == 64);
+}
+} // namespace util
+} // namespace marlon
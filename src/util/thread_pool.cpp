@@ -1,177 +1,511 @@
 #include "thread_pool.h"
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||            \
+    defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
 #include <iostream>
+#include <optional>
 #include <random>
+#include <stdexcept>
 #include <stop_token>
 
+#include "cpu_topology.h"
+#include "tracking_allocator.h"
+
 namespace marlon {
 namespace util {
-Thread_pool::Thread_pool(Size thread_count, Scheduling_policy scheduling_policy)
-    : _push_index{Size{}} {
-  if (thread_count > 0) {
-    auto allocator = System_allocator{};
-    auto block = Block{};
-    std::tie(block, _threads) =
-        List<Thread>::make(allocator, thread_count);
-    try {
-      for (int i = 0; i != thread_count; ++i) {
-        _threads.emplace_back(
-            _threads.data(), thread_count, i, scheduling_policy);
+namespace {
+// bounds for the number of pause iterations an adaptive worker spins for
+// before parking
+auto constexpr min_spin_limit = Size{64};
+auto constexpr max_spin_limit = Size{1} << 14;
+
+constinit auto thread_pool_allocation_tag =
+    Allocation_tag{"util::Thread_pool"};
+
+Tracking_allocator<System_allocator> thread_pool_allocator() noexcept {
+  return Tracking_allocator<System_allocator>{System_allocator{},
+                                              thread_pool_allocation_tag};
+}
+
+thread_local void const *current_pool{};
+thread_local Size current_thread_index{};
+thread_local auto random_engine = std::minstd_rand{std::random_device{}()};
+
+// Increments a counter only its own thread writes to
+template <typename T> void add(std::atomic<T> &counter, T value) noexcept {
+  counter.store(counter.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+}
+
+void pause() noexcept {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||            \
+    defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  asm volatile("yield");
+#endif
+}
+} // namespace
+
+Thread_pool::Thread_pool(Size thread_count,
+                         Scheduling_policy scheduling_policy,
+                         Size max_queue_size)
+    : Thread_pool{Thread_pool_create_info{
+          .thread_count = thread_count,
+          .scheduling_policy = scheduling_policy,
+          .max_queue_size = max_queue_size,
+      }} {}
+
+Thread_pool::Thread_pool(Thread_pool_create_info const &create_info)
+    : _scheduling_policy{create_info.scheduling_policy},
+      _collect_statistics{create_info.collect_statistics} {
+  auto const thread_count = create_info.thread_count;
+  auto const restricted = create_info.affinity != Thread_affinity::none ||
+                          create_info.numa_node >= 0;
+  auto topology = std::optional<Cpu_topology>{};
+  if (restricted) {
+    topology.emplace();
+  }
+  auto const logical_cpus =
+      topology ? topology->logical_cpus() : std::span<Logical_cpu const>{};
+  auto const queue_memory_requirement =
+      Work_stealing_deque<Task *>::memory_requirement(
+          create_info.max_queue_size);
+  _block = thread_pool_allocator().alloc(Stack_allocator<>::memory_requirement({
+      List<Work_stealing_deque<Task *>>::memory_requirement(thread_count),
+      thread_count * queue_memory_requirement,
+      Mpmc_queue<Task *>::memory_requirement(create_info.max_queue_size),
+      List<Thread_counters>::memory_requirement(thread_count + 1),
+      List<int>::memory_requirement(static_cast<Size>(logical_cpus.size())),
+      List<Thread>::memory_requirement(thread_count),
+  }));
+  auto allocator = Stack_allocator<>{_block};
+  _queues =
+      List<Work_stealing_deque<Task *>>::make(allocator, thread_count).second;
+  for (auto i = Size{}; i != thread_count; ++i) {
+    _queues.emplace_back(allocator.alloc(queue_memory_requirement),
+                         create_info.max_queue_size);
+  }
+  // exists even without workers so that the threads outside of the pool can
+  // always push and run tasks themselves
+  _injection_queue =
+      Mpmc_queue<Task *>::make(allocator, create_info.max_queue_size).second;
+  // the last counters are shared by the threads outside of the pool
+  _counters = List<Thread_counters>::make(allocator, thread_count + 1).second;
+  _counters.resize(thread_count + 1);
+  reset_statistics();
+  _cpus =
+      List<int>::make(allocator, static_cast<Size>(logical_cpus.size())).second;
+  if (restricted) {
+    // order the allowed cpus by how many of their smt siblings come before
+    // them, so that the first cpus are all on distinct physical cores
+    for (auto rank = 0;; ++rank) {
+      auto higher_rank_found = false;
+      for (auto it = logical_cpus.begin(); it != logical_cpus.end(); ++it) {
+        if (create_info.numa_node >= 0 &&
+            it->numa_node != create_info.numa_node) {
+          continue;
+        }
+        auto const sibling_rank = std::count_if(
+            logical_cpus.begin(), it, [&](Logical_cpu const &cpu) {
+              return cpu.package == it->package && cpu.core == it->core;
+            });
+        if (sibling_rank == rank) {
+          _cpus.push_back(it->index);
+        } else if (sibling_rank > rank) {
+          higher_rank_found = true;
+        }
       }
-    } catch (...) {
-      _threads = {};
-      allocator.free(block);
-      throw;
+      if (!higher_rank_found ||
+          create_info.affinity == Thread_affinity::physical_core) {
+        break;
+      }
+    }
+    if (_cpus.empty()) {
+      stop();
+      throw std::runtime_error{"Thread_pool: no cpus on requested numa node"};
     }
   }
-}
-
-Thread_pool::~Thread_pool() {
-  if (auto const block = _threads.block(); block.size() != 0) {
-    _threads = {};
-    System_allocator{}.free(block);
+  _threads = List<Thread>::make(allocator, thread_count).second;
+  try {
+    for (auto i = Size{}; i != thread_count; ++i) {
+      auto const cpus =
+          create_info.affinity == Thread_affinity::none
+              ? std::span<int const>{_cpus.data(),
+                                     static_cast<std::size_t>(_cpus.size())}
+              : std::span<int const>{&_cpus[i % _cpus.size()], 1};
+      _threads.emplace_back(this, i, cpus);
+    }
+  } catch (...) {
+    stop();
+    throw;
   }
 }
 
+Thread_pool::~Thread_pool() { stop(); }
+
 bool Thread_pool::empty() const noexcept { return size() <= 0; }
 
-Size Thread_pool::size() const noexcept {
-  return _threads.size();
+Size Thread_pool::size() const noexcept { return _queues.size(); }
+
+Size Thread_pool::thread_index() const noexcept {
+  return current_pool == this ? current_thread_index : size();
 }
 
 Size Thread_pool::push_notify(Task *task) {
   auto const index = push_silent(task);
-  _threads[index].notify();
+  wake(1);
   return index;
 }
 
 Size Thread_pool::push_silent(Task *task) {
-  auto const base = _push_index++;
-  for (auto offset = Size{}; offset != 2 * _threads.size(); ++offset) {
-    auto const index = (base + offset) % _threads.size();
-    auto &thread = _threads[index];
-    if (thread.try_push(task)) {
-      return index;
+  task->_group = nullptr;
+  return push(task);
+}
+
+void Thread_pool::notify() noexcept { wake(queued_task_count()); }
+
+void Thread_pool::set_scheduling_policy(
+    Scheduling_policy scheduling_policy) noexcept {
+  _scheduling_policy.store(scheduling_policy, std::memory_order_relaxed);
+  wake_all();
+}
+
+Thread_statistics Thread_pool::statistics(Size thread_index) const noexcept {
+  using Seconds = std::chrono::duration<double>;
+  if (!_collect_statistics) {
+    return {};
+  }
+  auto const &counters = _counters[thread_index];
+  auto const running_time =
+      Clock::duration{counters.running_time.load(std::memory_order_relaxed)};
+  auto const parked_time =
+      Clock::duration{counters.parked_time.load(std::memory_order_relaxed)};
+  auto const elapsed_time =
+      Clock::now().time_since_epoch() -
+      Clock::duration{_statistics_begin.load(std::memory_order_relaxed)};
+  auto const idle_time = thread_index == size()
+                             ? Clock::duration{}
+                             : std::max(elapsed_time - running_time,
+                                        Clock::duration{});
+  return {
+      .executed_task_count =
+          counters.executed_task_count.load(std::memory_order_relaxed),
+      .successful_steal_count =
+          counters.successful_steal_count.load(std::memory_order_relaxed),
+      .failed_steal_count =
+          counters.failed_steal_count.load(std::memory_order_relaxed),
+      .wakeup_count = counters.wakeup_count.load(std::memory_order_relaxed),
+      .max_queued_task_count =
+          counters.max_queued_task_count.load(std::memory_order_relaxed),
+      .running_time = std::chrono::duration_cast<Seconds>(running_time).count(),
+      .idle_time = std::chrono::duration_cast<Seconds>(idle_time).count(),
+      .parked_time = std::chrono::duration_cast<Seconds>(parked_time).count(),
+  };
+}
+
+void Thread_pool::reset_statistics() noexcept {
+  for (auto &counters : _counters) {
+    counters.executed_task_count.store(0, std::memory_order_relaxed);
+    counters.successful_steal_count.store(0, std::memory_order_relaxed);
+    counters.failed_steal_count.store(0, std::memory_order_relaxed);
+    counters.wakeup_count.store(0, std::memory_order_relaxed);
+    counters.max_queued_task_count.store(0, std::memory_order_relaxed);
+    counters.running_time.store(0, std::memory_order_relaxed);
+    counters.parked_time.store(0, std::memory_order_relaxed);
+  }
+  _statistics_begin.store(Clock::now().time_since_epoch().count(),
+                          std::memory_order_relaxed);
+}
+
+bool Thread_pool::run_task() noexcept {
+  auto const index = thread_index();
+  if (auto const task = find_task(index)) {
+    run(task, index);
+    return true;
+  } else {
+    return false;
+  }
+}
+
+Size Thread_pool::push(Task *task) {
+  auto const index = thread_index();
+  auto const outside = index == size();
+  if (!(outside ? _injection_queue.try_push(task)
+                : queue(index).try_push(task))) {
+    // running the task right away holds the pushing thread back until the
+    // pool catches up
+    run(task, index);
+    return index;
+  }
+  if (_collect_statistics) {
+    auto &max_queued_task_count = _counters[index].max_queued_task_count;
+    auto const queued_task_count =
+        outside ? _injection_queue.size() : queue(index).size();
+    if (queued_task_count >
+        max_queued_task_count.load(std::memory_order_relaxed)) {
+      max_queued_task_count.store(queued_task_count,
+                                  std::memory_order_relaxed);
     }
   }
-  auto const index = base % _threads.size();
-  auto &thread = _threads[index];
-  thread.push(task);
   return index;
 }
 
-void Thread_pool::notify() {
-  for (auto &thread : _threads) {
-    thread.notify();
+void Thread_pool::wake(Size count) noexcept {
+  // pairs with the fence in park, either the parking thread sees the pushed
+  // tasks or we see the parking thread
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto const parked_count = _parked_count.load(std::memory_order_relaxed);
+  if (parked_count != 0 && count > 0) {
+    _epoch.fetch_add(1, std::memory_order_release);
+    if (count >= parked_count) {
+      _epoch.notify_all();
+    } else {
+      for (auto i = Size{}; i != count; ++i) {
+        _epoch.notify_one();
+      }
+    }
   }
 }
 
-void Thread_pool::set_scheduling_policy(Scheduling_policy scheduling_policy) {
-  for (auto &thread : _threads) {
-    thread.set_scheduling_policy(scheduling_policy);
+void Thread_pool::wake_all() noexcept {
+  _epoch.fetch_add(1, std::memory_order_release);
+  _epoch.notify_all();
+}
+
+void Thread_pool::park(Size thread_index,
+                       std::stop_token const &stop_token) noexcept {
+  auto const epoch = _epoch.load(std::memory_order_acquire);
+  _parked_count.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!has_queued_tasks() && !stop_token.stop_requested() &&
+      _scheduling_policy.load(std::memory_order_relaxed) !=
+          Scheduling_policy::spin) {
+    if (_collect_statistics) {
+      auto &counters = _counters[thread_index];
+      auto const begin = Clock::now();
+      _epoch.wait(epoch, std::memory_order_acquire);
+      add(counters.parked_time, (Clock::now() - begin).count());
+      add(counters.wakeup_count, Size{1});
+    } else {
+      _epoch.wait(epoch, std::memory_order_acquire);
+    }
   }
+  _parked_count.fetch_sub(1, std::memory_order_relaxed);
 }
 
-Thread_pool::Thread::Thread(Thread *threads,
-                            Size thread_count,
-                            Size index,
-                            Scheduling_policy scheduling_policy)
-    : _threads{threads},
-      _thread_count{thread_count},
-      _index{index},
-      _scheduling_policy{scheduling_policy},
-      _thread{[this](std::stop_token stop_token) {
-        {
-          auto const lock = std::scoped_lock{_mutex};
-          _queue.reserve(1024);
-        }
-        auto rng = std::minstd_rand{std::random_device{}()};
-        auto try_steal = [&](int attempts) -> Task * {
-          auto d = std::uniform_int_distribution<Size>{
-              Size{1}, std::max(Size{1}, _thread_count - 1)};
-          for (auto attempt = 0; attempt < attempts; ++attempt) {
-            auto const offset = d(rng);
-            auto const index = (_index + offset) % _thread_count;
-            auto &thread = _threads[index];
-            if (auto lock = std::unique_lock{thread._mutex, std::try_to_lock}) {
-              if (!thread._queue.empty()) {
-                auto result = thread._queue.front();
-                thread._queue.pop_front();
-                return result;
-              }
-            }
-          }
-          return nullptr;
-        };
-        for (;;) {
-          // try to steal from our own queue
-          auto task = (Task *)nullptr;
-          if (auto lock = std::unique_lock{_mutex, std::try_to_lock}) {
-            if (!_queue.empty()) {
-              task = _queue.back();
-              _queue.pop_back();
-            }
-          }
-          // try to steal from other queues
-          if (!task) {
-            task = try_steal(_thread_count - 1);
-          }
-          // just wait for work
-          if (!task) {
-            auto lock = std::unique_lock{_mutex};
-            _condvar.wait(lock, [&] {
-              return _scheduling_policy == Scheduling_policy::spin ||
-                     !_queue.empty() || stop_token.stop_requested();
-            });
-            if (!_queue.empty()) {
-              task = _queue.back();
-              _queue.pop_back();
-            }
-          }
-          if (task) {
-            try {
-              task->run(_index);
-            } catch (std::exception &e) {
-              std::cerr << "Exception in Task::run: " << e.what() << "\n";
-            } catch (...) {
-              std::cerr << "Exception in Task::run\n";
-            }
-          } else if (stop_token.stop_requested()) {
-            return;
-          }
-        }
-      }} {}
+Task *Thread_pool::spin_for_task(Size thread_index,
+                                 Size spin_limit,
+                                 std::stop_token const &stop_token) noexcept {
+  for (auto i = Size{}; i != spin_limit && !stop_token.stop_requested(); ++i) {
+    pause();
+    if (has_queued_tasks()) {
+      if (auto const task = find_task(thread_index)) {
+        return task;
+      }
+    }
+  }
+  return nullptr;
+}
 
-Thread_pool::Thread::~Thread() {
-  _thread.request_stop();
-  _condvar.notify_one();
+Task *Thread_pool::find_task(Size thread_index) noexcept {
+  if (thread_index != size()) {
+    if (auto const task = queue(thread_index).pop()) {
+      return *task;
+    }
+  }
+  if (auto const task = _injection_queue.try_pop()) {
+    if (_collect_statistics) {
+      add(_counters[thread_index].successful_steal_count, Size{1});
+    }
+    return *task;
+  }
+  return try_steal(thread_index, random_engine());
 }
 
-void Thread_pool::Thread::push(Task *task) {
-  auto lock = std::unique_lock{_mutex};
-  _queue.push_back(task);
+void Thread_pool::run(Task *task, Size thread_index) noexcept {
+  // the group may be destroyed as soon as its pending count drops to zero
+  auto const group = task->_group;
+  auto const begin = _collect_statistics ? Clock::now() : Clock::time_point{};
+  try {
+    task->run(thread_index);
+  } catch (std::exception &e) {
+    std::cerr << "Exception in Task::run: " << e.what() << "\n";
+  } catch (...) {
+    std::cerr << "Exception in Task::run\n";
+  }
+  if (_collect_statistics) {
+    auto &counters = _counters[thread_index];
+    add(counters.running_time, (Clock::now() - begin).count());
+    add(counters.executed_task_count, Size{1});
+  }
+  // the epoch belongs to the pool, touching the group after the decrement
+  // could race with its destruction
+  if (group &&
+      group->_pending_count.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+    _group_epoch.fetch_add(1, std::memory_order_seq_cst);
+    _group_epoch.notify_all();
+  }
 }
 
-bool Thread_pool::Thread::try_push(Task *task) {
-  if (auto lock = std::unique_lock{_mutex, std::try_to_lock}) {
-    _queue.push_back(task);
+Task *Thread_pool::try_steal(Size thief_index,
+                             Size first_victim_offset) noexcept {
+  // the threads outside of the pool have no deque of their own
+  auto const queue_count = _queues.size();
+  for (auto i = Size{}; i != queue_count; ++i) {
+    auto const victim_index = (first_victim_offset + i) % queue_count;
+    if (victim_index == thief_index) {
+      continue;
+    }
+    if (auto const task = queue(victim_index).steal()) {
+      if (_collect_statistics) {
+        add(_counters[thief_index].successful_steal_count, Size{1});
+      }
+      return *task;
+    }
+    if (_collect_statistics) {
+      add(_counters[thief_index].failed_steal_count, Size{1});
+    }
+  }
+  return nullptr;
+}
+
+bool Thread_pool::has_queued_tasks() const noexcept {
+  if (!_injection_queue.empty()) {
     return true;
-  } else {
-    return false;
+  }
+  for (auto &queue : _queues) {
+    if (!queue.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Size Thread_pool::queued_task_count() const noexcept {
+  auto result = std::max(_injection_queue.size(), Size{});
+  for (auto &queue : _queues) {
+    result += std::max(queue.size(), Size{});
+  }
+  return result;
+}
+
+void Thread_pool::stop() noexcept {
+  for (auto &thread : _threads) {
+    thread.request_stop();
+  }
+  wake_all();
+  _threads = {};
+  _cpus = {};
+  _counters = {};
+  _injection_queue = {};
+  _queues = {};
+  if (_block.begin) {
+    thread_pool_allocator().free(_block);
+    _block = {};
   }
 }
 
-void Thread_pool::Thread::notify() {
-  _condvar.notify_one();
+Thread_pool::Thread::Thread(Thread_pool *pool,
+                            Size index,
+                            std::span<int const> cpus)
+    : _pool{pool},
+      _index{index},
+      _cpus{cpus},
+      _thread{[this](std::stop_token stop_token) { run(stop_token); }} {}
+
+Thread_pool::Thread::~Thread() { request_stop(); }
+
+void Thread_pool::Thread::request_stop() noexcept { _thread.request_stop(); }
+
+void Thread_pool::Thread::run(std::stop_token stop_token) {
+  current_pool = _pool;
+  current_thread_index = _index;
+  if (!_cpus.empty()) {
+    // placement is an optimization, keep running where we are if it fails
+    set_current_thread_affinity(_cpus);
+  }
+  // grows while spinning pays off and shrinks when we end up parking anyway
+  auto spin_limit = min_spin_limit;
+  for (;;) {
+    if (auto const task = _pool->find_task(_index)) {
+      _pool->run(task, _index);
+      continue;
+    }
+    if (stop_token.stop_requested()) {
+      return;
+    }
+    switch (_pool->_scheduling_policy.load(std::memory_order_relaxed)) {
+    case Scheduling_policy::block:
+      _pool->park(_index, stop_token);
+      break;
+    case Scheduling_policy::spin:
+      pause();
+      break;
+    case Scheduling_policy::adaptive:
+      if (auto const task =
+              _pool->spin_for_task(_index, spin_limit, stop_token)) {
+        spin_limit = std::min(2 * spin_limit, max_spin_limit);
+        _pool->run(task, _index);
+      } else {
+        spin_limit = std::max(spin_limit / 2, min_spin_limit);
+        _pool->park(_index, stop_token);
+      }
+      break;
+    }
+  }
 }
 
-void Thread_pool::Thread::set_scheduling_policy(
-    Scheduling_policy scheduling_policy) {
-  {
-    auto const lock = std::scoped_lock{_mutex};
-    _scheduling_policy = scheduling_policy;
+Size Task_group::push_notify(Task *task) {
+  auto const index = push_silent(task);
+  _pool->wake(1);
+  return index;
+}
+
+Size Task_group::push_silent(Task *task) {
+  task->_group = this;
+  _pending_count.fetch_add(1, std::memory_order_relaxed);
+  try {
+    return _pool->push(task);
+  } catch (...) {
+    _pending_count.fetch_sub(1, std::memory_order_relaxed);
+    throw;
+  }
+}
+
+void Task_group::wait() noexcept {
+  for (;;) {
+    if (_pending_count.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+    if (_pool->run_task()) {
+      continue;
+    }
+    // the remaining tasks run on other threads, they are likely to finish soon
+    auto spin_count = Size{};
+    while (spin_count != max_spin_limit &&
+           _pending_count.load(std::memory_order_acquire) != 0 &&
+           !_pool->has_queued_tasks()) {
+      pause();
+      ++spin_count;
+    }
+    if (spin_count != max_spin_limit ||
+        _pool->_scheduling_policy.load(std::memory_order_relaxed) ==
+            Scheduling_policy::spin) {
+      continue;
+    }
+    // the epoch is read before the count, a group finishing in between changes
+    // it and keeps the wait from blocking
+    auto const epoch = _pool->_group_epoch.load(std::memory_order_seq_cst);
+    if (_pending_count.load(std::memory_order_seq_cst) == 0) {
+      return;
+    }
+    _pool->_group_epoch.wait(epoch, std::memory_order_seq_cst);
   }
-  notify();
 }
 } // namespace util
-} // namespace marlon
\ No newline at end of file
+} // namespace marlon
@@ -1,29 +1,83 @@
 #ifndef MARLON_UTIL_THREAD_POOL_H
 #define MARLON_UTIL_THREAD_POOL_H
 
-#include <condition_variable>
-#include <mutex>
+#include <cstdint>
+
+#include <atomic>
+#include <chrono>
+#include <span>
 #include <thread>
 
 #include "list.h"
 #include "queue.h"
+#include "work_stealing_deque.h"
 
 namespace marlon {
 namespace util {
-enum class Scheduling_policy { block, spin };
+// block: idle workers park right away
+// spin: idle workers never park
+// adaptive: idle workers spin for a self-tuning number of iterations, then park
+enum class Scheduling_policy { block, spin, adaptive };
+
+// none: workers may run on any cpu
+// logical_core: each worker is pinned to one logical cpu, spreading over the
+// physical cores before using their smt siblings
+// physical_core: each worker is pinned to one logical cpu per physical core,
+// smt siblings are never used
+enum class Thread_affinity { none, logical_core, physical_core };
+
+class Thread_pool;
+class Task_group;
+struct Thread_pool_create_info;
+
+// Counters of one thread of a Thread_pool since the pool was created or its
+// statistics were reset. Times are in seconds. Idle time is the time a worker
+// spent outside of tasks, parked time is the part of it spent parked. The
+// threads outside of the pool share one set of counters that only counts
+// tasks, steals and pushes, and may miss some when they run concurrently.
+// Taking a task from the injection queue counts as a steal.
+struct Thread_statistics {
+  Size executed_task_count;
+  Size successful_steal_count;
+  Size failed_steal_count;
+  Size wakeup_count;
+  // high water mark of the thread's queue
+  Size max_queued_task_count;
+  double running_time;
+  double idle_time;
+  double parked_time;
+};
 
 class Task {
 public:
   virtual ~Task() {}
 
+  // thread_index is in [0, pool size], the pool size itself identifies the
+  // threads outside of the pool when they help out with queued tasks
   virtual void run(Size thread_index) = 0;
+
+private:
+  friend class Thread_pool;
+  friend class Task_group;
+
+  Task_group *_group{};
 };
 
+// Every worker owns a lock-free work stealing deque. Tasks pushed by a worker
+// go to the bottom of its own deque, tasks pushed from outside the pool go to
+// a lock-free injection queue that any number of threads may push to. Idle
+// workers drain the injection queue and steal from the top of the others'
+// deques. A task pushed while its queue is full runs on the pushing thread.
 class Thread_pool {
 public:
+  static constexpr auto default_max_queue_size = Size{1024};
+
   explicit Thread_pool(
       Size thread_count,
-      Scheduling_policy scheduling_policy = Scheduling_policy::block);
+      Scheduling_policy scheduling_policy = Scheduling_policy::block,
+      Size max_queue_size = default_max_queue_size);
+
+  explicit Thread_pool(Thread_pool_create_info const &create_info);
 
   ~Thread_pool();
 
@@ -31,48 +85,156 @@ public:
 
   Size size() const noexcept;
 
+  // Index of the calling thread if it is one of the pool's workers, size()
+  // for every other thread
+  Size thread_index() const noexcept;
+
+  // Returns the calling thread's thread_index()
   Size push_notify(Task *task);
 
+  // Returns the calling thread's thread_index()
   Size push_silent(Task *task);
 
-  void notify();
+  // Wakes up as many parked workers as there are queued tasks
+  void notify() noexcept;
+
+  void set_scheduling_policy(Scheduling_policy policy) noexcept;
+
+  bool collects_statistics() const noexcept { return _collect_statistics; }
+
+  // Snapshot of the counters of thread thread_index, which is in [0, size()].
+  // All zero unless the pool collects statistics.
+  Thread_statistics statistics(Size thread_index) const noexcept;
+
+  // Counters of threads that are busy while they are reset may keep some of
+  // their old counts
+  void reset_statistics() noexcept;
 
-  // CANNOT be called from inside the thread pool
-  void set_scheduling_policy(Scheduling_policy policy);
+  // Runs one queued task on the calling thread, preferring tasks from the
+  // calling thread's own queue. Returns false if no task could be found.
+  bool run_task() noexcept;
 
 private:
+  friend class Task_group;
+
   class Thread {
   public:
-    explicit Thread(Thread *threads,
-                    Size thread_count,
-                    Size index,
-                    Scheduling_policy scheduling_policy);
+    explicit Thread(Thread_pool *pool, Size index, std::span<int const> cpus);
 
     ~Thread();
 
-    void push(Task *task);
-
-    bool try_push(Task *task);
-
-    void notify();
-
-    void set_scheduling_policy(Scheduling_policy scheduling_policy);
+    void request_stop() noexcept;
 
   private:
-    Thread *const _threads;
-    Size const _thread_count;
+    void run(std::stop_token stop_token);
+
+    Thread_pool *const _pool;
     Size const _index;
-    Scheduling_policy _scheduling_policy;
-    Allocating_queue<Task *> _queue;
-    std::mutex _mutex;
-    std::condition_variable _condvar;
+    std::span<int const> const _cpus;
     std::jthread _thread;
   };
 
+  using Clock = std::chrono::steady_clock;
+
+  // Written only by the thread they belong to, or by the threads outside of
+  // the pool
+  struct Thread_counters {
+    std::atomic<Size> executed_task_count;
+    std::atomic<Size> successful_steal_count;
+    std::atomic<Size> failed_steal_count;
+    std::atomic<Size> wakeup_count;
+    std::atomic<Size> max_queued_task_count;
+    std::atomic<Clock::rep> running_time;
+    std::atomic<Clock::rep> parked_time;
+    std::byte _padding[cache_line_size];
+  };
+
+  // queue i belongs to worker i
+  Work_stealing_deque<Task *> &queue(Size index) noexcept {
+    return _queues[index];
+  }
+
+  Size push(Task *task);
+
+  void wake(Size count) noexcept;
+
+  void wake_all() noexcept;
+
+  void park(Size thread_index, std::stop_token const &stop_token) noexcept;
+
+  Task *spin_for_task(Size thread_index,
+                      Size spin_limit,
+                      std::stop_token const &stop_token) noexcept;
+
+  Task *find_task(Size thread_index) noexcept;
+
+  void run(Task *task, Size thread_index) noexcept;
+
+  Task *try_steal(Size thief_index, Size first_victim_offset) noexcept;
+
+  bool has_queued_tasks() const noexcept;
+
+  Size queued_task_count() const noexcept;
+
+  void stop() noexcept;
+
+  Block _block{};
+  List<Work_stealing_deque<Task *>> _queues;
+  Mpmc_queue<Task *> _injection_queue;
+  List<Thread_counters> _counters;
+  List<int> _cpus;
   List<Thread> _threads;
-  std::atomic<Size> _push_index;
+  std::atomic<Scheduling_policy> _scheduling_policy;
+  // parked workers wait for the epoch to change
+  std::atomic<std::uint32_t> _epoch{};
+  std::atomic<Size> _parked_count{};
+  // parked Task_group::wait callers wait for a group to finish
+  std::atomic<std::uint32_t> _group_epoch{};
+  bool _collect_statistics{};
+  std::atomic<Clock::rep> _statistics_begin{};
+};
+
+struct Thread_pool_create_info {
+  Size thread_count{};
+  Scheduling_policy scheduling_policy{Scheduling_policy::block};
+  Size max_queue_size{Thread_pool::default_max_queue_size};
+  Thread_affinity affinity{Thread_affinity::none};
+  // Restricts the workers to the cpus of this numa node if not negative. With
+  // more workers than allowed cpus the workers share cpus.
+  int numa_node{-1};
+  // Enables Thread_pool::statistics, at the cost of two clock reads per task
+  bool collect_statistics{false};
+};
+
+// Tracks completion of a set of tasks pushed to a Thread_pool. Waiting runs
+// queued tasks on the waiting thread instead of blocking it, so waiting from
+// inside a task is fine. Once nothing is left to run the waiter spins for a
+// while, then parks until the last task of some group finishes.
+class Task_group {
+public:
+  explicit Task_group(Thread_pool *pool) noexcept : _pool{pool} {}
+
+  Task_group(Task_group const &other) = delete;
+
+  Task_group &operator=(Task_group const &other) = delete;
+
+  ~Task_group() { wait(); }
+
+  Thread_pool *pool() const noexcept { return _pool; }
+
+  Size push_notify(Task *task);
+
+  Size push_silent(Task *task);
+
+  void wait() noexcept;
+
+private:
+  friend class Thread_pool;
+
+  Thread_pool *_pool;
+  std::atomic<Size> _pending_count{};
 };
 } // namespace util
 } // namespace marlon
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,112 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+namespace {
+class Empty_task : public Task {
+public:
+  explicit Empty_task(std::atomic<Size> *counter) noexcept
+      : _counter{counter} {}
+
+  void run(Size) final { _counter->fetch_add(1, std::memory_order_release); }
+
+private:
+  std::atomic<Size> *_counter;
+};
+
+void run_empty_tasks(Thread_pool &pool, std::vector<Empty_task> &tasks,
+                     std::atomic<Size> &counter) {
+  counter.store(0, std::memory_order_relaxed);
+  for (auto &task : tasks) {
+    pool.push_silent(&task);
+  }
+  pool.notify();
+  auto const task_count = static_cast<Size>(tasks.size());
+  while (counter.load(std::memory_order_acquire) != task_count) {
+  }
+}
+
+void fork_join(Thread_pool &pool, std::vector<Empty_task> &tasks) {
+  auto group = Task_group{&pool};
+  for (auto &task : tasks) {
+    group.push_silent(&task);
+  }
+  pool.notify();
+  group.wait();
+}
+
+void print_statistics(std::string const &name, Thread_pool const &pool) {
+  auto total = Thread_statistics{};
+  for (auto i = Size{}; i <= pool.size(); ++i) {
+    auto const statistics = pool.statistics(i);
+    total.executed_task_count += statistics.executed_task_count;
+    total.successful_steal_count += statistics.successful_steal_count;
+    total.failed_steal_count += statistics.failed_steal_count;
+    total.wakeup_count += statistics.wakeup_count;
+    total.max_queued_task_count = std::max(total.max_queued_task_count,
+                                           statistics.max_queued_task_count);
+    total.running_time += statistics.running_time;
+    total.idle_time += statistics.idle_time;
+    total.parked_time += statistics.parked_time;
+  }
+  std::cout << name << ": " << total.executed_task_count << " tasks, "
+            << total.successful_steal_count << " steals, "
+            << total.failed_steal_count << " failed steals, "
+            << total.wakeup_count << " wakeups, "
+            << total.max_queued_task_count << " max queued, "
+            << total.running_time << " s running, " << total.idle_time
+            << " s idle, " << total.parked_time << " s parked\n";
+}
+} // namespace
+
+TEST_CASE("marlon::util::Thread_pool throughput") {
+  constexpr auto task_count = 1000;
+  auto counter = std::atomic<Size>{};
+  auto tasks = std::vector<Empty_task>(task_count, Empty_task{&counter});
+  auto const policies = std::array{
+      std::pair{Scheduling_policy::block, "block"},
+      std::pair{Scheduling_policy::spin, "spin"},
+      std::pair{Scheduling_policy::adaptive, "adaptive"},
+  };
+  for (auto const &[policy, policy_name] : policies) {
+    for (auto const thread_count : {1, 2, 4, 8}) {
+      auto pool = Thread_pool{thread_count, policy, task_count};
+      BENCHMARK("1000 empty tasks, " + std::to_string(thread_count) +
+                " threads, " + policy_name) {
+        run_empty_tasks(pool, tasks, counter);
+      };
+    }
+  }
+}
+
+TEST_CASE("marlon::util::Thread_pool fork-join latency") {
+  auto counter = std::atomic<Size>{};
+  for (auto const thread_count : {1, 2, 4, 8}) {
+    // one task per thread, including the joining one
+    auto tasks =
+        std::vector<Empty_task>(thread_count + 1, Empty_task{&counter});
+    auto pool = Thread_pool{{
+        .thread_count = thread_count,
+        .scheduling_policy = Scheduling_policy::adaptive,
+        .collect_statistics = true,
+    }};
+    auto const name = "fork-join of " + std::to_string(thread_count + 1) +
+                      " empty tasks, " + std::to_string(thread_count) +
+                      " threads";
+    BENCHMARK(name) { fork_join(pool, tasks); };
+    print_statistics(name, pool);
+  }
+}
+} // namespace util
+} // namespace marlon
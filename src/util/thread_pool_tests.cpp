@@ -0,0 +1,276 @@
+#include "thread_pool.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+namespace {
+class Counting_task : public Task {
+public:
+  explicit Counting_task(std::atomic<Size> *counter) noexcept
+      : _counter{counter} {}
+
+  void run(Size) final { _counter->fetch_add(1, std::memory_order_release); }
+
+private:
+  std::atomic<Size> *_counter;
+};
+
+class Sleeping_task : public Task {
+public:
+  explicit Sleeping_task(std::atomic<Size> *counter) noexcept
+      : _counter{counter} {}
+
+  void run(Size) final {
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    _counter->fetch_add(1, std::memory_order_release);
+  }
+
+private:
+  std::atomic<Size> *_counter;
+};
+
+class Spawning_task : public Task {
+public:
+  explicit Spawning_task(Thread_pool *pool,
+                         Counting_task *children,
+                         std::atomic<Size> *misplaced_count) noexcept
+      : _pool{pool}, _children{children}, _misplaced_count{misplaced_count} {}
+
+  void run(Size thread_index) final {
+    for (auto i = 0; i != 8; ++i) {
+      if (_pool->push_notify(&_children[i]) != thread_index) {
+        _misplaced_count->fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  Thread_pool *_pool;
+  Counting_task *_children;
+  std::atomic<Size> *_misplaced_count;
+};
+
+class Policy_task : public Task {
+public:
+  explicit Policy_task(Thread_pool *pool,
+                       Scheduling_policy policy,
+                       std::atomic<Size> *counter) noexcept
+      : _pool{pool}, _policy{policy}, _counter{counter} {}
+
+  void run(Size) final {
+    _pool->set_scheduling_policy(_policy);
+    _counter->fetch_add(1, std::memory_order_release);
+  }
+
+private:
+  Thread_pool *_pool;
+  Scheduling_policy _policy;
+  std::atomic<Size> *_counter;
+};
+
+void wait_for(std::atomic<Size> const &counter, Size value) {
+  while (counter.load(std::memory_order_acquire) != value) {
+    std::this_thread::yield();
+  }
+}
+} // namespace
+
+TEST_CASE("marlon::util::Thread_pool") {
+  constexpr auto task_count = 1000;
+  auto counter = std::atomic<Size>{};
+  auto tasks = std::vector<Counting_task>(task_count, Counting_task{&counter});
+  auto pool = Thread_pool{4, Scheduling_policy::block, task_count};
+  REQUIRE(pool.size() == 4);
+  for (auto &task : tasks) {
+    REQUIRE(pool.push_silent(&task) == pool.size());
+  }
+  pool.notify();
+  wait_for(counter, task_count);
+  pool.set_scheduling_policy(Scheduling_policy::spin);
+  for (auto &task : tasks) {
+    pool.push_notify(&task);
+  }
+  wait_for(counter, 2 * task_count);
+  pool.set_scheduling_policy(Scheduling_policy::block);
+  auto misplaced_count = std::atomic<Size>{};
+  auto spawners = std::vector<Spawning_task>{};
+  for (auto i = 0; i != task_count / 8; ++i) {
+    spawners.emplace_back(&pool, &tasks[i * 8], &misplaced_count);
+  }
+  for (auto &spawner : spawners) {
+    pool.push_notify(&spawner);
+  }
+  wait_for(counter, 3 * task_count);
+  REQUIRE(misplaced_count.load() == 0);
+}
+
+TEST_CASE("marlon::util::Thread_pool full queues") {
+  auto counter = std::atomic<Size>{};
+  auto tasks = std::vector<Counting_task>(10, Counting_task{&counter});
+  auto pool = Thread_pool{0, Scheduling_policy::block, 4};
+  for (auto &task : tasks) {
+    REQUIRE(pool.push_silent(&task) == pool.size());
+  }
+  // the tasks that did not fit ran on the pushing thread
+  REQUIRE(counter.load() == 6);
+  while (pool.run_task()) {
+  }
+  REQUIRE(counter.load() == 10);
+}
+
+TEST_CASE("marlon::util::Thread_pool concurrent outside threads") {
+  constexpr auto thread_count = 4;
+  constexpr auto task_count = 10000;
+  auto counter = std::atomic<Size>{};
+  auto tasks = std::vector<Counting_task>(thread_count * task_count,
+                                          Counting_task{&counter});
+  auto pool = Thread_pool{2, Scheduling_policy::block, 64};
+  {
+    auto threads = std::vector<std::jthread>{};
+    for (auto i = 0; i != thread_count; ++i) {
+      threads.emplace_back([&, i] {
+        for (auto j = 0; j != task_count; ++j) {
+          REQUIRE(pool.push_notify(&tasks[i * task_count + j]) == pool.size());
+          if (j % 16 == 0) {
+            pool.run_task();
+          }
+        }
+      });
+    }
+  }
+  while (pool.run_task()) {
+  }
+  wait_for(counter, thread_count * task_count);
+}
+
+TEST_CASE("marlon::util::Thread_pool adaptive") {
+  constexpr auto task_count = 1000;
+  auto counter = std::atomic<Size>{};
+  auto tasks = std::vector<Counting_task>(task_count, Counting_task{&counter});
+  auto pool = Thread_pool{4, Scheduling_policy::adaptive, task_count};
+  for (auto round = 1; round != 4; ++round) {
+    for (auto &task : tasks) {
+      pool.push_silent(&task);
+    }
+    pool.notify();
+    wait_for(counter, round * task_count);
+    // give the workers time to run out their spin window and park
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+  // switching policies from inside of the pool
+  auto policy_tasks = std::array{
+      Policy_task{&pool, Scheduling_policy::spin, &counter},
+      Policy_task{&pool, Scheduling_policy::block, &counter},
+      Policy_task{&pool, Scheduling_policy::adaptive, &counter},
+  };
+  for (auto &policy_task : policy_tasks) {
+    pool.push_notify(&policy_task);
+    wait_for(counter, 3 * task_count + (&policy_task - &policy_tasks[0]) + 1);
+  }
+}
+
+TEST_CASE("marlon::util::Thread_pool affinity") {
+  constexpr auto task_count = 1000;
+  auto counter = std::atomic<Size>{};
+  auto tasks = std::vector<Counting_task>(task_count, Counting_task{&counter});
+  for (auto const affinity : {Thread_affinity::none,
+                              Thread_affinity::logical_core,
+                              Thread_affinity::physical_core}) {
+    counter = 0;
+    auto pool = Thread_pool{{
+        .thread_count = 4,
+        .max_queue_size = task_count,
+        .affinity = affinity,
+        .numa_node = 0,
+    }};
+    for (auto &task : tasks) {
+      pool.push_silent(&task);
+    }
+    pool.notify();
+    wait_for(counter, task_count);
+  }
+  REQUIRE_THROWS(Thread_pool{{.thread_count = 1, .numa_node = 1 << 20}});
+}
+
+TEST_CASE("marlon::util::Thread_pool statistics") {
+  constexpr auto task_count = 1000;
+  auto counter = std::atomic<Size>{};
+  auto tasks = std::vector<Counting_task>(task_count, Counting_task{&counter});
+  auto pool = Thread_pool{{
+      .thread_count = 4,
+      .max_queue_size = task_count,
+      .collect_statistics = true,
+  }};
+  REQUIRE(pool.collects_statistics());
+  for (auto &task : tasks) {
+    pool.push_silent(&task);
+  }
+  pool.notify();
+  wait_for(counter, task_count);
+  // the last task may still be finishing its bookkeeping
+  std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  auto executed_task_count = Size{};
+  auto successful_steal_count = Size{};
+  for (auto i = Size{}; i != pool.size(); ++i) {
+    auto const statistics = pool.statistics(i);
+    executed_task_count += statistics.executed_task_count;
+    successful_steal_count += statistics.successful_steal_count;
+    REQUIRE(statistics.running_time >= 0.0);
+    REQUIRE(statistics.parked_time >= 0.0);
+    REQUIRE(statistics.idle_time > 0.0);
+  }
+  // workers take every task from the injection queue, which counts as a steal
+  REQUIRE(executed_task_count == task_count);
+  REQUIRE(successful_steal_count == task_count);
+  auto const outside_statistics = pool.statistics(pool.size());
+  REQUIRE(outside_statistics.executed_task_count == 0);
+  REQUIRE(outside_statistics.max_queued_task_count > 0);
+  REQUIRE(outside_statistics.max_queued_task_count <= task_count);
+  REQUIRE(outside_statistics.idle_time == 0.0);
+  pool.reset_statistics();
+  REQUIRE(pool.statistics(pool.size()).max_queued_task_count == 0);
+  auto const unmeasured_pool = Thread_pool{1};
+  REQUIRE(!unmeasured_pool.collects_statistics());
+  REQUIRE(unmeasured_pool.statistics(0).executed_task_count == 0);
+}
+
+TEST_CASE("marlon::util::Task_group") {
+  constexpr auto task_count = 1000;
+  auto counter = std::atomic<Size>{};
+  auto tasks = std::vector<Counting_task>(task_count, Counting_task{&counter});
+  for (auto const thread_count : {0, 4}) {
+    counter = 0;
+    auto pool = Thread_pool{thread_count, Scheduling_policy::block, task_count};
+    auto group = Task_group{&pool};
+    for (auto &task : tasks) {
+      REQUIRE(group.push_notify(&task) == pool.size());
+    }
+    group.wait();
+    REQUIRE(counter.load() == task_count);
+    REQUIRE(!pool.run_task());
+  }
+}
+
+TEST_CASE("marlon::util::Task_group parks until the last task finishes") {
+  auto pool = Thread_pool{2};
+  auto counter = std::atomic<Size>{};
+  for (auto round = Size{}; round != 10; ++round) {
+    auto task = Sleeping_task{&counter};
+    auto group = Task_group{&pool};
+    group.push_notify(&task);
+    // the worker takes the task, the waiter has nothing to run and parks
+    while (pool.run_task()) {
+    }
+    group.wait();
+    REQUIRE(counter.load() == round + 1);
+  }
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,180 @@
+#include "tracking_allocator.h"
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define MARLON_UTIL_HAS_BACKTRACE
+#endif
+
+#include <cstdlib>
+
+#include <ostream>
+
+namespace marlon {
+namespace util {
+namespace {
+constinit std::atomic<Allocation_tag *> allocation_tags{};
+
+void write_bytes(std::ostream &os, Size bytes) {
+  constexpr char const *units[]{"B", "KiB", "MiB", "GiB", "TiB"};
+  auto unit = 0;
+  auto value = static_cast<double>(bytes);
+  while (value >= 1024.0 && unit != 4) {
+    value /= 1024.0;
+    ++unit;
+  }
+  os << value << ' ' << units[unit];
+}
+
+void write_stack(std::ostream &os, Allocation_stack const &stack) {
+  os << "    ";
+  write_bytes(os, stack.size);
+  os << " allocated at\n";
+#ifdef MARLON_UTIL_HAS_BACKTRACE
+  auto const symbols = backtrace_symbols(stack.frames.data(), stack.depth);
+  for (auto i = 0; i != stack.depth; ++i) {
+    os << "      " << (symbols != nullptr ? symbols[i] : "?") << '\n';
+  }
+  std::free(symbols);
+#else
+  for (auto i = 0; i != stack.depth; ++i) {
+    os << "      " << stack.frames[i] << '\n';
+  }
+#endif
+}
+} // namespace
+
+Allocation_statistics Allocation_tag::statistics() const noexcept {
+  auto result = Allocation_statistics{
+      .allocation_count = _allocation_count.load(std::memory_order_relaxed),
+      .free_count = _free_count.load(std::memory_order_relaxed),
+      .allocated_bytes = _allocated_bytes.load(std::memory_order_relaxed),
+      .freed_bytes = _freed_bytes.load(std::memory_order_relaxed),
+      .current_bytes = _current_bytes.load(std::memory_order_relaxed),
+      .peak_bytes = _peak_bytes.load(std::memory_order_relaxed),
+      .size_histogram = {},
+  };
+  for (auto i = 0; i != allocation_size_bucket_count; ++i) {
+    result.size_histogram[i] =
+        _size_histogram[i].load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+std::array<Allocation_stack, tracked_allocation_stack_count>
+Allocation_tag::largest_allocation_stacks() const {
+  auto const lock = std::scoped_lock{_stacks_mutex};
+  return _stacks;
+}
+
+void Allocation_tag::record_alloc(Size size) noexcept {
+  if (!_registered.load(std::memory_order_acquire)) {
+    register_tag();
+  }
+  _allocation_count.fetch_add(1, std::memory_order_relaxed);
+  _allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  _size_histogram[size_bucket(size)].fetch_add(1, std::memory_order_relaxed);
+  auto const current =
+      _current_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  auto peak = _peak_bytes.load(std::memory_order_relaxed);
+  while (peak < current && !_peak_bytes.compare_exchange_weak(
+                               peak, current, std::memory_order_relaxed)) {
+  }
+  if constexpr (allocation_stack_tracking_enabled) {
+    record_stack(size);
+  }
+}
+
+void Allocation_tag::record_free(Size size) noexcept {
+  _free_count.fetch_add(1, std::memory_order_relaxed);
+  _freed_bytes.fetch_add(size, std::memory_order_relaxed);
+  _current_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void Allocation_tag::reset_statistics() noexcept {
+  _allocation_count.store(0, std::memory_order_relaxed);
+  _free_count.store(0, std::memory_order_relaxed);
+  _allocated_bytes.store(0, std::memory_order_relaxed);
+  _freed_bytes.store(0, std::memory_order_relaxed);
+  _peak_bytes.store(_current_bytes.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+  for (auto &bucket : _size_histogram) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  auto const lock = std::scoped_lock{_stacks_mutex};
+  _stacks = {};
+}
+
+void Allocation_tag::register_tag() noexcept {
+  if (_registered.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  _next = allocation_tags.load(std::memory_order_relaxed);
+  while (!allocation_tags.compare_exchange_weak(
+      _next, this, std::memory_order_release, std::memory_order_relaxed)) {
+  }
+}
+
+void Allocation_tag::record_stack(Size size) noexcept {
+  auto const lock = std::scoped_lock{_stacks_mutex};
+  auto const smallest = std::min_element(
+      _stacks.begin(), _stacks.end(), [](auto const &lhs, auto const &rhs) {
+        return lhs.size < rhs.size;
+      });
+  if (size <= smallest->size) {
+    return;
+  }
+  smallest->size = size;
+#ifdef MARLON_UTIL_HAS_BACKTRACE
+  smallest->depth =
+      backtrace(smallest->frames.data(), max_allocation_stack_depth);
+#else
+  smallest->depth = 0;
+#endif
+  std::sort(
+      _stacks.begin(), _stacks.end(), [](auto const &lhs, auto const &rhs) {
+        return lhs.size > rhs.size;
+      });
+}
+
+Allocation_tag *first_allocation_tag() noexcept {
+  return allocation_tags.load(std::memory_order_acquire);
+}
+
+void write_allocation_report(std::ostream &os) {
+  if constexpr (!allocation_tracking_enabled) {
+    os << "allocation tracking is compiled out, define "
+          "MARLON_UTIL_TRACK_ALLOCATIONS to enable it\n";
+  }
+  for (auto tag = first_allocation_tag(); tag != nullptr; tag = tag->next()) {
+    auto const statistics = tag->statistics();
+    os << tag->name() << ":\n  current ";
+    write_bytes(os, statistics.current_bytes);
+    os << ", peak ";
+    write_bytes(os, statistics.peak_bytes);
+    os << "\n  " << statistics.allocation_count << " allocations of ";
+    write_bytes(os, statistics.allocated_bytes);
+    os << ", " << statistics.free_count << " frees of ";
+    write_bytes(os, statistics.freed_bytes);
+    os << '\n';
+    for (auto i = 0; i != allocation_size_bucket_count; ++i) {
+      if (statistics.size_histogram[i] != 0) {
+        os << "  [";
+        write_bytes(os, i != 0 ? Size{1} << (i - 1) : 0);
+        os << ", ";
+        if (i + 1 != allocation_size_bucket_count) {
+          write_bytes(os, Size{1} << i);
+        } else {
+          os << "inf";
+        }
+        os << "): " << statistics.size_histogram[i] << '\n';
+      }
+    }
+    for (auto const &stack : tag->largest_allocation_stacks()) {
+      if (stack.size != 0) {
+        write_stack(os, stack);
+      }
+    }
+  }
+}
+} // namespace util
+} // namespace marlon
@@ -0,0 +1,182 @@
+#ifndef MARLON_UTIL_TRACKING_ALLOCATOR_H
+#define MARLON_UTIL_TRACKING_ALLOCATOR_H
+
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <iosfwd>
+#include <mutex>
+#include <utility>
+
+#include "memory.h"
+
+namespace marlon {
+namespace util {
+// Tracking_allocator records statistics only if the build defines
+// MARLON_UTIL_TRACK_ALLOCATIONS, otherwise it forwards to its parent and
+// costs nothing. MARLON_UTIL_TRACK_ALLOCATION_STACKS additionally records the
+// call stacks of the largest allocations of every tag.
+#ifdef MARLON_UTIL_TRACK_ALLOCATIONS
+inline constexpr auto allocation_tracking_enabled = true;
+#else
+inline constexpr auto allocation_tracking_enabled = false;
+#endif
+
+#ifdef MARLON_UTIL_TRACK_ALLOCATION_STACKS
+inline constexpr auto allocation_stack_tracking_enabled = true;
+#else
+inline constexpr auto allocation_stack_tracking_enabled = false;
+#endif
+
+// Bucket i of an allocation size histogram counts sizes in [2^(i-1), 2^i),
+// the last one also counts everything larger
+inline constexpr auto allocation_size_bucket_count = 40;
+
+// Number of largest allocations whose call stacks a tag keeps
+inline constexpr auto tracked_allocation_stack_count = 4;
+
+inline constexpr auto max_allocation_stack_depth = 16;
+
+struct Allocation_stack {
+  Size size;
+  int depth;
+  std::array<void *, max_allocation_stack_depth> frames;
+};
+
+struct Allocation_statistics {
+  Size allocation_count;
+  Size free_count;
+  Size allocated_bytes;
+  Size freed_bytes;
+  Size current_bytes;
+  Size peak_bytes;
+  std::array<Size, allocation_size_bucket_count> size_histogram;
+};
+
+// Statistics of the allocations of one subsystem. Tags are meant to be
+// constinit globals, they add themselves to the report on their first
+// allocation and must outlive every report.
+class Allocation_tag {
+public:
+  explicit constexpr Allocation_tag(char const *name) noexcept
+      : _name{name} {}
+
+  Allocation_tag(Allocation_tag const &other) = delete;
+
+  Allocation_tag &operator=(Allocation_tag const &other) = delete;
+
+  char const *name() const noexcept { return _name; }
+
+  // The tag registered before this one, see first_allocation_tag
+  Allocation_tag *next() const noexcept { return _next; }
+
+  // Each counter is read atomically, but not all of them at once
+  Allocation_statistics statistics() const noexcept;
+
+  // Largest allocations first, empty unless stacks are tracked
+  std::array<Allocation_stack, tracked_allocation_stack_count>
+  largest_allocation_stacks() const;
+
+  void record_alloc(Size size) noexcept;
+
+  void record_free(Size size) noexcept;
+
+  // Zeroes every counter but current_bytes, peak_bytes starts over from it
+  void reset_statistics() noexcept;
+
+  static int size_bucket(Size size) noexcept {
+    return std::min(static_cast<int>(std::bit_width(
+                        static_cast<std::uint64_t>(std::max(size, Size{})))),
+                    allocation_size_bucket_count - 1);
+  }
+
+private:
+  void register_tag() noexcept;
+
+  void record_stack(Size size) noexcept;
+
+  char const *_name;
+  Allocation_tag *_next{};
+  std::atomic<bool> _registered{};
+  std::atomic<Size> _allocation_count{};
+  std::atomic<Size> _free_count{};
+  std::atomic<Size> _allocated_bytes{};
+  std::atomic<Size> _freed_bytes{};
+  std::atomic<Size> _current_bytes{};
+  std::atomic<Size> _peak_bytes{};
+  std::array<std::atomic<Size>, allocation_size_bucket_count>
+      _size_histogram{};
+  mutable std::mutex _stacks_mutex;
+  std::array<Allocation_stack, tracked_allocation_stack_count> _stacks{};
+};
+
+// The tag that first allocated most recently, follow next() for the others
+Allocation_tag *first_allocation_tag() noexcept;
+
+// Writes the statistics of every tag in a human readable form
+void write_allocation_report(std::ostream &os);
+
+// Decorates Parent so that its allocations count towards a tag. Frees must
+// go through an allocator with the same tag.
+template <typename Parent, bool Enabled = allocation_tracking_enabled>
+class Tracking_allocator {
+public:
+  explicit Tracking_allocator(Parent const &parent,
+                              Allocation_tag &tag) noexcept
+      : _parent{parent}, _tag{&tag} {}
+
+  explicit Tracking_allocator(Parent &&parent, Allocation_tag &tag) noexcept
+      : _parent{std::move(parent)}, _tag{&tag} {}
+
+  Parent const &parent() const noexcept { return _parent; }
+
+  Parent &parent() noexcept { return _parent; }
+
+  Allocation_tag &tag() const noexcept { return *_tag; }
+
+  Block alloc(Size size) {
+    auto const result = _parent.alloc(size);
+    if constexpr (Enabled) {
+      _tag->record_alloc(size);
+    }
+    return result;
+  }
+
+  void free(Const_block block) noexcept {
+    if constexpr (Enabled) {
+      _tag->record_free(block.size());
+    }
+    _parent.free(block);
+  }
+
+private:
+  Parent _parent;
+  Allocation_tag *_tag;
+};
+
+template <typename Parent> class Tracking_allocator<Parent, false> {
+public:
+  explicit Tracking_allocator(Parent const &parent, Allocation_tag &) noexcept
+      : _parent{parent} {}
+
+  explicit Tracking_allocator(Parent &&parent, Allocation_tag &) noexcept
+      : _parent{std::move(parent)} {}
+
+  Parent const &parent() const noexcept { return _parent; }
+
+  Parent &parent() noexcept { return _parent; }
+
+  Block alloc(Size size) { return _parent.alloc(size); }
+
+  void free(Const_block block) noexcept { _parent.free(block); }
+
+private:
+  [[no_unique_address]] Parent _parent;
+};
+} // namespace util
+} // namespace marlon
+
+#endif
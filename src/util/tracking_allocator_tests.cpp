@@ -0,0 +1,75 @@
+#include "tracking_allocator.h"
+
+#include <sstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+namespace {
+constinit auto test_allocation_tag =
+    Allocation_tag{"util::Tracking_allocator tests"};
+
+constinit auto unused_allocation_tag =
+    Allocation_tag{"util::Tracking_allocator unused"};
+} // namespace
+
+TEST_CASE("marlon::util::Tracking_allocator") {
+  test_allocation_tag.reset_statistics();
+  auto allocator = Tracking_allocator<System_allocator, true>{
+      System_allocator{}, test_allocation_tag};
+  auto const first = allocator.alloc(100);
+  auto const second = allocator.alloc(5000);
+  auto statistics = test_allocation_tag.statistics();
+  REQUIRE(statistics.allocation_count == 2);
+  REQUIRE(statistics.allocated_bytes == 5100);
+  REQUIRE(statistics.current_bytes == 5100);
+  REQUIRE(statistics.peak_bytes == 5100);
+  REQUIRE(statistics.size_histogram[Allocation_tag::size_bucket(100)] == 1);
+  REQUIRE(statistics.size_histogram[Allocation_tag::size_bucket(5000)] == 1);
+  allocator.free(second);
+  auto const third = allocator.alloc(10);
+  allocator.free(third);
+  allocator.free(first);
+  statistics = test_allocation_tag.statistics();
+  REQUIRE(statistics.allocation_count == 3);
+  REQUIRE(statistics.free_count == 3);
+  REQUIRE(statistics.allocated_bytes == 5110);
+  REQUIRE(statistics.freed_bytes == 5110);
+  REQUIRE(statistics.current_bytes == 0);
+  REQUIRE(statistics.peak_bytes == 5100);
+  auto found = false;
+  auto found_unused = false;
+  for (auto tag = first_allocation_tag(); tag != nullptr; tag = tag->next()) {
+    found = found || tag == &test_allocation_tag;
+    found_unused = found_unused || tag == &unused_allocation_tag;
+  }
+  REQUIRE(found);
+  REQUIRE(!found_unused);
+  auto report = std::ostringstream{};
+  write_allocation_report(report);
+  REQUIRE(report.str().find("util::Tracking_allocator tests") !=
+          std::string::npos);
+}
+
+TEST_CASE("marlon::util::Tracking_allocator compiled out") {
+  test_allocation_tag.reset_statistics();
+  auto allocator = Tracking_allocator<System_allocator, false>{
+      System_allocator{}, test_allocation_tag};
+  static_assert(sizeof(allocator) == 1);
+  allocator.free(allocator.alloc(100));
+  REQUIRE(test_allocation_tag.statistics().allocation_count == 0);
+}
+
+TEST_CASE("marlon::util::Allocation_tag::size_bucket") {
+  REQUIRE(Allocation_tag::size_bucket(0) == 0);
+  REQUIRE(Allocation_tag::size_bucket(1) == 1);
+  REQUIRE(Allocation_tag::size_bucket(2) == 2);
+  REQUIRE(Allocation_tag::size_bucket(3) == 2);
+  REQUIRE(Allocation_tag::size_bucket(4) == 3);
+  REQUIRE(Allocation_tag::size_bucket(Size{1} << 60) ==
+          allocation_size_bucket_count - 1);
+}
+} // namespace util
+} // namespace marlon
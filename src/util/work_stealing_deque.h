@@ -0,0 +1,172 @@
+#ifndef MARLON_UTIL_WORK_STEALING_DEQUE_H
+#define MARLON_UTIL_WORK_STEALING_DEQUE_H
+
+#include <cstddef>
+
+#include <atomic>
+#include <bit>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "capacity_error.h"
+#include "memory.h"
+
+namespace marlon {
+namespace util {
+// Fixed capacity Chase-Lev deque.
+// push and pop may only be called by the owning thread, steal may be called by
+// any thread. T must be trivially copyable.
+template <typename T> class Work_stealing_deque {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  template <typename Allocator>
+  static std::pair<Block, Work_stealing_deque> make(Allocator &allocator,
+                                                    Size max_size) {
+    auto const block = allocator.alloc(memory_requirement(max_size));
+    return {block, Work_stealing_deque{block, max_size}};
+  }
+
+  static constexpr Size memory_requirement(Size max_size) noexcept {
+    if (max_size != 0) {
+      return static_cast<Size>(
+          sizeof(std::atomic<T>) *
+          std::bit_ceil(static_cast<std::size_t>(max_size)));
+    } else {
+      return 0;
+    }
+  }
+
+  constexpr Work_stealing_deque() noexcept = default;
+
+  explicit Work_stealing_deque(Block block, Size max_size) noexcept
+      : Work_stealing_deque{block.begin, max_size} {}
+
+  explicit Work_stealing_deque(void *block, Size max_size) noexcept
+      : _slots{static_cast<std::atomic<T> *>(block),
+               max_size != 0 ? std::bit_ceil(static_cast<std::size_t>(max_size))
+                             : 0} {
+    for (auto &slot : _slots) {
+      new (&slot) std::atomic<T>{};
+    }
+  }
+
+  // not thread safe
+  Work_stealing_deque(Work_stealing_deque &&other) noexcept
+      : _slots{std::exchange(other._slots, std::span<std::atomic<T>>{})},
+        _top{other._top.exchange(0, std::memory_order_relaxed)},
+        _bottom{other._bottom.exchange(0, std::memory_order_relaxed)} {}
+
+  // not thread safe
+  Work_stealing_deque &operator=(Work_stealing_deque &&other) noexcept {
+    auto temp = Work_stealing_deque{std::move(other)};
+    swap(temp);
+    return *this;
+  }
+
+  Const_block block() const noexcept {
+    return {reinterpret_cast<std::byte const *>(_slots.data()),
+            static_cast<Size>(_slots.size_bytes())};
+  }
+
+  // approximate when called concurrently with push, pop or steal
+  bool empty() const noexcept { return size() <= 0; }
+
+  // approximate when called concurrently with push, pop or steal
+  Size size() const noexcept {
+    auto const bottom = _bottom.load(std::memory_order_relaxed);
+    auto const top = _top.load(std::memory_order_relaxed);
+    return bottom - top;
+  }
+
+  Size max_size() const noexcept { return _slots.size(); }
+
+  Size capacity() const noexcept { return max_size(); }
+
+  void push(T value) {
+    if (!try_push(value)) {
+      throw Capacity_error{"Capacity_error in Work_stealing_deque::push"};
+    }
+  }
+
+  // Returns false if the deque is full
+  bool try_push(T value) noexcept {
+    auto const bottom = _bottom.load(std::memory_order_relaxed);
+    auto const top = _top.load(std::memory_order_acquire);
+    if (bottom - top >= max_size()) {
+      return false;
+    }
+    _slots[bottom & (max_size() - 1)].store(value, std::memory_order_relaxed);
+    _bottom.store(bottom + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::optional<T> pop() noexcept {
+    auto const bottom = _bottom.load(std::memory_order_relaxed) - 1;
+    _bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = _top.load(std::memory_order_relaxed);
+    if (top <= bottom) {
+      auto result = std::optional<T>{
+          _slots[bottom & (max_size() - 1)].load(std::memory_order_relaxed)};
+      if (top == bottom) {
+        // last element, race against thieves for it
+        if (!_top.compare_exchange_strong(top,
+                                          top + 1,
+                                          std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+          result = std::nullopt;
+        }
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+      }
+      return result;
+    } else {
+      _bottom.store(bottom + 1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+  }
+
+  // returns nullopt if the deque is empty or another thread won the race
+  std::optional<T> steal() noexcept {
+    auto top = _top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto const bottom = _bottom.load(std::memory_order_acquire);
+    if (top < bottom) {
+      auto const result =
+          _slots[top & (max_size() - 1)].load(std::memory_order_relaxed);
+      if (_top.compare_exchange_strong(top,
+                                       top + 1,
+                                       std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+        return result;
+      }
+    }
+    return std::nullopt;
+  }
+
+private:
+  void swap(Work_stealing_deque &other) noexcept {
+    std::swap(_slots, other._slots);
+    auto const top = _top.load(std::memory_order_relaxed);
+    auto const bottom = _bottom.load(std::memory_order_relaxed);
+    _top.store(other._top.load(std::memory_order_relaxed),
+               std::memory_order_relaxed);
+    _bottom.store(other._bottom.load(std::memory_order_relaxed),
+                  std::memory_order_relaxed);
+    other._top.store(top, std::memory_order_relaxed);
+    other._bottom.store(bottom, std::memory_order_relaxed);
+  }
+
+  std::span<std::atomic<T>> _slots;
+  // keep top and bottom on separate cache lines without requiring an
+  // over-aligned placement
+  std::atomic<Size> _top{};
+  std::byte _padding[cache_line_size - sizeof(std::atomic<Size>)]{};
+  std::atomic<Size> _bottom{};
+};
+} // namespace util
+} // namespace marlon
+
+#endif
@@ -0,0 +1,80 @@
+#include "work_stealing_deque.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace marlon {
+namespace util {
+TEST_CASE("marlon::util::Work_stealing_deque") {
+  auto const block =
+      Unique_block<>{Work_stealing_deque<int>::memory_requirement(1000)};
+  auto deque = Work_stealing_deque<int>{block.get(), 1000};
+  REQUIRE(deque.empty());
+  REQUIRE(deque.max_size() == 1024);
+  for (int i = 0; i < 10; ++i) {
+    deque.push(i);
+  }
+  REQUIRE(deque.size() == 10);
+  REQUIRE(deque.pop() == 9);
+  REQUIRE(deque.steal() == 0);
+  REQUIRE(deque.pop() == 8);
+  REQUIRE(deque.steal() == 1);
+  REQUIRE(deque.size() == 6);
+  for (int i = 6; i < 1024; ++i) {
+    deque.push(i);
+  }
+  REQUIRE_THROWS_AS(deque.push(1024), Capacity_error);
+  REQUIRE(!deque.try_push(1024));
+  REQUIRE(deque.pop() == 1023);
+  while (deque.pop()) {
+  }
+  REQUIRE(deque.empty());
+  REQUIRE(!deque.steal());
+}
+
+TEST_CASE("marlon::util::Work_stealing_deque contention") {
+  auto const block =
+      Unique_block<>{Work_stealing_deque<int>::memory_requirement(1000)};
+  auto deque = Work_stealing_deque<int>{block.get(), 1000};
+  constexpr auto item_count = 200000;
+  constexpr auto thief_count = 4;
+  auto taken = std::vector<std::atomic<int>>(item_count);
+  auto done = std::atomic<bool>{};
+  auto thieves = std::vector<std::jthread>{};
+  for (auto i = 0; i != thief_count; ++i) {
+    thieves.emplace_back([&] {
+      while (!done.load(std::memory_order_acquire)) {
+        if (auto const item = deque.steal()) {
+          taken[*item].fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  for (auto i = 0; i != item_count;) {
+    // push in bursts and pop some back to exercise the owner side races
+    for (auto j = 0; j != 64 && i != item_count; ++j, ++i) {
+      while (deque.size() >= deque.max_size()) {
+        std::this_thread::yield();
+      }
+      deque.push(i);
+    }
+    for (auto j = 0; j != 16; ++j) {
+      if (auto const item = deque.pop()) {
+        taken[*item].fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+  while (auto const item = deque.pop()) {
+    taken[*item].fetch_add(1, std::memory_order_relaxed);
+  }
+  done.store(true, std::memory_order_release);
+  thieves.clear();
+  for (auto const &count : taken) {
+    REQUIRE(count.load() == 1);
+  }
+}
+} // namespace util
+} // namespace marlon